@@ -22,7 +22,10 @@
 // each row comes from the array as it is right then. A level change between two
 // calls can shift what an index means and shorten the array, so a row index that
 // was valid a moment ago answers BML_ERROR_NOT_FOUND. Read the count again rather
-// than keeping it.
+// than keeping it. Since minor 1 each collection can also be read as a range of
+// rows in one call, which looks the array up and checks its columns once for the
+// whole range instead of once per row; the C++ list readers use that when the
+// loader has it.
 //
 // Nothing here writes: changing gameplay state still goes through the Virtools
 // arrays directly.
@@ -36,7 +39,7 @@ BML_BEGIN_CDECLS
 
 #define BML_GAMEPLAY_INTERFACE_ID "bml.gameplay"
 #define BML_GAMEPLAY_INTERFACE_MAJOR 1
-#define BML_GAMEPLAY_INTERFACE_MINOR 0
+#define BML_GAMEPLAY_INTERFACE_MINOR 1
 
 // Capacity of each of the three name buffers below, terminator included.
 #define BML_GAMEPLAY_NAME_CAPACITY 128u
@@ -109,13 +112,23 @@ typedef struct BML_GameplayInterface {
 
     int (*ReadResetpointCount)(size_t *out);
     int (*ReadResetpoint)(size_t index, BML_GameplayResetpoint *out);
+
+    // Minor 1. Read the rows first to first + count - 1 into out[0] onward, as the
+    // array is right then, and set *written to how many were read. That is fewer
+    // than count when the array ends sooner, and 0 when first is past the last
+    // row, which still answers BML_OK.
+    int (*ReadCatalogEntries)(size_t first, size_t count, BML_GameplayCatalogEntry *out, size_t *written);
+    int (*ReadCheckpoints)(size_t first, size_t count, BML_GameplayCheckpoint *out, size_t *written);
+    int (*ReadResetpoints)(size_t first, size_t count, BML_GameplayResetpoint *out, size_t *written);
 } BML_GameplayInterface;
 
 BML_END_CDECLS
 
 #ifdef __cplusplus
 
+#include <algorithm>
 #include <cstddef>
+#include <limits>
 #include <new>
 #include <string>
 #include <utility>
@@ -183,6 +196,60 @@ int ReadList(int (*readCount)(std::size_t *), int (*readRow)(std::size_t, Row *)
     return BML_OK;
 }
 
+// Reads up to count rows from first with one call to a minor 1 range member and
+// replaces out with the ones that were there. count is clamped to the rows the
+// collection has past first, so the buffer never outgrows the collection.
+template <typename Value, typename Row, typename Convert>
+int ReadRange(int (*readCount)(std::size_t *), int (*readRange)(std::size_t, std::size_t, Row *, std::size_t *),
+              std::size_t first, std::size_t count, std::vector<Value> &out, Convert convert) {
+    std::size_t total = 0;
+    const int countStatus = readCount(&total);
+    if (countStatus != BML_OK)
+        return countStatus;
+    count = first < total ? (std::min)(count, total - first) : 0;
+
+    std::vector<Value> values;
+    try {
+        std::vector<Row> rows(count, Row{});
+        std::size_t written = 0;
+        if (count != 0) {
+            const int status = readRange(first, count, rows.data(), &written);
+            if (status != BML_OK)
+                return status;
+        }
+        values.reserve(written);
+        for (std::size_t index = 0; index < written && index < count; ++index)
+            values.push_back(convert(rows[index]));
+    } catch (const std::bad_alloc &) {
+        return BML_ERROR_OUT_OF_MEMORY;
+    }
+    out = std::move(values);
+    return BML_OK;
+}
+
+// A whole collection: the count, then the rows in one range read when the loader
+// has the range member, or one row at a time when it does not.
+template <typename Value, typename Row, typename Convert>
+int ReadList(int (*readCount)(std::size_t *), int (*readRow)(std::size_t, Row *),
+             int (*readRange)(std::size_t, std::size_t, Row *, std::size_t *),
+             std::vector<Value> &out, Convert convert) {
+    if (!readRange)
+        return ReadList(readCount, readRow, out, convert);
+    return ReadRange(readCount, readRange, 0, (std::numeric_limits<std::size_t>::max)(), out, convert);
+}
+
+inline CatalogEntry ToCatalogEntry(const BML_GameplayCatalogEntry &row) {
+    return CatalogEntry{std::string(row.File), std::string(row.StartBall), std::string(row.Sky), row.Bonus, row.Music,
+                        row.FileLength >= static_cast<int>(BML_GAMEPLAY_NAME_CAPACITY),
+                        row.StartBallLength >= static_cast<int>(BML_GAMEPLAY_NAME_CAPACITY),
+                        row.SkyLength >= static_cast<int>(BML_GAMEPLAY_NAME_CAPACITY)};
+}
+
+template <typename Row>
+Row Copy(const Row &row) {
+    return row;
+}
+
 } // namespace Detail
 
 // Whether the running loader carries this interface. The functions below check
@@ -212,14 +279,10 @@ int ReadList(int (*readCount)(std::size_t *), int (*readRow)(std::size_t, Row *)
     if (!BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadCatalogCount) ||
         !BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadCatalogEntry))
         return BML_ERROR_NOT_FOUND;
-    return Detail::ReadList(gameplay->ReadCatalogCount, gameplay->ReadCatalogEntry, out,
-                            [](const BML_GameplayCatalogEntry &row) {
-                                return CatalogEntry{std::string(row.File), std::string(row.StartBall),
-                                                    std::string(row.Sky), row.Bonus, row.Music,
-                                                    row.FileLength >= static_cast<int>(BML_GAMEPLAY_NAME_CAPACITY),
-                                                    row.StartBallLength >= static_cast<int>(BML_GAMEPLAY_NAME_CAPACITY),
-                                                    row.SkyLength >= static_cast<int>(BML_GAMEPLAY_NAME_CAPACITY)};
-                            });
+    return Detail::ReadList(
+        gameplay->ReadCatalogCount, gameplay->ReadCatalogEntry,
+        BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadCatalogEntries) ? gameplay->ReadCatalogEntries : nullptr,
+        out, Detail::ToCatalogEntry);
 }
 
 [[nodiscard]] inline int ReadCheckpoints(std::vector<Checkpoint> &out) {
@@ -227,8 +290,10 @@ int ReadList(int (*readCount)(std::size_t *), int (*readRow)(std::size_t, Row *)
     if (!BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadCheckpointCount) ||
         !BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadCheckpoint))
         return BML_ERROR_NOT_FOUND;
-    return Detail::ReadList(gameplay->ReadCheckpointCount, gameplay->ReadCheckpoint, out,
-                            [](const BML_GameplayCheckpoint &row) { return row; });
+    return Detail::ReadList(
+        gameplay->ReadCheckpointCount, gameplay->ReadCheckpoint,
+        BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadCheckpoints) ? gameplay->ReadCheckpoints : nullptr,
+        out, Detail::Copy<Checkpoint>);
 }
 
 [[nodiscard]] inline int ReadResetpoints(std::vector<Resetpoint> &out) {
@@ -236,8 +301,31 @@ int ReadList(int (*readCount)(std::size_t *), int (*readRow)(std::size_t, Row *)
     if (!BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadResetpointCount) ||
         !BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadResetpoint))
         return BML_ERROR_NOT_FOUND;
-    return Detail::ReadList(gameplay->ReadResetpointCount, gameplay->ReadResetpoint, out,
-                            [](const BML_GameplayResetpoint &row) { return row; });
+    return Detail::ReadList(
+        gameplay->ReadResetpointCount, gameplay->ReadResetpoint,
+        BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadResetpoints) ? gameplay->ReadResetpoints : nullptr,
+        out, Detail::Copy<Resetpoint>);
+}
+
+// The range readers replace out with the rows first to first + count - 1 that
+// the collection has right now, which can be fewer than count. They need a
+// loader with minor 1 and answer BML_ERROR_NOT_FOUND otherwise.
+[[nodiscard]] inline int ReadCheckpoints(std::size_t first, std::size_t count, std::vector<Checkpoint> &out) {
+    const BML_GameplayInterface *gameplay = Detail::Interface();
+    if (!BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadCheckpointCount) ||
+        !BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadCheckpoints))
+        return BML_ERROR_NOT_FOUND;
+    return Detail::ReadRange(gameplay->ReadCheckpointCount, gameplay->ReadCheckpoints, first, count, out,
+                             Detail::Copy<Checkpoint>);
+}
+
+[[nodiscard]] inline int ReadResetpoints(std::size_t first, std::size_t count, std::vector<Resetpoint> &out) {
+    const BML_GameplayInterface *gameplay = Detail::Interface();
+    if (!BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadResetpointCount) ||
+        !BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadResetpoints))
+        return BML_ERROR_NOT_FOUND;
+    return Detail::ReadRange(gameplay->ReadResetpointCount, gameplay->ReadResetpoints, first, count, out,
+                             Detail::Copy<Resetpoint>);
 }
 
 } // namespace BML::Gameplay
@@ -20,6 +20,11 @@
 // Watch the two distinct failure modes on the Find functions: a name that matches
 // nothing still returns BML_OK and writes a null ref, because "absent" is an
 // answer rather than an error. Check out.Domain, not just the status.
+//
+// A Mod following many objects every frame should read them with one call to
+// ReadObjects or ReadEntityTransforms rather than one call per object. Both take
+// an array of refs and fill the matching element of out and of statuses for
+// each, so one stale ref costs that element and not the rest of the batch.
 #ifndef BML_SCENE_H
 #define BML_SCENE_H
 
@@ -30,7 +35,7 @@ BML_BEGIN_CDECLS
 
 #define BML_SCENE_INTERFACE_ID "bml.scene"
 #define BML_SCENE_INTERFACE_MAJOR 1
-#define BML_SCENE_INTERFACE_MINOR 0
+#define BML_SCENE_INTERFACE_MINOR 1
 
 // Capacity of the Name buffer below, terminator included.
 #define BML_SCENE_NAME_CAPACITY 128u
@@ -78,13 +83,24 @@ typedef struct BML_SceneInterface {
     // family: pass CKCID_3DOBJECT here instead of calling IBML::Get3dObjectByName.
     // Writes a null ref and still answers BML_OK when nothing matches.
     int (*FindObjectOfClass)(const char *name, int classId, BML_ObjectRef *out);
+
+    // Minor 1. Read count objects at once. statuses[i] is what ReadObject or
+    // ReadEntityTransform would have answered for objects[i], and out[i] is only
+    // filled where that is BML_OK. Answers BML_OK when every element did and
+    // BML_ERROR_OBJECT_INVALID when at least one did not; statuses may be null
+    // when the caller only needs to know that. A count of 0 answers BML_OK.
+    int (*ReadObjects)(const BML_ObjectRef *objects, size_t count, BML_SceneObjectInfo *out, int *statuses);
+    int (*ReadEntityTransforms)(const BML_ObjectRef *objects, size_t count, BML_SceneEntityTransform *out,
+                                int *statuses);
 } BML_SceneInterface;
 
 BML_END_CDECLS
 
 #ifdef __cplusplus
 
+#include <new>
 #include <string>
+#include <vector>
 
 namespace BML::Scene {
 
@@ -115,6 +131,39 @@ inline const BML_SceneInterface *Interface() {
     return found;
 }
 
+inline ObjectInfo ToObjectInfo(const BML_SceneObjectInfo &info) {
+    return {info.Id, std::string(info.Name), info.ClassId, info.Visible != 0, info.Dynamic != 0,
+            info.NameLength >= static_cast<int>(BML_SCENE_NAME_CAPACITY)};
+}
+
+// The shared body of the two batch readers. A loader older than minor 1 has no
+// batch member, so the batch is read one object at a time instead, with the same
+// result. out and statuses are resized to the number of objects. A failure that
+// is not about one object, such as the wrong thread, is answered for the batch.
+template <typename Row, typename BatchReader, typename Reader>
+int ReadBatch(const std::vector<ObjectRef> &objects, std::vector<Row> &out, std::vector<int> &statuses,
+              BatchReader readBatch, Reader readOne) {
+    try {
+        out.assign(objects.size(), Row{});
+        statuses.assign(objects.size(), BML_OK);
+    } catch (const std::bad_alloc &) {
+        return BML_ERROR_OUT_OF_MEMORY;
+    }
+    if (objects.empty())
+        return BML_OK;
+    if (readBatch)
+        return readBatch(objects.data(), objects.size(), out.data(), statuses.data());
+    int result = BML_OK;
+    for (std::size_t index = 0; index < objects.size(); ++index) {
+        statuses[index] = readOne(objects[index], &out[index]);
+        if (statuses[index] == BML_ERROR_OBJECT_INVALID)
+            result = BML_ERROR_OBJECT_INVALID;
+        else if (statuses[index] != BML_OK)
+            return statuses[index];
+    }
+    return result;
+}
+
 } // namespace Detail
 
 // Whether the running loader carries this interface. The functions below check
@@ -130,9 +179,7 @@ inline const BML_SceneInterface *Interface() {
     BML_SceneObjectInfo info = {};
     const int status = scene->ReadObject(object, &info);
     if (status == BML_OK)
-        out = {info.Id, std::string(info.Name), info.ClassId, info.Visible != 0,
-               info.Dynamic != 0,
-               info.NameLength >= static_cast<int>(BML_SCENE_NAME_CAPACITY)};
+        out = Detail::ToObjectInfo(info);
     return status;
 }
 
@@ -157,6 +204,42 @@ inline const BML_SceneInterface *Interface() {
     return scene->FindObjectOfClass(name.c_str(), classId, &out);
 }
 
+// The batch readers fill out[i] and statuses[i] for objects[i] and answer as the
+// interface members do. out[i] is left zeroed where statuses[i] is not BML_OK.
+[[nodiscard]] inline int ReadObjects(const std::vector<ObjectRef> &objects, std::vector<ObjectInfo> &out,
+                                     std::vector<int> &statuses) {
+    const BML_SceneInterface *scene = Detail::Interface();
+    if (!BML_IFACE_HAS(scene, BML_SceneInterface, ReadObject))
+        return BML_ERROR_NOT_FOUND;
+    std::vector<BML_SceneObjectInfo> rows;
+    const int status = Detail::ReadBatch(
+        objects, rows, statuses,
+        BML_IFACE_HAS(scene, BML_SceneInterface, ReadObjects) ? scene->ReadObjects : nullptr, scene->ReadObject);
+    if (status != BML_OK && status != BML_ERROR_OBJECT_INVALID)
+        return status;
+    try {
+        out.assign(rows.size(), ObjectInfo{});
+    } catch (const std::bad_alloc &) {
+        return BML_ERROR_OUT_OF_MEMORY;
+    }
+    for (std::size_t index = 0; index < rows.size(); ++index) {
+        if (statuses[index] == BML_OK)
+            out[index] = Detail::ToObjectInfo(rows[index]);
+    }
+    return status;
+}
+
+[[nodiscard]] inline int ReadEntityTransforms(const std::vector<ObjectRef> &objects,
+                                              std::vector<EntityTransform> &out, std::vector<int> &statuses) {
+    const BML_SceneInterface *scene = Detail::Interface();
+    if (!BML_IFACE_HAS(scene, BML_SceneInterface, ReadEntityTransform))
+        return BML_ERROR_NOT_FOUND;
+    return Detail::ReadBatch(
+        objects, out, statuses,
+        BML_IFACE_HAS(scene, BML_SceneInterface, ReadEntityTransforms) ? scene->ReadEntityTransforms : nullptr,
+        scene->ReadEntityTransform);
+}
+
 } // namespace BML::Scene
 
 #endif // __cplusplus
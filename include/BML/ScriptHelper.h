@@ -43,6 +43,16 @@
 // anything, and DeleteLink also creates that hidden block once and keeps it for the rest
 // of the process.
 //
+// Indexing. While the loader offers a script through OnLoadScript it keeps an index of
+// that script, so FindBB by name and the link finders look blocks and links up instead of
+// walking every sub-block and link each time; what they return is the same either way.
+// IndexScript does this for a script a Mod edits elsewhere and ReleaseScriptIndex drops it
+// again. The helpers here keep the index current. Blocks added or removed by other means,
+// in the searched graph or any graph below it, make that lookup walk and the next one
+// rebuild the index, and links added or removed are regrouped on their next lookup. A link
+// rewired by hand with SetInBehaviorIO or SetOutBehaviorIO is only seen after calling
+// IndexScript again, unless the link came from a FindLink call.
+//
 // All of it runs on the game thread and none of it is safe once the level holding the
 // script is gone, since the blocks, links, and parameters are objects of that level.
 #ifndef BML_SCRIPTHELPER_H
@@ -127,6 +137,10 @@ namespace ScriptHelper {
 
     BML_EXPORT void DeleteLink(CKBehavior *script, CKBehaviorLink *link);
     BML_EXPORT void DeleteBB(CKBehavior *script, CKBehavior *beh);
+
+    BML_EXPORT void IndexScript(CKBehavior *script);
+    BML_EXPORT void ReleaseScriptIndex(CKBehavior *script);
+    BML_EXPORT bool IsScriptIndexed(CKBehavior *script);
 };
 
 #endif // BML_SCRIPTHELPER_H
\ No newline at end of file
@@ -30,6 +30,10 @@ param(
 
     [switch]$IncludeAngelScript,
 
+    [string]$UpdaterDeltaBaseDir,
+
+    [switch]$UpdaterDeltaDropFullFiles,
+
     [string]$SigningCngKeyName,
 
     [switch]$SkipUpdateSigning
@@ -278,23 +282,33 @@ function New-UpdaterManifestObject {
     param(
         [string]$Version,
         [string]$PackagePath,
-        [string]$PackageStage
+        [string]$PackageStage,
+        [string]$DeltaJsonPath
     )
 
     $managedFiles = @()
-    foreach ($file in Get-ChildItem -LiteralPath $PackageStage -File -Recurse) {
-        $relative = Get-RelativeZipPath -BaseDir $PackageStage -Path $file.FullName
-        if (-not (Test-UpdaterManagedPath -RelativePath $relative)) {
-            throw "Updater package contains forbidden managed path: $relative"
-        }
-        $managedFiles += [pscustomobject]@{
-            path = $relative
-            sha256 = ((Get-FileHash -LiteralPath $file.FullName -Algorithm SHA256).Hash.ToLowerInvariant())
-            size = $file.Length
+    $deltaFiles = @()
+    if ($DeltaJsonPath) {
+        # UpdaterPackager listed the stage before adding patches and, with
+        # -UpdaterDeltaDropFullFiles, before removing the patched full copies.
+        $delta = Get-Content -LiteralPath $DeltaJsonPath -Raw | ConvertFrom-Json
+        $managedFiles = @($delta.managedFiles)
+        $deltaFiles = @($delta.deltaFiles)
+    } else {
+        foreach ($file in Get-ChildItem -LiteralPath $PackageStage -File -Recurse) {
+            $relative = Get-RelativeZipPath -BaseDir $PackageStage -Path $file.FullName
+            if (-not (Test-UpdaterManagedPath -RelativePath $relative)) {
+                throw "Updater package contains forbidden managed path: $relative"
+            }
+            $managedFiles += [pscustomobject]@{
+                path = $relative
+                sha256 = ((Get-FileHash -LiteralPath $file.FullName -Algorithm SHA256).Hash.ToLowerInvariant())
+                size = $file.Length
+            }
         }
     }
 
-    return [ordered]@{
+    $manifest = [ordered]@{
         schemaVersion = 1
         version = $Version
         package = [ordered]@{
@@ -305,6 +319,10 @@ function New-UpdaterManifestObject {
         preserve = @()
         removeFiles = @()
     }
+    if ($deltaFiles.Count -gt 0) {
+        $manifest.deltaFiles = $deltaFiles
+    }
+    return $manifest
 }
 
 function Write-UpdaterManifestSignature {
@@ -558,10 +576,28 @@ foreach ($forbidden in @(
     }
 }
 
+$updaterDeltaJson = $null
+if ($UpdaterDeltaBaseDir) {
+    # The base is the updater stage of the release the patches apply to,
+    # for example an extracted BMLPlus-Update zip of that release.
+    $packager = Join-Path $releaseBin 'UpdaterPackager.exe'
+    Assert-BMLPath -Path $packager -Type Leaf
+    Assert-BMLPath -Path $UpdaterDeltaBaseDir
+    $updaterDeltaJson = Join-Path $stageRoot 'updater-delta.json'
+    $packagerArgs = @('delta', $updaterStage, (Resolve-Path -LiteralPath $UpdaterDeltaBaseDir).Path, $updaterDeltaJson)
+    if ($UpdaterDeltaDropFullFiles) {
+        $packagerArgs += '--drop-full'
+    }
+    & $packager @packagerArgs
+    if ($LASTEXITCODE -ne 0) {
+        throw "UpdaterPackager failed with exit code $LASTEXITCODE"
+    }
+}
+
 $updaterZip = Join-Path $output "BMLPlus-Update-$Version.zip"
 New-BMLZipFromDirectory -SourceDir $updaterStage -ZipPath $updaterZip
 $updaterManifest = Join-Path $output "BMLPlus-Update-$Version.manifest.json"
-$manifestObject = New-UpdaterManifestObject -Version $Version -PackagePath $updaterZip -PackageStage $updaterStage
+$manifestObject = New-UpdaterManifestObject -Version $Version -PackagePath $updaterZip -PackageStage $updaterStage -DeltaJsonPath $updaterDeltaJson
 Write-Utf8NoBomText -Path $updaterManifest -Text (($manifestObject | ConvertTo-Json -Depth 6) + "`n")
 $updaterManifestSignature = "$updaterManifest.sig"
 if ($SkipUpdateSigning) {
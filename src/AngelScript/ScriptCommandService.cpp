@@ -10,6 +10,7 @@
 
 #include "CommandContext.h"
 #include "ScriptAngelScriptHandle.h"
+#include "ScriptContextPool.h"
 #include "ScriptFunctionSupport.h"
 #include "ModContext.h"
 #include "ScriptCallbackEvents.h"
@@ -219,7 +220,8 @@ static bool ReadStringProperty(asIScriptObject *object,
         return false;
     }
 
-    asIScriptContext *context = object->GetEngine()->CreateContext();
+    ScriptPooledContext pooledContext(object->GetEngine());
+    asIScriptContext *context = pooledContext.Get();
     if (!context) {
         diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Runtime, "Unable to create AngelScript context for command property.");
         return false;
@@ -230,23 +232,20 @@ static bool ReadStringProperty(asIScriptObject *object,
     if (code >= 0)
         code = context->SetObject(object);
     if (code >= 0)
-        code = context->Execute();
+        code = pooledContext.Execute();
 
     if (code == asEXECUTION_SUSPENDED)
         context->Abort();
     if (code != asEXECUTION_FINISHED) {
         diagnostic = MakeAngelScriptDiagnostic(ScriptDiagnosticPhase::Runtime, code, context, "Command property read failed");
-        context->Release();
         return false;
     }
 
     if (!ScriptStringInterop::ReadContextReturnString(context, value)) {
         diagnostic.Status = CKAS_TYPEMISMATCH;
         diagnostic.Message = std::string("Command object property returned an incompatible string for ") + declaration;
-        context->Release();
         return false;
     }
-    context->Release();
     return true;
 }
 
@@ -271,7 +270,8 @@ static bool ReadBoolProperty(asIScriptObject *object,
         return false;
     }
 
-    asIScriptContext *context = object->GetEngine()->CreateContext();
+    ScriptPooledContext pooledContext(object->GetEngine());
+    asIScriptContext *context = pooledContext.Get();
     if (!context) {
         diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Runtime, "Unable to create AngelScript context for command property.");
         return false;
@@ -282,18 +282,16 @@ static bool ReadBoolProperty(asIScriptObject *object,
     if (code >= 0)
         code = context->SetObject(object);
     if (code >= 0)
-        code = context->Execute();
+        code = pooledContext.Execute();
 
     if (code == asEXECUTION_SUSPENDED)
         context->Abort();
     if (code != asEXECUTION_FINISHED) {
         diagnostic = MakeAngelScriptDiagnostic(ScriptDiagnosticPhase::Runtime, code, context, "Command property read failed");
-        context->Release();
         return false;
     }
 
     value = context->GetReturnByte() != 0;
-    context->Release();
     return true;
 }
 
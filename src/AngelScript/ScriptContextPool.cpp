@@ -0,0 +1,24 @@
+#include "ScriptContextPool.h"
+
+#include <chrono>
+
+namespace BML {
+
+ScriptContextPool &ScriptContextPool::Get() {
+    static ScriptContextPool pool;
+    return pool;
+}
+
+int ScriptPooledContext::Execute() {
+    if (!m_Context)
+        return asCONTEXT_NOT_PREPARED;
+
+    const auto start = std::chrono::steady_clock::now();
+    const int code = m_Context->Execute();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    ScriptContextPool::Get().RecordExecution(
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    return code;
+}
+
+} // namespace BML
@@ -0,0 +1,190 @@
+#ifndef BML_SCRIPTCONTEXTPOOL_H
+#define BML_SCRIPTCONTEXTPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <angelscript.h>
+
+namespace BML {
+
+struct ScriptContextPoolStats {
+    uint64_t Requests = 0;
+    uint64_t Hits = 0;
+    uint64_t Executions = 0;
+    uint64_t ExecutionNs = 0;
+    uint64_t MaxExecutionNs = 0;
+    size_t Idle = 0;
+    size_t Active = 0;
+
+    double GetHitRate() const {
+        return Requests != 0 ? static_cast<double>(Hits) / static_cast<double>(Requests) : 0.0;
+    }
+    double GetMeanExecutionMs() const {
+        return Executions != 0 ? static_cast<double>(ExecutionNs) / static_cast<double>(Executions) / 1000000.0 : 0.0;
+    }
+};
+
+// Idle AngelScript contexts kept per engine so script callbacks stop creating
+// and destroying one per call. A context is handed out to one caller at a
+// time, so a callback that runs another script callback simply gets a second
+// context. Returned contexts are unprepared, which drops the object and
+// argument references of the last call.
+//
+// Traits supplies the Engine and Context types and the calls made on them
+// (Create, EngineOf, State, Unprepare, Release), so the pooling can be tested
+// without an AngelScript engine.
+template <typename Traits>
+class BasicScriptContextPool {
+public:
+    using Engine = typename Traits::Engine;
+    using Context = typename Traits::Context;
+
+    static constexpr size_t kMaxIdlePerEngine = 8;
+
+    BasicScriptContextPool() = default;
+    BasicScriptContextPool(const BasicScriptContextPool &) = delete;
+    BasicScriptContextPool &operator=(const BasicScriptContextPool &) = delete;
+
+    Context *Acquire(Engine *engine) {
+        if (!engine)
+            return nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            ++m_Stats.Requests;
+            for (EnginePool &pool : m_Pools) {
+                if (pool.Engine != engine || pool.Idle.empty())
+                    continue;
+                Context *context = pool.Idle.back();
+                pool.Idle.pop_back();
+                ++m_Stats.Hits;
+                --m_Stats.Idle;
+                ++m_Stats.Active;
+                return context;
+            }
+        }
+
+        Context *context = Traits::Create(engine);
+        if (context) {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            ++m_Stats.Active;
+        }
+        return context;
+    }
+
+    void Return(Context *context) {
+        if (!context)
+            return;
+
+        // A context still running a call or failing to unprepare is not reusable.
+        const bool reusable = Traits::State(context) != asEXECUTION_ACTIVE && Traits::Unprepare(context) >= 0;
+        Engine *engine = Traits::EngineOf(context);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (m_Stats.Active != 0)
+                --m_Stats.Active;
+            if (reusable) {
+                auto it = std::find_if(m_Pools.begin(), m_Pools.end(), [engine](const EnginePool &pool) {
+                    return pool.Engine == engine;
+                });
+                if (it == m_Pools.end()) {
+                    m_Pools.push_back({engine, {}});
+                    it = m_Pools.end() - 1;
+                }
+                if (it->Idle.size() < kMaxIdlePerEngine) {
+                    it->Idle.push_back(context);
+                    ++m_Stats.Idle;
+                    return;
+                }
+            }
+        }
+
+        Traits::Release(context);
+    }
+
+    void RecordExecution(uint64_t elapsedNs) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        ++m_Stats.Executions;
+        m_Stats.ExecutionNs += elapsedNs;
+        m_Stats.MaxExecutionNs = (std::max)(m_Stats.MaxExecutionNs, elapsedNs);
+    }
+
+    // Releases the idle contexts; they hold references to their engine.
+    void Clear() {
+        std::vector<EnginePool> pools;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            pools.swap(m_Pools);
+            m_Stats.Idle = 0;
+        }
+
+        for (EnginePool &pool : pools) {
+            for (Context *context : pool.Idle)
+                Traits::Release(context);
+        }
+    }
+
+    ScriptContextPoolStats GetStats() const {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Stats;
+    }
+
+private:
+    struct EnginePool {
+        typename Traits::Engine *Engine = nullptr;
+        std::vector<Context *> Idle;
+    };
+
+    mutable std::mutex m_Mutex;
+    std::vector<EnginePool> m_Pools;
+    ScriptContextPoolStats m_Stats;
+};
+
+struct AngelScriptContextTraits {
+    using Engine = asIScriptEngine;
+    using Context = asIScriptContext;
+
+    static asIScriptContext *Create(asIScriptEngine *engine) { return engine->CreateContext(); }
+    static asIScriptEngine *EngineOf(asIScriptContext *context) { return context->GetEngine(); }
+    static asEContextState State(asIScriptContext *context) { return context->GetState(); }
+    static int Unprepare(asIScriptContext *context) { return context->Unprepare(); }
+    static void Release(asIScriptContext *context) { context->Release(); }
+};
+
+class ScriptContextPool : public BasicScriptContextPool<AngelScriptContextTraits> {
+public:
+    static ScriptContextPool &Get();
+};
+
+// Borrows a pooled context for the lifetime of the scope.
+class ScriptPooledContext {
+public:
+    explicit ScriptPooledContext(asIScriptEngine *engine)
+        : m_Context(engine ? ScriptContextPool::Get().Acquire(engine) : nullptr) {}
+    ~ScriptPooledContext() {
+        if (m_Context)
+            ScriptContextPool::Get().Return(m_Context);
+    }
+
+    ScriptPooledContext(const ScriptPooledContext &) = delete;
+    ScriptPooledContext &operator=(const ScriptPooledContext &) = delete;
+
+    asIScriptContext *Get() const { return m_Context; }
+    asIScriptContext *operator->() const { return m_Context; }
+    explicit operator bool() const { return m_Context != nullptr; }
+
+    // Execute, timed for the dev tools statistics.
+    int Execute();
+
+private:
+    asIScriptContext *m_Context = nullptr;
+};
+
+} // namespace BML
+
+#endif
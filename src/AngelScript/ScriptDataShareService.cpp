@@ -13,6 +13,7 @@
 
 #include "ModContext.h"
 #include "ScriptAngelScriptHandle.h"
+#include "ScriptContextPool.h"
 #include "ScriptFunctionSupport.h"
 #include "ScriptMod.h"
 #include "ScriptModContextView.h"
@@ -160,7 +161,8 @@ static bool ReadStringProperty(asIScriptObject *object,
         return false;
     }
 
-    asIScriptContext *context = object->GetEngine()->CreateContext();
+    ScriptPooledContext pooledContext(object->GetEngine());
+    asIScriptContext *context = pooledContext.Get();
     if (!context) {
         diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Runtime, "Unable to create AngelScript context for DataShare request property.");
         return false;
@@ -172,26 +174,22 @@ static bool ReadStringProperty(asIScriptObject *object,
         code = context->SetObject(object);
     if (code < 0) {
         diagnostic = MakeAngelScriptDiagnostic(ScriptDiagnosticPhase::Runtime, code, context, "DataShare request property read failed");
-        context->Release();
         return false;
     }
 
-    code = context->Execute();
+    code = pooledContext.Execute();
     if (code == asEXECUTION_SUSPENDED)
         context->Abort();
     if (code != asEXECUTION_FINISHED) {
         diagnostic = MakeAngelScriptDiagnostic(ScriptDiagnosticPhase::Runtime, code, context, "DataShare request property read failed");
-        context->Release();
         return false;
     }
 
     if (!ScriptStringInterop::ReadContextReturnString(context, value)) {
         diagnostic.Status = CKAS_TYPEMISMATCH;
         diagnostic.Message = std::string("DataShare request property returned an incompatible string for ") + declaration;
-        context->Release();
         return false;
     }
-    context->Release();
     return true;
 }
 
@@ -220,7 +218,8 @@ static bool ReadIntProperty(asIScriptObject *object,
         return false;
     }
 
-    asIScriptContext *context = object->GetEngine()->CreateContext();
+    ScriptPooledContext pooledContext(object->GetEngine());
+    asIScriptContext *context = pooledContext.Get();
     if (!context) {
         diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Runtime, "Unable to create AngelScript context for DataShare request property.");
         return false;
@@ -232,21 +231,18 @@ static bool ReadIntProperty(asIScriptObject *object,
         code = context->SetObject(object);
     if (code < 0) {
         diagnostic = MakeAngelScriptDiagnostic(ScriptDiagnosticPhase::Runtime, code, context, "DataShare request property read failed");
-        context->Release();
         return false;
     }
 
-    code = context->Execute();
+    code = pooledContext.Execute();
     if (code == asEXECUTION_SUSPENDED)
         context->Abort();
     if (code != asEXECUTION_FINISHED) {
         diagnostic = MakeAngelScriptDiagnostic(ScriptDiagnosticPhase::Runtime, code, context, "DataShare request property read failed");
-        context->Release();
         return false;
     }
 
     value = static_cast<int>(context->GetReturnDWord());
-    context->Release();
     return true;
 }
 
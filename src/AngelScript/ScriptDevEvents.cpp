@@ -1,7 +1,10 @@
 #include "ScriptDevEvents.h"
 
 #include <algorithm>
+#include <charconv>
+#include <locale>
 #include <sstream>
+#include <string_view>
 
 #include "Utils/StringUtils.h"
 
@@ -9,7 +12,7 @@ namespace BML {
 
 namespace {
 
-std::string SeverityToLower(ScriptDevEventSeverity severity) {
+const char *SeverityToLower(ScriptDevEventSeverity severity) {
     switch (severity) {
     case ScriptDevEventSeverity::Warn:
         return "warn";
@@ -21,18 +24,83 @@ std::string SeverityToLower(ScriptDevEventSeverity severity) {
     }
 }
 
-bool ContainsInsensitive(const std::string &text, const std::string &needle) {
-    if (needle.empty())
-        return true;
-    return utils::ToLower(text).find(utils::ToLower(needle)) != std::string::npos;
-}
-
 bool IsReloadLog(const ScriptDevEvent &event) {
     return event.Phase == "reload" || event.Code.rfind("ScriptReload", 0) == 0;
 }
 
+bool SameFilters(const ScriptDevLogFilters &left, const ScriptDevLogFilters &right) {
+    return left.Severity == right.Severity &&
+           left.Code == right.Code &&
+           left.Source == right.Source &&
+           left.Attempt == right.Attempt &&
+           left.Text == right.Text &&
+           left.SelectedModId == right.SelectedModId &&
+           left.SelectedModOnly == right.SelectedModOnly &&
+           left.ReloadOnly == right.ReloadOnly;
+}
+
+// KMP prefix table: entry i is the length of the longest proper prefix of
+// needle[0..i] that is also a suffix of it.
+std::vector<size_t> BuildNeedlePrefix(const std::string &needle) {
+    std::vector<size_t> prefix(needle.size(), 0);
+    size_t matched = 0;
+    for (size_t i = 1; i < needle.size(); ++i) {
+        while (matched != 0 && needle[i] != needle[matched])
+            matched = prefix[matched - 1];
+        if (needle[i] == needle[matched])
+            ++matched;
+        prefix[i] = matched;
+    }
+    return prefix;
+}
+
+// Case-insensitive search for a lower-case needle in text fed piece by piece,
+// as if the pieces had been joined and lower-cased first.
+class NeedleScan {
+public:
+    NeedleScan(const std::string &needle, const std::vector<size_t> &prefix)
+        : m_Needle(needle), m_Prefix(prefix) {}
+
+    NeedleScan &Feed(std::string_view piece) {
+        const auto &loc = utils::detail::DefaultLocale();
+        for (size_t i = 0; i < piece.size() && !Found(); ++i) {
+            const char ch = std::tolower(piece[i], loc);
+            while (m_Matched != 0 && m_Needle[m_Matched] != ch)
+                m_Matched = m_Prefix[m_Matched - 1];
+            if (m_Needle[m_Matched] == ch)
+                ++m_Matched;
+        }
+        return *this;
+    }
+
+    bool Found() const { return m_Matched == m_Needle.size(); }
+
+private:
+    const std::string &m_Needle;
+    const std::vector<size_t> &m_Prefix;
+    size_t m_Matched = 0;
+};
+
+std::string_view AttemptText(const ScriptDevEvent &event, char (&buffer)[24]) {
+    if (event.ReloadAttemptId == 0)
+        return {};
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), event.ReloadAttemptId);
+    return {buffer, static_cast<size_t>(result.ptr - buffer)};
+}
+
 } // namespace
 
+ScriptDevEventRef MakeScriptDevEventRecord(ScriptDevEvent event) {
+    auto record = std::make_shared<ScriptDevEventRecord>();
+    record->CodeText = utils::ToLower(event.Code);
+    record->SourceText = utils::ToLower(ScriptDevLogSource(event) + " " + event.SourcePath);
+    if (event.ReloadAttemptId != 0)
+        record->AttemptText = std::to_string(event.ReloadAttemptId);
+    record->SearchText = utils::ToLower(ScriptDevLogSearchText(event));
+    record->Event = std::move(event);
+    return record;
+}
+
 ScriptDevEventRingBuffer::ScriptDevEventRingBuffer(size_t capacity)
     : m_Events(capacity) {
 }
@@ -47,12 +115,13 @@ uint64_t ScriptDevEventRingBuffer::Append(ScriptDevEvent event) {
         return sequence;
     }
 
+    ScriptDevEventRef record = MakeScriptDevEventRecord(std::move(event));
     if (m_EventCount < m_Events.size()) {
         const size_t index = (m_EventStart + m_EventCount) % m_Events.size();
-        m_Events[index] = std::move(event);
+        m_Events[index] = std::move(record);
         ++m_EventCount;
     } else {
-        m_Events[m_EventStart] = std::move(event);
+        m_Events[m_EventStart] = std::move(record);
         m_EventStart = (m_EventStart + 1) % m_Events.size();
         ++m_DroppedEvents;
     }
@@ -61,22 +130,146 @@ uint64_t ScriptDevEventRingBuffer::Append(ScriptDevEvent event) {
 }
 
 void ScriptDevEventRingBuffer::Clear() {
+    for (ScriptDevEventRef &record : m_Events)
+        record.reset();
     m_EventStart = 0;
     m_EventCount = 0;
     m_DroppedEvents = 0;
     ++m_Generation;
+    m_ClearGeneration = m_Generation;
 }
 
 std::vector<ScriptDevEvent> ScriptDevEventRingBuffer::Snapshot() const {
     std::vector<ScriptDevEvent> events;
     events.reserve(m_EventCount);
-    if (m_Events.empty())
-        return events;
     for (size_t i = 0; i < m_EventCount; ++i)
-        events.push_back(m_Events[(m_EventStart + i) % m_Events.size()]);
+        events.push_back(At(i)->Event);
     return events;
 }
 
+ScriptDevEventDelta ScriptDevEventRingBuffer::SnapshotSince(uint64_t generation, uint64_t sequence) const {
+    ScriptDevEventDelta delta;
+    delta.Generation = m_Generation;
+    delta.Reset = generation < m_ClearGeneration;
+    delta.FirstSequence = m_EventCount != 0 ? At(0)->Event.Sequence : m_NextSequence;
+    if (generation == m_Generation && !delta.Reset)
+        return delta;
+
+    // Buffered sequences are consecutive, so the first new event is found by
+    // offset rather than by search.
+    size_t first = 0;
+    if (!delta.Reset && sequence >= delta.FirstSequence)
+        first = static_cast<size_t>(std::min<uint64_t>(sequence - delta.FirstSequence + 1, m_EventCount));
+    delta.Events.reserve(m_EventCount - first);
+    for (size_t i = first; i < m_EventCount; ++i)
+        delta.Events.push_back(At(i));
+    return delta;
+}
+
+ScriptDevLogMatcher::ScriptDevLogMatcher(const ScriptDevLogFilters &filters) : m_Filters(filters) {
+    m_Filters.Severity = utils::ToLower(m_Filters.Severity);
+    m_Filters.Code = utils::ToLower(m_Filters.Code);
+    m_Filters.Source = utils::ToLower(m_Filters.Source);
+    m_Filters.Attempt = utils::ToLower(m_Filters.Attempt);
+    m_Filters.Text = utils::ToLower(m_Filters.Text);
+    m_CodePrefix = BuildNeedlePrefix(m_Filters.Code);
+    m_SourcePrefix = BuildNeedlePrefix(m_Filters.Source);
+    m_AttemptPrefix = BuildNeedlePrefix(m_Filters.Attempt);
+    m_TextPrefix = BuildNeedlePrefix(m_Filters.Text);
+}
+
+bool ScriptDevLogMatcher::Matches(const ScriptDevEventRecord &record) const {
+    const ScriptDevEvent &event = record.Event;
+    if (!m_Filters.Severity.empty() && SeverityToLower(event.Severity) != m_Filters.Severity)
+        return false;
+    if (m_Filters.SelectedModOnly && !m_Filters.SelectedModId.empty() && event.ModId != m_Filters.SelectedModId)
+        return false;
+    if (m_Filters.ReloadOnly && !IsReloadLog(event))
+        return false;
+    if (record.CodeText.find(m_Filters.Code) == std::string::npos)
+        return false;
+    if (record.SourceText.find(m_Filters.Source) == std::string::npos)
+        return false;
+    if (record.AttemptText.find(m_Filters.Attempt) == std::string::npos)
+        return false;
+    return record.SearchText.find(m_Filters.Text) != std::string::npos;
+}
+
+bool ScriptDevLogMatcher::Matches(const ScriptDevEvent &event) const {
+    if (!m_Filters.Severity.empty() && SeverityToLower(event.Severity) != m_Filters.Severity)
+        return false;
+    if (m_Filters.SelectedModOnly && !m_Filters.SelectedModId.empty() && event.ModId != m_Filters.SelectedModId)
+        return false;
+    if (m_Filters.ReloadOnly && !IsReloadLog(event))
+        return false;
+    if (!NeedleScan(m_Filters.Code, m_CodePrefix).Feed(event.Code).Found())
+        return false;
+
+    // Same text as ScriptDevLogSource(event) + " " + SourcePath
+    const std::string &source = event.ModId.empty() ? event.SourcePath : event.ModId;
+    if (!NeedleScan(m_Filters.Source, m_SourcePrefix).Feed(source).Feed(" ").Feed(event.SourcePath).Found())
+        return false;
+
+    char attemptBuffer[24];
+    const std::string_view attempt = AttemptText(event, attemptBuffer);
+    if (!NeedleScan(m_Filters.Attempt, m_AttemptPrefix).Feed(attempt).Found())
+        return false;
+
+    // Same text as ScriptDevLogSearchText(event)
+    NeedleScan text(m_Filters.Text, m_TextPrefix);
+    text.Feed(event.Code).Feed(" ").Feed(event.ModId).Feed(" ").Feed(event.Phase).Feed(" ");
+    text.Feed(attempt).Feed(" ").Feed(event.SourcePath).Feed(" ").Feed(event.Message).Feed(" ");
+    for (size_t i = 0; i < event.Fields.size() && !text.Found(); ++i) {
+        if (i != 0)
+            text.Feed(" ");
+        text.Feed(event.Fields[i].Key).Feed("=").Feed(event.Fields[i].Value);
+    }
+    return text.Found();
+}
+
+void ScriptDevLogView::SetFilters(const ScriptDevLogFilters &filters) {
+    if (SameFilters(filters, m_Filters))
+        return;
+    m_Filters = filters;
+    m_Matcher = ScriptDevLogMatcher(filters);
+    Reset();
+}
+
+void ScriptDevLogView::Reset() {
+    m_Rescan = true;
+    m_Generation = 0;
+    m_LastSequence = 0;
+}
+
+bool ScriptDevLogView::Apply(const ScriptDevEventDelta &delta) {
+    bool changed = false;
+    if (m_Rescan || delta.Reset) {
+        changed = m_Rescan || !m_Events.empty();
+        m_Events.clear();
+        m_Rescan = false;
+    }
+
+    size_t evicted = 0;
+    while (evicted < m_Events.size() && m_Events[evicted]->Event.Sequence < delta.FirstSequence)
+        ++evicted;
+
+    for (const ScriptDevEventRef &record : delta.Events) {
+        m_LastSequence = record->Event.Sequence;
+        if (m_Matcher.Matches(*record)) {
+            m_Events.push_back(record);
+            changed = true;
+        }
+    }
+    if (m_Limit != 0 && m_Events.size() - evicted > m_Limit)
+        evicted = m_Events.size() - m_Limit;
+    if (evicted != 0) {
+        m_Events.erase(m_Events.begin(), m_Events.begin() + static_cast<std::ptrdiff_t>(evicted));
+        changed = true;
+    }
+    m_Generation = delta.Generation;
+    return changed;
+}
+
 const char *ToString(ScriptDevEventSeverity severity) {
     switch (severity) {
     case ScriptDevEventSeverity::Warn:
@@ -127,34 +320,17 @@ std::string ScriptDevLogSearchText(const ScriptDevEvent &event) {
 }
 
 bool ScriptDevLogMatchesFilters(const ScriptDevEvent &event, const ScriptDevLogFilters &filters) {
-    if (!ScriptDevEventSeverityMatches(event, filters.Severity))
-        return false;
-    if (filters.SelectedModOnly && !filters.SelectedModId.empty() && event.ModId != filters.SelectedModId)
-        return false;
-    if (filters.ReloadOnly && !IsReloadLog(event))
-        return false;
-    if (!ContainsInsensitive(event.Code, filters.Code))
-        return false;
-
-    const std::string sourceHaystack = ScriptDevLogSource(event) + " " + event.SourcePath;
-    if (!ContainsInsensitive(sourceHaystack, filters.Source))
-        return false;
-    if (!filters.Attempt.empty() &&
-        !ContainsInsensitive(event.ReloadAttemptId == 0 ? "" : std::to_string(event.ReloadAttemptId),
-                             filters.Attempt)) {
-        return false;
-    }
-
-    return ContainsInsensitive(ScriptDevLogSearchText(event), filters.Text);
+    return ScriptDevLogMatcher(filters).Matches(event);
 }
 
 std::vector<ScriptDevEvent> FilterScriptDevEvents(const std::vector<ScriptDevEvent> &events,
                                                   const ScriptDevLogFilters &filters,
                                                   size_t limit) {
+    const ScriptDevLogMatcher matcher(filters);
     std::vector<ScriptDevEvent> filtered;
     filtered.reserve(events.size());
     for (const auto &event : events) {
-        if (ScriptDevLogMatchesFilters(event, filters))
+        if (matcher.Matches(event))
             filtered.push_back(event);
     }
     if (limit != 0 && filtered.size() > limit)
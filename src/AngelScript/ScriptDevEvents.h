@@ -2,6 +2,7 @@
 #define BML_SCRIPTDEVEVENTS_H
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -42,6 +43,32 @@ struct ScriptDevLogFilters {
     bool ReloadOnly = false;
 };
 
+// Stored form of an event. Records are immutable once appended and shared by
+// the ring buffer, snapshots and filtered views, so none of them copies the
+// event's strings. The lower-case text the log filters match against is built
+// once, when the record is made.
+struct ScriptDevEventRecord {
+    ScriptDevEvent Event;
+    std::string CodeText;
+    std::string SourceText;
+    std::string AttemptText;
+    std::string SearchText;
+};
+
+using ScriptDevEventRef = std::shared_ptr<const ScriptDevEventRecord>;
+
+ScriptDevEventRef MakeScriptDevEventRecord(ScriptDevEvent event);
+
+// Events appended after a consumer's last look at the buffer.
+struct ScriptDevEventDelta {
+    uint64_t Generation = 0;
+    // The buffer was cleared since; events the consumer holds are gone.
+    bool Reset = false;
+    // Oldest sequence still buffered; anything older has been evicted.
+    uint64_t FirstSequence = 0;
+    std::vector<ScriptDevEventRef> Events;
+};
+
 class ScriptDevEventRingBuffer {
 public:
     explicit ScriptDevEventRingBuffer(size_t capacity);
@@ -50,18 +77,73 @@ public:
     void Clear();
 
     std::vector<ScriptDevEvent> Snapshot() const;
+    // Events newer than sequence, given the generation the consumer last saw.
+    // SnapshotSince(0, 0) returns everything buffered.
+    ScriptDevEventDelta SnapshotSince(uint64_t generation, uint64_t sequence) const;
     uint64_t GetDroppedCount() const { return m_DroppedEvents; }
     uint64_t GetGeneration() const { return m_Generation; }
     size_t GetCount() const { return m_EventCount; }
     size_t GetCapacity() const { return m_Events.size(); }
 
 private:
-    std::vector<ScriptDevEvent> m_Events;
+    const ScriptDevEventRef &At(size_t index) const { return m_Events[(m_EventStart + index) % m_Events.size()]; }
+
+    std::vector<ScriptDevEventRef> m_Events;
     size_t m_EventStart = 0;
     size_t m_EventCount = 0;
     uint64_t m_NextSequence = 1;
     uint64_t m_DroppedEvents = 0;
     uint64_t m_Generation = 0;
+    uint64_t m_ClearGeneration = 0;
+};
+
+// Log filters with their needles lower-cased once, matched against the cached
+// text of event records. A plain event is matched by streaming its strings
+// through the needles, without building or lower-casing any text.
+class ScriptDevLogMatcher {
+public:
+    explicit ScriptDevLogMatcher(const ScriptDevLogFilters &filters);
+
+    bool Matches(const ScriptDevEventRecord &record) const;
+    bool Matches(const ScriptDevEvent &event) const;
+
+private:
+    ScriptDevLogFilters m_Filters;
+    // Prefix tables of the Code, Source, Attempt and Text needles
+    std::vector<size_t> m_CodePrefix;
+    std::vector<size_t> m_SourcePrefix;
+    std::vector<size_t> m_AttemptPrefix;
+    std::vector<size_t> m_TextPrefix;
+};
+
+// Filtered view of a ring buffer that is kept up to date incrementally: new
+// events are matched and appended, evicted ones trimmed from the front. Only
+// a filter change or a cleared buffer re-scans the buffered events.
+//
+//     view.SetFilters(filters);
+//     view.Apply(buffer.SnapshotSince(view.GetGeneration(), view.GetLastSequence()));
+class ScriptDevLogView {
+public:
+    // Keeps the newest limit matches; 0 keeps all of them.
+    explicit ScriptDevLogView(size_t limit = 0) : m_Limit(limit) {}
+
+    void SetFilters(const ScriptDevLogFilters &filters);
+    // Returns true when the view changed.
+    bool Apply(const ScriptDevEventDelta &delta);
+    void Reset();
+
+    uint64_t GetGeneration() const { return m_Generation; }
+    uint64_t GetLastSequence() const { return m_LastSequence; }
+    const std::vector<ScriptDevEventRef> &GetEvents() const { return m_Events; }
+
+private:
+    ScriptDevLogFilters m_Filters;
+    ScriptDevLogMatcher m_Matcher{ScriptDevLogFilters()};
+    size_t m_Limit = 0;
+    bool m_Rescan = true;
+    uint64_t m_Generation = 0;
+    uint64_t m_LastSequence = 0;
+    std::vector<ScriptDevEventRef> m_Events;
 };
 
 const char *ToString(ScriptDevEventSeverity severity);
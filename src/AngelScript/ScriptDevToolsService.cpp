@@ -331,21 +331,21 @@ std::string LogSortSpecsKey(const ImGuiTableSortSpecs *sortSpecs) {
     return stream.str();
 }
 
-void SortLogs(std::vector<ScriptDevEvent> &logs, const ImGuiTableSortSpecs *sortSpecs) {
+void SortLogs(std::vector<ScriptDevEventRef> &logs, const ImGuiTableSortSpecs *sortSpecs) {
     if (!sortSpecs || sortSpecs->SpecsCount <= 0)
         return;
 
-    std::stable_sort(logs.begin(), logs.end(), [sortSpecs](const ScriptDevEvent &left, const ScriptDevEvent &right) {
+    std::stable_sort(logs.begin(), logs.end(), [sortSpecs](const ScriptDevEventRef &left, const ScriptDevEventRef &right) {
         for (int i = 0; i < sortSpecs->SpecsCount; ++i) {
             const ImGuiTableColumnSortSpecs &spec = sortSpecs->Specs[i];
-            int cmp = CompareLogs(left, right, LogColumnFromSortSpec(spec));
+            int cmp = CompareLogs(left->Event, right->Event, LogColumnFromSortSpec(spec));
             if (cmp == 0)
                 continue;
             if (spec.SortDirection == ImGuiSortDirection_Descending)
                 cmp = -cmp;
             return cmp < 0;
         }
-        return left.Sequence < right.Sequence;
+        return left->Event.Sequence < right->Event.Sequence;
     });
 }
 
@@ -982,9 +982,9 @@ std::vector<std::string> ScriptDevToolsService::GetScriptModIds() {
     return ids;
 }
 
-std::vector<ScriptDevEvent> ScriptDevToolsService::GetEventSnapshot() const {
+ScriptDevEventDelta ScriptDevToolsService::GetEventsSince(uint64_t generation, uint64_t sequence) const {
     std::lock_guard<std::mutex> lock(m_EventMutex);
-    return m_EventStore.Snapshot();
+    return m_EventStore.SnapshotSince(generation, sequence);
 }
 
 uint64_t ScriptDevToolsService::GetDroppedEventCount() const {
@@ -1015,6 +1015,7 @@ ScriptDevStatusSnapshot ScriptDevToolsService::GetStatusSnapshot() {
         status.PendingActions = m_Actions.size();
         status.DroppedActions = m_DroppedActions;
     }
+    status.ContextPool = ScriptContextPool::Get().GetStats();
     return status;
 }
 
@@ -1028,31 +1029,36 @@ std::string ScriptDevToolsService::FormatStatus() {
            << " actions=" << status.PendingActions
            << " actionDropped=" << status.DroppedActions
            << " logs=" << status.EventCount
-           << " dropped=" << status.DroppedEvents;
+           << " dropped=" << status.DroppedEvents
+           << " contextHit=" << static_cast<int>(status.ContextPool.GetHitRate() * 100.0 + 0.5) << '%'
+           << " contexts=" << status.ContextPool.Active << '/' << status.ContextPool.Idle
+           << " callMeanMs=" << status.ContextPool.GetMeanExecutionMs()
+           << " callMaxMs=" << static_cast<double>(status.ContextPool.MaxExecutionNs) / 1000000.0;
     return stream.str();
 }
 
 std::vector<std::string> ScriptDevToolsService::FormatLogs(const std::string &severity) {
-    std::vector<ScriptDevEvent> events = GetEventSnapshot();
+    const std::vector<ScriptDevEventRef> events = GetEventsSince(0, 0).Events;
     std::vector<std::string> lines;
     lines.push_back("Recent script logs:");
     size_t emitted = 0;
-    for (auto it = events.rbegin(); it != events.rend() && emitted < 25; ++it) {
-        if (!ScriptDevEventSeverityMatches(*it, severity))
+    for (auto record = events.rbegin(); record != events.rend() && emitted < 25; ++record) {
+        const ScriptDevEvent &event = (*record)->Event;
+        if (!ScriptDevEventSeverityMatches(event, severity))
             continue;
         std::ostringstream stream;
-        stream << '#' << it->Sequence << ' ' << FormatTimestamp(it->TimestampMs)
-               << ' ' << ToString(it->Severity)
-               << ' ' << it->Code;
-        if (!it->ModId.empty())
-            stream << " mod=" << it->ModId;
-        if (!it->Phase.empty())
-            stream << " phase=" << it->Phase;
-        if (it->ReloadAttemptId != 0)
-            stream << " reload=" << it->ReloadAttemptId;
-        if (!it->SourcePath.empty())
-            stream << " source=" << DisplayScriptPath(m_Context, it->SourcePath);
-        stream << " - " << DisplayEventMessage(m_Context, *it);
+        stream << '#' << event.Sequence << ' ' << FormatTimestamp(event.TimestampMs)
+               << ' ' << ToString(event.Severity)
+               << ' ' << event.Code;
+        if (!event.ModId.empty())
+            stream << " mod=" << event.ModId;
+        if (!event.Phase.empty())
+            stream << " phase=" << event.Phase;
+        if (event.ReloadAttemptId != 0)
+            stream << " reload=" << event.ReloadAttemptId;
+        if (!event.SourcePath.empty())
+            stream << " source=" << DisplayScriptPath(m_Context, event.SourcePath);
+        stream << " - " << DisplayEventMessage(m_Context, event);
         lines.push_back(stream.str());
         ++emitted;
     }
@@ -1627,6 +1633,16 @@ void ScriptDevToolsService::DrawStatusBar() {
     ImGui::Text("logs %llu", static_cast<unsigned long long>(status.EventCount));
     ImGui::SameLine();
     ImGui::Text("dropped %llu", static_cast<unsigned long long>(status.DroppedEvents));
+    ImGui::SameLine();
+    ImGui::Text("context hit %.0f%%", status.ContextPool.GetHitRate() * 100.0);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("contexts active %zu, idle %zu\nscript calls %llu, mean %.3f ms, max %.3f ms",
+                          status.ContextPool.Active,
+                          status.ContextPool.Idle,
+                          static_cast<unsigned long long>(status.ContextPool.Executions),
+                          status.ContextPool.GetMeanExecutionMs(),
+                          static_cast<double>(status.ContextPool.MaxExecutionNs) / 1000000.0);
+    }
     if (status.PendingActions != 0 || status.DroppedActions != 0) {
         ImGui::SameLine();
         ImGui::Text("actions %zu", status.PendingActions);
@@ -1920,11 +1936,6 @@ void ScriptDevToolsService::DrawLogFilters() {
 }
 
 void ScriptDevToolsService::RebuildLogCacheIfNeeded() {
-    uint64_t eventGeneration = 0;
-    {
-        std::lock_guard<std::mutex> lock(m_EventMutex);
-        eventGeneration = m_EventStore.GetGeneration();
-    }
     const ScriptDevLogFilters filters = {kLogSeverityFilters[m_EventSeverityFilter],
                                          m_EventCodeFilter,
                                          m_EventSourceFilter,
@@ -1933,34 +1944,16 @@ void ScriptDevToolsService::RebuildLogCacheIfNeeded() {
                                          m_SelectedModId,
                                          m_LogSelectedModOnly,
                                          m_LogReloadOnly};
-    if (eventGeneration != m_FilteredEventCacheGeneration ||
-        m_EventSeverityFilter != m_FilteredEventSeverityFilter ||
-        filters.Code != m_FilteredEventCodeFilter ||
-        filters.Source != m_FilteredEventSourceFilter ||
-        filters.Attempt != m_FilteredEventAttemptFilter ||
-        filters.Text != m_FilteredEventSearch ||
-        filters.SelectedModId != m_FilteredEventSelectedModId ||
-        filters.SelectedModOnly != m_FilteredEventSelectedModOnly ||
-        filters.ReloadOnly != m_FilteredEventReloadOnly) {
-        m_FilteredEventCache = FilterScriptDevEvents(GetEventSnapshot(), filters, 1000);
-        m_FilteredEventCacheGeneration = eventGeneration;
-        m_FilteredEventSeverityFilter = m_EventSeverityFilter;
-        m_FilteredEventCodeFilter = filters.Code;
-        m_FilteredEventSourceFilter = filters.Source;
-        m_FilteredEventAttemptFilter = filters.Attempt;
-        m_FilteredEventSearch = filters.Text;
-        m_FilteredEventSelectedModId = filters.SelectedModId;
-        m_FilteredEventSelectedModOnly = filters.SelectedModOnly;
-        m_FilteredEventReloadOnly = filters.ReloadOnly;
+    m_LogView.SetFilters(filters);
+    if (m_LogView.Apply(GetEventsSince(m_LogView.GetGeneration(), m_LogView.GetLastSequence())))
         ++m_FilteredEventCacheRevision;
-    }
 }
 
 void ScriptDevToolsService::RebuildSortedLogCacheIfNeeded(ImGuiTableSortSpecs *sortSpecs) {
     const std::string sortKey = LogSortSpecsKey(sortSpecs);
     if (m_SortedEventSourceRevision != m_FilteredEventCacheRevision ||
         sortKey != m_SortedEventSortKey) {
-        m_SortedEventCache = m_FilteredEventCache;
+        m_SortedEventCache = m_LogView.GetEvents();
         SortLogs(m_SortedEventCache, sortSpecs);
         m_SortedEventSourceRevision = m_FilteredEventCacheRevision;
         m_SortedEventSortKey = sortKey;
@@ -1995,7 +1988,7 @@ void ScriptDevToolsService::DrawLogTable(float tableHeight) {
             clipper.Begin(static_cast<int>(m_SortedEventCache.size()));
             while (clipper.Step()) {
                 for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
-                    DrawLogRow(m_SortedEventCache[static_cast<size_t>(i)]);
+                    DrawLogRow(m_SortedEventCache[static_cast<size_t>(i)]->Event);
             }
             ImGui::EndTable();
         }
@@ -2028,9 +2021,9 @@ void ScriptDevToolsService::DrawLogRow(const ScriptDevEvent &event) {
 }
 
 const ScriptDevEvent *ScriptDevToolsService::FindSelectedLog() const {
-    for (const auto &event : m_FilteredEventCache) {
-        if (event.Sequence == m_SelectedEventSequence) {
-            return &event;
+    for (const ScriptDevEventRef &record : m_LogView.GetEvents()) {
+        if (record->Event.Sequence == m_SelectedEventSequence) {
+            return &record->Event;
         }
     }
     return nullptr;
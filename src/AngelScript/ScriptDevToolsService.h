@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "BML/Bui.h"
+#include "ScriptContextPool.h"
 #include "ScriptDevEvents.h"
 #include "ScriptMod.h"
 
@@ -107,6 +108,7 @@ struct ScriptDevStatusSnapshot {
     uint64_t DroppedActions = 0;
     uint64_t DroppedEvents = 0;
     uint64_t EventCount = 0;
+    ScriptContextPoolStats ContextPool;
 };
 
 enum class ScriptDevActionKind {
@@ -154,7 +156,7 @@ public:
     std::vector<std::string> GetScriptModIds();
     ScriptDevStatusSnapshot GetStatusSnapshot();
     std::vector<ScriptModSnapshot> GetModSnapshots(bool force = false);
-    std::vector<ScriptDevEvent> GetEventSnapshot() const;
+    ScriptDevEventDelta GetEventsSince(uint64_t generation, uint64_t sequence) const;
     uint64_t GetDroppedEventCount() const;
 
     ImGuiWindowFlags GetFlags() override;
@@ -167,6 +169,7 @@ public:
 
 private:
     static constexpr size_t kEventCapacity = 8192;
+    static constexpr size_t kLogViewLimit = 1000;
     static constexpr size_t kActionCapacity = 256;
 
     ScriptMod *FindScriptMod(const std::string &id) const;
@@ -239,18 +242,9 @@ private:
     bool m_LogReloadOnly = false;
     bool m_ShowAdvancedLogFilters = false;
     bool m_LogColumnVisible[7] = {true, true, true, true, false, false, true};
-    std::vector<ScriptDevEvent> m_FilteredEventCache;
-    uint64_t m_FilteredEventCacheGeneration = 0;
-    int m_FilteredEventSeverityFilter = -1;
-    std::string m_FilteredEventCodeFilter;
-    std::string m_FilteredEventSourceFilter;
-    std::string m_FilteredEventAttemptFilter;
-    std::string m_FilteredEventSearch;
-    std::string m_FilteredEventSelectedModId;
-    bool m_FilteredEventSelectedModOnly = false;
-    bool m_FilteredEventReloadOnly = false;
+    ScriptDevLogView m_LogView{kLogViewLimit};
     uint64_t m_FilteredEventCacheRevision = 0;
-    std::vector<ScriptDevEvent> m_SortedEventCache;
+    std::vector<ScriptDevEventRef> m_SortedEventCache;
     uint64_t m_SortedEventSourceRevision = 0;
     std::string m_SortedEventSortKey;
 };
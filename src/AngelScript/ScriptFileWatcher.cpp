@@ -0,0 +1,151 @@
+#include "ScriptFileWatcher.h"
+
+#include <algorithm>
+
+#include "ScriptFileWatcherPolling.h"
+#if defined(_WIN32)
+#include "ScriptFileWatcherWin32.h"
+#elif defined(__linux__)
+#include "ScriptFileWatcherInotify.h"
+#endif
+
+namespace BML {
+
+std::unique_ptr<ScriptFileWatcher> ScriptFileWatcher::Create(size_t maxQueuedEvents) {
+#if defined(_WIN32)
+    return std::make_unique<ScriptFileWatcherWin32>(maxQueuedEvents);
+#else
+#if defined(__linux__)
+    if (ScriptFileWatcherInotify::IsSupported())
+        return std::make_unique<ScriptFileWatcherInotify>(maxQueuedEvents);
+#endif
+    return std::make_unique<ScriptFileWatcherPolling>(maxQueuedEvents);
+#endif
+}
+
+ScriptFileWatcher::ScriptFileWatcher(size_t maxQueuedEvents)
+    : m_MaxQueuedEvents(std::max<size_t>(maxQueuedEvents, 1)) {
+}
+
+bool ScriptFileWatcher::SameRoot(const std::wstring &left, const std::wstring &right) {
+    if (left.empty() || right.empty())
+        return false;
+#if defined(_WIN32)
+    return _wcsicmp(left.c_str(), right.c_str()) == 0;
+#else
+    return left == right;
+#endif
+}
+
+std::vector<ScriptFileWatcher::Event> ScriptFileWatcher::DrainEvents() {
+    std::vector<Event> events;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    events.swap(m_Events);
+    m_OverflowQueued.clear();
+    m_QueuedModifications.clear();
+    m_FirstSequence = 0;
+    return events;
+}
+
+uint64_t ScriptFileWatcher::GetDroppedEventCount() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats.Dropped;
+}
+
+ScriptFileWatcherStats ScriptFileWatcher::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void ScriptFileWatcher::PushEvent(const Event &event) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (event.Overflow) {
+        PushOverflowEventLocked(event.Root, event.Recursive);
+        return;
+    }
+
+    ++m_Stats.Events;
+    if (event.Action == ScriptFileAction::Modified) {
+        if (m_QueuedModifications.find(event.Path) != m_QueuedModifications.end()) {
+            ++m_Stats.Coalesced;
+            return;
+        }
+    } else {
+        // Later modifications must stay ordered after this event.
+        m_QueuedModifications.erase(event.Path);
+    }
+
+    if (m_Events.size() >= m_MaxQueuedEvents) {
+        ++m_Stats.Dropped;
+        PushOverflowEventLocked(event.Root, event.Recursive);
+        return;
+    }
+    if (event.Action == ScriptFileAction::Modified)
+        m_QueuedModifications[event.Path] = m_FirstSequence + m_Events.size();
+    m_Events.push_back(event);
+}
+
+void ScriptFileWatcher::ClearEvents() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Events.clear();
+    m_OverflowQueued.clear();
+    m_QueuedModifications.clear();
+    m_FirstSequence = 0;
+}
+
+bool ScriptFileWatcher::HasOverflowEventLocked(const std::wstring &root, bool recursive) const {
+    for (const OverflowKey &key : m_OverflowQueued) {
+        if (key.Recursive == recursive && SameRoot(key.Root, root))
+            return true;
+    }
+    return false;
+}
+
+void ScriptFileWatcher::EvictFrontEventLocked() {
+    const Event &front = m_Events.front();
+    if (front.Overflow) {
+        auto it = std::remove_if(m_OverflowQueued.begin(), m_OverflowQueued.end(), [&](const OverflowKey &key) {
+            return key.Recursive == front.Recursive && SameRoot(key.Root, front.Root);
+        });
+        m_OverflowQueued.erase(it, m_OverflowQueued.end());
+    } else if (front.Action == ScriptFileAction::Modified) {
+        auto it = m_QueuedModifications.find(front.Path);
+        if (it != m_QueuedModifications.end() && it->second == m_FirstSequence)
+            m_QueuedModifications.erase(it);
+    }
+    m_Events.erase(m_Events.begin());
+    ++m_FirstSequence;
+    ++m_Stats.Dropped;
+}
+
+void ScriptFileWatcher::PushOverflowEventLocked(const std::wstring &root, bool recursive) {
+    if (HasOverflowEventLocked(root, recursive))
+        return;
+    if (m_Events.size() >= m_MaxQueuedEvents && !m_Events.empty())
+        EvictFrontEventLocked();
+
+    Event overflow;
+    overflow.Root = root;
+    overflow.Path = root;
+    overflow.Overflow = true;
+    overflow.Recursive = recursive;
+    m_Events.push_back(overflow);
+    ++m_Stats.Overflows;
+    OverflowKey key;
+    key.Root = root;
+    key.Recursive = recursive;
+    m_OverflowQueued.push_back(key);
+}
+
+#ifdef BML_TEST
+void ScriptFileWatcher::PushOverflowEventForTest(const std::wstring &root, bool recursive) {
+    Event overflow;
+    overflow.Root = root;
+    overflow.Path = root;
+    overflow.Overflow = true;
+    overflow.Recursive = recursive;
+    PushEvent(overflow);
+}
+#endif
+
+} // namespace BML
@@ -0,0 +1,109 @@
+#ifndef BML_SCRIPTFILEWATCHER_H
+#define BML_SCRIPTFILEWATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace BML {
+
+// Values match the Win32 FILE_ACTION_* codes.
+enum class ScriptFileAction : uint32_t {
+    Unknown = 0,
+    Added = 1,
+    Removed = 2,
+    Modified = 3,
+    RenamedOldName = 4,
+    RenamedNewName = 5,
+};
+
+struct ScriptFileEvent {
+    std::wstring Root;
+    std::wstring Path;
+    ScriptFileAction Action = ScriptFileAction::Unknown;
+    bool Overflow = false;
+    bool Recursive = true;
+};
+
+struct ScriptFileWatcherStats {
+    // Change notifications reported by the backend, overflows excluded.
+    uint64_t Events = 0;
+    // Modifications folded into a modification of the same path that was
+    // still queued.
+    uint64_t Coalesced = 0;
+    // Changes lost to a full queue; each one is covered by an overflow event.
+    uint64_t Dropped = 0;
+    uint64_t Overflows = 0;
+};
+
+// Directory watcher shared by the hot reload service and its tests. Backends
+// report changes from their own threads; this class owns the queue the
+// service drains once per frame.
+//
+// The queue is bounded. Once it is full a change is dropped and replaced by a
+// single overflow event for its watch root, which tells the consumer to rescan
+// that root. Repeated modifications of a path collapse into one event until
+// the queue is drained.
+class ScriptFileWatcher {
+public:
+    using Event = ScriptFileEvent;
+
+    static constexpr size_t kDefaultMaxQueuedEvents = 4096;
+
+    // The native backend for the platform, or the polling one when the native
+    // mechanism is unavailable.
+    static std::unique_ptr<ScriptFileWatcher> Create(size_t maxQueuedEvents = kDefaultMaxQueuedEvents);
+
+    explicit ScriptFileWatcher(size_t maxQueuedEvents = kDefaultMaxQueuedEvents);
+    virtual ~ScriptFileWatcher() = default;
+
+    ScriptFileWatcher(const ScriptFileWatcher &) = delete;
+    ScriptFileWatcher &operator=(const ScriptFileWatcher &) = delete;
+
+    virtual const char *GetBackendName() const = 0;
+    virtual bool Watch(const std::wstring &root, bool recursive = true) = 0;
+    virtual bool Unwatch(const std::wstring &root) = 0;
+    // Stops every watch and discards the queued events.
+    virtual void StopAll() = 0;
+
+    std::vector<Event> DrainEvents();
+    uint64_t GetDroppedEventCount() const;
+    ScriptFileWatcherStats GetStats() const;
+#ifdef BML_TEST
+    void PushOverflowEventForTest(const std::wstring &root, bool recursive = true);
+#endif
+
+protected:
+    static bool SameRoot(const std::wstring &left, const std::wstring &right);
+
+    void PushEvent(const Event &event);
+    void ClearEvents();
+
+private:
+    struct OverflowKey {
+        std::wstring Root;
+        bool Recursive = true;
+    };
+
+    bool HasOverflowEventLocked(const std::wstring &root, bool recursive) const;
+    void EvictFrontEventLocked();
+    void PushOverflowEventLocked(const std::wstring &root, bool recursive);
+
+    mutable std::mutex m_Mutex;
+    size_t m_MaxQueuedEvents = kDefaultMaxQueuedEvents;
+    std::vector<Event> m_Events;
+    std::vector<OverflowKey> m_OverflowQueued;
+    // Sequence number of the queued modification of each path, used to
+    // coalesce the next one. m_FirstSequence numbers m_Events.front().
+    std::unordered_map<std::wstring, uint64_t> m_QueuedModifications;
+    uint64_t m_FirstSequence = 0;
+    ScriptFileWatcherStats m_Stats;
+};
+
+} // namespace BML
+
+#endif
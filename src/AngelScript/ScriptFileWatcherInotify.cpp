@@ -0,0 +1,305 @@
+#include "ScriptFileWatcherInotify.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <memory>
+#include <system_error>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace BML {
+
+namespace {
+
+constexpr uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB |
+                                IN_MOVED_FROM | IN_MOVED_TO |
+                                IN_ONLYDIR | IN_EXCL_UNLINK;
+
+std::string JoinWatchedPath(const std::string &directory, const char *name) {
+    std::string path = directory;
+    if (!path.empty() && path.back() != '/')
+        path.push_back('/');
+    path.append(name);
+    return path;
+}
+
+bool IsInsideOrSame(const std::string &path, const std::string &directory) {
+    if (path.size() < directory.size() || path.compare(0, directory.size(), directory) != 0)
+        return false;
+    return path.size() == directory.size() || path[directory.size()] == '/';
+}
+
+ScriptFileAction ToScriptFileAction(uint32_t mask) {
+    if (mask & IN_CREATE)
+        return ScriptFileAction::Added;
+    if (mask & IN_DELETE)
+        return ScriptFileAction::Removed;
+    if (mask & IN_MOVED_FROM)
+        return ScriptFileAction::RenamedOldName;
+    if (mask & IN_MOVED_TO)
+        return ScriptFileAction::RenamedNewName;
+    if (mask & (IN_MODIFY | IN_ATTRIB))
+        return ScriptFileAction::Modified;
+    return ScriptFileAction::Unknown;
+}
+
+} // namespace
+
+bool ScriptFileWatcherInotify::IsSupported() {
+    const int fd = ::inotify_init1(IN_CLOEXEC);
+    if (fd < 0)
+        return false;
+    ::close(fd);
+    return true;
+}
+
+ScriptFileWatcherInotify::~ScriptFileWatcherInotify() {
+    StopAll();
+}
+
+void ScriptFileWatcherInotify::StopWatches(std::vector<WatchState *> &watches) {
+    for (WatchState *state : watches) {
+        if (!state || state->StopEvent < 0)
+            continue;
+        const uint64_t signal = 1;
+        [[maybe_unused]] const ssize_t written = ::write(state->StopEvent, &signal, sizeof(signal));
+    }
+
+    for (WatchState *state : watches) {
+        if (!state)
+            continue;
+        if (state->Worker.joinable())
+            state->Worker.join();
+        if (state->Inotify >= 0)
+            ::close(state->Inotify);
+        if (state->StopEvent >= 0)
+            ::close(state->StopEvent);
+        delete state;
+    }
+    watches.clear();
+}
+
+bool ScriptFileWatcherInotify::AddDirectoryWatch(WatchState *state, const std::string &directory) {
+    const int wd = ::inotify_add_watch(state->Inotify, directory.c_str(), kWatchMask);
+    if (wd < 0)
+        return false;
+    state->Directories[wd] = directory;
+    return true;
+}
+
+bool ScriptFileWatcherInotify::Watch(const std::wstring &root, bool recursive) {
+    if (root.empty())
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_WatchMutex);
+        for (const WatchState *existing : m_Watches) {
+            if (existing && SameRoot(existing->Root, root) && existing->Recursive == recursive)
+                return true;
+        }
+    }
+
+    auto *state = new (std::nothrow) WatchState();
+    if (!state)
+        return false;
+
+    state->Root = root;
+    state->Recursive = recursive;
+    state->Inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    state->StopEvent = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    const std::string rootPath = std::filesystem::path(root).string();
+    bool ready = state->Inotify >= 0 && state->StopEvent >= 0 && AddDirectoryWatch(state, rootPath);
+    if (ready && recursive) {
+        std::error_code ec;
+        const auto options = std::filesystem::directory_options::skip_permission_denied;
+        for (std::filesystem::recursive_directory_iterator it(rootPath, options, ec), end; !ec && it != end; it.increment(ec)) {
+            std::error_code typeError;
+            if (it->is_directory(typeError) && !it->is_symlink(typeError))
+                AddDirectoryWatch(state, it->path().string());
+        }
+    }
+
+    bool duplicate = false;
+    bool registered = false;
+    if (ready) {
+        std::lock_guard<std::mutex> lock(m_WatchMutex);
+        for (const WatchState *existing : m_Watches) {
+            if (existing && SameRoot(existing->Root, root) && existing->Recursive == recursive) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (!duplicate) {
+            try {
+                m_Watches.reserve(m_Watches.size() + 1);
+                state->Worker = std::thread([this, state] { WorkerLoop(state); });
+                m_Watches.push_back(state);
+                registered = true;
+            } catch (...) {
+                // The unpublished state is stopped and released after dropping m_WatchMutex.
+            }
+        }
+    }
+
+    if (!registered) {
+        std::vector<WatchState *> failed;
+        failed.push_back(state);
+        StopWatches(failed);
+        return duplicate;
+    }
+    return true;
+}
+
+bool ScriptFileWatcherInotify::Unwatch(const std::wstring &root) {
+    if (root.empty())
+        return false;
+
+    std::vector<WatchState *> removed;
+    {
+        std::lock_guard<std::mutex> lock(m_WatchMutex);
+        auto it = std::remove_if(m_Watches.begin(), m_Watches.end(), [&](WatchState *state) {
+            if (!state || !SameRoot(state->Root, root))
+                return false;
+            removed.push_back(state);
+            return true;
+        });
+        m_Watches.erase(it, m_Watches.end());
+    }
+
+    if (removed.empty())
+        return false;
+    StopWatches(removed);
+    return true;
+}
+
+void ScriptFileWatcherInotify::StopAll() {
+    std::vector<WatchState *> watches;
+    {
+        std::lock_guard<std::mutex> lock(m_WatchMutex);
+        watches.swap(m_Watches);
+    }
+
+    StopWatches(watches);
+    ClearEvents();
+}
+
+void ScriptFileWatcherInotify::WorkerLoop(WatchState *state) {
+    if (!state)
+        return;
+
+    try {
+        // inotify records are aligned to and start with struct inotify_event.
+        std::unique_ptr<inotify_event[]> storage(new inotify_event[(64 * 1024) / sizeof(inotify_event)]);
+        char *buffer = reinterpret_cast<char *>(storage.get());
+        const size_t bufferSize = (64 * 1024) / sizeof(inotify_event) * sizeof(inotify_event);
+
+        while (true) {
+            pollfd fds[2] = {{state->StopEvent, POLLIN, 0}, {state->Inotify, POLLIN, 0}};
+            const int ready = ::poll(fds, 2, -1);
+            if (ready < 0) {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            if (fds[0].revents != 0)
+                break;
+            if ((fds[1].revents & POLLIN) == 0) {
+                if (fds[1].revents != 0)
+                    break;
+                continue;
+            }
+
+            while (true) {
+                const ssize_t bytes = ::read(state->Inotify, buffer, bufferSize);
+                if (bytes <= 0)
+                    break;
+
+                for (ssize_t offset = 0; offset < bytes;) {
+                    const auto *info = reinterpret_cast<const inotify_event *>(buffer + offset);
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + info->len);
+
+                    if (info->mask & IN_Q_OVERFLOW) {
+                        Event overflow;
+                        overflow.Root = state->Root;
+                        overflow.Path = state->Root;
+                        overflow.Overflow = true;
+                        overflow.Recursive = state->Recursive;
+                        PushEvent(overflow);
+                        continue;
+                    }
+                    if (info->mask & IN_IGNORED) {
+                        state->Directories.erase(info->wd);
+                        continue;
+                    }
+                    if (info->len == 0 || info->name[0] == '\0')
+                        continue;
+                    const auto it = state->Directories.find(info->wd);
+                    if (it == state->Directories.end())
+                        continue;
+                    HandleEvent(state, info->mask, JoinWatchedPath(it->second, info->name));
+                }
+            }
+        }
+    } catch (...) {
+        // File watching is best-effort; a background watcher must not terminate the host process.
+    }
+}
+
+void ScriptFileWatcherInotify::HandleEvent(WatchState *state, uint32_t mask, const std::string &path) {
+    const ScriptFileAction action = ToScriptFileAction(mask);
+    if (action == ScriptFileAction::Unknown)
+        return;
+
+    PushPathEvent(state, path, action);
+    if (!state->Recursive || (mask & IN_ISDIR) == 0)
+        return;
+
+    // A directory keeps its watch descriptors when it moves, so a directory
+    // leaving the tree drops them and one entering it is watched afresh.
+    if (action == ScriptFileAction::Added || action == ScriptFileAction::RenamedNewName)
+        WatchNewDirectory(state, path);
+    else if (action == ScriptFileAction::RenamedOldName)
+        ForgetDirectory(state, path);
+}
+
+void ScriptFileWatcherInotify::WatchNewDirectory(WatchState *state, const std::string &directory) {
+    if (!AddDirectoryWatch(state, directory))
+        return;
+
+    // Entries created before the watch was in place produced no events.
+    std::error_code ec;
+    const auto options = std::filesystem::directory_options::skip_permission_denied;
+    for (std::filesystem::recursive_directory_iterator it(directory, options, ec), end; !ec && it != end; it.increment(ec)) {
+        const std::string path = it->path().string();
+        std::error_code typeError;
+        if (it->is_directory(typeError) && !it->is_symlink(typeError))
+            AddDirectoryWatch(state, path);
+        PushPathEvent(state, path, ScriptFileAction::Added);
+    }
+}
+
+void ScriptFileWatcherInotify::ForgetDirectory(WatchState *state, const std::string &directory) {
+    for (auto it = state->Directories.begin(); it != state->Directories.end();) {
+        if (IsInsideOrSame(it->second, directory)) {
+            ::inotify_rm_watch(state->Inotify, it->first);
+            it = state->Directories.erase(it);
+            continue;
+        }
+        ++it;
+    }
+}
+
+void ScriptFileWatcherInotify::PushPathEvent(WatchState *state, const std::string &path, ScriptFileAction action) {
+    Event event;
+    event.Root = state->Root;
+    event.Path = std::filesystem::path(path).wstring();
+    event.Action = action;
+    event.Recursive = state->Recursive;
+    PushEvent(event);
+}
+
+} // namespace BML
@@ -0,0 +1,58 @@
+#ifndef BML_SCRIPTFILEWATCHERINOTIFY_H
+#define BML_SCRIPTFILEWATCHERINOTIFY_H
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ScriptFileWatcher.h"
+
+namespace BML {
+
+// inotify backend. Each root gets its own inotify instance and worker thread;
+// recursive roots add a watch per directory and pick up directories created
+// or moved in after the watch started. A kernel queue overflow becomes an
+// overflow event for the root.
+class ScriptFileWatcherInotify : public ScriptFileWatcher {
+public:
+    static bool IsSupported();
+
+    explicit ScriptFileWatcherInotify(size_t maxQueuedEvents = kDefaultMaxQueuedEvents)
+        : ScriptFileWatcher(maxQueuedEvents) {}
+    ~ScriptFileWatcherInotify() override;
+
+    const char *GetBackendName() const override { return "inotify"; }
+    bool Watch(const std::wstring &root, bool recursive = true) override;
+    bool Unwatch(const std::wstring &root) override;
+    void StopAll() override;
+
+private:
+    struct WatchState {
+        std::wstring Root;
+        bool Recursive = true;
+        int Inotify = -1;
+        int StopEvent = -1;
+        // Watch descriptor to watched directory; only the worker touches it
+        // once the worker runs.
+        std::unordered_map<int, std::string> Directories;
+        std::thread Worker;
+    };
+
+    static void StopWatches(std::vector<WatchState *> &watches);
+    static bool AddDirectoryWatch(WatchState *state, const std::string &directory);
+
+    void WorkerLoop(WatchState *state);
+    void HandleEvent(WatchState *state, uint32_t mask, const std::string &path);
+    void WatchNewDirectory(WatchState *state, const std::string &directory);
+    void ForgetDirectory(WatchState *state, const std::string &directory);
+    void PushPathEvent(WatchState *state, const std::string &path, ScriptFileAction action);
+
+    std::mutex m_WatchMutex;
+    std::vector<WatchState *> m_Watches;
+};
+
+} // namespace BML
+
+#endif
@@ -0,0 +1,147 @@
+#include "ScriptFileWatcherPolling.h"
+
+#include <algorithm>
+#include <system_error>
+
+namespace BML {
+
+ScriptFileWatcherPolling::ScriptFileWatcherPolling(size_t maxQueuedEvents, std::chrono::milliseconds interval)
+    : ScriptFileWatcher(maxQueuedEvents),
+      m_Interval(std::max(interval, std::chrono::milliseconds(1))) {
+}
+
+ScriptFileWatcherPolling::~ScriptFileWatcherPolling() {
+    StopAll();
+}
+
+ScriptFileWatcherPolling::Snapshot ScriptFileWatcherPolling::Scan(const std::wstring &root, bool recursive) {
+    Snapshot entries;
+    const auto record = [&entries](const std::filesystem::directory_entry &entry) {
+        std::error_code ec;
+        Stamp stamp;
+        stamp.Directory = entry.is_directory(ec);
+        if (!stamp.Directory) {
+            stamp.Size = entry.file_size(ec);
+            if (ec)
+                stamp.Size = 0;
+        }
+        stamp.WriteTime = entry.last_write_time(ec);
+        entries.emplace(entry.path().wstring(), stamp);
+    };
+
+    std::error_code ec;
+    if (recursive) {
+        const auto options = std::filesystem::directory_options::skip_permission_denied;
+        for (std::filesystem::recursive_directory_iterator it(root, options, ec), end; !ec && it != end; it.increment(ec))
+            record(*it);
+    } else {
+        for (std::filesystem::directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec))
+            record(*it);
+    }
+    return entries;
+}
+
+bool ScriptFileWatcherPolling::Watch(const std::wstring &root, bool recursive) {
+    if (root.empty())
+        return false;
+    std::error_code ec;
+    if (!std::filesystem::is_directory(root, ec))
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_WatchMutex);
+        for (const WatchState &existing : m_Watches) {
+            if (SameRoot(existing.Root, root) && existing.Recursive == recursive)
+                return true;
+        }
+    }
+
+    WatchState state;
+    state.Root = root;
+    state.Recursive = recursive;
+    state.Entries = Scan(root, recursive);
+
+    std::lock_guard<std::mutex> lock(m_WatchMutex);
+    for (const WatchState &existing : m_Watches) {
+        if (SameRoot(existing.Root, root) && existing.Recursive == recursive)
+            return true;
+    }
+    try {
+        if (!m_Worker.joinable()) {
+            m_Stopping = false;
+            m_Worker = std::thread([this] { WorkerLoop(); });
+        }
+        m_Watches.push_back(std::move(state));
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+bool ScriptFileWatcherPolling::Unwatch(const std::wstring &root) {
+    if (root.empty())
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_WatchMutex);
+    auto it = std::remove_if(m_Watches.begin(), m_Watches.end(), [&](const WatchState &state) {
+        return SameRoot(state.Root, root);
+    });
+    if (it == m_Watches.end())
+        return false;
+    m_Watches.erase(it, m_Watches.end());
+    return true;
+}
+
+void ScriptFileWatcherPolling::StopAll() {
+    {
+        std::lock_guard<std::mutex> lock(m_WatchMutex);
+        m_Stopping = true;
+        m_Watches.clear();
+    }
+    m_Wake.notify_all();
+    if (m_Worker.joinable())
+        m_Worker.join();
+    ClearEvents();
+}
+
+void ScriptFileWatcherPolling::WorkerLoop() {
+    try {
+        std::unique_lock<std::mutex> lock(m_WatchMutex);
+        while (!m_Wake.wait_for(lock, m_Interval, [this] { return m_Stopping; })) {
+            for (WatchState &state : m_Watches)
+                Rescan(state);
+        }
+    } catch (...) {
+        // File watching is best-effort; a background watcher must not terminate the host process.
+    }
+}
+
+void ScriptFileWatcherPolling::Rescan(WatchState &state) {
+    Snapshot current = Scan(state.Root, state.Recursive);
+
+    const auto push = [&state, this](const std::wstring &path, ScriptFileAction action) {
+        Event event;
+        event.Root = state.Root;
+        event.Path = path;
+        event.Action = action;
+        event.Recursive = state.Recursive;
+        PushEvent(event);
+    };
+
+    for (const auto &entry : state.Entries) {
+        if (current.find(entry.first) == current.end())
+            push(entry.first, ScriptFileAction::Removed);
+    }
+    for (const auto &entry : current) {
+        const auto previous = state.Entries.find(entry.first);
+        if (previous == state.Entries.end()) {
+            push(entry.first, ScriptFileAction::Added);
+        } else if (!entry.second.Directory &&
+                   (previous->second.WriteTime != entry.second.WriteTime || previous->second.Size != entry.second.Size)) {
+            push(entry.first, ScriptFileAction::Modified);
+        }
+    }
+    state.Entries = std::move(current);
+}
+
+} // namespace BML
@@ -0,0 +1,63 @@
+#ifndef BML_SCRIPTFILEWATCHERPOLLING_H
+#define BML_SCRIPTFILEWATCHERPOLLING_H
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ScriptFileWatcher.h"
+
+namespace BML {
+
+// Fallback backend for file systems without change notifications. One worker
+// rescans every root each interval and reports the difference from the last
+// scan, so changes made between two scans arrive as a single event per path.
+class ScriptFileWatcherPolling : public ScriptFileWatcher {
+public:
+    static constexpr std::chrono::milliseconds kDefaultInterval{100};
+
+    explicit ScriptFileWatcherPolling(size_t maxQueuedEvents = kDefaultMaxQueuedEvents,
+                                      std::chrono::milliseconds interval = kDefaultInterval);
+    ~ScriptFileWatcherPolling() override;
+
+    const char *GetBackendName() const override { return "polling"; }
+    bool Watch(const std::wstring &root, bool recursive = true) override;
+    bool Unwatch(const std::wstring &root) override;
+    void StopAll() override;
+
+private:
+    struct Stamp {
+        std::filesystem::file_time_type WriteTime;
+        uintmax_t Size = 0;
+        bool Directory = false;
+    };
+
+    using Snapshot = std::unordered_map<std::wstring, Stamp>;
+
+    struct WatchState {
+        std::wstring Root;
+        bool Recursive = true;
+        Snapshot Entries;
+    };
+
+    static Snapshot Scan(const std::wstring &root, bool recursive);
+
+    void WorkerLoop();
+    void Rescan(WatchState &state);
+
+    std::chrono::milliseconds m_Interval;
+    std::mutex m_WatchMutex;
+    std::condition_variable m_Wake;
+    bool m_Stopping = false;
+    std::vector<WatchState> m_Watches;
+    std::thread m_Worker;
+};
+
+} // namespace BML
+
+#endif
@@ -7,8 +7,6 @@ namespace BML {
 
 namespace {
 
-constexpr size_t kMaxQueuedEvents = 4096;
-
 class ScopedHandle {
 public:
     explicit ScopedHandle(HANDLE handle = nullptr) : m_Handle(handle) {}
@@ -48,12 +46,6 @@ ScriptFileWatcherWin32::~ScriptFileWatcherWin32() {
     StopAll();
 }
 
-bool ScriptFileWatcherWin32::SameRoot(const std::wstring &left, const std::wstring &right) {
-    if (left.empty() || right.empty())
-        return false;
-    return _wcsicmp(left.c_str(), right.c_str()) == 0;
-}
-
 void ScriptFileWatcherWin32::StopWatches(std::vector<WatchState *> &watches) {
     for (WatchState *state : watches) {
         if (!state)
@@ -83,7 +75,7 @@ bool ScriptFileWatcherWin32::Watch(const std::wstring &root, bool recursive) {
         return false;
 
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        std::lock_guard<std::mutex> lock(m_WatchMutex);
         for (const WatchState *existing : m_Watches) {
             if (existing && SameRoot(existing->Root, root) && existing->Recursive == recursive)
                 return true;
@@ -116,7 +108,7 @@ bool ScriptFileWatcherWin32::Watch(const std::wstring &root, bool recursive) {
     bool duplicate = false;
     bool registered = false;
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        std::lock_guard<std::mutex> lock(m_WatchMutex);
         for (const WatchState *existing : m_Watches) {
             if (existing && SameRoot(existing->Root, root) && existing->Recursive == recursive) {
                 duplicate = true;
@@ -130,7 +122,7 @@ bool ScriptFileWatcherWin32::Watch(const std::wstring &root, bool recursive) {
                 m_Watches.push_back(state);
                 registered = true;
             } catch (...) {
-                // The unpublished state is stopped and released after dropping m_Mutex.
+                // The unpublished state is stopped and released after dropping m_WatchMutex.
             }
         }
     }
@@ -150,7 +142,7 @@ bool ScriptFileWatcherWin32::Unwatch(const std::wstring &root) {
 
     std::vector<WatchState *> removed;
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        std::lock_guard<std::mutex> lock(m_WatchMutex);
         auto it = std::remove_if(m_Watches.begin(), m_Watches.end(), [&](WatchState *state) {
             if (!state || !SameRoot(state->Root, root))
                 return false;
@@ -169,30 +161,12 @@ bool ScriptFileWatcherWin32::Unwatch(const std::wstring &root) {
 void ScriptFileWatcherWin32::StopAll() {
     std::vector<WatchState *> watches;
     {
-        std::lock_guard<std::mutex> lock(m_Mutex);
+        std::lock_guard<std::mutex> lock(m_WatchMutex);
         watches.swap(m_Watches);
     }
 
     StopWatches(watches);
-
-    {
-        std::lock_guard<std::mutex> lock(m_Mutex);
-        m_Events.clear();
-        m_OverflowQueued.clear();
-    }
-}
-
-std::vector<ScriptFileWatcherWin32::Event> ScriptFileWatcherWin32::DrainEvents() {
-    std::vector<Event> events;
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    events.swap(m_Events);
-    m_OverflowQueued.clear();
-    return events;
-}
-
-uint64_t ScriptFileWatcherWin32::GetDroppedEventCount() const {
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    return m_DroppedEvents;
+    ClearEvents();
 }
 
 void ScriptFileWatcherWin32::WorkerLoop(WatchState *state) {
@@ -254,7 +228,7 @@ void ScriptFileWatcherWin32::WorkerLoop(WatchState *state) {
                 Event event;
                 event.Root = state->Root;
                 event.Path = JoinWatchedPath(state->Root, info->FileName, info->FileNameLength);
-                event.Action = info->Action;
+                event.Action = static_cast<ScriptFileAction>(info->Action);
                 event.Recursive = state->Recursive;
                 PushEvent(event);
                 if (info->NextEntryOffset == 0)
@@ -267,68 +241,4 @@ void ScriptFileWatcherWin32::WorkerLoop(WatchState *state) {
     }
 }
 
-void ScriptFileWatcherWin32::PushEvent(const Event &event) {
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    if (event.Overflow) {
-        PushOverflowEventLocked(event.Root, event.Recursive);
-        return;
-    }
-    if (m_Events.size() >= kMaxQueuedEvents) {
-        ++m_DroppedEvents;
-        PushOverflowEventLocked(event.Root, event.Recursive);
-        return;
-    }
-    m_Events.push_back(event);
-}
-
-bool ScriptFileWatcherWin32::HasOverflowEventLocked(const std::wstring &root, bool recursive) const {
-    for (const OverflowKey &key : m_OverflowQueued) {
-        if (key.Recursive == recursive && SameRoot(key.Root, root))
-            return true;
-    }
-    return false;
-}
-
-void ScriptFileWatcherWin32::ForgetOverflowEventLocked(const Event &event) {
-    if (!event.Overflow)
-        return;
-
-    auto it = std::remove_if(m_OverflowQueued.begin(), m_OverflowQueued.end(), [&](const OverflowKey &key) {
-        return key.Recursive == event.Recursive && SameRoot(key.Root, event.Root);
-    });
-    m_OverflowQueued.erase(it, m_OverflowQueued.end());
-}
-
-void ScriptFileWatcherWin32::PushOverflowEventLocked(const std::wstring &root, bool recursive) {
-    if (HasOverflowEventLocked(root, recursive))
-        return;
-    if (m_Events.size() >= kMaxQueuedEvents && !m_Events.empty()) {
-        ForgetOverflowEventLocked(m_Events.front());
-        m_Events.erase(m_Events.begin());
-        ++m_DroppedEvents;
-    }
-
-    Event overflow;
-    overflow.Root = root;
-    overflow.Path = root;
-    overflow.Overflow = true;
-    overflow.Recursive = recursive;
-    m_Events.push_back(overflow);
-    OverflowKey key;
-    key.Root = root;
-    key.Recursive = recursive;
-    m_OverflowQueued.push_back(key);
-}
-
-#ifdef BML_TEST
-void ScriptFileWatcherWin32::PushOverflowEventForTest(const std::wstring &root, bool recursive) {
-    Event overflow;
-    overflow.Root = root;
-    overflow.Path = root;
-    overflow.Overflow = true;
-    overflow.Recursive = recursive;
-    PushEvent(overflow);
-}
-#endif
-
 } // namespace BML
@@ -1,7 +1,6 @@
 #ifndef BML_SCRIPTFILEWATCHERWIN32_H
 #define BML_SCRIPTFILEWATCHERWIN32_H
 
-#include <cstdint>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -12,32 +11,20 @@
 #endif
 #include <Windows.h>
 
+#include "ScriptFileWatcher.h"
+
 namespace BML {
 
-class ScriptFileWatcherWin32 {
+class ScriptFileWatcherWin32 : public ScriptFileWatcher {
 public:
-    struct Event {
-        std::wstring Root;
-        std::wstring Path;
-        DWORD Action = 0;
-        bool Overflow = false;
-        bool Recursive = true;
-    };
-
-    ScriptFileWatcherWin32() = default;
-    ~ScriptFileWatcherWin32();
+    explicit ScriptFileWatcherWin32(size_t maxQueuedEvents = kDefaultMaxQueuedEvents)
+        : ScriptFileWatcher(maxQueuedEvents) {}
+    ~ScriptFileWatcherWin32() override;
 
-    ScriptFileWatcherWin32(const ScriptFileWatcherWin32 &) = delete;
-    ScriptFileWatcherWin32 &operator=(const ScriptFileWatcherWin32 &) = delete;
-
-    bool Watch(const std::wstring &root, bool recursive = true);
-    bool Unwatch(const std::wstring &root);
-    void StopAll();
-    std::vector<Event> DrainEvents();
-    uint64_t GetDroppedEventCount() const;
-#ifdef BML_TEST
-    void PushOverflowEventForTest(const std::wstring &root, bool recursive = true);
-#endif
+    const char *GetBackendName() const override { return "win32"; }
+    bool Watch(const std::wstring &root, bool recursive = true) override;
+    bool Unwatch(const std::wstring &root) override;
+    void StopAll() override;
 
 private:
     struct WatchState {
@@ -48,25 +35,12 @@ private:
         std::thread Worker;
     };
 
-    struct OverflowKey {
-        std::wstring Root;
-        bool Recursive = true;
-    };
-
-    static bool SameRoot(const std::wstring &left, const std::wstring &right);
     static void StopWatches(std::vector<WatchState *> &watches);
 
     void WorkerLoop(WatchState *state);
-    void PushEvent(const Event &event);
-    bool HasOverflowEventLocked(const std::wstring &root, bool recursive) const;
-    void ForgetOverflowEventLocked(const Event &event);
-    void PushOverflowEventLocked(const std::wstring &root, bool recursive);
 
-    mutable std::mutex m_Mutex;
-    std::vector<Event> m_Events;
+    std::mutex m_WatchMutex;
     std::vector<WatchState *> m_Watches;
-    uint64_t m_DroppedEvents = 0;
-    std::vector<OverflowKey> m_OverflowQueued;
 };
 
 } // namespace BML
@@ -1,7 +1,10 @@
 #include "ScriptFunctionSupport.h"
 
+#include <optional>
 #include <string>
 
+#include "FrameProfiler.h"
+#include "ScriptContextPool.h"
 #include "ScriptMod.h"
 #include "ScriptModRuntime.h"
 
@@ -99,8 +102,8 @@ bool ExecuteScriptFunction(const ScriptFunctionCall &call, ScriptDiagnostic &dia
         return false;
     }
 
-    asIScriptEngine *engine = call.Function->GetEngine();
-    asIScriptContext *context = engine ? engine->CreateContext() : nullptr;
+    ScriptPooledContext pooledContext(call.Function->GetEngine());
+    asIScriptContext *context = pooledContext.Get();
     if (!context) {
         diagnostic = MakeScriptDiagnostic(call.Phase,
                                           call.ContextFailureMessage ? call.ContextFailureMessage : "Unable to create AngelScript context for script callback.");
@@ -116,7 +119,6 @@ bool ExecuteScriptFunction(const ScriptFunctionCall &call, ScriptDiagnostic &dia
     if (!callable) {
         diagnostic = MakeScriptDiagnostic(call.Phase,
                                           call.InvalidStateMessage ? call.InvalidStateMessage : "Script callback has invalid runtime state.");
-        context->Release();
         return false;
     }
 
@@ -129,16 +131,23 @@ bool ExecuteScriptFunction(const ScriptFunctionCall &call, ScriptDiagnostic &dia
 
     if (code < 0) {
         diagnostic = MakeScriptFunctionDiagnostic(call, code, context);
-        context->Release();
         return false;
     }
 
-    code = context->Execute();
+    {
+        FrameProfiler &profiler = FrameProfiler::Get();
+        std::optional<FrameProfiler::Scope> profile;
+        if (profiler.IsEnabled()) {
+            const char *owner = call.Owner ? call.Owner->GetID() : nullptr;
+            const char *name = callable->GetName();
+            profile.emplace(profiler, owner ? owner : "Script", name ? name : "");
+        }
+        code = pooledContext.Execute();
+    }
     if (code == asEXECUTION_SUSPENDED)
         context->Abort();
     if (code != asEXECUTION_FINISHED) {
         diagnostic = MakeScriptFunctionDiagnostic(call, code, context);
-        context->Release();
         return false;
     }
 
@@ -146,12 +155,10 @@ bool ExecuteScriptFunction(const ScriptFunctionCall &call, ScriptDiagnostic &dia
         code = call.ReadResult(context, call.UserData);
         if (code < 0) {
             diagnostic = MakeScriptFunctionDiagnostic(call, code, context);
-            context->Release();
             return false;
         }
     }
 
-    context->Release();
     return true;
 }
 
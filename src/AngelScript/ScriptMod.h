@@ -38,12 +38,15 @@ class ScriptModReloadPhaseScope;
 class ScriptModReloadTransaction;
 class ScriptLibrarySourceCache;
 class ScriptStateBag;
+struct ScriptModReloadSourceSnapshot;
 
 struct ScriptModReloadOptions {
     bool Automatic = false;
     bool DryRun = false;
     bool CheckStateHooks = false;
     ScriptLibrarySourceCache *LibrarySourceCache = nullptr;
+    // Already captured snapshot to reload from; the reload takes it over.
+    ScriptModReloadSourceSnapshot *SourceSnapshot = nullptr;
 };
 
 struct ScriptModReloadDiagnosticField {
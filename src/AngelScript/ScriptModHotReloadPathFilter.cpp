@@ -1,35 +1,74 @@
 #include "ScriptModHotReloadPathFilter.h"
 
+#include <algorithm>
 #include <cwchar>
+#include <cwctype>
 
-#include "Utils/PathUtils.h"
+#include "Utils/PathUtilsDetail.h"
 
 namespace BML {
 
 namespace {
 
-bool EndsWithInsensitive(const std::wstring &value, const wchar_t *suffix) {
-    if (!suffix)
-        return false;
-    const size_t suffixLength = std::wcslen(suffix);
-    if (value.size() < suffixLength)
-        return false;
-    return _wcsicmp(value.c_str() + value.size() - suffixLength, suffix) == 0;
+bool IsSeparator(wchar_t ch) {
+    return ch == L'\\' || ch == L'/';
+}
+
+bool EqualsInsensitive(const wchar_t *left, const wchar_t *right, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (std::towlower(left[i]) != std::towlower(right[i]))
+            return false;
+    }
+    return true;
+}
+
+// utils::ResolvePathW and GetDirectoryW wrap these same string helpers. Using
+// them directly keeps the filter off the Windows-only BML_PathUtils library.
+std::wstring ResolvePath(const std::wstring &path) {
+    return utils::detail::ResolvePathImpl<wchar_t>(path);
+}
+
+std::wstring GetDirectory(const std::wstring &path) {
+    return utils::detail::GetDirectoryImpl<wchar_t>(path);
+}
+
+size_t TrimmedLength(const std::wstring &path) {
+    size_t length = path.size();
+    while (length > 3 && IsSeparator(path[length - 1]))
+        --length;
+    return length;
 }
 
 bool SamePathInsensitive(const std::wstring &left, const std::wstring &right) {
     if (left.empty() || right.empty())
         return false;
-    const std::wstring resolvedLeft = utils::ResolvePathW(left);
-    const std::wstring resolvedRight = utils::ResolvePathW(right);
-    return _wcsicmp(resolvedLeft.c_str(), resolvedRight.c_str()) == 0;
+    const std::wstring resolvedLeft = ResolvePath(left);
+    const std::wstring resolvedRight = ResolvePath(right);
+    return resolvedLeft.size() == resolvedRight.size() &&
+           EqualsInsensitive(resolvedLeft.c_str(), resolvedRight.c_str(), resolvedLeft.size());
+}
+
+// Same rules as utils::IsPathInsideRootW.
+bool IsPathInsideRoot(const std::wstring &path, const std::wstring &root) {
+    if (path.empty() || root.empty())
+        return false;
+
+    const std::wstring resolvedPath = ResolvePath(path);
+    const std::wstring resolvedRoot = ResolvePath(root);
+    const size_t pathLength = TrimmedLength(resolvedPath);
+    const size_t rootLength = TrimmedLength(resolvedRoot);
+    if (pathLength == 0 || rootLength == 0 || pathLength < rootLength)
+        return false;
+    if (!EqualsInsensitive(resolvedPath.c_str(), resolvedRoot.c_str(), rootLength))
+        return false;
+    return pathLength == rootLength || IsSeparator(resolvedPath[rootLength]);
 }
 
 bool IsPathInsideOrSameRoot(const std::wstring &path, const std::wstring &root) {
-    return SamePathInsensitive(path, root) || utils::IsPathInsideRootW(path, root);
+    return SamePathInsensitive(path, root) || IsPathInsideRoot(path, root);
 }
 
-bool IsPathUnderWatchedRoot(const ScriptFileWatcherWin32::Event &event,
+bool IsPathUnderWatchedRoot(const ScriptFileWatcher::Event &event,
                             const std::wstring &path) {
     if (path.empty())
         return false;
@@ -37,10 +76,10 @@ bool IsPathUnderWatchedRoot(const ScriptFileWatcherWin32::Event &event,
         return true;
     if (event.Recursive)
         return IsPathInsideOrSameRoot(path, event.Root);
-    return SamePathInsensitive(utils::GetDirectoryW(path), event.Root);
+    return SamePathInsensitive(GetDirectory(path), event.Root);
 }
 
-bool IsDirectoryAffectedByWatchedRoot(const ScriptFileWatcherWin32::Event &event,
+bool IsDirectoryAffectedByWatchedRoot(const ScriptFileWatcher::Event &event,
                                       const std::wstring &directory) {
     if (directory.empty())
         return false;
@@ -49,17 +88,17 @@ bool IsDirectoryAffectedByWatchedRoot(const ScriptFileWatcherWin32::Event &event
     if (event.Recursive)
         return IsPathInsideOrSameRoot(directory, event.Root);
     return SamePathInsensitive(directory, event.Root) ||
-           SamePathInsensitive(utils::GetDirectoryW(directory), event.Root);
+           SamePathInsensitive(GetDirectory(directory), event.Root);
 }
 
-bool IsRootLifecycleAction(DWORD action) {
-    return action == FILE_ACTION_ADDED ||
-           action == FILE_ACTION_REMOVED ||
-           action == FILE_ACTION_RENAMED_OLD_NAME ||
-           action == FILE_ACTION_RENAMED_NEW_NAME;
+bool IsRootLifecycleAction(ScriptFileAction action) {
+    return action == ScriptFileAction::Added ||
+           action == ScriptFileAction::Removed ||
+           action == ScriptFileAction::RenamedOldName ||
+           action == ScriptFileAction::RenamedNewName;
 }
 
-bool IsSourceRootLifecycleEvent(const ScriptFileWatcherWin32::Event &event,
+bool IsSourceRootLifecycleEvent(const ScriptFileWatcher::Event &event,
                                 const ScriptModEntry &entry) {
     if (!IsRootLifecycleAction(event.Action))
         return false;
@@ -74,9 +113,56 @@ bool IsSourceRootLifecycleEvent(const ScriptFileWatcherWin32::Event &event,
     return false;
 }
 
+// Folded segments of a resolved path. Separators of either kind and empty
+// segments are dropped, matching how IsPathInsideRoot compares paths.
+std::vector<std::wstring> SplitFoldedPath(const std::wstring &path) {
+    std::vector<std::wstring> segments;
+    if (path.empty())
+        return segments;
+
+    std::wstring resolved = ResolvePath(path);
+    std::transform(resolved.begin(), resolved.end(), resolved.begin(), [](wchar_t ch) {
+        return static_cast<wchar_t>(std::towlower(ch));
+    });
+    size_t start = 0;
+    while (start <= resolved.size()) {
+        const size_t separator = resolved.find_first_of(L"\\/", start);
+        const size_t end = separator == std::wstring::npos ? resolved.size() : separator;
+        if (end > start)
+            segments.emplace_back(resolved, start, end - start);
+        if (separator == std::wstring::npos)
+            break;
+        start = separator + 1;
+    }
+    return segments;
+}
+
+bool TargetLess(const ScriptHotReloadEventRouter::Target &left, const ScriptHotReloadEventRouter::Target &right) {
+    if (left.Mod != right.Mod)
+        return left.Mod < right.Mod;
+    // kModSource sorts after the mod's libraries, which are checked first
+    return left.Library < right.Library;
+}
+
+bool SameTarget(const ScriptHotReloadEventRouter::Target &left, const ScriptHotReloadEventRouter::Target &right) {
+    return left.Mod == right.Mod && left.Library == right.Library;
+}
+
 } // namespace
 
-bool ScriptHotReloadOverflowCanAffectEntry(const ScriptFileWatcherWin32::Event &event,
+bool ScriptHotReloadSamePath(const std::wstring &left, const std::wstring &right) {
+    return SamePathInsensitive(left, right);
+}
+
+bool ScriptHotReloadPathEndsWith(const std::wstring &path, const wchar_t *suffix) {
+    if (!suffix)
+        return false;
+    const size_t suffixLength = std::wcslen(suffix);
+    return path.size() >= suffixLength &&
+           EqualsInsensitive(path.c_str() + path.size() - suffixLength, suffix, suffixLength);
+}
+
+bool ScriptHotReloadOverflowCanAffectEntry(const ScriptFileWatcher::Event &event,
                                            const ScriptModEntry &entry) {
     if (event.Root.empty())
         return true;
@@ -113,7 +199,7 @@ bool ScriptHotReloadEventBelongsToEntry(const std::wstring &path,
     return !entry.RootDirectory.empty() && IsPathInsideOrSameRoot(path, entry.RootDirectory);
 }
 
-bool ScriptHotReloadEventLooksRelevant(const ScriptFileWatcherWin32::Event &event,
+bool ScriptHotReloadEventLooksRelevant(const ScriptFileWatcher::Event &event,
                                        const ScriptModEntry &entry) {
     if (event.Overflow)
         return ScriptHotReloadOverflowCanAffectEntry(event, entry);
@@ -123,13 +209,13 @@ bool ScriptHotReloadEventLooksRelevant(const ScriptFileWatcherWin32::Event &even
         return false;
 
     if (entry.SourceKind == ScriptModEntrySourceKind::ZipPackage)
-        return EndsWithInsensitive(event.Path, L".zip") &&
+        return ScriptHotReloadPathEndsWith(event.Path, L".zip") &&
                SamePathInsensitive(event.Path, entry.SourcePath);
 
-    return EndsWithInsensitive(event.Path, L".as");
+    return ScriptHotReloadPathEndsWith(event.Path, L".as");
 }
 
-bool ScriptHotReloadEventLooksRelevantToLibraryUse(const ScriptFileWatcherWin32::Event &event,
+bool ScriptHotReloadEventLooksRelevantToLibraryUse(const ScriptFileWatcher::Event &event,
                                                    const ScriptLibraryUse &library) {
     if (library.RootDirectory.empty())
         return false;
@@ -145,7 +231,82 @@ bool ScriptHotReloadEventLooksRelevantToLibraryUse(const ScriptFileWatcherWin32:
     if (!IsPathInsideOrSameRoot(event.Path, library.RootDirectory))
         return false;
 
-    return EndsWithInsensitive(event.Path, L".as");
+    return ScriptHotReloadPathEndsWith(event.Path, L".as");
+}
+
+void ScriptHotReloadEventRouter::Clear() {
+    m_Nodes.clear();
+    m_AllTargets.clear();
+}
+
+void ScriptHotReloadEventRouter::AddMod(size_t mod,
+                                        const ScriptModEntry &entry,
+                                        const std::vector<ScriptLibraryUse> &libraries) {
+    // Every path ScriptHotReloadEventLooksRelevant accepts is one of these or
+    // lies below one. Source dependencies and include targets live under the
+    // same roots, so they need no nodes of their own.
+    const Target source{mod, kModSource};
+    if (entry.SourceKind == ScriptModEntrySourceKind::ZipPackage) {
+        AddPath(entry.SourcePath, source);
+    } else if (entry.SourceKind == ScriptModEntrySourceKind::SingleFile) {
+        AddPath(entry.EntryPath, source);
+        AddPath(entry.ResourceRootDirectory, source);
+    } else {
+        AddPath(entry.RootDirectory, source);
+    }
+
+    for (size_t i = 0; i < libraries.size(); ++i) {
+        if (libraries[i].RootDirectory.empty())
+            continue;
+        const Target library{mod, i};
+        AddPath(libraries[i].RootDirectory, library);
+        m_AllTargets.push_back(library);
+    }
+    m_AllTargets.push_back(source);
+}
+
+void ScriptHotReloadEventRouter::Route(const ScriptFileWatcher::Event &event, std::vector<Target> &targets) const {
+    targets.clear();
+    if (event.Overflow) {
+        targets = m_AllTargets;
+        return;
+    }
+    if (m_Nodes.empty())
+        return;
+
+    size_t node = 0;
+    targets.insert(targets.end(), m_Nodes[node].Targets.begin(), m_Nodes[node].Targets.end());
+    for (const std::wstring &segment : SplitFoldedPath(event.Path)) {
+        const auto child = m_Nodes[node].Children.find(segment);
+        if (child == m_Nodes[node].Children.end())
+            break;
+        node = child->second;
+        targets.insert(targets.end(), m_Nodes[node].Targets.begin(), m_Nodes[node].Targets.end());
+    }
+    std::sort(targets.begin(), targets.end(), TargetLess);
+    targets.erase(std::unique(targets.begin(), targets.end(), SameTarget), targets.end());
+}
+
+void ScriptHotReloadEventRouter::AddPath(const std::wstring &path, const Target &target) {
+    const std::vector<std::wstring> segments = SplitFoldedPath(path);
+    if (segments.empty())
+        return;
+
+    if (m_Nodes.empty())
+        m_Nodes.emplace_back();
+    size_t node = 0;
+    for (const std::wstring &segment : segments) {
+        const auto child = m_Nodes[node].Children.find(segment);
+        if (child != m_Nodes[node].Children.end()) {
+            node = child->second;
+            continue;
+        }
+        const size_t created = m_Nodes.size();
+        m_Nodes[node].Children.emplace(segment, created);
+        m_Nodes.emplace_back();
+        node = created;
+    }
+    m_Nodes[node].Targets.push_back(target);
 }
 
 } // namespace BML
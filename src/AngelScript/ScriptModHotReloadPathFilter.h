@@ -1,20 +1,67 @@
 #ifndef BML_SCRIPTMODHOTRELOADPATHFILTER_H
 #define BML_SCRIPTMODHOTRELOADPATHFILTER_H
 
+#include <cstddef>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
-#include "ScriptFileWatcherWin32.h"
+#include "ScriptFileWatcher.h"
 #include "ScriptModEntryScanner.h"
 #include "ScriptSourceSnapshot.h"
 
 namespace BML {
 
+// Case-insensitive path checks. Paths are resolved lexically, so they need not
+// exist and behave the same on every platform.
+bool ScriptHotReloadSamePath(const std::wstring &left, const std::wstring &right);
+bool ScriptHotReloadPathEndsWith(const std::wstring &path, const wchar_t *suffix);
+
 bool ScriptHotReloadEventBelongsToEntry(const std::wstring &path, const ScriptModEntry &entry);
-bool ScriptHotReloadEventLooksRelevant(const ScriptFileWatcherWin32::Event &event, const ScriptModEntry &entry);
-bool ScriptHotReloadOverflowCanAffectEntry(const ScriptFileWatcherWin32::Event &event, const ScriptModEntry &entry);
-bool ScriptHotReloadEventLooksRelevantToLibraryUse(const ScriptFileWatcherWin32::Event &event,
+bool ScriptHotReloadEventLooksRelevant(const ScriptFileWatcher::Event &event, const ScriptModEntry &entry);
+bool ScriptHotReloadOverflowCanAffectEntry(const ScriptFileWatcher::Event &event, const ScriptModEntry &entry);
+bool ScriptHotReloadEventLooksRelevantToLibraryUse(const ScriptFileWatcher::Event &event,
                                                    const ScriptLibraryUse &library);
 
+// Narrows a watcher event down to the mods and library uses whose paths can
+// match it. Source roots, entry files and library package roots sit in a trie
+// keyed by folded path segments, so an event walks its own path once instead
+// of being compared with every mod. The checks above still make the decision;
+// routing only skips mods that cannot pass them.
+class ScriptHotReloadEventRouter {
+public:
+    static constexpr size_t kModSource = static_cast<size_t>(-1);
+
+    // Library indexes the mod's library uses, or is kModSource for the mod's
+    // own source files.
+    struct Target {
+        size_t Mod = 0;
+        size_t Library = kModSource;
+    };
+
+    void Clear();
+    // Mods are added in ascending index order.
+    void AddMod(size_t mod, const ScriptModEntry &entry, const std::vector<ScriptLibraryUse> &libraries);
+
+    // Targets registered at the event path or one of its parents, ordered by
+    // mod and then library. Overflow events carry no file path and get every
+    // target.
+    void Route(const ScriptFileWatcher::Event &event, std::vector<Target> &targets) const;
+
+    size_t GetNodeCount() const { return m_Nodes.size(); }
+
+private:
+    struct Node {
+        std::unordered_map<std::wstring, size_t> Children;
+        std::vector<Target> Targets;
+    };
+
+    void AddPath(const std::wstring &path, const Target &target);
+
+    std::vector<Node> m_Nodes;
+    std::vector<Target> m_AllTargets;
+};
+
 } // namespace BML
 
 #endif
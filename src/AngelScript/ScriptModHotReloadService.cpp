@@ -11,6 +11,7 @@
 #include "ScriptDevToolsService.h"
 #include "ScriptLibraryServices.h"
 #include "ScriptModHotReloadPathFilter.h"
+#include "ScriptReloadCandidateBuilder.h"
 #include "ScriptSourceSnapshotBuilder.h"
 #include "Utils/PathUtils.h"
 #include "Utils/StringUtils.h"
@@ -22,20 +23,11 @@ constexpr auto kDebounceDelay = std::chrono::milliseconds(500);
 constexpr auto kRetryDelay = std::chrono::milliseconds(100);
 constexpr auto kBlockedNoticeDelay = std::chrono::seconds(1);
 
-bool SamePathInsensitive(const std::wstring &left, const std::wstring &right) {
-    if (left.empty() || right.empty())
-        return false;
-    const std::wstring resolvedLeft = utils::ResolvePathW(left);
-    const std::wstring resolvedRight = utils::ResolvePathW(right);
-    return _wcsicmp(resolvedLeft.c_str(), resolvedRight.c_str()) == 0;
-}
-
 std::wstring ScriptEntryStem(const std::wstring &entryPath) {
     std::wstring fileName = utils::GetFileNameW(entryPath);
     constexpr wchar_t suffix[] = L".mod.as";
     constexpr size_t suffixLength = (sizeof(suffix) / sizeof(suffix[0])) - 1;
-    if (fileName.size() > suffixLength &&
-        _wcsicmp(fileName.c_str() + fileName.size() - suffixLength, suffix) == 0) {
+    if (fileName.size() > suffixLength && ScriptHotReloadPathEndsWith(fileName, suffix)) {
         fileName.resize(fileName.size() - suffixLength);
     }
     return fileName;
@@ -352,7 +344,8 @@ bool ScriptModReloadOperation::Run(std::chrono::steady_clock::time_point now) {
 }
 
 ScriptModHotReloadService::ScriptModHotReloadService(ModContext *context)
-    : m_Context(context) {
+    : m_Context(context),
+      m_Watcher(ScriptFileWatcher::Create()) {
 }
 
 ScriptModHotReloadService::~ScriptModHotReloadService() {
@@ -408,7 +401,7 @@ void ScriptModHotReloadService::Start() {
 
 void ScriptModHotReloadService::Stop() {
     m_Started = false;
-    m_Watcher.StopAll();
+    m_Watcher->StopAll();
     m_ActiveWatches.clear();
     m_Pending.clear();
     m_PendingLibraries.clear();
@@ -419,8 +412,8 @@ void ScriptModHotReloadService::Process() {
         return;
 
     if (m_AutomaticEnabled) {
-        const std::vector<ScriptFileWatcherWin32::Event> events = m_Watcher.DrainEvents();
-        const uint64_t watcherDroppedEvents = m_Watcher.GetDroppedEventCount();
+        const std::vector<ScriptFileWatcher::Event> events = m_Watcher->DrainEvents();
+        const uint64_t watcherDroppedEvents = m_Watcher->GetDroppedEventCount();
         ScriptModReloadOptions automaticOptions;
         automaticOptions.Automatic = true;
         std::vector<ScriptLibraryReloadPackage> changedLibraryPackages;
@@ -441,19 +434,28 @@ void ScriptModHotReloadService::Process() {
                     QueueReloadDebounced(record.Mod, automaticOptions, "watch overflow");
             }
         }
+        if (!events.empty())
+            RebuildEventRouter();
+        std::vector<ScriptHotReloadEventRouter::Target> targets;
         for (const auto &event : events) {
             PublishNewModRestartRequired(event);
-            for (const auto &record : m_Mods) {
-                if (!record.Mod || record.Policy != ScriptModReloadPolicy::Auto)
-                    continue;
-                const std::vector<ScriptLibraryReloadPackage> libraryPackages = GetEventAffectedLibraryPackages(event, record.Mod);
+            m_EventRouter.Route(event, targets);
+            for (size_t begin = 0; begin < targets.size();) {
+                size_t end = begin + 1;
+                while (end < targets.size() && targets[end].Mod == targets[begin].Mod)
+                    ++end;
+                ScriptMod *mod = m_Mods[targets[begin].Mod].Mod;
+                const bool sourceRouted = targets[end - 1].Library == ScriptHotReloadEventRouter::kModSource;
+                const std::vector<ScriptLibraryReloadPackage> libraryPackages =
+                    GetEventAffectedLibraryPackages(event, mod, targets.data() + begin, targets.data() + end);
+                begin = end;
                 if (!libraryPackages.empty()) {
                     AddLibraryPackages(changedLibraryPackages, libraryPackages);
                     continue;
                 }
-                if (!EventLooksRelevant(event, record.Mod))
+                if (!sourceRouted || !EventLooksRelevant(event, mod))
                     continue;
-                QueueReloadDebounced(record.Mod, automaticOptions, "file changed");
+                QueueReloadDebounced(mod, automaticOptions, "file changed");
             }
         }
         if (!changedLibraryPackages.empty()) {
@@ -507,6 +509,31 @@ void ScriptModHotReloadService::Process() {
     }
     sortReadyKeys(ready, m_Pending);
 
+    // Reloads that are ready together, such as a reload-all, capture their
+    // sources as one batch that shares library sources and worker threads.
+    std::vector<std::string> batchIds;
+    std::vector<ScriptModEntry> batchEntries;
+    for (const std::string &id : ready) {
+        const auto pendingIt = m_Pending.find(id);
+        if (pendingIt == m_Pending.end())
+            continue;
+        if (pendingIt->second.Options.Automatic && !m_AutomaticEnabled)
+            continue;
+        ScriptMod *mod = FindMod(id);
+        if (!mod || !mod->CanHotReloadNow())
+            continue;
+        batchIds.push_back(id);
+        batchEntries.push_back(mod->GetEntry());
+    }
+    ScriptLibrarySourceCache batchSourceCache;
+    std::vector<std::unique_ptr<ScriptModReloadSourceSnapshot>> batchSnapshots;
+    if (batchEntries.size() > 1) {
+        ScriptReloadCandidateBuilder::CaptureSourceSnapshots(m_Context,
+                                                             batchEntries,
+                                                             &batchSourceCache,
+                                                             batchSnapshots);
+    }
+
     for (const std::string &id : ready) {
         auto pendingIt = m_Pending.find(id);
         if (pendingIt == m_Pending.end())
@@ -516,8 +543,19 @@ void ScriptModHotReloadService::Process() {
         if (pending.Options.Automatic && !m_AutomaticEnabled) {
             continue;
         }
+        const size_t batchIndex = std::find(batchIds.begin(), batchIds.end(), id) - batchIds.begin();
+        const bool batched = batchIndex < batchSnapshots.size();
+        const bool batchCache = batched && !pending.Options.LibrarySourceCache;
+        if (batched) {
+            pending.Options.SourceSnapshot = batchSnapshots[batchIndex].get();
+            if (batchCache)
+                pending.Options.LibrarySourceCache = &batchSourceCache;
+        }
         if (!ScriptModReloadOperation(*this, id, pending).Run(now)) {
             pending.Due = now + kRetryDelay;
+            pending.Options.SourceSnapshot = nullptr;
+            if (batchCache)
+                pending.Options.LibrarySourceCache = nullptr;
             m_Pending[id] = pending;
         }
     }
@@ -610,7 +648,8 @@ std::string ScriptModHotReloadService::GetStatus() const {
            << " sourceLibs=" << activeLibraryPackages.size()
            << " automatic=" << (m_AutomaticEnabled ? "on" : "off")
            << " watches=" << m_ActiveWatches.size()
-           << " watcherDropped=" << m_Watcher.GetDroppedEventCount();
+           << " watcher=" << m_Watcher->GetBackendName()
+           << " watcherDropped=" << m_Watcher->GetDroppedEventCount();
     return stream.str();
 }
 
@@ -667,7 +706,7 @@ void ScriptModHotReloadService::RefreshRegisteredModOrder() {
 
 void ScriptModHotReloadService::RebuildWatches() {
     if (!m_Started || !m_AutomaticEnabled) {
-        m_Watcher.StopAll();
+        m_Watcher->StopAll();
         m_ActiveWatches.clear();
         return;
     }
@@ -700,7 +739,7 @@ void ScriptModHotReloadService::RebuildWatches() {
         const auto desiredIt = desired.find(it->first);
         if (desiredIt == desired.end() ||
             desiredIt->second.Recursive != it->second.Recursive) {
-            m_Watcher.Unwatch(it->second.Root);
+            m_Watcher->Unwatch(it->second.Root);
             it = m_ActiveWatches.erase(it);
             continue;
         }
@@ -711,7 +750,7 @@ void ScriptModHotReloadService::RebuildWatches() {
         const auto activeIt = m_ActiveWatches.find(entry.first);
         if (activeIt != m_ActiveWatches.end())
             continue;
-        if (m_Watcher.Watch(entry.second.Root, entry.second.Recursive)) {
+        if (m_Watcher->Watch(entry.second.Root, entry.second.Recursive)) {
             m_ActiveWatches.emplace(entry.first, entry.second);
         } else if (m_Context && m_Context->GetScriptDevTools()) {
             m_Context->GetScriptDevTools()->PublishEvent(ScriptDevEventSeverity::Warn,
@@ -725,6 +764,18 @@ void ScriptModHotReloadService::RebuildWatches() {
     }
 }
 
+// Library uses change with every reload, so the router is rebuilt for each
+// drained batch: one pass over the mods per batch instead of one per event.
+void ScriptModHotReloadService::RebuildEventRouter() {
+    m_EventRouter.Clear();
+    for (size_t i = 0; i < m_Mods.size(); ++i) {
+        const ModRecord &record = m_Mods[i];
+        if (!record.Mod || record.Policy != ScriptModReloadPolicy::Auto)
+            continue;
+        m_EventRouter.AddMod(i, record.Mod->GetEntry(), record.Mod->GetDefinition().SourceLibraries);
+    }
+}
+
 void ScriptModHotReloadService::ClearAutomaticPendingReloads() {
     for (auto it = m_Pending.begin(); it != m_Pending.end();) {
         if (it->second.Options.Automatic)
@@ -1065,14 +1116,14 @@ void ScriptModHotReloadService::AddDesiredWatch(std::unordered_map<std::wstring,
         it->second.Recursive = true;
 }
 
-bool ScriptModHotReloadService::EventOverflowCanAffectMod(const ScriptFileWatcherWin32::Event &event,
+bool ScriptModHotReloadService::EventOverflowCanAffectMod(const ScriptFileWatcher::Event &event,
                                                           const ScriptMod *mod) const {
     if (!mod)
         return false;
     return ScriptHotReloadOverflowCanAffectEntry(event, mod->GetEntry());
 }
 
-bool ScriptModHotReloadService::EventLooksRelevant(const ScriptFileWatcherWin32::Event &event,
+bool ScriptModHotReloadService::EventLooksRelevant(const ScriptFileWatcher::Event &event,
                                                    const ScriptMod *mod) const {
     if (!mod)
         return false;
@@ -1093,12 +1144,18 @@ std::vector<ScriptLibraryReloadPackage> ScriptModHotReloadService::GetActiveLibr
 }
 
 std::vector<ScriptLibraryReloadPackage> ScriptModHotReloadService::GetEventAffectedLibraryPackages(
-    const ScriptFileWatcherWin32::Event &event,
-    const ScriptMod *mod) const {
+    const ScriptFileWatcher::Event &event,
+    const ScriptMod *mod,
+    const ScriptHotReloadEventRouter::Target *begin,
+    const ScriptHotReloadEventRouter::Target *end) const {
     std::vector<ScriptLibraryReloadPackage> packages;
     if (!mod)
         return packages;
-    for (const ScriptLibraryUse &library : mod->GetDefinition().SourceLibraries) {
+    const std::vector<ScriptLibraryUse> &libraries = mod->GetDefinition().SourceLibraries;
+    for (const ScriptHotReloadEventRouter::Target *target = begin; target != end; ++target) {
+        if (target->Library >= libraries.size())
+            continue;
+        const ScriptLibraryUse &library = libraries[target->Library];
         if (!ScriptHotReloadEventLooksRelevantToLibraryUse(event, library))
             continue;
         AddLibraryPackage(packages, library.Id, library.Version);
@@ -1680,7 +1737,7 @@ bool ScriptModHotReloadService::ProcessLibraryReload(PendingLibraryReload &pendi
     return ScriptLibraryReloadOperation(*this, pending).Run();
 }
 
-void ScriptModHotReloadService::PublishNewModRestartRequired(const ScriptFileWatcherWin32::Event &event) {
+void ScriptModHotReloadService::PublishNewModRestartRequired(const ScriptFileWatcher::Event &event) {
     if (event.Overflow || !IsScriptModEntryName(utils::GetFileNameW(event.Path).c_str()))
         return;
 
@@ -1692,7 +1749,7 @@ void ScriptModHotReloadService::PublishNewModRestartRequired(const ScriptFileWat
     const std::wstring modsRoot = GetModsRoot();
     const std::wstring entryDirectory = utils::GetDirectoryW(event.Path);
     std::wstring candidateRoot = entryDirectory;
-    if (SamePathInsensitive(entryDirectory, modsRoot))
+    if (ScriptHotReloadSamePath(entryDirectory, modsRoot))
         candidateRoot = utils::CombinePathW(entryDirectory, ScriptEntryStem(event.Path));
 
     const std::wstring key = utils::ResolvePathW(candidateRoot);
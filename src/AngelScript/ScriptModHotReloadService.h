@@ -3,13 +3,15 @@
 
 #include <chrono>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
-#include "ScriptFileWatcherWin32.h"
+#include "ScriptFileWatcher.h"
 #include "ScriptMod.h"
+#include "ScriptModHotReloadPathFilter.h"
 
 class ModContext;
 
@@ -83,6 +85,7 @@ private:
     ScriptMod *FindMod(const std::string &id) const;
     void RefreshRegisteredModOrder();
     void RebuildWatches();
+    void RebuildEventRouter();
     void ClearAutomaticPendingReloads();
     void QueueReloadNow(ScriptMod *mod, const ScriptModReloadOptions &options, const std::string &reason);
     void QueueReloadDebounced(ScriptMod *mod, const ScriptModReloadOptions &options, const std::string &reason);
@@ -105,11 +108,14 @@ private:
     void AddDesiredWatch(std::unordered_map<std::wstring, WatchSpec> &desired,
                          const std::wstring &root,
                          bool recursive) const;
-    bool EventOverflowCanAffectMod(const ScriptFileWatcherWin32::Event &event, const ScriptMod *mod) const;
-    bool EventLooksRelevant(const ScriptFileWatcherWin32::Event &event, const ScriptMod *mod) const;
+    bool EventOverflowCanAffectMod(const ScriptFileWatcher::Event &event, const ScriptMod *mod) const;
+    bool EventLooksRelevant(const ScriptFileWatcher::Event &event, const ScriptMod *mod) const;
     std::vector<ScriptLibraryReloadPackage> GetActiveLibraryPackages(bool automaticOnly) const;
-    std::vector<ScriptLibraryReloadPackage> GetEventAffectedLibraryPackages(const ScriptFileWatcherWin32::Event &event,
-                                                                            const ScriptMod *mod) const;
+    std::vector<ScriptLibraryReloadPackage> GetEventAffectedLibraryPackages(
+        const ScriptFileWatcher::Event &event,
+        const ScriptMod *mod,
+        const ScriptHotReloadEventRouter::Target *begin,
+        const ScriptHotReloadEventRouter::Target *end) const;
     bool EventBelongsToKnownMod(const std::wstring &path, const ScriptMod *mod) const;
     bool ModUsesLibrary(const ScriptMod *mod, const std::string &id, const std::string &version) const;
     bool ModUsesAnyLibrary(const ScriptMod *mod, const std::vector<ScriptLibraryReloadPackage> &packages) const;
@@ -128,7 +134,7 @@ private:
                              const std::string &reason,
                              const ScriptModReloadOptions &options,
                              const ScriptModReloadResult &result);
-    void PublishNewModRestartRequired(const ScriptFileWatcherWin32::Event &event);
+    void PublishNewModRestartRequired(const ScriptFileWatcher::Event &event);
 
     ModContext *m_Context = nullptr;
     bool m_Started = false;
@@ -138,7 +144,8 @@ private:
     std::unordered_map<std::string, PendingLibraryReload> m_PendingLibraries;
     std::unordered_map<std::wstring, WatchSpec> m_ActiveWatches;
     std::unordered_set<std::wstring> m_ReportedNewModRoots;
-    ScriptFileWatcherWin32 m_Watcher;
+    std::unique_ptr<ScriptFileWatcher> m_Watcher;
+    ScriptHotReloadEventRouter m_EventRouter;
     uint64_t m_LastWatcherDroppedEvents = 0;
 };
 
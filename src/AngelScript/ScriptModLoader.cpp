@@ -53,6 +53,7 @@ ScriptModLoadResult ScriptModLoader::Load(ModContext *owner,
         } else {
             ScriptSourceSnapshot snapshot;
             ScriptSourceSnapshotBuilder snapshotBuilder(std::move(registry));
+            snapshotBuilder.SetParallelism(ScriptSourceSnapshotBuilder::GetDefaultParallelism());
             if (!snapshotBuilder.Build(entry, snapshot, failure)) {
                 result.Failed = true;
             } else if (!runtime.LoadModuleFromSections(context,
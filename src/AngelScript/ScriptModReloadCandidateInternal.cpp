@@ -1,6 +1,7 @@
 #include "ScriptModReloadCandidateInternal.h"
 
 #include <algorithm>
+#include <utility>
 
 #include "Utils/PathUtils.h"
 
@@ -13,6 +14,33 @@ ScriptModReloadSourceSnapshot::~ScriptModReloadSourceSnapshot() {
     Cleanup();
 }
 
+ScriptModReloadSourceSnapshot::ScriptModReloadSourceSnapshot(ScriptModReloadSourceSnapshot &&other) {
+    *this = std::move(other);
+}
+
+ScriptModReloadSourceSnapshot &ScriptModReloadSourceSnapshot::operator=(ScriptModReloadSourceSnapshot &&other) {
+    if (this == &other)
+        return *this;
+
+    Cleanup();
+    CompileCandidate = std::move(other.CompileCandidate);
+    CompileEntry = std::move(other.CompileEntry);
+    CommitEntry = std::move(other.CommitEntry);
+    CompileEntryPathUtf8 = std::move(other.CompileEntryPathUtf8);
+    CommitEntryPathUtf8 = std::move(other.CommitEntryPathUtf8);
+    EntrySectionNameUtf8 = std::move(other.EntrySectionNameUtf8);
+    SourceSections = std::move(other.SourceSections);
+    SourceLibraries = std::move(other.SourceLibraries);
+    SourceDependencies = std::move(other.SourceDependencies);
+    SourceIncludeEdges = std::move(other.SourceIncludeEdges);
+    StagedRoot = std::move(other.StagedRoot);
+    DiagnosticStagedRootUtf8 = std::move(other.DiagnosticStagedRootUtf8);
+    DiagnosticDisplayRootUtf8 = std::move(other.DiagnosticDisplayRootUtf8);
+    other.StagedRoot.clear();
+    other.Reset();
+    return *this;
+}
+
 void ScriptModReloadSourceSnapshot::Reset() {
     Cleanup();
     CompileCandidate = ScriptModLoadCandidate();
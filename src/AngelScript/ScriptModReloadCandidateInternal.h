@@ -47,6 +47,8 @@ struct ScriptModReloadSourceSnapshot {
     ScriptModReloadSourceSnapshot() = default;
     ScriptModReloadSourceSnapshot(const ScriptModReloadSourceSnapshot &) = delete;
     ScriptModReloadSourceSnapshot &operator=(const ScriptModReloadSourceSnapshot &) = delete;
+    ScriptModReloadSourceSnapshot(ScriptModReloadSourceSnapshot &&other);
+    ScriptModReloadSourceSnapshot &operator=(ScriptModReloadSourceSnapshot &&other);
 
     ~ScriptModReloadSourceSnapshot();
 
@@ -347,11 +347,9 @@ static bool PrepareZipReloadCandidate(const ScriptModEntry &entry,
     return true;
 }
 
-static bool CaptureReloadSourceSnapshot(ModContext *context,
-                                        const ScriptModEntry &entry,
-                                        ScriptModReloadSourceSnapshot &snapshot,
-                                        ScriptLibrarySourceCache *librarySourceCache,
-                                        ScriptDiagnostic &diagnostic) {
+static bool StageReloadSourceSnapshot(const ScriptModEntry &entry,
+                                      ScriptModReloadSourceSnapshot &snapshot,
+                                      ScriptDiagnostic &diagnostic) {
     snapshot.Reset();
 
     ScriptModLoadCandidate candidate;
@@ -399,6 +397,24 @@ static bool CaptureReloadSourceSnapshot(ModContext *context,
                                                          snapshot.CompileEntry);
     }
     snapshot.CommitEntryPathUtf8 = utils::Utf16ToUtf8(snapshot.CommitEntry.EntryPath);
+    return true;
+}
+
+static void AdoptSourceSnapshot(ScriptModReloadSourceSnapshot &snapshot, ScriptSourceSnapshot &sourceSnapshot) {
+    snapshot.EntrySectionNameUtf8 = sourceSnapshot.EntrySectionName;
+    snapshot.SourceSections = std::move(sourceSnapshot.Sections);
+    snapshot.SourceLibraries = std::move(sourceSnapshot.Libraries);
+    snapshot.SourceDependencies = std::move(sourceSnapshot.Dependencies);
+    snapshot.SourceIncludeEdges = std::move(sourceSnapshot.IncludeEdges);
+}
+
+static bool CaptureReloadSourceSnapshot(ModContext *context,
+                                        const ScriptModEntry &entry,
+                                        ScriptModReloadSourceSnapshot &snapshot,
+                                        ScriptLibrarySourceCache *librarySourceCache,
+                                        ScriptDiagnostic &diagnostic) {
+    if (!StageReloadSourceSnapshot(entry, snapshot, diagnostic))
+        return false;
 
     ScriptLibraryRegistry registry = MakeInstalledScriptLibraryRegistry(context, diagnostic);
     if (!diagnostic.Message.empty())
@@ -407,19 +423,56 @@ static bool CaptureReloadSourceSnapshot(ModContext *context,
     ScriptSourceSnapshot sourceSnapshot;
     ScriptSourceSnapshotBuilder snapshotBuilder(std::move(registry));
     snapshotBuilder.SetLibrarySourceCache(librarySourceCache);
+    snapshotBuilder.SetParallelism(ScriptSourceSnapshotBuilder::GetDefaultParallelism());
     if (!snapshotBuilder.Build(snapshot.CompileEntry, sourceSnapshot, diagnostic)) {
         RewriteReloadSnapshotDiagnosticPaths(snapshot, diagnostic);
         return false;
     }
-    snapshot.EntrySectionNameUtf8 = sourceSnapshot.EntrySectionName;
-    snapshot.SourceSections = std::move(sourceSnapshot.Sections);
-    snapshot.SourceLibraries = std::move(sourceSnapshot.Libraries);
-    snapshot.SourceDependencies = std::move(sourceSnapshot.Dependencies);
-    snapshot.SourceIncludeEdges = std::move(sourceSnapshot.IncludeEdges);
-
+    AdoptSourceSnapshot(snapshot, sourceSnapshot);
     return true;
 }
 
+void ScriptReloadCandidateBuilder::CaptureSourceSnapshots(
+    ModContext *context,
+    const std::vector<ScriptModEntry> &entries,
+    ScriptLibrarySourceCache *librarySourceCache,
+    std::vector<std::unique_ptr<ScriptModReloadSourceSnapshot>> &snapshots) {
+    snapshots.clear();
+    snapshots.resize(entries.size());
+
+    ScriptDiagnostic diagnostic;
+    ScriptLibraryRegistry registry = MakeInstalledScriptLibraryRegistry(context, diagnostic);
+    if (!diagnostic.Message.empty())
+        return;
+
+    // A mod that fails here is left without a snapshot; its own reload
+    // captures again and reports the failure through the usual path.
+    std::vector<size_t> staged;
+    std::vector<ScriptModEntry> compileEntries;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto snapshot = std::make_unique<ScriptModReloadSourceSnapshot>();
+        ScriptDiagnostic stageDiagnostic;
+        if (!StageReloadSourceSnapshot(entries[i], *snapshot, stageDiagnostic))
+            continue;
+        compileEntries.push_back(snapshot->CompileEntry);
+        staged.push_back(i);
+        snapshots[i] = std::move(snapshot);
+    }
+    if (compileEntries.empty())
+        return;
+
+    ScriptSourceSnapshotBuilder snapshotBuilder(std::move(registry));
+    snapshotBuilder.SetLibrarySourceCache(librarySourceCache);
+    snapshotBuilder.SetParallelism(ScriptSourceSnapshotBuilder::GetDefaultParallelism());
+    std::vector<ScriptSourceSnapshotBuildResult> results = snapshotBuilder.BuildAll(compileEntries);
+    for (size_t i = 0; i < staged.size(); ++i) {
+        if (results[i].Succeeded)
+            AdoptSourceSnapshot(*snapshots[staged[i]], results[i].Snapshot);
+        else
+            snapshots[staged[i]].reset();
+    }
+}
+
 ScriptReloadCandidateBuilder::ScriptReloadCandidateBuilder(ScriptMod &mod,
                                                            ScriptModReloadCandidate::State &state,
                                                            const ScriptModReloadOptions &options)
@@ -481,12 +534,15 @@ bool ScriptReloadCandidateBuilder::Build(ScriptModReloadResult &result, Failure
     failure = Failure();
 
     ScriptDiagnostic diagnostic;
-    if (!CaptureReloadSourceSnapshot(m_Mod.m_Context,
-                                     m_Mod.m_Entry,
-                                     m_State.Snapshot,
-                                     m_Options.LibrarySourceCache,
-                                     diagnostic))
+    if (m_Options.SourceSnapshot && !m_Options.SourceSnapshot->CompileEntryPathUtf8.empty()) {
+        m_State.Snapshot = std::move(*m_Options.SourceSnapshot);
+    } else if (!CaptureReloadSourceSnapshot(m_Mod.m_Context,
+                                            m_Mod.m_Entry,
+                                            m_State.Snapshot,
+                                            m_Options.LibrarySourceCache,
+                                            diagnostic)) {
         return FailWithDiagnostic(diagnostic, failure, false);
+    }
     result.SourcePath = m_State.Snapshot.CommitEntryPathUtf8;
 
     m_State.CandidateRuntime = ScriptModRuntime(MakeReloadModuleName(m_Mod.m_Runtime));
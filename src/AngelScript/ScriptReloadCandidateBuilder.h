@@ -1,6 +1,7 @@
 #ifndef BML_SCRIPTRELOADCANDIDATEBUILDER_H
 #define BML_SCRIPTRELOADCANDIDATEBUILDER_H
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -29,6 +30,14 @@ public:
     bool Build(ScriptModReloadResult &result, Failure &failure);
     void KeepPreparedRuntime();
 
+    // Stages every entry and builds their source snapshots in one batch that
+    // shares librarySourceCache. snapshots[i] is null when entries[i] could
+    // not be captured.
+    static void CaptureSourceSnapshots(ModContext *context,
+                                       const std::vector<ScriptModEntry> &entries,
+                                       ScriptLibrarySourceCache *librarySourceCache,
+                                       std::vector<std::unique_ptr<ScriptModReloadSourceSnapshot>> &snapshots);
+
 private:
     bool FailWithDiagnostic(ScriptDiagnostic diagnostic, Failure &failure, bool rewriteSnapshotPaths = true);
     bool FailWithMessage(const std::string &message,
@@ -1,6 +1,7 @@
 #include "ScriptSourceSnapshotBuilder.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cwchar>
 #include <cwctype>
@@ -8,11 +9,13 @@
 #include <io.h>
 #include <set>
 #include <sstream>
+#include <system_error>
+#include <thread>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
-#include "Utils/CryptoUtils.h"
+#include "Utils/HashUtils.h"
 #include "Utils/PathUtils.h"
 #include "Utils/StringUtils.h"
 
@@ -78,76 +81,116 @@ bool RegisterSectionKey(const std::string &sectionName,
     return true;
 }
 
-bool AddScriptSourceSection(const std::wstring &path,
-                            const std::wstring &sectionRoot,
-                            std::set<std::wstring> &seen,
-                            ScriptSourceSnapshot &snapshot,
-                            std::unordered_map<std::string, size_t> &sectionIndex,
-                            ScriptDiagnostic &diagnostic) {
-    const std::string pathUtf8 = utils::Utf16ToUtf8(path);
+// A local script file read ahead of being added to the snapshot. Resolving and
+// reading touch nothing shared, so several files can be loaded at once and
+// added afterwards in section order.
+struct LoadedScriptSource {
+    std::wstring FinalPath;
+    std::wstring Key;
+    ScriptSourceSection Section;
+    std::string ContentHash;
+    ScriptDiagnostic Diagnostic;
+    bool Resolved = false;
+    bool Loaded = false;
+};
+
+bool ResolveScriptSource(const std::wstring &path,
+                         const std::wstring &sectionRoot,
+                         LoadedScriptSource &source) {
     const std::wstring normalized = utils::ResolvePathW(path);
-    std::wstring finalPath;
-    if (!utils::TryGetFinalPathW(normalized, finalPath)) {
-        diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Entry,
-                                          "Failed to resolve script source final path.");
-        diagnostic.EntryPath = pathUtf8;
+    if (!utils::TryGetFinalPathW(normalized, source.FinalPath)) {
+        source.Diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Entry,
+                                                 "Failed to resolve script source final path.");
+        source.Diagnostic.EntryPath = utils::Utf16ToUtf8(path);
         return false;
     }
 
     if (!sectionRoot.empty()) {
         std::wstring finalRoot;
         if (!utils::TryGetFinalPathW(sectionRoot, finalRoot)) {
-            diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Entry,
-                                              "Failed to resolve script source root final path.");
-            diagnostic.EntryPath = utils::Utf16ToUtf8(sectionRoot);
+            source.Diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Entry,
+                                                     "Failed to resolve script source root final path.");
+            source.Diagnostic.EntryPath = utils::Utf16ToUtf8(sectionRoot);
             return false;
         }
-        if (!utils::IsPathInsideRootW(finalPath, finalRoot)) {
-            diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Entry,
-                                              "Script source escapes the source snapshot root.");
-            diagnostic.EntryPath = pathUtf8;
+        if (!utils::IsPathInsideRootW(source.FinalPath, finalRoot)) {
+            source.Diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Entry,
+                                                     "Script source escapes the source snapshot root.");
+            source.Diagnostic.EntryPath = utils::Utf16ToUtf8(path);
             return false;
         }
     }
 
     if (!sectionRoot.empty() && !utils::IsPathInsideRootW(normalized, sectionRoot)) {
-        diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Entry,
-                                          "Script source escapes the source snapshot root.");
-        diagnostic.EntryPath = pathUtf8;
+        source.Diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Entry,
+                                                 "Script source escapes the source snapshot root.");
+        source.Diagnostic.EntryPath = utils::Utf16ToUtf8(path);
         return false;
     }
 
-    const std::wstring key = FoldPathKeyW(normalized);
-    if (!seen.insert(key).second)
-        return true;
+    source.Key = FoldPathKeyW(normalized);
+    source.Resolved = true;
+    return true;
+}
 
-    std::string code;
-    if (!utils::ReadFileBytesUtf8(utils::Utf16ToUtf8(finalPath), code)) {
-        diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Entry,
-                                          "Failed to read script source into source snapshot.");
-        diagnostic.EntryPath = pathUtf8;
+bool ReadScriptSource(const std::wstring &path,
+                      const std::wstring &sectionRoot,
+                      LoadedScriptSource &source) {
+    const ScriptFileStamp stamp = ScriptContentHashMemo::StampFile(source.FinalPath);
+    if (!utils::ReadFileBytesUtf8(utils::Utf16ToUtf8(source.FinalPath), source.Section.Code)) {
+        source.Diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Entry,
+                                                 "Failed to read script source into source snapshot.");
+        source.Diagnostic.EntryPath = utils::Utf16ToUtf8(path);
         return false;
     }
 
-    ScriptSourceSection section;
-    section.Name = ToScriptSectionNameUtf8(path, sectionRoot);
-    section.Code = std::move(code);
-    if (!RegisterSectionKey(section.Name, snapshot.Sections.size(), sectionIndex, diagnostic))
+    source.Section.Name = ToScriptSectionNameUtf8(path, sectionRoot);
+    source.ContentHash = ScriptContentHashMemo::Get().GetHash(source.FinalPath, stamp, source.Section.Code);
+    source.Loaded = true;
+    return true;
+}
+
+bool AddLoadedScriptSource(LoadedScriptSource &source,
+                           ScriptSourceSnapshot &snapshot,
+                           std::unordered_map<std::string, size_t> &sectionIndex,
+                           ScriptDiagnostic &diagnostic) {
+    if (!RegisterSectionKey(source.Section.Name, snapshot.Sections.size(), sectionIndex, diagnostic))
         return false;
 
     ScriptSourceDependency dependency;
-    dependency.PhysicalPath = finalPath;
-    dependency.VirtualSection = section.Name;
-    dependency.ContentHash = utils::Sha256Hex(section.Code);
+    dependency.PhysicalPath = std::move(source.FinalPath);
+    dependency.VirtualSection = source.Section.Name;
+    dependency.ContentHash = std::move(source.ContentHash);
     snapshot.Dependencies.push_back(std::move(dependency));
-    snapshot.Sections.push_back(std::move(section));
+    snapshot.Sections.push_back(std::move(source.Section));
     return true;
 }
 
+bool AddScriptSourceSection(const std::wstring &path,
+                            const std::wstring &sectionRoot,
+                            std::set<std::wstring> &seen,
+                            ScriptSourceSnapshot &snapshot,
+                            std::unordered_map<std::string, size_t> &sectionIndex,
+                            ScriptDiagnostic &diagnostic) {
+    LoadedScriptSource source;
+    if (!ResolveScriptSource(path, sectionRoot, source)) {
+        diagnostic = std::move(source.Diagnostic);
+        return false;
+    }
+    if (!seen.insert(source.Key).second)
+        return true;
+    if (!ReadScriptSource(path, sectionRoot, source)) {
+        diagnostic = std::move(source.Diagnostic);
+        return false;
+    }
+    return AddLoadedScriptSource(source, snapshot, sectionIndex, diagnostic);
+}
+
 bool AddScriptSourceDirectory(const std::wstring &root,
                               const std::wstring &sectionRoot,
                               const std::wstring &entryPath,
                               bool includeModEntries,
+                              ScriptSourceWorkerPool &workers,
                               std::set<std::wstring> &seen,
                               ScriptSourceSnapshot &snapshot,
                               std::unordered_map<std::string, size_t> &sectionIndex,
@@ -190,8 +233,34 @@ bool AddScriptSourceDirectory(const std::wstring &root,
             return leftSection < rightSection;
         return FoldPathKeyW(left) < FoldPathKeyW(right);
     });
-    for (const std::wstring &path : sourcePaths) {
-        if (!AddScriptSourceSection(path, sectionRoot, seen, snapshot, sectionIndex, diagnostic))
+    if (workers.GetWorkerCount() <= 1) {
+        for (const std::wstring &path : sourcePaths) {
+            if (!AddScriptSourceSection(path, sectionRoot, seen, snapshot, sectionIndex, diagnostic))
+                return false;
+        }
+        return true;
+    }
+
+    // Load every file up front, then add them in sorted order so the sections
+    // and the first reported error match a sequential build.
+    std::vector<LoadedScriptSource> sources(sourcePaths.size());
+    workers.ForEach(sourcePaths.size(), [&](size_t i) {
+        LoadedScriptSource &source = sources[i];
+        if (ResolveScriptSource(sourcePaths[i], sectionRoot, source) && seen.find(source.Key) == seen.end())
+            ReadScriptSource(sourcePaths[i], sectionRoot, source);
+    });
+    for (LoadedScriptSource &source : sources) {
+        if (!source.Resolved) {
+            diagnostic = std::move(source.Diagnostic);
+            return false;
+        }
+        if (!seen.insert(source.Key).second)
+            continue;
+        if (!source.Loaded) {
+            diagnostic = std::move(source.Diagnostic);
+            return false;
+        }
+        if (!AddLoadedScriptSource(source, snapshot, sectionIndex, diagnostic))
             return false;
     }
     return true;
@@ -252,14 +321,53 @@ std::string LibraryUseKey(const std::string &id, const std::string &version) {
     return id + "@" + version;
 }
 
-size_t LineNumberFromOffset(const std::string &code, size_t offset) {
+// What the include closure needs from one section, worked out without touching
+// the snapshot so pending sections can be scanned side by side.
+struct ScannedScriptSection {
+    bool Scanned = false;
+    bool HasMetadata = false;
+    std::string Metadata;
+    std::vector<ScriptIncludeDirective> Includes;
+    std::vector<size_t> Lines;
+};
+
+void ScanScriptSection(const ScriptSourceSection &section, ScannedScriptSection &scan) {
+    scan.Scanned = true;
+    if (ScriptLibraryRegistry::IsLibraryVirtualPath(section.Name) &&
+        ScriptSourceSnapshotBuilder::ContainsBmlMetadata(section.Code, &scan.Metadata)) {
+        scan.HasMetadata = true;
+        return;
+    }
+
+    scan.Includes = ScriptSourceSnapshotBuilder::ScanIncludeDirectives(section.Code);
+    scan.Lines.reserve(scan.Includes.size());
     size_t line = 1;
-    const size_t end = std::min(offset, code.size());
-    for (size_t i = 0; i < end; ++i) {
-        if (code[i] == '\n')
-            ++line;
+    size_t position = 0;
+    for (const ScriptIncludeDirective &include : scan.Includes) {
+        const size_t end = std::max(position, std::min(include.Offset, section.Code.size()));
+        line += static_cast<size_t>(std::count(section.Code.begin() + position, section.Code.begin() + end, '\n'));
+        position = end;
+        scan.Lines.push_back(line);
+    }
+}
+
+// Scans every pending section not scanned yet; one breadth-first frontier of
+// the include closure at a time.
+void ScanPendingSections(const ScriptSourceSnapshot &snapshot,
+                         const std::vector<size_t> &pending,
+                         size_t cursor,
+                         ScriptSourceWorkerPool &workers,
+                         std::vector<ScannedScriptSection> &scans) {
+    std::vector<size_t> frontier;
+    for (size_t i = cursor; i < pending.size(); ++i) {
+        if (pending[i] < scans.size() && !scans[pending[i]].Scanned)
+            frontier.push_back(pending[i]);
     }
-    return line;
+    std::sort(frontier.begin(), frontier.end());
+    frontier.erase(std::unique(frontier.begin(), frontier.end()), frontier.end());
+    workers.ForEach(frontier.size(), [&](size_t i) {
+        ScanScriptSection(snapshot.Sections[frontier[i]], scans[frontier[i]]);
+    });
 }
 
 void AddIncludeEdge(ScriptSourceSnapshot &snapshot,
@@ -351,9 +459,38 @@ bool ScriptLibrarySourceCache::CapturePackage(const ScriptLibraryRegistry &regis
                                               const std::string &version,
                                               ScriptDiagnostic &diagnostic) {
     const std::string packageKey = LibraryUseKey(id, version);
-    if (m_CapturedPackages.find(packageKey) != m_CapturedPackages.end())
-        return true;
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_CaptureDone.wait(lock, [&]() {
+            return m_CapturingPackages.find(packageKey) == m_CapturingPackages.end();
+        });
+        if (m_CapturedPackages.find(packageKey) != m_CapturedPackages.end())
+            return true;
+        m_CapturingPackages.insert(packageKey);
+    }
+
+    // Read outside the lock; builds waiting on this package resume once it is
+    // published, and retry the capture themselves if it failed
+    std::unordered_map<std::wstring, CapturedFile> files;
+    const bool captured = ReadPackageFiles(registry, id, version, files, diagnostic);
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_CapturingPackages.erase(packageKey);
+        if (captured) {
+            for (auto &file : files)
+                m_Files[file.first] = std::move(file.second);
+            m_CapturedPackages.insert(packageKey);
+        }
+    }
+    m_CaptureDone.notify_all();
+    return captured;
+}
 
+bool ScriptLibrarySourceCache::ReadPackageFiles(const ScriptLibraryRegistry &registry,
+                                                const std::string &id,
+                                                const std::string &version,
+                                                std::unordered_map<std::wstring, CapturedFile> &files,
+                                                ScriptDiagnostic &diagnostic) {
     ScriptLibraryPackage package;
     if (!registry.FindPackage(id, version, package)) {
         diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Entry,
@@ -405,14 +542,15 @@ bool ScriptLibrarySourceCache::CapturePackage(const ScriptLibraryRegistry &regis
             return false;
         }
 
-        std::string code;
-        if (!utils::ReadFileBytesUtf8(utils::Utf16ToUtf8(finalPath), code)) {
+        CapturedFile file;
+        file.Stamp = ScriptContentHashMemo::StampFile(finalPath);
+        if (!utils::ReadFileBytesUtf8(utils::Utf16ToUtf8(finalPath), file.Code)) {
             diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Entry,
                                               "Failed to read script library source while capturing batch source.");
             diagnostic.EntryPath = utils::Utf16ToUtf8(path);
             return false;
         }
-        m_Files[FoldPathKeyW(finalPath)] = std::move(code);
+        files[FoldPathKeyW(finalPath)] = std::move(file);
     }
 
     if (ec) {
@@ -421,24 +559,20 @@ bool ScriptLibrarySourceCache::CapturePackage(const ScriptLibraryRegistry &regis
         diagnostic.EntryPath = utils::Utf16ToUtf8(package.RootDirectory);
         return false;
     }
-    m_CapturedPackages.insert(packageKey);
     return true;
 }
 
 bool ScriptLibrarySourceCache::ReadFileUtf8(const std::wstring &physicalPath,
                                             const std::string &virtualSection,
                                             std::string &code,
-                                            ScriptDiagnostic &diagnostic) {
+                                            ScriptDiagnostic &diagnostic,
+                                            ScriptFileStamp *stamp) {
     code.clear();
-    const std::wstring normalized = utils::ResolvePathW(physicalPath);
-    auto cached = m_Files.find(FoldPathKeyW(normalized));
-    if (cached == m_Files.end()) {
-        std::wstring finalPath;
-        if (utils::TryGetFinalPathW(normalized, finalPath))
-            cached = m_Files.find(FoldPathKeyW(finalPath));
-    }
-    if (cached != m_Files.end()) {
-        code = cached->second;
+    CapturedFile file;
+    if (LookupFile(physicalPath, file)) {
+        code = std::move(file.Code);
+        if (stamp)
+            *stamp = file.Stamp;
         return true;
     }
 
@@ -451,17 +585,178 @@ bool ScriptLibrarySourceCache::ReadFileUtf8(const std::wstring &physicalPath,
 
 bool ScriptLibrarySourceCache::GetFileContentHash(const std::wstring &physicalPath, std::string &hash) const {
     hash.clear();
+    CapturedFile file;
+    if (!LookupFile(physicalPath, file))
+        return false;
+    hash = ScriptContentHashMemo::Get().GetHash(physicalPath, file.Stamp, file.Code);
+    return !hash.empty();
+}
+
+size_t ScriptLibrarySourceCache::GetFileCount() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Files.size();
+}
+
+// Copies the entry out: a package captured later may replace a shared file.
+bool ScriptLibrarySourceCache::LookupFile(const std::wstring &physicalPath, CapturedFile &file) const {
     const std::wstring normalized = utils::ResolvePathW(physicalPath);
-    auto cached = m_Files.find(FoldPathKeyW(normalized));
-    if (cached == m_Files.end()) {
-        std::wstring finalPath;
-        if (utils::TryGetFinalPathW(normalized, finalPath))
-            cached = m_Files.find(FoldPathKeyW(finalPath));
+    const std::wstring key = FoldPathKeyW(normalized);
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto cached = m_Files.find(key);
+        if (cached != m_Files.end()) {
+            file = cached->second;
+            return true;
+        }
     }
+
+    std::wstring finalPath;
+    if (!utils::TryGetFinalPathW(normalized, finalPath))
+        return false;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto cached = m_Files.find(FoldPathKeyW(finalPath));
     if (cached == m_Files.end())
         return false;
-    hash = utils::Sha256Hex(cached->second);
-    return !hash.empty();
+    file = cached->second;
+    return true;
+}
+
+std::string ComputeScriptContentHash(const std::string &content) {
+    return utils::ContentHash128Hex(content);
+}
+
+ScriptContentHashMemo &ScriptContentHashMemo::Get() {
+    static ScriptContentHashMemo memo;
+    return memo;
+}
+
+ScriptFileStamp ScriptContentHashMemo::StampFile(const std::wstring &path) {
+    ScriptFileStamp stamp;
+    std::error_code ec;
+    const std::filesystem::path file(path);
+    const uintmax_t size = std::filesystem::file_size(file, ec);
+    if (ec)
+        return stamp;
+    const auto writeTime = std::filesystem::last_write_time(file, ec);
+    if (ec)
+        return stamp;
+    stamp.Size = static_cast<uint64_t>(size);
+    stamp.WriteTime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+    stamp.Valid = true;
+    return stamp;
+}
+
+std::string ScriptContentHashMemo::GetHash(const std::wstring &path,
+                                           const ScriptFileStamp &stamp,
+                                           const std::string &content) {
+    // A stamp that does not describe this content cannot be trusted later
+    if (!stamp.Valid || stamp.Size != content.size())
+        return ComputeScriptContentHash(content);
+
+    const std::wstring key = FoldPathKeyW(path);
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto it = m_Entries.find(key);
+        if (it != m_Entries.end() && it->second.Stamp.Size == stamp.Size &&
+            it->second.Stamp.WriteTime == stamp.WriteTime) {
+            return it->second.Hash;
+        }
+    }
+
+    std::string hash = ComputeScriptContentHash(content);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries[key] = {stamp, hash};
+    return hash;
+}
+
+void ScriptContentHashMemo::Clear() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries.clear();
+}
+
+size_t ScriptContentHashMemo::GetSize() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Entries.size();
+}
+
+struct ScriptSourceWorkerPool::Job {
+    Job(size_t count, const std::function<void(size_t)> &fn) : Count(count), Fn(fn) {}
+
+    const size_t Count;
+    const std::function<void(size_t)> &Fn;
+    std::atomic<size_t> Next{0};
+    size_t Done = 0;
+};
+
+ScriptSourceWorkerPool::ScriptSourceWorkerPool(size_t workers) {
+    for (size_t i = 1; i < workers; ++i) {
+        try {
+            m_Threads.emplace_back([this] { RunWorker(); });
+        } catch (const std::system_error &) {
+            break;
+        }
+    }
+}
+
+ScriptSourceWorkerPool::~ScriptSourceWorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_Wake.notify_all();
+    for (std::thread &thread : m_Threads)
+        thread.join();
+}
+
+void ScriptSourceWorkerPool::ForEach(size_t count, const std::function<void(size_t)> &fn) {
+    if (m_Threads.empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+
+    const auto job = std::make_shared<Job>(count, fn);
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Jobs.push_back(job);
+    }
+    m_Wake.notify_all();
+    RunJob(*job);
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Finished.wait(lock, [&] { return job->Done == job->Count; });
+}
+
+void ScriptSourceWorkerPool::RunJob(Job &job) {
+    size_t ran = 0;
+    for (size_t i = job.Next++; i < job.Count; i = job.Next++) {
+        job.Fn(i);
+        ++ran;
+    }
+
+    // Every index is claimed, so nobody else needs to find the job
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    const auto it = std::find_if(m_Jobs.begin(), m_Jobs.end(), [&](const std::shared_ptr<Job> &queued) {
+        return queued.get() == &job;
+    });
+    if (it != m_Jobs.end())
+        m_Jobs.erase(it);
+    job.Done += ran;
+    if (job.Done == job.Count)
+        m_Finished.notify_all();
+}
+
+void ScriptSourceWorkerPool::RunWorker() {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true) {
+        m_Wake.wait(lock, [&] { return m_Stopping || !m_Jobs.empty(); });
+        if (m_Stopping)
+            return;
+        const std::shared_ptr<Job> job = m_Jobs.front();
+        lock.unlock();
+        RunJob(*job);
+        lock.lock();
+    }
 }
 
 void ScriptSourceSnapshotBuilder::SetLibraryRegistry(ScriptLibraryRegistry registry) {
@@ -472,6 +767,16 @@ void ScriptSourceSnapshotBuilder::SetLibrarySourceCache(ScriptLibrarySourceCache
     m_LibrarySourceCache = cache;
 }
 
+void ScriptSourceSnapshotBuilder::SetParallelism(size_t workers) {
+    m_Parallelism = workers;
+}
+
+size_t ScriptSourceSnapshotBuilder::GetDefaultParallelism() {
+    // Past a handful of threads the reads queue on the same disk anyway
+    const size_t hardware = std::thread::hardware_concurrency();
+    return std::clamp<size_t>(hardware, 1, 8);
+}
+
 std::vector<ScriptIncludeDirective> ScriptSourceSnapshotBuilder::ScanIncludeDirectives(const std::string &code) {
     std::vector<ScriptIncludeDirective> directives;
     enum class State {
@@ -601,12 +906,33 @@ bool ScriptSourceSnapshotBuilder::ContainsBmlMetadata(const std::string &code, s
 bool ScriptSourceSnapshotBuilder::Build(const ScriptModEntry &entry,
                                         ScriptSourceSnapshot &snapshot,
                                         ScriptDiagnostic &diagnostic) const {
+    ScriptSourceWorkerPool workers(m_Parallelism);
+    return Build(entry, workers, snapshot, diagnostic);
+}
+
+std::vector<ScriptSourceSnapshotBuildResult> ScriptSourceSnapshotBuilder::BuildAll(
+    const std::vector<ScriptModEntry> &entries) const {
+    std::vector<ScriptSourceSnapshotBuildResult> results(entries.size());
+    // Whole builds are spread over the pool; a build's own files go to
+    // whichever workers are idle
+    ScriptSourceWorkerPool workers(m_Parallelism);
+    workers.ForEach(entries.size(), [&](size_t i) {
+        ScriptSourceSnapshotBuildResult &result = results[i];
+        result.Succeeded = Build(entries[i], workers, result.Snapshot, result.Diagnostic);
+    });
+    return results;
+}
+
+bool ScriptSourceSnapshotBuilder::Build(const ScriptModEntry &entry,
+                                        ScriptSourceWorkerPool &workers,
+                                        ScriptSourceSnapshot &snapshot,
+                                        ScriptDiagnostic &diagnostic) const {
     snapshot = ScriptSourceSnapshot();
     snapshot.CompileEntry = entry;
     std::unordered_map<std::string, size_t> sectionIndex;
-    if (!AddLocalSources(entry, snapshot, sectionIndex, diagnostic))
+    if (!AddLocalSources(entry, workers, snapshot, sectionIndex, diagnostic))
         return false;
-    return ResolveLibraryClosure(snapshot, sectionIndex, diagnostic);
+    return ResolveLibraryClosure(workers, snapshot, sectionIndex, diagnostic);
 }
 
 bool ScriptSourceSnapshotBuilder::BuildLibraryIncludeSnapshot(const ScriptLibraryInclude &include,
@@ -622,10 +948,12 @@ bool ScriptSourceSnapshotBuilder::BuildLibraryIncludeSnapshot(const ScriptLibrar
 
     std::unordered_map<std::string, size_t> sectionIndex;
     sectionIndex.emplace(FoldSectionKey(snapshot.EntrySectionName), 0);
-    return ResolveLibraryClosure(snapshot, sectionIndex, diagnostic);
+    ScriptSourceWorkerPool workers(m_Parallelism);
+    return ResolveLibraryClosure(workers, snapshot, sectionIndex, diagnostic);
 }
 
 bool ScriptSourceSnapshotBuilder::AddLocalSources(const ScriptModEntry &entry,
+                                                  ScriptSourceWorkerPool &workers,
                                                   ScriptSourceSnapshot &snapshot,
                                                   std::unordered_map<std::string, size_t> &sectionIndex,
                                                   ScriptDiagnostic &diagnostic) const {
@@ -650,6 +978,7 @@ bool ScriptSourceSnapshotBuilder::AddLocalSources(const ScriptModEntry &entry,
                                         entry.ResourceRootDirectory,
                                         entry.EntryPath,
                                         false,
+                                        workers,
                                         seen,
                                         snapshot,
                                         sectionIndex,
@@ -660,19 +989,22 @@ bool ScriptSourceSnapshotBuilder::AddLocalSources(const ScriptModEntry &entry,
                                     sectionRoot,
                                     entry.EntryPath,
                                     true,
+                                    workers,
                                     seen,
                                     snapshot,
                                     sectionIndex,
                                     diagnostic);
 }
 
-bool ScriptSourceSnapshotBuilder::ResolveLibraryClosure(ScriptSourceSnapshot &snapshot,
+bool ScriptSourceSnapshotBuilder::ResolveLibraryClosure(ScriptSourceWorkerPool &workers,
+                                                        ScriptSourceSnapshot &snapshot,
                                                         std::unordered_map<std::string, size_t> &sectionIndex,
                                                         ScriptDiagnostic &diagnostic) const {
     std::vector<size_t> pending;
     if (!snapshot.Sections.empty())
         pending.push_back(0);
     std::unordered_set<size_t> processed;
+    std::vector<ScannedScriptSection> scans;
 
     for (size_t cursor = 0; cursor < pending.size(); ++cursor) {
         const size_t sectionIndexValue = pending[cursor];
@@ -680,22 +1012,30 @@ bool ScriptSourceSnapshotBuilder::ResolveLibraryClosure(ScriptSourceSnapshot &sn
             continue;
         if (!processed.insert(sectionIndexValue).second)
             continue;
-        const ScriptSourceSection &section = snapshot.Sections[sectionIndexValue];
-        const std::string sectionName = section.Name;
+        if (scans.size() < snapshot.Sections.size())
+            scans.resize(snapshot.Sections.size());
+        if (!scans[sectionIndexValue].Scanned) {
+            if (workers.GetWorkerCount() > 1)
+                ScanPendingSections(snapshot, pending, cursor, workers, scans);
+            else
+                ScanScriptSection(snapshot.Sections[sectionIndexValue], scans[sectionIndexValue]);
+        }
+
+        // Adding library sections below grows the snapshot, so nothing may
+        // keep a reference into it across the loop
+        const std::string sectionName = snapshot.Sections[sectionIndexValue].Name;
         const bool libraryOwned = ScriptLibraryRegistry::IsLibraryVirtualPath(sectionName);
-        if (libraryOwned) {
-            std::string metadata;
-            if (ContainsBmlMetadata(section.Code, &metadata)) {
-                diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Metadata,
-                                                  "BML metadata is not allowed in script library source: " + metadata);
-                diagnostic.EntryPath = sectionName;
-                return false;
-            }
+        const ScannedScriptSection scan = std::move(scans[sectionIndexValue]);
+        if (scan.HasMetadata) {
+            diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Metadata,
+                                              "BML metadata is not allowed in script library source: " + scan.Metadata);
+            diagnostic.EntryPath = sectionName;
+            return false;
         }
 
-        const std::vector<ScriptIncludeDirective> includes = ScanIncludeDirectives(section.Code);
-        for (const ScriptIncludeDirective &include : includes) {
-            const size_t includeLine = LineNumberFromOffset(section.Code, include.Offset);
+        for (size_t includeIndex = 0; includeIndex < scan.Includes.size(); ++includeIndex) {
+            const ScriptIncludeDirective &include = scan.Includes[includeIndex];
+            const size_t includeLine = scan.Lines[includeIndex];
             if (!include.Quoted) {
                 diagnostic = MakeScriptDiagnostic(
                     ScriptDiagnosticPhase::Entry,
@@ -812,12 +1152,14 @@ bool ScriptSourceSnapshotBuilder::AddLibrarySection(const ScriptLibraryInclude &
         return false;
     }
     std::string code;
+    ScriptFileStamp stamp;
     if (m_LibrarySourceCache) {
         if (!m_LibrarySourceCache->CapturePackage(m_LibraryRegistry, include.Id, include.Version, diagnostic))
             return false;
-        if (!m_LibrarySourceCache->ReadFileUtf8(physicalPath, include.VirtualSection, code, diagnostic))
+        if (!m_LibrarySourceCache->ReadFileUtf8(physicalPath, include.VirtualSection, code, diagnostic, &stamp))
             return false;
     } else {
+        stamp = ScriptContentHashMemo::StampFile(physicalPath);
         if (!utils::ReadFileBytesUtf8(utils::Utf16ToUtf8(physicalPath), code)) {
             diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Entry,
                                               "Failed to read script library source: " + include.VirtualSection + ".");
@@ -844,7 +1186,7 @@ bool ScriptSourceSnapshotBuilder::AddLibrarySection(const ScriptLibraryInclude &
     ScriptSourceDependency dependency;
     dependency.PhysicalPath = physicalPath;
     dependency.VirtualSection = include.VirtualSection;
-    dependency.ContentHash = utils::Sha256Hex(section.Code);
+    dependency.ContentHash = ScriptContentHashMemo::Get().GetHash(physicalPath, stamp, section.Code);
     dependency.LibraryOwned = true;
     dependency.LibraryId = include.Id;
     dependency.LibraryVersion = include.Version;
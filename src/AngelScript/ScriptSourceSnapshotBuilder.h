@@ -1,7 +1,14 @@
 #ifndef BML_SCRIPTSOURCESNAPSHOTBUILDER_H
 #define BML_SCRIPTSOURCESNAPSHOTBUILDER_H
 
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -18,6 +25,43 @@ struct ScriptIncludeDirective {
     size_t Offset = 0;
 };
 
+// A script file's size and last write time when it was read.
+struct ScriptFileStamp {
+    uint64_t Size = 0;
+    int64_t WriteTime = 0;
+    bool Valid = false;
+};
+
+// Change-detection hash of script source. Not SHA-256: nothing here is
+// verified against a published hash, it only tells whether a file changed.
+std::string ComputeScriptContentHash(const std::string &content);
+
+// Content hashes of script files keyed by path, size and last write time,
+// shared by every snapshot build so a file that did not change is not hashed
+// again. Stamp a file before reading it, so a write racing the read changes
+// the stamp instead of pairing the new stamp with the old content.
+class ScriptContentHashMemo {
+public:
+    static ScriptContentHashMemo &Get();
+    static ScriptFileStamp StampFile(const std::wstring &path);
+
+    std::string GetHash(const std::wstring &path, const ScriptFileStamp &stamp, const std::string &content);
+    void Clear();
+    size_t GetSize() const;
+
+private:
+    struct Entry {
+        ScriptFileStamp Stamp;
+        std::string Hash;
+    };
+
+    mutable std::mutex m_Mutex;
+    std::unordered_map<std::wstring, Entry> m_Entries;
+};
+
+// Library sources captured once per batch. Safe to share between snapshot
+// builds running on different threads: a package being captured by one build
+// is waited for by the others instead of being read twice.
 class ScriptLibrarySourceCache {
 public:
     bool CapturePackage(const ScriptLibraryRegistry &registry,
@@ -27,13 +71,66 @@ public:
     bool ReadFileUtf8(const std::wstring &physicalPath,
                       const std::string &virtualSection,
                       std::string &code,
-                      ScriptDiagnostic &diagnostic);
+                      ScriptDiagnostic &diagnostic,
+                      ScriptFileStamp *stamp = nullptr);
     bool GetFileContentHash(const std::wstring &physicalPath, std::string &hash) const;
-    size_t GetFileCount() const { return m_Files.size(); }
+    size_t GetFileCount() const;
 
 private:
-    std::unordered_map<std::wstring, std::string> m_Files;
+    struct CapturedFile {
+        std::string Code;
+        ScriptFileStamp Stamp;
+    };
+
+    static bool ReadPackageFiles(const ScriptLibraryRegistry &registry,
+                                 const std::string &id,
+                                 const std::string &version,
+                                 std::unordered_map<std::wstring, CapturedFile> &files,
+                                 ScriptDiagnostic &diagnostic);
+    bool LookupFile(const std::wstring &physicalPath, CapturedFile &file) const;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_CaptureDone;
+    std::unordered_map<std::wstring, CapturedFile> m_Files;
     std::unordered_set<std::string> m_CapturedPackages;
+    std::unordered_set<std::string> m_CapturingPackages;
+};
+
+// Threads shared by every loop of one build or batch of builds, so reading a
+// directory or scanning an include frontier does not start threads of its
+// own. ForEach hands indices to idle workers and to the calling thread alike,
+// which lets a loop started from inside another loop's callback finish.
+class ScriptSourceWorkerPool {
+public:
+    // workers counts the calling thread; 0 or 1 starts no threads.
+    explicit ScriptSourceWorkerPool(size_t workers);
+    ~ScriptSourceWorkerPool();
+
+    ScriptSourceWorkerPool(const ScriptSourceWorkerPool &) = delete;
+    ScriptSourceWorkerPool &operator=(const ScriptSourceWorkerPool &) = delete;
+
+    size_t GetWorkerCount() const { return m_Threads.size() + 1; }
+    // Runs fn(i) for every i in [0, count) and returns once all have finished.
+    void ForEach(size_t count, const std::function<void(size_t)> &fn);
+
+private:
+    struct Job;
+
+    void RunWorker();
+    void RunJob(Job &job);
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::condition_variable m_Finished;
+    std::deque<std::shared_ptr<Job>> m_Jobs;
+    std::vector<std::thread> m_Threads;
+    bool m_Stopping = false;
+};
+
+struct ScriptSourceSnapshotBuildResult {
+    ScriptSourceSnapshot Snapshot;
+    ScriptDiagnostic Diagnostic;
+    bool Succeeded = false;
 };
 
 class ScriptSourceSnapshotBuilder {
@@ -43,22 +140,40 @@ public:
 
     void SetLibraryRegistry(ScriptLibraryRegistry registry);
     void SetLibrarySourceCache(ScriptLibrarySourceCache *cache);
+
+    // Worker threads used to read, hash and scan source files; one pool of
+    // them serves a whole Build or BuildAll call. 0 or 1 builds on the calling
+    // thread. Snapshots, section order and the reported error are the same
+    // for every setting.
+    void SetParallelism(size_t workers);
+    size_t GetParallelism() const { return m_Parallelism; }
+    static size_t GetDefaultParallelism();
+
     bool Build(const ScriptModEntry &entry,
                ScriptSourceSnapshot &snapshot,
                ScriptDiagnostic &diagnostic) const;
     bool BuildLibraryIncludeSnapshot(const ScriptLibraryInclude &include,
                                      ScriptSourceSnapshot &snapshot,
                                      ScriptDiagnostic &diagnostic) const;
+    // Builds every entry, spreading whole builds over the workers; results are
+    // in entry order. Set a library source cache to read shared packages once.
+    std::vector<ScriptSourceSnapshotBuildResult> BuildAll(const std::vector<ScriptModEntry> &entries) const;
 
     static std::vector<ScriptIncludeDirective> ScanIncludeDirectives(const std::string &code);
     static bool ContainsBmlMetadata(const std::string &code, std::string *metadata = nullptr);
 
 private:
+    bool Build(const ScriptModEntry &entry,
+               ScriptSourceWorkerPool &workers,
+               ScriptSourceSnapshot &snapshot,
+               ScriptDiagnostic &diagnostic) const;
     bool AddLocalSources(const ScriptModEntry &entry,
+                         ScriptSourceWorkerPool &workers,
                          ScriptSourceSnapshot &snapshot,
                          std::unordered_map<std::string, size_t> &sectionIndex,
                          ScriptDiagnostic &diagnostic) const;
-    bool ResolveLibraryClosure(ScriptSourceSnapshot &snapshot,
+    bool ResolveLibraryClosure(ScriptSourceWorkerPool &workers,
+                               ScriptSourceSnapshot &snapshot,
                                std::unordered_map<std::string, size_t> &sectionIndex,
                                ScriptDiagnostic &diagnostic) const;
     bool AddLibrarySection(const ScriptLibraryInclude &include,
@@ -69,6 +184,7 @@ private:
 
     ScriptLibraryRegistry m_LibraryRegistry;
     ScriptLibrarySourceCache *m_LibrarySourceCache = nullptr;
+    size_t m_Parallelism = 0;
 };
 
 } // namespace BML
@@ -10,6 +10,7 @@
 #include "BML/ILogger.h"
 #include "ModContext.h"
 #include "ScriptAngelScriptHandle.h"
+#include "ScriptContextPool.h"
 #include "ScriptFunctionSupport.h"
 #include "ScriptMod.h"
 #include "ScriptModContextView.h"
@@ -120,7 +121,8 @@ static bool ExecuteObjectMethod(asIScriptObject *object,
         return false;
     }
 
-    asIScriptContext *context = object->GetEngine()->CreateContext();
+    ScriptPooledContext pooledContext(object->GetEngine());
+    asIScriptContext *context = pooledContext.Get();
     if (!context) {
         diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Callback, "Unable to create AngelScript context for timer callback.");
         return false;
@@ -137,21 +139,18 @@ static bool ExecuteObjectMethod(asIScriptObject *object,
 
     if (code < 0) {
         diagnostic = MakeAngelScriptDiagnostic(ScriptDiagnosticPhase::Callback, code, context, failurePrefix);
-        context->Release();
         return false;
     }
 
-    code = context->Execute();
+    code = pooledContext.Execute();
     if (code == asEXECUTION_SUSPENDED)
         context->Abort();
     if (code != asEXECUTION_FINISHED) {
         diagnostic = MakeAngelScriptDiagnostic(ScriptDiagnosticPhase::Callback, code, context, failurePrefix);
-        context->Release();
         return false;
     }
 
     result = context->GetReturnByte() != 0;
-    context->Release();
     return true;
 }
 
@@ -175,7 +174,8 @@ static bool ReadStringProperty(asIScriptObject *object,
         return false;
     }
 
-    asIScriptContext *context = object->GetEngine()->CreateContext();
+    ScriptPooledContext pooledContext(object->GetEngine());
+    asIScriptContext *context = pooledContext.Get();
     if (!context) {
         diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Runtime, "Unable to create AngelScript context for timer property.");
         return false;
@@ -186,23 +186,20 @@ static bool ReadStringProperty(asIScriptObject *object,
     if (code >= 0)
         code = context->SetObject(object);
     if (code >= 0)
-        code = context->Execute();
+        code = pooledContext.Execute();
 
     if (code == asEXECUTION_SUSPENDED)
         context->Abort();
     if (code != asEXECUTION_FINISHED) {
         diagnostic = MakeAngelScriptDiagnostic(ScriptDiagnosticPhase::Runtime, code, context, "Timer property read failed");
-        context->Release();
         return false;
     }
 
     if (!ScriptStringInterop::ReadContextReturnString(context, value)) {
         diagnostic.Status = CKAS_TYPEMISMATCH;
         diagnostic.Message = std::string("Timer property returned an incompatible string for ") + declaration;
-        context->Release();
         return false;
     }
-    context->Release();
     return true;
 }
 
@@ -227,7 +224,8 @@ static bool ReadBoolProperty(asIScriptObject *object,
         return false;
     }
 
-    asIScriptContext *context = object->GetEngine()->CreateContext();
+    ScriptPooledContext pooledContext(object->GetEngine());
+    asIScriptContext *context = pooledContext.Get();
     if (!context) {
         diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Runtime, "Unable to create AngelScript context for timer property.");
         return false;
@@ -238,18 +236,16 @@ static bool ReadBoolProperty(asIScriptObject *object,
     if (code >= 0)
         code = context->SetObject(object);
     if (code >= 0)
-        code = context->Execute();
+        code = pooledContext.Execute();
 
     if (code == asEXECUTION_SUSPENDED)
         context->Abort();
     if (code != asEXECUTION_FINISHED) {
         diagnostic = MakeAngelScriptDiagnostic(ScriptDiagnosticPhase::Runtime, code, context, "Timer property read failed");
-        context->Release();
         return false;
     }
 
     value = context->GetReturnByte() != 0;
-    context->Release();
     return true;
 }
 
@@ -274,7 +270,8 @@ static bool ReadIntProperty(asIScriptObject *object,
         return false;
     }
 
-    asIScriptContext *context = object->GetEngine()->CreateContext();
+    ScriptPooledContext pooledContext(object->GetEngine());
+    asIScriptContext *context = pooledContext.Get();
     if (!context) {
         diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Runtime, "Unable to create AngelScript context for timer property.");
         return false;
@@ -285,18 +282,16 @@ static bool ReadIntProperty(asIScriptObject *object,
     if (code >= 0)
         code = context->SetObject(object);
     if (code >= 0)
-        code = context->Execute();
+        code = pooledContext.Execute();
 
     if (code == asEXECUTION_SUSPENDED)
         context->Abort();
     if (code != asEXECUTION_FINISHED) {
         diagnostic = MakeAngelScriptDiagnostic(ScriptDiagnosticPhase::Runtime, code, context, "Timer property read failed");
-        context->Release();
         return false;
     }
 
     value = context->GetReturnDWord();
-    context->Release();
     return true;
 }
 
@@ -322,7 +317,8 @@ static bool ReadUIntProperty(asIScriptObject *object,
         return false;
     }
 
-    asIScriptContext *context = object->GetEngine()->CreateContext();
+    ScriptPooledContext pooledContext(object->GetEngine());
+    asIScriptContext *context = pooledContext.Get();
     if (!context) {
         diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Runtime, "Unable to create AngelScript context for timer property.");
         return false;
@@ -333,19 +329,17 @@ static bool ReadUIntProperty(asIScriptObject *object,
     if (code >= 0)
         code = context->SetObject(object);
     if (code >= 0)
-        code = context->Execute();
+        code = pooledContext.Execute();
 
     if (code == asEXECUTION_SUSPENDED)
         context->Abort();
     if (code != asEXECUTION_FINISHED) {
         diagnostic = MakeAngelScriptDiagnostic(ScriptDiagnosticPhase::Runtime, code, context, "Timer property read failed");
-        context->Release();
         return false;
     }
 
     value = context->GetReturnDWord();
     present = true;
-    context->Release();
     return true;
 }
 
@@ -371,7 +365,8 @@ static bool ReadFloatProperty(asIScriptObject *object,
         return false;
     }
 
-    asIScriptContext *context = object->GetEngine()->CreateContext();
+    ScriptPooledContext pooledContext(object->GetEngine());
+    asIScriptContext *context = pooledContext.Get();
     if (!context) {
         diagnostic = MakeScriptDiagnostic(ScriptDiagnosticPhase::Runtime, "Unable to create AngelScript context for timer property.");
         return false;
@@ -382,19 +377,17 @@ static bool ReadFloatProperty(asIScriptObject *object,
     if (code >= 0)
         code = context->SetObject(object);
     if (code >= 0)
-        code = context->Execute();
+        code = pooledContext.Execute();
 
     if (code == asEXECUTION_SUSPENDED)
         context->Abort();
     if (code != asEXECUTION_FINISHED) {
         diagnostic = MakeAngelScriptDiagnostic(ScriptDiagnosticPhase::Runtime, code, context, "Timer property read failed");
-        context->Release();
         return false;
     }
 
     value = context->GetReturnFloat();
     present = true;
-    context->Release();
     return true;
 }
 
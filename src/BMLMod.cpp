@@ -172,6 +172,7 @@ void BMLMod::OnUnload() {
     UnregisterBuiltinCapabilities(*this);
 
     m_CommandBar.SaveHistory();
+    m_MapMenu.Shutdown();
 
     Bui::CleanupResources(m_CKContext);
 
@@ -326,6 +327,8 @@ void BMLMod::OnModifyConfig(const char *category, const char *key, IProperty *pr
         m_MessageBoard.SetFadeMaxAlpha(std::clamp(m_MsgFadeMaxAlpha->GetFloat(), 0.0f, 1.0f));
     } else if (prop == m_CustomMapTooltip) {
         m_MapMenu.SetShowTooltip(m_CustomMapTooltip->GetBoolean());
+    } else if (prop == m_CustomMapRegexSearch) {
+        m_MapMenu.SetRegexSearch(m_CustomMapRegexSearch->GetBoolean());
     }
 }
 
@@ -631,6 +634,11 @@ void BMLMod::InitConfigs() {
     m_CustomMapMaxDepth->SetComment("The max depth of the nested subdirectories.");
     m_CustomMapMaxDepth->SetDefaultInteger(8);
     m_MapMenu.SetMaxDepth(m_CustomMapMaxDepth->GetInteger());
+
+    m_CustomMapRegexSearch = GetConfig()->GetProperty("CustomMap", "RegexSearch");
+    m_CustomMapRegexSearch->SetComment("Treat the map search text as a regular expression instead of plain text");
+    m_CustomMapRegexSearch->SetDefaultBoolean(false);
+    m_MapMenu.SetRegexSearch(m_CustomMapRegexSearch->GetBoolean());
 }
 
 void BMLMod::InitGUI() {
@@ -670,7 +678,7 @@ void BMLMod::InitGUI() {
 }
 
 void BMLMod::RegisterCommands() {
-    m_BML->RegisterCommand(new CommandBML());
+    m_BML->RegisterCommand(new CommandBML(this));
     m_BML->RegisterCommand(new CommandHelp());
     m_BML->RegisterCommand(new CommandCheat());
     m_BML->RegisterCommand(new CommandEcho());
@@ -896,6 +904,8 @@ void BMLMod::OnProcess_HUD() {
     // Process and render HUD
     m_HUD.OnProcess();
     m_HUD.Render();
+
+    m_ProfilerOverlay.Render();
 }
 
 void BMLMod::OnProcess_CommandBar() {
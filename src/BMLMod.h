@@ -12,6 +12,7 @@
 #include "MapMenu.h"
 #include "CommandBar.h"
 #include "MessageBoard.h"
+#include "ProfilerOverlay.h"
 
 class EventHookRegistrar;
 class ModContext;
@@ -87,6 +88,8 @@ public:
 
     MessageBoard &GetMessageBoard() { return m_MessageBoard; }
 
+    ProfilerOverlay &GetProfilerOverlay() { return m_ProfilerOverlay; }
+
     // Built-in HUD element controls
     void ShowTitle(bool show);
     void ShowFPS(bool show);
@@ -142,6 +145,7 @@ private:
     MapMenu m_MapMenu;
     CommandBar m_CommandBar;
     MessageBoard m_MessageBoard;
+    ProfilerOverlay m_ProfilerOverlay;
 
     // HUD builtin components
     FpsCounter m_FPSCounter;
@@ -192,6 +196,7 @@ private:
     IProperty *m_CustomMapNumber = nullptr;
     IProperty *m_CustomMapTooltip = nullptr;
     IProperty *m_CustomMapMaxDepth = nullptr;
+    IProperty *m_CustomMapRegexSearch = nullptr;
 
     CK2dEntity *m_Level01 = nullptr;
     CKBehavior *m_ExitStart = nullptr;
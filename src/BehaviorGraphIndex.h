@@ -0,0 +1,181 @@
+#ifndef BML_BEHAVIORGRAPHINDEX_H
+#define BML_BEHAVIORGRAPHINDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Name and link lookups over one behavior graph, built once and shared by
+ * every ScriptHelper query on it.
+ *
+ * Graph adapts the graph types: it names Behavior and Link and provides
+ * static SubBehaviorCount, SubBehavior, Name, LinkCount, GetLink, LinkIn,
+ * LinkOut and Owner, mirroring the CK calls of the same meaning. Tests plug
+ * in a mock graph.
+ *
+ * Behaviors are numbered in post-order, which is the order FindBB visits
+ * them when walking hierarchically, so the blocks below any indexed graph
+ * are one contiguous range. Each name maps to its sorted positions. Links
+ * are grouped per graph by the behavior they leave and the one they enter,
+ * and are grouped lazily the first time a graph's links are asked for.
+ *
+ * The index only answers for the graphs it has seen while every graph it
+ * would search still has the sub-behavior count it recorded, and groups
+ * links again when a graph's link count moves; anything else is left to the
+ * caller's walk. Edits that keep those counts, such as rewiring a link, have
+ * to be reported through InvalidateLinks or Invalidate.
+ */
+template <typename Graph>
+class BehaviorGraphIndex {
+public:
+    using Behavior = typename Graph::Behavior;
+    using Link = typename Graph::Link;
+
+    void Build(Behavior *root) {
+        Clear();
+        m_Root = root;
+        if (root)
+            Visit(root, kNoParent);
+    }
+
+    void Clear() {
+        m_Root = nullptr;
+        m_Stale = false;
+        m_Nodes.clear();
+        m_Order.clear();
+        m_Ids.clear();
+        m_Names.clear();
+        m_Links.clear();
+    }
+
+    Behavior *Root() const { return m_Root; }
+    bool Stale() const { return m_Stale; }
+    bool Covers(Behavior *script) const { return m_Ids.find(script) != m_Ids.end(); }
+    size_t Size() const { return m_Nodes.size(); }
+
+    // Forces a rebuild before the next lookup.
+    void Invalidate() { m_Stale = true; }
+
+    // Regroups the links of script on their next lookup.
+    void InvalidateLinks(Behavior *script) {
+        auto it = m_Links.find(script);
+        if (it != m_Links.end())
+            it->second.Dirty = true;
+    }
+
+    // Behaviors below script named name, in the order FindBB visits them.
+    // Returns false when the index cannot answer for script.
+    bool FindByName(Behavior *script, const char *name, bool hierarchically, std::vector<Behavior *> &out) const {
+        out.clear();
+        if (m_Stale || !name)
+            return false;
+        auto id = m_Ids.find(script);
+        if (id == m_Ids.end())
+            return false;
+        const Node &node = m_Nodes[id->second];
+        if (!Current(id->second, hierarchically))
+            return false;
+
+        auto names = m_Names.find(name);
+        if (names == m_Names.end())
+            return true;
+        const std::vector<uint32_t> &positions = names->second;
+        auto first = std::lower_bound(positions.begin(), positions.end(), node.SubtreeStart);
+        auto last = std::lower_bound(first, positions.end(), node.Post);
+        for (; first != last; ++first) {
+            const Node &match = m_Nodes[m_Order[*first]];
+            if (hierarchically || match.Parent == id->second)
+                out.push_back(match.Beh);
+        }
+        return true;
+    }
+
+    // Links of script leaving beh (outgoing) or entering it, in the order
+    // script holds them, or nullptr when the index cannot answer for script.
+    const std::vector<Link *> *FindLinks(Behavior *script, Behavior *beh, bool outgoing) {
+        if (m_Stale || !Covers(script))
+            return nullptr;
+        LinkTable &table = m_Links[script];
+        const int count = Graph::LinkCount(script);
+        if (table.Dirty || table.LinkCount != count)
+            GroupLinks(script, count, table);
+
+        const auto &groups = outgoing ? table.Outgoing : table.Incoming;
+        auto it = groups.find(beh);
+        return it != groups.end() ? &it->second : &m_NoLinks;
+    }
+
+private:
+    static constexpr uint32_t kNoParent = UINT32_MAX;
+
+    struct Node {
+        Behavior *Beh = nullptr;
+        uint32_t Parent = kNoParent;
+        uint32_t SubtreeStart = 0; // Post-order position of the first descendant
+        uint32_t Post = 0;
+        int ChildCount = 0;
+    };
+
+    struct LinkTable {
+        int LinkCount = 0;
+        bool Dirty = true;
+        std::unordered_map<Behavior *, std::vector<Link *>> Outgoing;
+        std::unordered_map<Behavior *, std::vector<Link *>> Incoming;
+    };
+
+    void Visit(Behavior *beh, uint32_t parent) {
+        const auto id = static_cast<uint32_t>(m_Nodes.size());
+        m_Nodes.push_back({beh, parent, static_cast<uint32_t>(m_Order.size()), 0, Graph::SubBehaviorCount(beh)});
+        m_Ids.emplace(beh, id);
+
+        for (int i = 0; i < m_Nodes[id].ChildCount; ++i)
+            Visit(Graph::SubBehavior(beh, i), id);
+
+        const auto post = static_cast<uint32_t>(m_Order.size());
+        m_Nodes[id].Post = post;
+        m_Order.push_back(id);
+        // FindBB never reports the graph it was asked about.
+        const char *name = Graph::Name(beh);
+        if (parent != kNoParent && name)
+            m_Names[name].push_back(post);
+    }
+
+    // Whether script, and with hierarchically every graph below it, still has
+    // the children it had when indexed. Node ids are handed out in pre-order,
+    // so the subtree of id is the ids after it, one per post-order position.
+    bool Current(uint32_t id, bool hierarchically) const {
+        const Node &node = m_Nodes[id];
+        const uint32_t end = hierarchically ? id + (node.Post - node.SubtreeStart) + 1 : id + 1;
+        for (uint32_t i = id; i < end; ++i) {
+            if (Graph::SubBehaviorCount(m_Nodes[i].Beh) != m_Nodes[i].ChildCount)
+                return false;
+        }
+        return true;
+    }
+
+    static void GroupLinks(Behavior *script, int count, LinkTable &table) {
+        table.Outgoing.clear();
+        table.Incoming.clear();
+        for (int i = 0; i < count; ++i) {
+            Link *link = Graph::GetLink(script, i);
+            table.Outgoing[Graph::Owner(Graph::LinkIn(link))].push_back(link);
+            table.Incoming[Graph::Owner(Graph::LinkOut(link))].push_back(link);
+        }
+        table.LinkCount = count;
+        table.Dirty = false;
+    }
+
+    Behavior *m_Root = nullptr;
+    bool m_Stale = false;
+    std::vector<Node> m_Nodes;
+    std::vector<uint32_t> m_Order; // Post-order position -> node id
+    std::unordered_map<Behavior *, uint32_t> m_Ids;
+    std::unordered_map<std::string, std::vector<uint32_t>> m_Names;
+    std::unordered_map<Behavior *, LinkTable> m_Links;
+    std::vector<Link *> m_NoLinks;
+};
+
+#endif // BML_BEHAVIORGRAPHINDEX_H
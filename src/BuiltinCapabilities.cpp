@@ -34,11 +34,16 @@ public:
     }
 
     CKObject *Resolve(ModContext *context, BML_ObjectRef reference) const {
-        if (!context || !context->GetCKContext() || reference.Domain != kVirtoolsObjectDomain ||
-            reference.Slot == 0 || reference.Generation == 0) {
+        return Resolve(context ? context->GetCKContext() : nullptr, reference);
+    }
+
+    // For a batch, which looks the CKContext up once rather than once per ref.
+    CKObject *Resolve(CKContext *ckContext, BML_ObjectRef reference) const {
+        if (!ckContext || reference.Domain != kVirtoolsObjectDomain || reference.Slot == 0 ||
+            reference.Generation == 0) {
             return nullptr;
         }
-        CKObject *current = context->GetCKContext()->GetObject(static_cast<CK_ID>(reference.Slot));
+        CKObject *current = ckContext->GetObject(static_cast<CK_ID>(reference.Slot));
         return current && !current->IsToBeDeleted() &&
                        m_References.Matches(reference.Slot, reference.Generation, current)
                    ? current
@@ -72,50 +77,44 @@ public:
         return m_ObjectReferences.Resolve(GetContext(), reference);
     }
 
-    void InvalidateObjectRefs(const CK_ID *ids, int count) { m_ObjectReferences.Invalidate(ids, count); }
-    void InvalidateAllObjectRefs() { m_ObjectReferences.InvalidateAll(); }
+    void InvalidateObjectRefs(const CK_ID *ids, int count) {
+        m_ObjectReferences.Invalidate(ids, count);
+        m_FoundNames.clear();
+    }
+
+    void InvalidateAllObjectRefs() {
+        m_ObjectReferences.InvalidateAll();
+        m_FoundNames.clear();
+    }
+
+    void InvalidateObjectNames() { m_FoundNames.clear(); }
 
     int ReadSceneObject(BML_ObjectRef reference, BML_SceneObjectInfo &out) {
-        CKObject *object = m_ObjectReferences.Resolve(GetContext(), reference);
-        if (!object)
-            return BML_ERROR_OBJECT_INVALID;
-        out.Id = static_cast<int>(object->GetID());
-        out.ClassId = static_cast<int>(object->GetClassID());
-        WriteText(out.Name, out.NameLength, object->GetName());
-        out.Visible = object->IsVisible() != FALSE ? 1 : 0;
-        out.Dynamic = object->IsDynamic() != FALSE ? 1 : 0;
-        return BML_OK;
+        ModContext *context = GetContext();
+        return ReadSceneObjectFrom(context ? context->GetCKContext() : nullptr, reference, out);
     }
 
     int ReadSceneEntityTransform(BML_ObjectRef reference, BML_SceneEntityTransform &out) {
-        auto *entity = dynamic_cast<CK3dEntity *>(m_ObjectReferences.Resolve(GetContext(), reference));
-        if (!entity)
-            return BML_ERROR_OBJECT_INVALID;
-        VxVector position, scale;
-        entity->GetPosition(&position);
-        entity->GetScale(&scale);
-        out.Position = BML::Convert::ToVec3(position);
-        out.Scale = BML::Convert::ToVec3(scale);
-        out.Parent = m_ObjectReferences.Make(entity->GetParent());
-        out.ChildCount = entity->GetChildrenCount();
-        return BML_OK;
+        ModContext *context = GetContext();
+        return ReadSceneEntityTransformFrom(context ? context->GetCKContext() : nullptr, reference, out);
+    }
+
+    int ReadSceneObjects(const BML_ObjectRef *references, std::size_t count, BML_SceneObjectInfo *out,
+                         int *statuses) {
+        return ReadSceneBatch(references, count, out, statuses, &BuiltinCapabilities::ReadSceneObjectFrom);
+    }
+
+    int ReadSceneEntityTransforms(const BML_ObjectRef *references, std::size_t count,
+                                  BML_SceneEntityTransform *out, int *statuses) {
+        return ReadSceneBatch(references, count, out, statuses, &BuiltinCapabilities::ReadSceneEntityTransformFrom);
     }
 
     int FindSceneObject(const char *name, BML_ObjectRef &out) {
-        ModContext *context = GetContext();
-        if (!context || !context->GetCKContext())
-            return BML_ERROR_UNAVAILABLE;
-        out = m_ObjectReferences.Make(context->GetCKContext()->GetObjectByName(const_cast<char *>(name)));
-        return BML_OK;
+        return FindSceneObjectByName(name, kAnyClass, out);
     }
 
     int FindSceneObjectOfClass(const char *name, int classId, BML_ObjectRef &out) {
-        ModContext *context = GetContext();
-        if (!context || !context->GetCKContext())
-            return BML_ERROR_UNAVAILABLE;
-        out = m_ObjectReferences.Make(context->GetCKContext()->GetObjectByNameAndClass(
-            const_cast<char *>(name), static_cast<CK_CLASSID>(classId)));
-        return BML_OK;
+        return FindSceneObjectByName(name, classId, out);
     }
 
     int ReadGameplayLevel(BML_GameplayLevelState &out) {
@@ -150,12 +149,181 @@ public:
     }
 
     int ReadGameplayCatalogEntry(std::size_t index, BML_GameplayCatalogEntry &out) {
-        CKDataArray *array = GameplaySource("catalog", "AllLevel");
+        return ReadGameplayRow("catalog", "AllLevel", index, out, &BuiltinCapabilities::ReadCatalogRow);
+    }
+
+    int ReadGameplayCatalogEntries(std::size_t first, std::size_t count, BML_GameplayCatalogEntry *out,
+                                   std::size_t &written) {
+        return ReadGameplayRows("catalog", "AllLevel", first, count, out, written,
+                                &BuiltinCapabilities::ReadCatalogRow);
+    }
+
+    int ReadGameplayCheckpointCount(std::size_t &out) {
+        return CountGameplayRows("checkpoints", "Checkpoints", out);
+    }
+
+    int ReadGameplayCheckpoint(std::size_t index, BML_GameplayCheckpoint &out) {
+        return ReadGameplayRow("checkpoints", "Checkpoints", index, out, &BuiltinCapabilities::ReadCheckpointRow);
+    }
+
+    int ReadGameplayCheckpoints(std::size_t first, std::size_t count, BML_GameplayCheckpoint *out,
+                                std::size_t &written) {
+        return ReadGameplayRows("checkpoints", "Checkpoints", first, count, out, written,
+                                &BuiltinCapabilities::ReadCheckpointRow);
+    }
+
+    int ReadGameplayResetpointCount(std::size_t &out) {
+        return CountGameplayRows("resetpoints", "ResetPoints", out);
+    }
+
+    int ReadGameplayResetpoint(std::size_t index, BML_GameplayResetpoint &out) {
+        return ReadGameplayRow("resetpoints", "ResetPoints", index, out, &BuiltinCapabilities::ReadResetpointRow);
+    }
+
+    int ReadGameplayResetpoints(std::size_t first, std::size_t count, BML_GameplayResetpoint *out,
+                                std::size_t &written) {
+        return ReadGameplayRows("resetpoints", "ResetPoints", first, count, out, written,
+                                &BuiltinCapabilities::ReadResetpointRow);
+    }
+
+private:
+    static constexpr int kAnyClass = -1;
+
+    // A name FindObject (classId kAnyClass) or FindObjectOfClass answered with an
+    // object.
+    struct FoundName {
+        int ClassId = kAnyClass;
+        std::string Name;
+
+        bool operator==(const FoundName &other) const { return ClassId == other.ClassId && Name == other.Name; }
+    };
+
+    struct FoundNameHash {
+        std::size_t operator()(const FoundName &key) const {
+            return std::hash<std::string>()(key.Name) * 31u + static_cast<std::size_t>(key.ClassId);
+        }
+    };
+
+    int ReadSceneObjectFrom(CKContext *ckContext, BML_ObjectRef reference, BML_SceneObjectInfo &out) {
+        CKObject *object = m_ObjectReferences.Resolve(ckContext, reference);
+        if (!object)
+            return BML_ERROR_OBJECT_INVALID;
+        out.Id = static_cast<int>(object->GetID());
+        out.ClassId = static_cast<int>(object->GetClassID());
+        WriteText(out.Name, out.NameLength, object->GetName());
+        out.Visible = object->IsVisible() != FALSE ? 1 : 0;
+        out.Dynamic = object->IsDynamic() != FALSE ? 1 : 0;
+        return BML_OK;
+    }
+
+    int ReadSceneEntityTransformFrom(CKContext *ckContext, BML_ObjectRef reference, BML_SceneEntityTransform &out) {
+        auto *entity = dynamic_cast<CK3dEntity *>(m_ObjectReferences.Resolve(ckContext, reference));
+        if (!entity)
+            return BML_ERROR_OBJECT_INVALID;
+        VxVector position, scale;
+        entity->GetPosition(&position);
+        entity->GetScale(&scale);
+        out.Position = BML::Convert::ToVec3(position);
+        out.Scale = BML::Convert::ToVec3(scale);
+        out.Parent = m_ObjectReferences.Make(entity->GetParent());
+        out.ChildCount = entity->GetChildrenCount();
+        return BML_OK;
+    }
+
+    // The object-load and deletion callbacks clear the cache. A hit is still
+    // checked against the live object, which also catches a rename, and a name
+    // that matched nothing is not kept, so an object created under it later is
+    // found.
+    int FindSceneObjectByName(const char *name, int classId, BML_ObjectRef &out) {
+        ModContext *context = GetContext();
+        CKContext *ckContext = context ? context->GetCKContext() : nullptr;
+        if (!ckContext)
+            return BML_ERROR_UNAVAILABLE;
+
+        FoundName key{classId, name};
+        const auto cached = m_FoundNames.find(key);
+        if (cached != m_FoundNames.end()) {
+            CKObject *object = m_ObjectReferences.Resolve(ckContext, cached->second);
+            const char *current = object ? object->GetName() : nullptr;
+            if (current && std::strcmp(current, name) == 0) {
+                out = cached->second;
+                return BML_OK;
+            }
+            m_FoundNames.erase(cached);
+        }
+
+        CKObject *object = classId == kAnyClass
+                               ? ckContext->GetObjectByName(const_cast<char *>(name))
+                               : ckContext->GetObjectByNameAndClass(const_cast<char *>(name),
+                                                                    static_cast<CK_CLASSID>(classId));
+        out = m_ObjectReferences.Make(object);
+        if (out.Domain != 0)
+            m_FoundNames.emplace(std::move(key), out);
+        return BML_OK;
+    }
+
+    // The batch reads check their arguments and look the CKContext up once, then
+    // resolve each ref on its own.
+    template <typename Row>
+    int ReadSceneBatch(const BML_ObjectRef *references, std::size_t count, Row *out, int *statuses,
+                       int (BuiltinCapabilities::*read)(CKContext *, BML_ObjectRef, Row &)) {
+        if (count == 0)
+            return BML_OK;
+        if (!references || !out)
+            return BML_ERROR_INVALID_PARAMETER;
+        ModContext *context = GetContext();
+        CKContext *ckContext = context ? context->GetCKContext() : nullptr;
+        int result = BML_OK;
+        for (std::size_t index = 0; index < count; ++index) {
+            const int status = (this->*read)(ckContext, references[index], out[index]);
+            if (statuses)
+                statuses[index] = status;
+            if (status != BML_OK)
+                result = status;
+        }
+        return result;
+    }
+
+    template <typename Row>
+    using RowReader = int (BuiltinCapabilities::*)(CKDataArray *, int, Row &);
+
+    template <typename Row>
+    int ReadGameplayRow(const char *endpoint, const char *arrayName, std::size_t index, Row &out,
+                        RowReader<Row> read) {
+        CKDataArray *array = GameplaySource(endpoint, arrayName);
         if (!array)
             return BML_ERROR_UNAVAILABLE;
         const int row = RowIndex(array, index);
         if (row < 0)
             return BML_ERROR_NOT_FOUND;
+        return (this->*read)(array, row, out);
+    }
+
+    // One array lookup and one column check for the whole range.
+    template <typename Row>
+    int ReadGameplayRows(const char *endpoint, const char *arrayName, std::size_t first, std::size_t count,
+                         Row *out, std::size_t &written, RowReader<Row> read) {
+        written = 0;
+        if (count != 0 && !out)
+            return BML_ERROR_INVALID_PARAMETER;
+        CKDataArray *array = GameplaySource(endpoint, arrayName);
+        if (!array)
+            return BML_ERROR_UNAVAILABLE;
+        const int rows = array->GetRowCount();
+        const std::size_t available = rows > 0 ? static_cast<std::size_t>(rows) : 0u;
+        if (first >= available)
+            return BML_OK;
+        const std::size_t end = first + (std::min)(count, available - first);
+        for (std::size_t index = first; index < end; ++index) {
+            const int status = (this->*read)(array, static_cast<int>(index), out[index - first]);
+            if (status != BML_OK)
+                return status;
+            ++written;
+        }
+        return BML_OK;
+    }
+
+    int ReadCatalogRow(CKDataArray *array, int row, BML_GameplayCatalogEntry &out) {
         std::string file, startBall, sky;
         int bonus = 0, music = 0;
         if (!ReadString(array, row, 0, file) || !ReadString(array, row, 1, startBall) ||
@@ -170,17 +338,7 @@ public:
         return BML_OK;
     }
 
-    int ReadGameplayCheckpointCount(std::size_t &out) {
-        return CountGameplayRows("checkpoints", "Checkpoints", out);
-    }
-
-    int ReadGameplayCheckpoint(std::size_t index, BML_GameplayCheckpoint &out) {
-        CKDataArray *array = GameplaySource("checkpoints", "Checkpoints");
-        if (!array)
-            return BML_ERROR_UNAVAILABLE;
-        const int row = RowIndex(array, index);
-        if (row < 0)
-            return BML_ERROR_NOT_FOUND;
+    int ReadCheckpointRow(CKDataArray *array, int row, BML_GameplayCheckpoint &out) {
         VxMatrix matrix;
         if (!ReadMatrix(array, row, 0, matrix))
             return BML_ERROR_UNAVAILABLE;
@@ -189,22 +347,11 @@ public:
         return BML_OK;
     }
 
-    int ReadGameplayResetpointCount(std::size_t &out) {
-        return CountGameplayRows("resetpoints", "ResetPoints", out);
-    }
-
-    int ReadGameplayResetpoint(std::size_t index, BML_GameplayResetpoint &out) {
-        CKDataArray *array = GameplaySource("resetpoints", "ResetPoints");
-        if (!array)
-            return BML_ERROR_UNAVAILABLE;
-        const int row = RowIndex(array, index);
-        if (row < 0)
-            return BML_ERROR_NOT_FOUND;
+    int ReadResetpointRow(CKDataArray *array, int row, BML_GameplayResetpoint &out) {
         out.Object = m_ObjectReferences.Make(ReadObject(array, row, 0));
         return BML_OK;
     }
 
-private:
     ModContext *GetContext() const { return m_Mod.GetRuntimeContext(); }
 
     // outLength is the whole length, so text too long for the buffer is detectable
@@ -319,6 +466,7 @@ private:
 
     BMLMod &m_Mod;
     ObjectReferences m_ObjectReferences;
+    std::unordered_map<FoundName, BML_ObjectRef, FoundNameHash> m_FoundNames;
 };
 
 std::unordered_map<BMLMod *, std::unique_ptr<BuiltinCapabilities>> g_Capabilities;
@@ -359,6 +507,11 @@ void InvalidateAllBuiltinObjectRefs(ModContext &context) {
         capabilities->InvalidateAllObjectRefs();
 }
 
+void InvalidateBuiltinObjectNames(ModContext &context) {
+    if (BuiltinCapabilities *capabilities = Find(context))
+        capabilities->InvalidateObjectNames();
+}
+
 BML_ObjectRef MakeBuiltinObjectRef(ModContext &context, CKObject *object) {
     BuiltinCapabilities *capabilities = Find(context);
     return capabilities ? capabilities->MakeObjectRef(object) : BML_ObjectRef{};
@@ -395,6 +548,17 @@ int ReadBuiltinSceneEntityTransform(ModContext &context, BML_ObjectRef object,
     return ServeBuiltinCapability(context, &BuiltinCapabilities::ReadSceneEntityTransform, object, out);
 }
 
+int ReadBuiltinSceneObjects(ModContext &context, const BML_ObjectRef *objects, std::size_t count,
+                            BML_SceneObjectInfo *out, int *statuses) {
+    return ServeBuiltinCapability(context, &BuiltinCapabilities::ReadSceneObjects, objects, count, out, statuses);
+}
+
+int ReadBuiltinSceneEntityTransforms(ModContext &context, const BML_ObjectRef *objects, std::size_t count,
+                                     BML_SceneEntityTransform *out, int *statuses) {
+    return ServeBuiltinCapability(context, &BuiltinCapabilities::ReadSceneEntityTransforms, objects, count, out,
+                                  statuses);
+}
+
 int FindBuiltinSceneObject(ModContext &context, const char *name, BML_ObjectRef &out) {
     return ServeBuiltinCapability(context, &BuiltinCapabilities::FindSceneObject, name, out);
 }
@@ -439,3 +603,21 @@ int ReadBuiltinGameplayResetpoint(ModContext &context, std::size_t index,
                                   BML_GameplayResetpoint &out) {
     return ServeBuiltinCapability(context, &BuiltinCapabilities::ReadGameplayResetpoint, index, out);
 }
+
+int ReadBuiltinGameplayCatalogEntries(ModContext &context, std::size_t first, std::size_t count,
+                                      BML_GameplayCatalogEntry *out, std::size_t &written) {
+    return ServeBuiltinCapability(context, &BuiltinCapabilities::ReadGameplayCatalogEntries, first, count, out,
+                                  written);
+}
+
+int ReadBuiltinGameplayCheckpoints(ModContext &context, std::size_t first, std::size_t count,
+                                   BML_GameplayCheckpoint *out, std::size_t &written) {
+    return ServeBuiltinCapability(context, &BuiltinCapabilities::ReadGameplayCheckpoints, first, count, out,
+                                  written);
+}
+
+int ReadBuiltinGameplayResetpoints(ModContext &context, std::size_t first, std::size_t count,
+                                   BML_GameplayResetpoint *out, std::size_t &written) {
+    return ServeBuiltinCapability(context, &BuiltinCapabilities::ReadGameplayResetpoints, first, count, out,
+                                  written);
+}
@@ -21,6 +21,9 @@ void UnregisterBuiltinCapabilities(BMLMod &mod);
  * because ObjectRef never exposes CK lifetime mechanics across the ABI. */
 void InvalidateBuiltinObjectRefs(ModContext &context, const CK_ID *ids, int count);
 void InvalidateAllBuiltinObjectRefs(ModContext &context);
+/* Called after a file is loaded, since the objects it brought in can answer a
+ * name the scene find cache already holds. */
+void InvalidateBuiltinObjectNames(ModContext &context);
 
 /* Script bindings are allowed to translate an already-borrowed CKObject to the
  * opaque identity the scene reads hand out, and back again at the final host
@@ -35,6 +38,10 @@ CKObject *ResolveBuiltinObjectRef(ModContext &context, BML_ObjectRef reference);
 int ReadBuiltinSceneObject(ModContext &context, BML_ObjectRef object, BML_SceneObjectInfo &out);
 int ReadBuiltinSceneEntityTransform(ModContext &context, BML_ObjectRef object,
                                     BML_SceneEntityTransform &out);
+int ReadBuiltinSceneObjects(ModContext &context, const BML_ObjectRef *objects, std::size_t count,
+                            BML_SceneObjectInfo *out, int *statuses);
+int ReadBuiltinSceneEntityTransforms(ModContext &context, const BML_ObjectRef *objects, std::size_t count,
+                                     BML_SceneEntityTransform *out, int *statuses);
 int FindBuiltinSceneObject(ModContext &context, const char *name, BML_ObjectRef &out);
 int FindBuiltinSceneObjectOfClass(ModContext &context, const char *name, int classId,
                                   BML_ObjectRef &out);
@@ -53,5 +60,11 @@ int ReadBuiltinGameplayCheckpoint(ModContext &context, std::size_t index,
 int ReadBuiltinGameplayResetpointCount(ModContext &context, std::size_t &out);
 int ReadBuiltinGameplayResetpoint(ModContext &context, std::size_t index,
                                   BML_GameplayResetpoint &out);
+int ReadBuiltinGameplayCatalogEntries(ModContext &context, std::size_t first, std::size_t count,
+                                      BML_GameplayCatalogEntry *out, std::size_t &written);
+int ReadBuiltinGameplayCheckpoints(ModContext &context, std::size_t first, std::size_t count,
+                                   BML_GameplayCheckpoint *out, std::size_t &written);
+int ReadBuiltinGameplayResetpoints(ModContext &context, std::size_t first, std::size_t count,
+                                   BML_GameplayResetpoint *out, std::size_t &written);
 
 #endif // BML_BUILTINCAPABILITIES_H
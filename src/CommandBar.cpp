@@ -3,9 +3,7 @@
 #include <cctype>
 #include <cstdint>
 #include <cstring>
-#include <sstream>
-
-#include <utf8.h>
+#include <string_view>
 
 #include "BML/ICommand.h"
 #include "BML/InputHook.h"
@@ -23,80 +21,6 @@ namespace {
 
         return utils::CombinePathW(loaderDirectory, kCommandHistoryFile);
     }
-
-    void MergeHistoryEntry(std::vector<std::string> &history, const std::string &entry) {
-        if (entry.empty())
-            return;
-
-        auto it = std::find(history.begin(), history.end(), entry);
-        if (it != history.end())
-            history.erase(it);
-
-        history.emplace_back(entry);
-    }
-
-    std::vector<std::string> ReadHistoryEntries(const std::wstring &path) {
-        if (path.empty())
-            return {};
-
-        const std::vector<std::uint8_t> bytes = utils::ReadBinaryFileW(path);
-        if (bytes.empty())
-            return {};
-
-        std::vector<std::string> history;
-        std::istringstream input(std::string(bytes.begin(), bytes.end()));
-        std::string line;
-        while (std::getline(input, line)) {
-            if (line.empty() || line[0] == '\0')
-                continue;
-
-            MergeHistoryEntry(history, line);
-        }
-
-        return history;
-    }
-
-    bool WriteHistoryEntries(const std::wstring &path, const std::vector<std::string> &history) {
-        if (path.empty())
-            return false;
-
-        const std::wstring tempPath = path + L".tmp";
-        if (history.empty()) {
-            utils::DeleteFileW(tempPath);
-            utils::DeleteFileW(path);
-            return true;
-        }
-
-        std::string content;
-        for (const std::string &entry : history) {
-            content.append(entry);
-            content.push_back('\n');
-        }
-
-        const std::vector<std::uint8_t> bytes(content.begin(), content.end());
-        if (!utils::WriteBinaryFileW(tempPath, bytes)) {
-            utils::DeleteFileW(tempPath);
-            return false;
-        }
-
-        if (!utils::MoveFileW(tempPath, path)) {
-            utils::DeleteFileW(tempPath);
-            return false;
-        }
-
-        return true;
-    }
-
-    std::string NormalizeCandidateEncoding(const std::string &candidate) {
-        if (candidate.empty())
-            return candidate;
-
-        const auto *utf8Candidate = reinterpret_cast<const utf8_int8_t *>(candidate.c_str());
-        if (utf8valid(utf8Candidate) == nullptr)
-            return candidate;
-
-        return utils::Utf16ToUtf8(utils::AnsiToUtf16(candidate));
-    }
 }
 
 CommandBar::CommandBar() : Window("CommandBar"), m_Buffer(65535, '\0') {
@@ -255,25 +179,24 @@ void CommandBar::OnHide() {
 }
 
 void CommandBar::PrintHistory() {
-    const int count = static_cast<int>(m_History.size());
+    const std::vector<std::string> entries = m_History.GetEntries();
+    const int count = static_cast<int>(entries.size());
     for (int i = 0; i < count; ++i) {
-        const std::string str = "[" + std::to_string(i + 1) + "] " + m_History[(count - 1) - i];
+        const std::string str = "[" + std::to_string(i + 1) + "] " + entries[(count - 1) - i];
         BML_GetModContext()->SendIngameMessage(str.c_str());
     }
 }
 
 void CommandBar::ExecuteHistory(int index) {
-    if (index < 1 || index > static_cast<int>(m_History.size()))
+    std::string line;
+    if (index < 1 || !m_History.GetRecent(static_cast<size_t>(index - 1), line))
         return;
 
-    const std::string line = m_History[(m_History.size() - index)];
     BML_GetModContext()->ExecuteCommand(line.c_str());
 }
 
 void CommandBar::ClearHistory() {
-    m_History.clear();
-    m_HistoryIndex = -1;
-    SaveHistory();
+    m_History.Clear();
 }
 
 std::wstring CommandBar::GetHistoryPath() const {
@@ -281,38 +204,20 @@ std::wstring CommandBar::GetHistoryPath() const {
 }
 
 void CommandBar::LoadHistory() {
-    m_History = ReadHistoryEntries(GetHistoryPath());
-    m_HistoryIndex = -1;
+    m_History.Open(GetHistoryPath());
 }
 
 void CommandBar::SaveHistory() {
-    WriteHistoryEntries(GetHistoryPath(), m_History);
+    m_History.Flush();
 }
 
 void CommandBar::RecordHistoryEntry(const std::string &entry) {
-    if (entry.empty())
-        return;
-
-    MergeHistoryEntry(m_History, entry);
-    m_HistoryIndex = -1;
-    SaveHistory();
+    m_History.Record(entry);
 }
 
 void CommandBar::CollectCommandCandidates(const char *cmdStart, int cmdLength) {
-    const int count = BML_GetModContext()->GetCommandCount();
-    for (int i = 0; i < count; ++i) {
-        ICommand *cmd = BML_GetModContext()->GetCommand(i);
-        if (!cmd)
-            continue;
-
-        const std::string name = NormalizeCandidateEncoding(cmd->GetName());
-        if (!name.empty() && utf8ncasecmp(name.c_str(), cmdStart, cmdLength) == 0)
-            utils::AppendUnique(m_Candidates, name);
-
-        const std::string alias = NormalizeCandidateEncoding(cmd->GetAlias());
-        if (!alias.empty() && utf8ncasecmp(alias.c_str(), cmdStart, cmdLength) == 0)
-            utils::AppendUnique(m_Candidates, alias);
-    }
+    const auto &commands = BML_GetModContext()->GetCommandContext();
+    m_Candidates = commands.FindCommandNames(std::string_view(cmdStart, cmdLength));
 }
 
 void CommandBar::CollectArgumentCandidates(const char *wordStart, int wordLength, const char *cmdStart, const char *lineEnd) {
@@ -320,15 +225,13 @@ void CommandBar::CollectArgumentCandidates(const char *wordStart, int wordLength
     if (args.empty())
         return;
 
-    ICommand *cmd = BML_GetModContext()->FindCommand(args[0].c_str());
+    auto *context = BML_GetModContext();
+    ICommand *cmd = context->FindCommand(args[0].c_str());
     if (!cmd)
         return;
 
-    for (const std::string &rawCandidate : cmd->GetTabCompletion(BML_GetModContext(), args)) {
-        const std::string candidate = NormalizeCandidateEncoding(rawCandidate);
-        if (!candidate.empty() && utf8ncasecmp(candidate.c_str(), wordStart, wordLength) == 0)
-            utils::AppendUnique(m_Candidates, candidate);
-    }
+    m_Candidates = context->GetCommandContext().GetArgumentCompletions(
+        context, cmd, args, std::string_view(wordStart, wordLength));
 }
 
 void CommandBar::ReplaceCurrentToken(ImGuiInputTextCallbackData *data, const char *replacement, int replacementLength) {
@@ -374,11 +277,14 @@ void CommandBar::ToggleCommandBar(bool on) {
     if (on) {
         Show();
         m_Buffer[0] = '\0';
+        // Argument completions can depend on game state, so refresh them each
+        // time the bar is opened.
+        context->GetCommandContext().InvalidateCompletionCache();
         if (m_InputBlockToken == 0) {
             if (auto *input = context->GetInputManager())
                 m_InputBlockToken = input->AcquireBlock(InputHook::INPUT_BLOCK_KEYBOARD);
         }
-        m_HistoryIndex = static_cast<int>(m_History.size());
+        m_History.ResetBrowse();
     } else {
         const uint64_t releaseToken = m_InputBlockToken;
         m_InputBlockToken = 0;
@@ -543,22 +449,16 @@ int CommandBar::OnTextEdit(ImGuiInputTextCallbackData *data) {
                 InvalidateCandidates();
             }
 
-            const int prevHistoryPos = m_HistoryIndex;
-            if (data->EventKey == ImGuiKey_UpArrow) {
-                if (m_HistoryIndex == -1)
-                    m_HistoryIndex = static_cast<int>(m_History.size() - 1);
-                else if (m_HistoryIndex > 0)
-                    m_HistoryIndex--;
-            } else if (data->EventKey == ImGuiKey_DownArrow) {
-                if (m_HistoryIndex != -1)
-                    if (++m_HistoryIndex >= static_cast<int>(m_History.size()))
-                        m_HistoryIndex = -1;
-            }
+            bool moved = false;
+            if (data->EventKey == ImGuiKey_UpArrow)
+                moved = m_History.BrowseOlder();
+            else if (data->EventKey == ImGuiKey_DownArrow)
+                moved = m_History.BrowseNewer();
 
-            if (prevHistoryPos != m_HistoryIndex) {
-                const std::string &historyStr = (m_HistoryIndex >= 0) ? m_History[m_HistoryIndex] : "";
+            if (moved) {
+                const std::string *historyStr = m_History.GetBrowsed();
                 data->DeleteChars(0, data->BufTextLen);
-                data->InsertChars(0, historyStr.c_str());
+                data->InsertChars(0, historyStr ? historyStr->c_str() : "");
             }
         }
         break;
@@ -663,60 +563,22 @@ std::vector<std::string> CommandBar::MakeArgs(const char *line) {
     if (!line || line[0] == '\0')
         return {};
 
-    size_t size = utf8size(line);
-    char *buf = new char[size + 1];
-    utf8ncpy(buf, line, size);
-    buf[size] = '\0';
-
-    std::vector<std::string> args;
-
-    char *lp = buf;
-    char *rp = lp;
-    char *end = lp + size;
-    utf8_int32_t cp, temp;
-    utf8codepoint(rp, &cp);
-    while (rp != end) {
-        if (std::isspace(static_cast<unsigned char>(*rp)) || *rp == '\0') {
-            const size_t len = rp - lp;
-            if (len != 0) {
-                const char bk = *rp;
-                *rp = '\0';
-                args.emplace_back(lp);
-                *rp = bk;
-            }
-
-            if (*rp != '\0') {
-                while (std::isspace(static_cast<unsigned char>(*rp)))
-                    ++rp;
-                --rp;
-            }
-
-            lp = utf8codepoint(rp, &temp);
-            if (std::isspace(static_cast<unsigned char>(*rp)) && *lp == '\0') {
-                args.emplace_back("");
-                break;
-            }
-        }
-
-        rp = utf8codepoint(rp, &cp);
-    }
-
-    delete[] buf;
-
-    return args;
+    return MakeArgsRange(line, line + std::strlen(line));
 }
 
 std::vector<std::string> CommandBar::MakeArgsRange(const char *begin, const char *end) {
     if (!begin || !end || begin >= end)
         return {};
 
-    const size_t size = static_cast<size_t>(end - begin);
-    char *buf = new char[size + 1];
-    // Copy bytes as-is and NUL-terminate; downstream parser will handle tokenization
-    memcpy(buf, begin, size);
-    buf[size] = '\0';
+    const std::string_view line(begin, static_cast<size_t>(end - begin));
+    BML::CommandTokens tokens;
+    BML::CommandContext::TokenizeCommandLine(line, tokens);
+    auto args = tokens.ToStrings();
 
-    auto args = MakeArgs(buf);
-    delete[] buf;
+    // A caret after whitespace starts a new, still empty argument
+    const size_t terminator = line.find('\0');
+    const std::string_view text = line.substr(0, terminator);
+    if (!text.empty() && std::isspace(static_cast<unsigned char>(text.back())))
+        args.emplace_back();
     return args;
 }
@@ -7,6 +7,8 @@
 
 #include "BML/Bui.h"
 
+#include "CommandHistory.h"
+
 class CommandBar : public Bui::Window {
 public:
     CommandBar();
@@ -61,8 +63,7 @@ private:
     uint64_t m_InputBlockToken = 0;
     std::string m_Buffer;
     int m_CursorPos = 0;
-    int m_HistoryIndex = -1;
-    std::vector<std::string> m_History;
+    CommandHistory m_History;
     int m_CandidateSelected = -1;
     int m_CandidateIndex = 0;
     int m_CandidatePage = 0;
@@ -2,7 +2,9 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
 #include <cstring>
+#include <unordered_set>
 
 #include <utf8.h>
 
@@ -29,6 +31,12 @@ namespace {
         return std::isalnum(ch) || ch == '_' || ch == '-' || ch == '.';
     }
 
+    // std::isspace can accept bytes >= 0x80 in some locales, and those bytes
+    // are part of multi-byte UTF-8 sequences, so only ASCII whitespace splits.
+    bool IsCommandLineSpace(char ch) {
+        return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' || ch == '\r';
+    }
+
     CommandKeyEncoding ClassifyCommandKey(const char *name) {
         if (!name || name[0] == '\0') {
             return CommandKeyEncoding::kAscii;
@@ -131,9 +139,98 @@ namespace {
         });
     }
 
+    constexpr size_t kMaxCompletionCacheEntries = 256;
+
+    std::string NormalizeCandidateEncoding(const std::string &candidate) {
+        if (candidate.empty())
+            return candidate;
+
+        const auto *utf8Candidate = reinterpret_cast<const utf8_int8_t *>(candidate.c_str());
+        if (utf8valid(utf8Candidate) == nullptr)
+            return candidate;
+
+        return utils::Utf16ToUtf8(utils::AnsiToUtf16(candidate));
+    }
+
+    // Completions depend on the arguments before the one being completed, so
+    // they are part of the key along with its position and typed text.
+    std::string MakeCompletionCacheKey(ICommand *cmd, const std::vector<std::string> &args, const std::string &prefix) {
+        std::string key = std::to_string(reinterpret_cast<uintptr_t>(cmd));
+        key.push_back('\0');
+        key += std::to_string(args.size() - 1);
+        for (const std::string &arg : args) {
+            key.push_back('\0');
+            key += arg;
+        }
+        key.push_back('\0');
+        key += prefix;
+        return key;
+    }
 }
 
-CommandContext::CommandContext() = default;
+struct CommandContext::CommandTrieNode {
+    struct Entry {
+        std::string Text;
+        ICommand *Command = nullptr;
+    };
+
+    // Sorted by byte so that a walk lists keys in order.
+    std::vector<std::pair<unsigned char, std::unique_ptr<CommandTrieNode>>> Children;
+    std::vector<Entry> Entries;
+
+    const CommandTrieNode *Find(std::string_view key) const {
+        const CommandTrieNode *node = this;
+        for (const char ch : key) {
+            const auto byte = static_cast<unsigned char>(ch);
+            const auto it = std::lower_bound(node->Children.begin(), node->Children.end(), byte,
+                [](const auto &child, unsigned char value) { return child.first < value; });
+            if (it == node->Children.end() || it->first != byte)
+                return nullptr;
+            node = it->second.get();
+        }
+        return node;
+    }
+
+    void Insert(std::string_view key, std::string text, ICommand *cmd) {
+        CommandTrieNode *node = this;
+        for (const char ch : key) {
+            const auto byte = static_cast<unsigned char>(ch);
+            auto it = std::lower_bound(node->Children.begin(), node->Children.end(), byte,
+                [](const auto &child, unsigned char value) { return child.first < value; });
+            if (it == node->Children.end() || it->first != byte)
+                it = node->Children.emplace(it, byte, std::make_unique<CommandTrieNode>());
+            node = it->second.get();
+        }
+        node->Entries.push_back({std::move(text), cmd});
+    }
+
+    // Returns true when this node is left without entries or children.
+    bool Remove(std::string_view key, ICommand *cmd) {
+        if (key.empty()) {
+            Entries.erase(std::remove_if(Entries.begin(), Entries.end(),
+                              [cmd](const Entry &entry) { return entry.Command == cmd; }),
+                          Entries.end());
+        } else {
+            const auto byte = static_cast<unsigned char>(key.front());
+            const auto it = std::lower_bound(Children.begin(), Children.end(), byte,
+                [](const auto &child, unsigned char value) { return child.first < value; });
+            if (it != Children.end() && it->first == byte && it->second->Remove(key.substr(1), cmd))
+                Children.erase(it);
+        }
+        return Entries.empty() && Children.empty();
+    }
+
+    void Collect(std::vector<std::string> &names, std::unordered_set<std::string_view> &seen) const {
+        for (const Entry &entry : Entries) {
+            if (seen.insert(entry.Text).second)
+                names.push_back(entry.Text);
+        }
+        for (const auto &child : Children)
+            child.second->Collect(names, seen);
+    }
+};
+
+CommandContext::CommandContext() : m_CommandTrie(std::make_unique<CommandTrieNode>()) {}
 
 CommandContext::~CommandContext() = default;
 
@@ -194,9 +291,33 @@ bool CommandContext::RegisterCommand(ICommand *cmd) {
         }
     }
 
+    InsertCommandNames(cmd, name, alias);
     return true;
 }
 
+void CommandContext::InsertCommandNames(ICommand *cmd, const std::string &name, const std::string &alias) {
+    // Conflicting aliases stay listed, as they were before the trie.
+    auto &keys = m_CommandTrieKeys[cmd];
+    keys.push_back(NormalizeCommandKey(name.c_str()));
+    m_CommandTrie->Insert(keys.back(), name, cmd);
+    if (!alias.empty()) {
+        keys.push_back(NormalizeCommandKey(alias.c_str()));
+        m_CommandTrie->Insert(keys.back(), alias, cmd);
+    }
+    m_CompletionCache.clear();
+}
+
+void CommandContext::RemoveCommandNames(ICommand *cmd) {
+    const auto it = m_CommandTrieKeys.find(cmd);
+    if (it == m_CommandTrieKeys.end())
+        return;
+
+    for (const std::string &key : it->second)
+        m_CommandTrie->Remove(key, cmd);
+    m_CommandTrieKeys.erase(it);
+    m_CompletionCache.clear();
+}
+
 std::string CommandContext::NormalizeCommandKey(const char *name) {
     if (!name || name[0] == '\0')
         return {};
@@ -236,6 +357,7 @@ bool CommandContext::UnregisterCommand(const char *name) {
     }
 
     m_Commands.erase(std::remove(m_Commands.begin(), m_Commands.end(), cmd), m_Commands.end());
+    RemoveCommandNames(cmd);
     return true;
 }
 
@@ -260,6 +382,17 @@ ICommand *CommandContext::GetCommandByName(const char *name) const {
     return it->second;
 }
 
+ICommand *CommandContext::GetCommandByName(std::string_view name) const {
+    // No registered name is longer, so the lookup key fits on the stack.
+    if (name.empty() || name.size() > MAX_CMD_NAME_LENGTH)
+        return nullptr;
+
+    char key[MAX_CMD_NAME_LENGTH + 1];
+    std::memcpy(key, name.data(), name.size());
+    key[name.size()] = '\0';
+    return GetCommandByName(static_cast<const char *>(key));
+}
+
 void CommandContext::SortCommands() {
     std::sort(m_Commands.begin(), m_Commands.end(),
           [](ICommand *a, ICommand *b) { return a->GetName() < b->GetName(); });
@@ -268,6 +401,52 @@ void CommandContext::SortCommands() {
 void CommandContext::ClearCommands() {
     m_CommandMap.clear();
     m_Commands.clear();
+    m_CommandTrie = std::make_unique<CommandTrieNode>();
+    m_CommandTrieKeys.clear();
+    m_CompletionCache.clear();
+}
+
+std::vector<std::string> CommandContext::FindCommandNames(std::string_view prefix) const {
+    const std::string key = NormalizeCommandKey(std::string(prefix).c_str());
+    const CommandTrieNode *node = m_CommandTrie->Find(key);
+    if (!node)
+        return {};
+
+    std::vector<std::string> names;
+    std::unordered_set<std::string_view> seen;
+    node->Collect(names, seen);
+    return names;
+}
+
+std::vector<std::string> CommandContext::GetArgumentCompletions(IBML *bml, ICommand *cmd, const std::vector<std::string> &args,
+                                                                std::string_view prefix) {
+    if (!cmd || args.empty())
+        return {};
+
+    const std::string prefixText(prefix);
+    std::string key = MakeCompletionCacheKey(cmd, args, prefixText);
+    const auto it = m_CompletionCache.find(key);
+    if (it != m_CompletionCache.end())
+        return it->second;
+
+    std::vector<std::string> completions;
+    std::unordered_set<std::string> seen;
+    for (const std::string &rawCandidate : cmd->GetTabCompletion(bml, args)) {
+        std::string candidate = NormalizeCandidateEncoding(rawCandidate);
+        if (candidate.empty() || utf8ncasecmp(candidate.c_str(), prefixText.c_str(), prefixText.size()) != 0)
+            continue;
+        if (seen.insert(candidate).second)
+            completions.push_back(std::move(candidate));
+    }
+
+    if (m_CompletionCache.size() >= kMaxCompletionCacheEntries)
+        m_CompletionCache.clear();
+    m_CompletionCache.emplace(std::move(key), completions);
+    return completions;
+}
+
+void CommandContext::InvalidateCompletionCache() {
+    m_CompletionCache.clear();
 }
 
 const char *CommandContext::GetVariable(const char *key) const {
@@ -417,42 +596,55 @@ bool CommandContext::IsValidCommandAlias(const char *alias) {
     return true;
 }
 
-std::vector<std::string> CommandContext::ParseCommandLine(const char *cmd) {
-    if (!cmd || cmd[0] == '\0')
-        return {};
+void CommandTokens::Clear() {
+    m_Overflow.clear();
+    m_Size = 0;
+}
 
-    std::vector<std::string> args;
-    size_t size = utf8size(cmd);
-    char *buf = new char[size + 1];
-    utf8ncpy(buf, cmd, size);
-
-    char *lp = &buf[0];
-    char *rp = lp;
-    char *end = lp + size;
-    utf8_int32_t cp, temp;
-    utf8codepoint(rp, &cp);
-    while (rp != end) {
-        if ((utf8codepointsize(*rp) == 1 && std::isspace(static_cast<unsigned char>(*rp))) || *rp == '\0') {
-            size_t len = rp - lp;
-            if (len != 0) {
-                char bk = *rp;
-                *rp = '\0';
-                args.emplace_back(lp);
-                *rp = bk;
-            }
+void CommandTokens::Push(std::string_view token) {
+    if (m_Size < kInlineTokens)
+        m_Inline[m_Size] = token;
+    else
+        m_Overflow.push_back(token);
+    ++m_Size;
+}
 
-            if (*rp != '\0') {
-                while (utf8codepointsize(*rp) == 1 && std::isspace(static_cast<unsigned char>(*rp)))
-                    ++rp;
-                --rp;
-            }
+std::vector<std::string> CommandTokens::ToStrings() const {
+    std::vector<std::string> strings;
+    strings.reserve(m_Size);
+    for (size_t i = 0; i < m_Size; ++i)
+        strings.emplace_back((*this)[i]);
+    return strings;
+}
 
-            lp = utf8codepoint(rp, &temp);
-        }
+void CommandContext::TokenizeCommandLine(std::string_view line, CommandTokens &tokens) {
+    tokens.Clear();
+
+    // Bytes of multi-byte UTF-8 sequences are never ASCII whitespace, so
+    // scanning bytes splits the same way as scanning codepoints.
+    const size_t terminator = line.find('\0');
+    if (terminator != std::string_view::npos)
+        line = line.substr(0, terminator);
+
+    size_t cursor = 0;
+    while (cursor < line.size()) {
+        while (cursor < line.size() && IsCommandLineSpace(line[cursor]))
+            ++cursor;
+
+        const size_t start = cursor;
+        while (cursor < line.size() && !IsCommandLineSpace(line[cursor]))
+            ++cursor;
 
-        rp = utf8codepoint(rp, &cp);
+        if (cursor != start)
+            tokens.Push(line.substr(start, cursor - start));
     }
+}
+
+std::vector<std::string> CommandContext::ParseCommandLine(const char *cmd) {
+    if (!cmd || cmd[0] == '\0')
+        return {};
 
-    delete[] buf;
-    return args;
+    CommandTokens tokens;
+    TokenizeCommandLine(cmd, tokens);
+    return tokens.ToStrings();
 }
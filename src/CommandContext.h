@@ -1,8 +1,11 @@
 #ifndef BML_COMMANDCONTEXT_H
 #define BML_COMMANDCONTEXT_H
 
+#include <array>
 #include <cstdarg>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
@@ -11,6 +14,31 @@
 namespace BML {
     typedef void (*CommandOutputCallback)(const char *line, void *userdata);
 
+    // Tokens of one command line as views into the line. The first
+    // kInlineTokens live inside the object, so typical lines are tokenized
+    // without touching the heap.
+    class CommandTokens {
+    public:
+        static constexpr size_t kInlineTokens = 16;
+
+        size_t Size() const { return m_Size; }
+        bool Empty() const { return m_Size == 0; }
+        std::string_view operator[](size_t index) const {
+            return index < kInlineTokens ? m_Inline[index] : m_Overflow[index - kInlineTokens];
+        }
+
+        void Clear();
+        void Push(std::string_view token);
+
+        // Owned copies, for the ICommand and IMod interfaces.
+        std::vector<std::string> ToStrings() const;
+
+    private:
+        std::array<std::string_view, kInlineTokens> m_Inline = {};
+        std::vector<std::string_view> m_Overflow;
+        size_t m_Size = 0;
+    };
+
     class CommandContext {
     public:
         CommandContext();
@@ -29,10 +57,23 @@ namespace BML {
         size_t GetCommandCount() const;
         ICommand *GetCommandByIndex(size_t index) const;
         ICommand *GetCommandByName(const char *name) const;
+        ICommand *GetCommandByName(std::string_view name) const;
 
         void SortCommands();
         void ClearCommands();
 
+        // Names and aliases whose case-folded form starts with the case-folded
+        // prefix, each listed once, in folded key order.
+        std::vector<std::string> FindCommandNames(std::string_view prefix) const;
+
+        // Tab completions of the last argument in args that start with prefix,
+        // the part of it typed so far. Results are cached per command, argument
+        // position and prefix until the command table changes or the cache is
+        // invalidated.
+        std::vector<std::string> GetArgumentCompletions(IBML *bml, ICommand *cmd, const std::vector<std::string> &args,
+                                                        std::string_view prefix);
+        void InvalidateCompletionCache();
+
         const char *GetVariable(const char *key) const;
         bool AddVariable(const char *key, const char *value);
         bool RemoveVariable(const char *key);
@@ -52,6 +93,9 @@ namespace BML {
         static char *AllocPrintfV(const char *format, va_list args);
         static char *AllocPrintf(const char *format, ...);
 
+        // Splits line on ASCII whitespace, stopping at the first NUL. The tokens
+        // view line, which has to outlive them.
+        static void TokenizeCommandLine(std::string_view line, CommandTokens &tokens);
         static std::vector<std::string> ParseCommandLine(const char *cmd);
         static bool IsValidCommandAlias(const char *alias);
         static bool IsValidCommandName(const char *name);
@@ -72,12 +116,22 @@ namespace BML {
             bool operator()(const char *lhs, const std::string &rhs) const noexcept;
         };
 
+        struct CommandTrieNode;
+
         static std::string NormalizeCommandKey(const char *name);
 
+        void InsertCommandNames(ICommand *cmd, const std::string &name, const std::string &alias);
+        void RemoveCommandNames(ICommand *cmd);
+
         std::vector<ICommand *> m_Commands;
         typedef std::unordered_map<std::string, ICommand *, CommandKeyHash, CommandKeyEqual>
             CommandMap;
         CommandMap m_CommandMap;
+        // Folded names and aliases of every command, for prefix completion.
+        std::unique_ptr<CommandTrieNode> m_CommandTrie;
+        std::unordered_map<ICommand *, std::vector<std::string>> m_CommandTrieKeys;
+        typedef std::unordered_map<std::string, std::vector<std::string>> CompletionCache;
+        CompletionCache m_CompletionCache;
         typedef std::unordered_map<std::string, std::string> VariableMap;
         VariableMap m_Variables;
 
@@ -0,0 +1,296 @@
+#include "CommandHistory.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+namespace {
+    constexpr wchar_t kTempSuffix[] = L".tmp";
+
+    std::vector<std::string> ReadJournal(const std::wstring &path) {
+        std::vector<std::string> lines;
+        std::ifstream input(std::filesystem::path(path), std::ios::binary);
+        if (!input)
+            return lines;
+
+        std::string line;
+        while (std::getline(input, line)) {
+            if (line.empty() || line[0] == '\0')
+                continue;
+            lines.push_back(std::move(line));
+        }
+        return lines;
+    }
+
+    bool AppendJournal(const std::wstring &path, const std::vector<std::string> &lines) {
+        std::ofstream output(std::filesystem::path(path), std::ios::binary | std::ios::app);
+        for (const std::string &line : lines) {
+            output.write(line.data(), static_cast<std::streamsize>(line.size()));
+            output.put('\n');
+        }
+        return static_cast<bool>(output);
+    }
+
+    bool RewriteJournal(const std::wstring &path, const std::vector<std::string> &lines) {
+        std::error_code ec;
+        const std::filesystem::path target(path);
+        const std::filesystem::path temp(path + kTempSuffix);
+        if (lines.empty()) {
+            std::filesystem::remove(temp, ec);
+            std::filesystem::remove(target, ec);
+            return true;
+        }
+
+        {
+            std::ofstream output(temp, std::ios::binary | std::ios::trunc);
+            for (const std::string &line : lines) {
+                output.write(line.data(), static_cast<std::streamsize>(line.size()));
+                output.put('\n');
+            }
+            if (!output) {
+                output.close();
+                std::filesystem::remove(temp, ec);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temp, target, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+}
+
+CommandHistory::CommandHistory(size_t compactThreshold)
+    : m_CompactThreshold(compactThreshold), m_Browse(m_Entries.cend()) {}
+
+CommandHistory::~CommandHistory() {
+    WaitForLoad();
+    StopWriter();
+}
+
+void CommandHistory::Open(std::wstring path) {
+    WaitForLoad();
+    Flush();
+
+    m_Entries.clear();
+    m_Index.clear();
+    ResetBrowse();
+    m_JournalRecords = 0;
+    m_LoadedLines.clear();
+    m_Path = std::move(path);
+    if (m_Path.empty())
+        return;
+
+    m_LoadPending = true;
+    m_Loader = std::thread([this, path = m_Path] {
+        try {
+            m_LoadedLines = ReadJournal(path);
+        } catch (...) {
+            m_LoadedLines.clear();
+        }
+    });
+}
+
+void CommandHistory::Flush() {
+    if (!m_LoadPending)
+        CompactIfDue();
+
+    std::unique_lock<std::mutex> lock(m_WriteMutex);
+    m_WriteCondition.wait(lock, [this] { return m_WriteQueue.empty() && !m_WriteBusy; });
+}
+
+void CommandHistory::Record(const std::string &entry) {
+    if (entry.empty())
+        return;
+
+    EnsureLoaded();
+    Touch(entry);
+    ResetBrowse();
+    if (m_Path.empty())
+        return;
+
+    ++m_JournalRecords;
+    Enqueue(WriteOp::Kind::Append, {entry});
+    CompactIfDue();
+}
+
+void CommandHistory::Clear() {
+    EnsureLoaded();
+    m_Entries.clear();
+    m_Index.clear();
+    ResetBrowse();
+    m_JournalRecords = 0;
+    if (!m_Path.empty())
+        Enqueue(WriteOp::Kind::Remove);
+}
+
+size_t CommandHistory::Size() {
+    EnsureLoaded();
+    return m_Entries.size();
+}
+
+bool CommandHistory::GetRecent(size_t index, std::string &entry) {
+    EnsureLoaded();
+    if (index >= m_Entries.size())
+        return false;
+
+    auto it = m_Entries.crbegin();
+    std::advance(it, index);
+    entry = *it;
+    return true;
+}
+
+std::vector<std::string> CommandHistory::GetEntries() {
+    EnsureLoaded();
+    return {m_Entries.begin(), m_Entries.end()};
+}
+
+bool CommandHistory::BrowseOlder() {
+    EnsureLoaded();
+    if (m_Entries.empty())
+        return false;
+
+    if (!m_Browsing) {
+        m_Browse = std::prev(m_Entries.cend());
+        m_Browsing = true;
+        return true;
+    }
+
+    if (m_Browse == m_Entries.cbegin())
+        return false;
+
+    --m_Browse;
+    return true;
+}
+
+bool CommandHistory::BrowseNewer() {
+    if (!m_Browsing)
+        return false;
+
+    if (++m_Browse == m_Entries.cend())
+        m_Browsing = false;
+    return true;
+}
+
+const std::string *CommandHistory::GetBrowsed() const {
+    return m_Browsing ? &*m_Browse : nullptr;
+}
+
+void CommandHistory::ResetBrowse() {
+    m_Browse = m_Entries.cend();
+    m_Browsing = false;
+}
+
+size_t CommandHistory::GetJournalRecordCount() {
+    EnsureLoaded();
+    return m_JournalRecords;
+}
+
+void CommandHistory::EnsureLoaded() {
+    if (!m_LoadPending)
+        return;
+
+    WaitForLoad();
+
+    // Nothing is recorded before the load is merged, so the loaded entries are
+    // all older than the session's.
+    for (const std::string &line : m_LoadedLines)
+        Touch(line);
+    m_JournalRecords = m_LoadedLines.size();
+    m_LoadedLines.clear();
+    m_LoadedLines.shrink_to_fit();
+    CompactIfDue();
+}
+
+void CommandHistory::WaitForLoad() {
+    if (m_Loader.joinable())
+        m_Loader.join();
+    m_LoadPending = false;
+}
+
+void CommandHistory::Touch(const std::string &entry) {
+    const auto it = m_Index.find(entry);
+    if (it != m_Index.end()) {
+        m_Entries.splice(m_Entries.end(), m_Entries, it->second);
+        return;
+    }
+
+    m_Entries.push_back(entry);
+    const auto last = std::prev(m_Entries.end());
+    m_Index.emplace(*last, last);
+}
+
+void CommandHistory::CompactIfDue() {
+    if (m_Path.empty() || m_JournalRecords - m_Entries.size() <= m_CompactThreshold)
+        return;
+
+    Enqueue(WriteOp::Kind::Rewrite, GetEntries());
+    m_JournalRecords = m_Entries.size();
+}
+
+void CommandHistory::Enqueue(WriteOp::Kind type, std::vector<std::string> lines) {
+    WriteOp op;
+    op.Type = type;
+    op.Lines = std::move(lines);
+    op.Path = m_Path;
+    {
+        std::lock_guard<std::mutex> lock(m_WriteMutex);
+        m_WriteQueue.push_back(std::move(op));
+    }
+    m_WriteCondition.notify_all();
+
+    if (!m_Writer.joinable())
+        m_Writer = std::thread(&CommandHistory::WriterMain, this);
+}
+
+void CommandHistory::StopWriter() {
+    {
+        std::lock_guard<std::mutex> lock(m_WriteMutex);
+        m_StopWriter = true;
+    }
+    m_WriteCondition.notify_all();
+    if (m_Writer.joinable())
+        m_Writer.join();
+}
+
+void CommandHistory::WriterMain() {
+    std::unique_lock<std::mutex> lock(m_WriteMutex);
+    for (;;) {
+        m_WriteCondition.wait(lock, [this] { return m_StopWriter || !m_WriteQueue.empty(); });
+        if (m_WriteQueue.empty())
+            return;
+
+        WriteOp op = std::move(m_WriteQueue.front());
+        m_WriteQueue.pop_front();
+        m_WriteBusy = true;
+        lock.unlock();
+
+        try {
+            ExecuteWrite(op);
+        } catch (...) {
+            // History is best effort; a failed write only loses entries.
+        }
+
+        lock.lock();
+        m_WriteBusy = false;
+        m_WriteCondition.notify_all();
+    }
+}
+
+void CommandHistory::ExecuteWrite(const WriteOp &op) {
+    switch (op.Type) {
+        case WriteOp::Kind::Append:
+            AppendJournal(op.Path, op.Lines);
+            break;
+        case WriteOp::Kind::Rewrite:
+            RewriteJournal(op.Path, op.Lines);
+            break;
+        case WriteOp::Kind::Remove:
+            RewriteJournal(op.Path, {});
+            break;
+    }
+}
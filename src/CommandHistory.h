@@ -0,0 +1,108 @@
+#ifndef BML_COMMANDHISTORY_H
+#define BML_COMMANDHISTORY_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Command bar history, oldest entry first, each line at most once.
+ *
+ * Entries live in a list indexed by their text, so recording a line that is
+ * already present moves it to the end in constant time. The history file is a
+ * journal: every recorded line is appended to it, and replaying the journal
+ * with the same move-to-end rule rebuilds the history. Once the journal holds
+ * more than compactThreshold superseded lines it is rewritten with the live
+ * entries only. All file writes happen on a background thread.
+ *
+ * Open reads the previous session's journal on a background thread; the result
+ * is merged the first time the history is used.
+ */
+class CommandHistory {
+public:
+    static constexpr size_t kDefaultCompactThreshold = 256;
+
+    explicit CommandHistory(size_t compactThreshold = kDefaultCompactThreshold);
+    ~CommandHistory();
+
+    CommandHistory(const CommandHistory &) = delete;
+    CommandHistory &operator=(const CommandHistory &) = delete;
+
+    // Discards the current entries and starts loading the journal at path.
+    void Open(std::wstring path);
+    // Waits for pending writes and compacts the journal if it is due.
+    void Flush();
+
+    void Record(const std::string &entry);
+    void Clear();
+
+    size_t Size();
+    // Entry by recency; index 0 is the most recent one.
+    bool GetRecent(size_t index, std::string &entry);
+    std::vector<std::string> GetEntries();
+
+    // Walks the entries from the most recent one back. Browsing stops at the
+    // oldest entry and ends after the most recent one; both return whether the
+    // browsed entry changed.
+    bool BrowseOlder();
+    bool BrowseNewer();
+    // The browsed entry, or null when not browsing.
+    const std::string *GetBrowsed() const;
+    void ResetBrowse();
+
+    // Lines in the journal, superseded ones included.
+    size_t GetJournalRecordCount();
+
+private:
+    typedef std::list<std::string> EntryList;
+
+    struct WriteOp {
+        enum class Kind {
+            Append,
+            Rewrite,
+            Remove,
+        };
+
+        Kind Type = Kind::Append;
+        std::vector<std::string> Lines;
+        std::wstring Path;
+    };
+
+    void EnsureLoaded();
+    void WaitForLoad();
+    void Touch(const std::string &entry);
+    void CompactIfDue();
+    void Enqueue(WriteOp::Kind type, std::vector<std::string> lines = {});
+    void StopWriter();
+    void WriterMain();
+    void ExecuteWrite(const WriteOp &op);
+
+    size_t m_CompactThreshold;
+    std::wstring m_Path;
+
+    EntryList m_Entries;
+    std::unordered_map<std::string_view, EntryList::iterator> m_Index;
+    EntryList::const_iterator m_Browse;
+    bool m_Browsing = false;
+    size_t m_JournalRecords = 0;
+
+    std::thread m_Loader;
+    std::vector<std::string> m_LoadedLines;
+    bool m_LoadPending = false;
+
+    std::thread m_Writer;
+    std::mutex m_WriteMutex;
+    std::condition_variable m_WriteCondition;
+    std::deque<WriteOp> m_WriteQueue;
+    bool m_WriteBusy = false;
+    bool m_StopWriter = false;
+};
+
+#endif // BML_COMMANDHISTORY_H
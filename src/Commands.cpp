@@ -2,6 +2,9 @@
 
 #include <sstream>
 #include <cctype>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
 
 #include "BML/IBML.h"
 #include "BML/BML.h"
@@ -13,10 +16,19 @@
 #include "AngelScript/ScriptMod.h"
 #endif
 #include "AnsiPalette.h"
+#include "FrameProfiler.h"
+#include "ProfilerOverlay.h"
 #include "StringUtils.h"
 #include "PathUtils.h"
 
+CommandBML::CommandBML(BMLMod *mod) : m_BMLMod(mod) {}
+
 void CommandBML::Execute(IBML *bml, const std::vector<std::string> &args) {
+    if (args.size() >= 2 && args[1] == "profile") {
+        ExecuteProfile(bml, args);
+        return;
+    }
+
     bml->SendIngameMessage("Ballance Mod Loader Plus " BML_VERSION);
     bml->SendIngameMessage((std::to_string(bml->GetModCount()) + " Mods Installed:").data());
 
@@ -28,6 +40,91 @@ void CommandBML::Execute(IBML *bml, const std::vector<std::string> &args) {
     }
 }
 
+void CommandBML::ExecuteProfile(IBML *bml, const std::vector<std::string> &args) {
+    BML::FrameProfiler &profiler = BML::FrameProfiler::Get();
+    const std::string action = args.size() >= 3 ? args[2] : "show";
+
+    if (action == "on" || action == "off") {
+        const bool on = action == "on";
+        if (on && !profiler.IsEnabled())
+            profiler.Reset();
+        profiler.SetEnabled(on);
+        bml->SendIngameMessage(on ? "[profile] on" : "[profile] off");
+    } else if (action == "reset") {
+        profiler.Reset();
+        bml->SendIngameMessage("[profile] statistics cleared");
+    } else if (action == "show") {
+        const bool perLabel = args.size() >= 4 && args[3] == "callbacks";
+        const auto stats = profiler.GetStats(perLabel);
+        const size_t frames = profiler.GetRecordedFrames();
+        if (!profiler.IsEnabled() && frames == 0) {
+            bml->SendIngameMessage("[profile] profiler is off, run 'bml profile on' first");
+            return;
+        }
+
+        char line[512];
+        snprintf(line, sizeof(line), "[profile] %s over %zu frames, ms mean/p50/p99/max:",
+                 perLabel ? "callbacks" : "Mods", frames);
+        bml->SendIngameMessage(line);
+        const size_t rows = std::min<size_t>(stats.size(), 10);
+        for (size_t i = 0; i < rows; ++i) {
+            const auto &stat = stats[i];
+            const std::string name = perLabel ? stat.Owner + "." + stat.Label : stat.Owner;
+            snprintf(line, sizeof(line), "  %s: %.3f / %.3f / %.3f / %.3f (%zu calls)",
+                     name.c_str(), stat.MeanMs, stat.P50Ms, stat.P99Ms, stat.MaxMs, stat.Calls);
+            bml->SendIngameMessage(line);
+        }
+    } else if (action == "overlay") {
+        ProfilerOverlay &overlay = m_BMLMod->GetProfilerOverlay();
+        if (args.size() >= 4 && (args[3] == "mods" || args[3] == "callbacks")) {
+            overlay.SetPerLabel(args[3] == "callbacks");
+            overlay.Show();
+        } else if (args.size() >= 4) {
+            if (ParseBoolean(args[3]))
+                overlay.Show();
+            else
+                overlay.Hide();
+        } else {
+            overlay.Toggle();
+        }
+    } else if (action == "export") {
+        std::string file = "profile.json";
+        if (args.size() >= 4) {
+            file = args[3];
+            for (size_t i = 4; i < args.size(); ++i)
+                file += " " + args[i];
+            if (file.size() >= 2 && file.front() == '"' && file.back() == '"')
+                file = file.substr(1, file.size() - 2);
+        }
+
+        std::filesystem::path path(utils::Utf8ToUtf16(file));
+        if (path.is_relative())
+            path = std::filesystem::path(BML_GetLoaderPathW(BML_DIR_LOADER)) / path;
+        if (profiler.ExportChromeTrace(path)) {
+            bml->SendIngameMessage(("[profile] wrote " + std::to_string(profiler.GetEventCount()) +
+                                    " events to " + utils::Utf16ToUtf8(path.wstring())).c_str());
+        } else {
+            bml->SendIngameMessage(("[profile] failed to write " + utils::Utf16ToUtf8(path.wstring())).c_str());
+        }
+    } else {
+        bml->SendIngameMessage("Usage: bml profile [on|off|reset|show [mods|callbacks]|overlay [on|off|mods|callbacks]|export <file>]");
+    }
+}
+
+const std::vector<std::string> CommandBML::GetTabCompletion(IBML *bml, const std::vector<std::string> &args) {
+    if (args.size() == 2)
+        return {"profile"};
+    if (args.size() == 3 && args[1] == "profile")
+        return {"on", "off", "reset", "show", "overlay", "export"};
+    if (args.size() == 4 && args[1] == "profile") {
+        if (args[2] == "show")
+            return {"mods", "callbacks"};
+        if (args[2] == "overlay")
+            return {"on", "off", "mods", "callbacks"};
+    }
+    return {};
+}
+
 void CommandHelp::Execute(IBML *bml, const std::vector<std::string> &args) {
     const int cmdCount = bml->GetCommandCount();
     bml->SendIngameMessage((std::to_string(cmdCount) + " Existing Commands:").data());
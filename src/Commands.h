@@ -7,14 +7,19 @@ class BMLMod;
 
 class CommandBML : public ICommand {
 public:
-    CommandBML() = default;
+    explicit CommandBML(BMLMod *mod);
 
     std::string GetName() override { return "bml"; }
     std::string GetAlias() override { return ""; }
     std::string GetDescription() override { return "Show Information about Ballance Mod Loader."; }
     bool IsCheat() override { return false; }
     void Execute(IBML *bml, const std::vector<std::string> &args) override;
-    const std::vector<std::string> GetTabCompletion(IBML *bml, const std::vector<std::string> &args) override { return {}; }
+    const std::vector<std::string> GetTabCompletion(IBML *bml, const std::vector<std::string> &args) override;
+
+private:
+    void ExecuteProfile(IBML *bml, const std::vector<std::string> &args);
+
+    BMLMod *m_BMLMod;
 };
 
 class CommandHelp : public ICommand {
@@ -0,0 +1,277 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace BML {
+
+namespace {
+    void WriteJsonString(std::ostream &out, std::string_view value) {
+        out << '"';
+        for (const char c : value) {
+            switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out << escaped;
+                } else {
+                    out << c;
+                }
+            }
+        }
+        out << '"';
+    }
+
+    double ToMs(uint64_t ns) {
+        return static_cast<double>(ns) / 1000000.0;
+    }
+
+    // Nearest-rank percentile; reorders values.
+    uint64_t Percentile(std::vector<uint64_t> &values, double fraction) {
+        if (values.empty())
+            return 0;
+        size_t rank = static_cast<size_t>(fraction * static_cast<double>(values.size()) + 0.999999);
+        rank = std::clamp<size_t>(rank, 1, values.size()) - 1;
+        std::nth_element(values.begin(), values.begin() + static_cast<ptrdiff_t>(rank), values.end());
+        return values[rank];
+    }
+
+    FrameProfiler::Stat MakeStat(std::string owner, std::string label, std::vector<uint64_t> &frames, size_t calls) {
+        FrameProfiler::Stat stat;
+        stat.Owner = std::move(owner);
+        stat.Label = std::move(label);
+        stat.Calls = calls;
+        if (frames.empty())
+            return stat;
+
+        uint64_t total = 0;
+        uint64_t max = 0;
+        for (uint64_t value : frames) {
+            total += value;
+            max = std::max(max, value);
+        }
+        stat.MeanMs = ToMs(total) / static_cast<double>(frames.size());
+        stat.MaxMs = ToMs(max);
+        stat.P50Ms = ToMs(Percentile(frames, 0.50));
+        stat.P99Ms = ToMs(Percentile(frames, 0.99));
+        return stat;
+    }
+}
+
+FrameProfiler::FrameProfiler(size_t frameWindow, size_t eventCapacity)
+    : m_FrameWindow(std::max<size_t>(frameWindow, 1)),
+      m_SlotCount(m_FrameWindow + 1),
+      m_EventCapacity(std::max<size_t>(eventCapacity, 1)),
+      m_Epoch(std::chrono::steady_clock::now()) {}
+
+FrameProfiler &FrameProfiler::Get() {
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+void FrameProfiler::SetEnabled(bool enabled) {
+    if (enabled) {
+        m_Thread.store(std::this_thread::get_id(), std::memory_order_release);
+        if (m_Events.empty())
+            m_Events.resize(m_EventCapacity);
+    }
+    m_Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void FrameProfiler::Reset() {
+    std::fill(m_SelfTime.begin(), m_SelfTime.end(), 0);
+    std::fill(m_Calls.begin(), m_Calls.end(), 0);
+    m_Frame = 0;
+    m_EventHead = 0;
+    m_EventCount = 0;
+}
+
+void FrameProfiler::BeginFrame() {
+    if (!IsEnabled() || std::this_thread::get_id() != m_Thread.load(std::memory_order_acquire))
+        return;
+
+    ++m_Frame;
+    const size_t slot = CurrentSlot();
+    for (size_t key = 0; key < m_Keys.size(); ++key) {
+        m_SelfTime[key * m_SlotCount + slot] = 0;
+        m_Calls[key * m_SlotCount + slot] = 0;
+    }
+}
+
+std::string_view FrameProfiler::GetCurrentOwner() const {
+    if (m_Stack.empty())
+        return {};
+    return m_Names[m_Keys[m_Stack.back().Key].Owner];
+}
+
+size_t FrameProfiler::GetRecordedFrames() const {
+    return static_cast<size_t>(std::min<uint64_t>(m_Frame, m_FrameWindow));
+}
+
+bool FrameProfiler::Enter(std::string_view owner, std::string_view label) {
+    if (std::this_thread::get_id() != m_Thread.load(std::memory_order_acquire))
+        return false;
+
+    OpenScope scope;
+    scope.Key = GetKey(owner, label);
+    scope.Start = Now();
+    m_Stack.push_back(scope);
+    return true;
+}
+
+void FrameProfiler::Leave() {
+    if (m_Stack.empty())
+        return;
+
+    const uint64_t end = Now();
+    const OpenScope scope = m_Stack.back();
+    m_Stack.pop_back();
+
+    const uint64_t duration = end > scope.Start ? end - scope.Start : 0;
+    const uint64_t self = duration > scope.ChildTime ? duration - scope.ChildTime : 0;
+    if (!m_Stack.empty())
+        m_Stack.back().ChildTime += duration;
+
+    const size_t index = scope.Key * m_SlotCount + CurrentSlot();
+    m_SelfTime[index] += self;
+    ++m_Calls[index];
+
+    if (!m_Events.empty()) {
+        Event &event = m_Events[m_EventHead];
+        event.Key = scope.Key;
+        event.Depth = static_cast<uint32_t>(m_Stack.size());
+        event.Start = scope.Start;
+        event.Duration = duration;
+        m_EventHead = (m_EventHead + 1) % m_Events.size();
+        m_EventCount = std::min(m_EventCount + 1, m_Events.size());
+    }
+}
+
+uint64_t FrameProfiler::Now() const {
+    if (m_Clock)
+        return m_Clock();
+    const auto elapsed = std::chrono::steady_clock::now() - m_Epoch;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+uint32_t FrameProfiler::Intern(std::string_view name) {
+    const auto it = m_NameIds.find(name);
+    if (it != m_NameIds.end())
+        return it->second;
+
+    const auto id = static_cast<uint32_t>(m_Names.size());
+    m_Names.emplace_back(name);
+    m_NameIds.emplace(m_Names.back(), id);
+    return id;
+}
+
+uint32_t FrameProfiler::GetKey(std::string_view owner, std::string_view label) {
+    const uint32_t ownerId = Intern(owner);
+    const uint32_t labelId = Intern(label);
+    const uint64_t packed = static_cast<uint64_t>(ownerId) << 32 | labelId;
+
+    const auto it = m_KeyIds.find(packed);
+    if (it != m_KeyIds.end())
+        return it->second;
+
+    const auto key = static_cast<uint32_t>(m_Keys.size());
+    m_Keys.push_back({ownerId, labelId});
+    m_KeyIds.emplace(packed, key);
+    m_SelfTime.resize(m_Keys.size() * m_SlotCount, 0);
+    m_Calls.resize(m_Keys.size() * m_SlotCount, 0);
+    return key;
+}
+
+template <typename Fn>
+void FrameProfiler::ForEachRecordedSlot(Fn &&fn) const {
+    // The current frame is still being recorded and is left out
+    const size_t frames = GetRecordedFrames();
+    for (size_t i = 1; i <= frames; ++i)
+        fn(static_cast<size_t>((m_Frame - i) % m_SlotCount));
+}
+
+std::vector<FrameProfiler::Stat> FrameProfiler::GetStats(bool perLabel) const {
+    std::vector<Stat> stats;
+    std::vector<uint64_t> frames;
+
+    if (perLabel) {
+        for (size_t key = 0; key < m_Keys.size(); ++key) {
+            frames.clear();
+            size_t calls = 0;
+            ForEachRecordedSlot([&](size_t slot) {
+                frames.push_back(m_SelfTime[key * m_SlotCount + slot]);
+                calls += m_Calls[key * m_SlotCount + slot];
+            });
+            stats.push_back(MakeStat(m_Names[m_Keys[key].Owner], m_Names[m_Keys[key].Label], frames, calls));
+        }
+    } else {
+        std::vector<std::vector<uint32_t>> keysByOwner(m_Names.size());
+        for (size_t key = 0; key < m_Keys.size(); ++key)
+            keysByOwner[m_Keys[key].Owner].push_back(static_cast<uint32_t>(key));
+
+        for (size_t owner = 0; owner < keysByOwner.size(); ++owner) {
+            const auto &keys = keysByOwner[owner];
+            if (keys.empty())
+                continue;
+
+            frames.clear();
+            size_t calls = 0;
+            ForEachRecordedSlot([&](size_t slot) {
+                uint64_t total = 0;
+                for (uint32_t key : keys) {
+                    total += m_SelfTime[key * m_SlotCount + slot];
+                    calls += m_Calls[key * m_SlotCount + slot];
+                }
+                frames.push_back(total);
+            });
+            stats.push_back(MakeStat(m_Names[owner], std::string(), frames, calls));
+        }
+    }
+
+    std::stable_sort(stats.begin(), stats.end(), [](const Stat &lhs, const Stat &rhs) {
+        return lhs.P99Ms > rhs.P99Ms;
+    });
+    return stats;
+}
+
+void FrameProfiler::WriteChromeTrace(std::ostream &out) const {
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    const size_t first = (m_EventHead + m_Events.size() - m_EventCount) % std::max<size_t>(m_Events.size(), 1);
+    char number[32];
+    for (size_t i = 0; i < m_EventCount; ++i) {
+        const Event &event = m_Events[(first + i) % m_Events.size()];
+        const KeyInfo &key = m_Keys[event.Key];
+
+        out << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+        WriteJsonString(out, m_Names[key.Label]);
+        out << ",\"cat\":";
+        WriteJsonString(out, m_Names[key.Owner]);
+        // Timestamps are in microseconds
+        std::snprintf(number, sizeof(number), "%.3f", static_cast<double>(event.Start) / 1000.0);
+        out << ",\"ph\":\"X\",\"ts\":" << number;
+        std::snprintf(number, sizeof(number), "%.3f", static_cast<double>(event.Duration) / 1000.0);
+        out << ",\"dur\":" << number << ",\"pid\":1,\"tid\":1,\"args\":{\"mod\":";
+        WriteJsonString(out, m_Names[key.Owner]);
+        out << ",\"depth\":" << event.Depth << "}}";
+    }
+
+    out << "\n]}\n";
+}
+
+bool FrameProfiler::ExportChromeTrace(const std::filesystem::path &file) const {
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+    WriteChromeTrace(out);
+    return static_cast<bool>(out);
+}
+
+} // namespace BML
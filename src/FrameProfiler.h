@@ -0,0 +1,160 @@
+#ifndef BML_FRAMEPROFILER_H
+#define BML_FRAMEPROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace BML {
+
+// Times the loader's calls into Mods: callbacks, IMC handlers, timers and
+// script functions. Off by default; while off a Scope costs one relaxed load.
+//
+// Every scope is keyed by owner (a Mod id) and label (the callback). Each key
+// keeps the self time it spent in each of the last frameWindow frames, which is
+// what the rolling percentiles are computed from, and every scope is also
+// appended to a fixed-size event ring for the Chrome trace export.
+//
+// Recording happens only on the thread that enabled the profiler, which is
+// the game thread every callback runs on. Calls from other threads are ignored.
+class FrameProfiler {
+public:
+    static constexpr size_t kDefaultFrameWindow = 240;
+    static constexpr size_t kDefaultEventCapacity = 1u << 16;
+
+    struct Stat {
+        std::string Owner;
+        std::string Label; // Empty for the owner's total
+        double MeanMs = 0.0;
+        double P50Ms = 0.0;
+        double P99Ms = 0.0;
+        double MaxMs = 0.0;
+        size_t Calls = 0;
+    };
+
+    class Scope {
+    public:
+        Scope(FrameProfiler &profiler, std::string_view owner, std::string_view label) {
+            if (profiler.IsEnabled() && profiler.Enter(owner, label))
+                m_Profiler = &profiler;
+        }
+        ~Scope() {
+            if (m_Profiler)
+                m_Profiler->Leave();
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        FrameProfiler *m_Profiler = nullptr;
+    };
+
+    explicit FrameProfiler(size_t frameWindow = kDefaultFrameWindow,
+                           size_t eventCapacity = kDefaultEventCapacity);
+
+    FrameProfiler(const FrameProfiler &) = delete;
+    FrameProfiler &operator=(const FrameProfiler &) = delete;
+
+    // The loader's profiler.
+    static FrameProfiler &Get();
+
+    bool IsEnabled() const { return m_Enabled.load(std::memory_order_relaxed); }
+    void SetEnabled(bool enabled);
+    // Drops every recorded frame and event. Open scopes still close normally.
+    void Reset();
+
+    // Closes the current frame and starts the next one.
+    void BeginFrame();
+
+    // Owner of the innermost open scope, or empty outside of any.
+    std::string_view GetCurrentOwner() const;
+
+    size_t GetFrameWindow() const { return m_FrameWindow; }
+    // Completed frames the statistics are computed over.
+    size_t GetRecordedFrames() const;
+    size_t GetEventCount() const { return m_EventCount; }
+
+    // Per-frame self time over the recorded frames, one entry per owner with
+    // perLabel false or per owner and label with it true, slowest p99 first.
+    std::vector<Stat> GetStats(bool perLabel) const;
+
+    // Chrome trace-event JSON (chrome://tracing, Perfetto) of the event ring.
+    void WriteChromeTrace(std::ostream &out) const;
+    bool ExportChromeTrace(const std::filesystem::path &file) const;
+
+    // For tests; defaults to std::chrono::steady_clock.
+    void SetClock(std::function<uint64_t()> clock) { m_Clock = std::move(clock); }
+
+private:
+    struct OpenScope {
+        uint32_t Key = 0;
+        uint64_t Start = 0;
+        uint64_t ChildTime = 0;
+    };
+
+    struct Event {
+        uint32_t Key = 0;
+        uint32_t Depth = 0;
+        uint64_t Start = 0;
+        uint64_t Duration = 0;
+    };
+
+    struct KeyInfo {
+        uint32_t Owner = 0;
+        uint32_t Label = 0;
+    };
+
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+    };
+
+    bool Enter(std::string_view owner, std::string_view label);
+    void Leave();
+
+    uint64_t Now() const;
+    uint32_t Intern(std::string_view name);
+    uint32_t GetKey(std::string_view owner, std::string_view label);
+    size_t CurrentSlot() const { return static_cast<size_t>(m_Frame % m_SlotCount); }
+    template <typename Fn>
+    void ForEachRecordedSlot(Fn &&fn) const;
+
+    const size_t m_FrameWindow;
+    const size_t m_SlotCount; // The window plus the frame being recorded
+    const size_t m_EventCapacity;
+
+    std::atomic<bool> m_Enabled{false};
+    // Thread that records; other threads read it to skip their own scopes
+    std::atomic<std::thread::id> m_Thread;
+    std::function<uint64_t()> m_Clock;
+    std::chrono::steady_clock::time_point m_Epoch;
+
+    std::vector<std::string> m_Names;
+    std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> m_NameIds;
+    std::vector<KeyInfo> m_Keys;
+    std::unordered_map<uint64_t, uint32_t> m_KeyIds;
+
+    // Key-major: m_SelfTime[key * m_SlotCount + slot]
+    std::vector<uint64_t> m_SelfTime;
+    std::vector<uint32_t> m_Calls;
+    uint64_t m_Frame = 0;
+
+    std::vector<OpenScope> m_Stack;
+    std::vector<Event> m_Events;
+    size_t m_EventHead = 0;
+    size_t m_EventCount = 0;
+};
+
+} // namespace BML
+
+#endif // BML_FRAMEPROFILER_H
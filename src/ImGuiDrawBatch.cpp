@@ -0,0 +1,163 @@
+#include "ImGuiDrawBatch.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BML_IMGUI_VERTEX_SSE2 1
+#include <emmintrin.h>
+#else
+#define BML_IMGUI_VERTEX_SSE2 0
+#endif
+
+namespace BML {
+namespace {
+
+inline ImU32 ToArgb(ImU32 col) {
+#ifdef IMGUI_USE_BGRA_PACKED_COLOR
+    return col;
+#else
+    return (col & 0xFF00FF00) | ((col & 0xFF0000) >> 16) | ((col & 0xFF) << 16);
+#endif
+}
+
+inline void StoreVertex(const ImDrawVert &vtx, unsigned char *pos, unsigned char *col, unsigned char *uv) {
+    const float position[4] = {vtx.pos.x, vtx.pos.y, 0.0f, 1.0f};
+    const ImU32 argb = ToArgb(vtx.col);
+    std::memcpy(pos, position, sizeof(position));
+    std::memcpy(col, &argb, sizeof(argb));
+    std::memcpy(uv, &vtx.uv, sizeof(vtx.uv));
+}
+
+#if BML_IMGUI_VERTEX_SSE2
+inline __m128i ToArgb4(__m128i cols) {
+#ifdef IMGUI_USE_BGRA_PACKED_COLOR
+    return cols;
+#else
+    const __m128i lowByte = _mm_set1_epi32(0xFF);
+    const __m128i ag = _mm_and_si128(cols, _mm_set1_epi32(static_cast<int>(0xFF00FF00)));
+    const __m128i r = _mm_and_si128(_mm_srli_epi32(cols, 16), lowByte);
+    const __m128i b = _mm_slli_epi32(_mm_and_si128(cols, lowByte), 16);
+    return _mm_or_si128(ag, _mm_or_si128(r, b));
+#endif
+}
+
+inline __m128i LoadUV(const ImDrawVert &vtx) {
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i *>(&vtx.uv));
+}
+#endif
+
+// The CK2 backend has no scissor test, so a clip rectangle only decides
+// whether a command is drawn at all. Mirrors the clamping of the render loop.
+bool IsVisible(const ImDrawCmd &cmd, const ImGuiDrawViewport &viewport) {
+    float minX = (cmd.ClipRect.x - viewport.ClipOffset.x) * viewport.ClipScale.x;
+    float minY = (cmd.ClipRect.y - viewport.ClipOffset.y) * viewport.ClipScale.y;
+    float maxX = (cmd.ClipRect.z - viewport.ClipOffset.x) * viewport.ClipScale.x;
+    float maxY = (cmd.ClipRect.w - viewport.ClipOffset.y) * viewport.ClipScale.y;
+    if (minX < 0.0f) minX = 0.0f;
+    if (minY < 0.0f) minY = 0.0f;
+    if (maxX > viewport.Width) maxX = viewport.Width;
+    if (maxY > viewport.Height) maxY = viewport.Height;
+    return maxX > minX && maxY > minY;
+}
+
+} // namespace
+
+void ConvertImGuiVerticesScalar(const ImDrawVert *src, int count, const ImGuiVertexTarget &target) {
+    auto *pos = static_cast<unsigned char *>(target.Positions);
+    auto *col = static_cast<unsigned char *>(target.Colors);
+    auto *uv = static_cast<unsigned char *>(target.TexCoords);
+    for (int i = 0; i < count; ++i) {
+        StoreVertex(src[i], pos, col, uv);
+        pos += target.PositionStride;
+        col += target.ColorStride;
+        uv += target.TexCoordStride;
+    }
+}
+
+void ConvertImGuiVertices(const ImDrawVert *src, int count, const ImGuiVertexTarget &target) {
+#if BML_IMGUI_VERTEX_SSE2
+    auto *pos = static_cast<unsigned char *>(target.Positions);
+    auto *col = static_cast<unsigned char *>(target.Colors);
+    auto *uv = static_cast<unsigned char *>(target.TexCoords);
+    const unsigned int ps = target.PositionStride;
+    const unsigned int cs = target.ColorStride;
+    const unsigned int us = target.TexCoordStride;
+    const bool packedColors = cs == sizeof(ImU32);
+    const bool packedTexCoords = us == sizeof(ImVec2);
+    // Lanes 2 and 3 of every position: z = 0, w = 1.
+    const __m128 zw = _mm_set_ps(0.0f, 0.0f, 1.0f, 0.0f);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const ImDrawVert *v = src + i;
+
+        for (int k = 0; k < 4; ++k) {
+            const __m128 xy = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(&v[k].pos)));
+            _mm_storeu_ps(reinterpret_cast<float *>(pos + k * ps), _mm_movelh_ps(xy, zw));
+        }
+
+        const __m128i argb = ToArgb4(_mm_set_epi32(static_cast<int>(v[3].col), static_cast<int>(v[2].col),
+                                                   static_cast<int>(v[1].col), static_cast<int>(v[0].col)));
+        if (packedColors) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(col), argb);
+        } else {
+            const int lanes[4] = {
+                _mm_cvtsi128_si32(argb),
+                _mm_cvtsi128_si32(_mm_shuffle_epi32(argb, _MM_SHUFFLE(1, 1, 1, 1))),
+                _mm_cvtsi128_si32(_mm_shuffle_epi32(argb, _MM_SHUFFLE(2, 2, 2, 2))),
+                _mm_cvtsi128_si32(_mm_shuffle_epi32(argb, _MM_SHUFFLE(3, 3, 3, 3))),
+            };
+            for (int k = 0; k < 4; ++k)
+                std::memcpy(col + k * cs, &lanes[k], sizeof(int));
+        }
+
+        if (packedTexCoords) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(uv), _mm_unpacklo_epi64(LoadUV(v[0]), LoadUV(v[1])));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(uv + 16), _mm_unpacklo_epi64(LoadUV(v[2]), LoadUV(v[3])));
+        } else {
+            for (int k = 0; k < 4; ++k)
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(uv + k * us), LoadUV(v[k]));
+        }
+
+        pos += 4 * ps;
+        col += 4 * cs;
+        uv += 4 * us;
+    }
+
+    const ImGuiVertexTarget tail = {pos, ps, col, cs, uv, us};
+    ConvertImGuiVerticesScalar(src + i, count - i, tail);
+#else
+    ConvertImGuiVerticesScalar(src, count, target);
+#endif
+}
+
+void BuildImGuiDrawBatches(const ImVector<ImDrawCmd> &cmds,
+                           const ImGuiDrawViewport &viewport,
+                           ImVector<ImDrawCmd> &batches) {
+    batches.resize(0);
+    bool open = false;
+    for (const ImDrawCmd &cmd : cmds) {
+        if (cmd.UserCallback) {
+            batches.push_back(cmd);
+            open = false;
+            continue;
+        }
+        if (cmd.ElemCount == 0 || !IsVisible(cmd, viewport)) {
+            open = false;
+            continue;
+        }
+
+        if (open) {
+            ImDrawCmd &batch = batches.back();
+            if (batch.GetTexID() == cmd.GetTexID() && batch.VtxOffset == cmd.VtxOffset &&
+                batch.IdxOffset + batch.ElemCount == cmd.IdxOffset) {
+                batch.ElemCount += cmd.ElemCount;
+                continue;
+            }
+        }
+        batches.push_back(cmd);
+        open = true;
+    }
+}
+
+} // namespace BML
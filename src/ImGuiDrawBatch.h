@@ -0,0 +1,44 @@
+#ifndef BML_IMGUI_DRAW_BATCH_H
+#define BML_IMGUI_DRAW_BATCH_H
+
+#include "imgui.h"
+
+namespace BML {
+
+// Destination of converted vertices: strided VxVector4 positions, ARGB
+// colours and VxUV texture coordinates, as handed out by
+// CKRenderContext::GetDrawPrimitiveStructure().
+struct ImGuiVertexTarget {
+    void *Positions = nullptr;
+    unsigned int PositionStride = 0;
+    void *Colors = nullptr;
+    unsigned int ColorStride = 0;
+    void *TexCoords = nullptr;
+    unsigned int TexCoordStride = 0;
+};
+
+// Screen area the draw data is rendered to, used to drop commands whose clip
+// rectangle lies outside of it.
+struct ImGuiDrawViewport {
+    ImVec2 ClipOffset;
+    ImVec2 ClipScale = ImVec2(1.0f, 1.0f);
+    float Width = 0.0f;
+    float Height = 0.0f;
+};
+
+// Converts count vertices four at a time with SSE2 where available. Packed
+// colour and texture coordinate arrays are written with full-width stores.
+void ConvertImGuiVertices(const ImDrawVert *src, int count, const ImGuiVertexTarget &target);
+// Reference implementation, one vertex at a time.
+void ConvertImGuiVerticesScalar(const ImDrawVert *src, int count, const ImGuiVertexTarget &target);
+
+// Replaces batches with the visible commands of cmds, joining neighbours that
+// draw consecutive indices with the same texture and vertex offset into one
+// command. Callbacks are kept as they are and end the current batch.
+void BuildImGuiDrawBatches(const ImVector<ImDrawCmd> &cmds,
+                           const ImGuiDrawViewport &viewport,
+                           ImVector<ImDrawCmd> &batches);
+
+} // namespace BML
+
+#endif // BML_IMGUI_DRAW_BATCH_H
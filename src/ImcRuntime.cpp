@@ -1,5 +1,6 @@
 #include "ImcRuntime.h"
 
+#include "FrameProfiler.h"
 #include "ImcPrimitives.h"
 #include "ModInvocationGate.h"
 
@@ -650,6 +651,7 @@ struct ImcRuntime::State {
         response.Storage = &future->Result;
         int status = BML_ERROR_IMC_TARGET_EXECUTION_FAILED;
         try {
+            BML::FrameProfiler::Scope scope(BML::FrameProfiler::Get(), entry.Owner->Owner, "IMC RPC");
             status = entry.Handler(rpcId, &request, &response, entry.Userdata);
         } catch (const std::bad_alloc &) {
             status = BML_ERROR_OUT_OF_MEMORY;
@@ -1325,6 +1327,7 @@ int ImcRuntime::Publish(BML_ImcClient client, BML_ImcTopicId topicId,
                 auto operation = m_State->LockOperation();
                 if (subscription->Active.load(std::memory_order_acquire) &&
                     subscription->Owner->Active.load(std::memory_order_acquire)) {
+                    BML::FrameProfiler::Scope scope(BML::FrameProfiler::Get(), subscription->Owner->Owner, "IMC Topic");
                     subscription->Handler(topicId, &view, subscription->Userdata);
                     ++delivered;
                 }
@@ -1436,9 +1439,11 @@ void ImcRuntime::Pump(size_t rpcBudget, size_t messageBudgetPerSubscription,
                         invocation.emplace(m_State->InvocationGate->LockCall());
                     auto operation = m_State->LockOperation();
                     if (subscription->Active.load(std::memory_order_acquire) &&
-                        subscription->Owner->Active.load(std::memory_order_acquire))
+                        subscription->Owner->Active.load(std::memory_order_acquire)) {
+                        BML::FrameProfiler::Scope scope(BML::FrameProfiler::Get(), subscription->Owner->Owner, "IMC Topic");
                         subscription->Handler(subscription->Topic, &view,
                                               subscription->Userdata);
+                    }
                 } catch (...) {
                 }
             }
@@ -1456,8 +1461,10 @@ void ImcRuntime::Pump(size_t rpcBudget, size_t messageBudgetPerSubscription,
             if (m_State->InvocationGate)
                 invocation.emplace(m_State->InvocationGate->LockCall());
             auto operation = m_State->LockOperation();
-            if (completion->Owner->Active.load(std::memory_order_acquire))
+            if (completion->Owner->Active.load(std::memory_order_acquire)) {
+                BML::FrameProfiler::Scope scope(BML::FrameProfiler::Get(), completion->Owner->Owner, "IMC Completion");
                 completion->Callback(completion->Future->Handle, completion->Userdata);
+            }
         } catch (...) {
         }
         m_State->ReleaseClientRef(completion->Owner);
@@ -195,6 +195,30 @@ int GameplayReadResetpoint(size_t index, BML_GameplayResetpoint *out) {
     });
 }
 
+int GameplayReadCatalogEntries(size_t first, size_t count, BML_GameplayCatalogEntry *out, size_t *written) {
+    if ((count != 0 && !out) || !written)
+        return BML_ERROR_INVALID_PARAMETER;
+    return ServeOnMainThread([first, count, out, written](ModContext &context) {
+        return ReadBuiltinGameplayCatalogEntries(context, first, count, out, *written);
+    });
+}
+
+int GameplayReadCheckpoints(size_t first, size_t count, BML_GameplayCheckpoint *out, size_t *written) {
+    if ((count != 0 && !out) || !written)
+        return BML_ERROR_INVALID_PARAMETER;
+    return ServeOnMainThread([first, count, out, written](ModContext &context) {
+        return ReadBuiltinGameplayCheckpoints(context, first, count, out, *written);
+    });
+}
+
+int GameplayReadResetpoints(size_t first, size_t count, BML_GameplayResetpoint *out, size_t *written) {
+    if ((count != 0 && !out) || !written)
+        return BML_ERROR_INVALID_PARAMETER;
+    return ServeOnMainThread([first, count, out, written](ModContext &context) {
+        return ReadBuiltinGameplayResetpoints(context, first, count, out, *written);
+    });
+}
+
 int SceneReadObject(BML_ObjectRef object, BML_SceneObjectInfo *out) {
     if (!out)
         return BML_ERROR_INVALID_PARAMETER;
@@ -211,6 +235,23 @@ int SceneReadEntityTransform(BML_ObjectRef object, BML_SceneEntityTransform *out
     });
 }
 
+int SceneReadObjects(const BML_ObjectRef *objects, size_t count, BML_SceneObjectInfo *out, int *statuses) {
+    if (count != 0 && (!objects || !out))
+        return BML_ERROR_INVALID_PARAMETER;
+    return ServeOnMainThread([objects, count, out, statuses](ModContext &context) {
+        return ReadBuiltinSceneObjects(context, objects, count, out, statuses);
+    });
+}
+
+int SceneReadEntityTransforms(const BML_ObjectRef *objects, size_t count, BML_SceneEntityTransform *out,
+                              int *statuses) {
+    if (count != 0 && (!objects || !out))
+        return BML_ERROR_INVALID_PARAMETER;
+    return ServeOnMainThread([objects, count, out, statuses](ModContext &context) {
+        return ReadBuiltinSceneEntityTransforms(context, objects, count, out, statuses);
+    });
+}
+
 int SceneFindObject(const char *name, BML_ObjectRef *out) {
     if (!name || !out)
         return BML_ERROR_INVALID_PARAMETER;
@@ -445,6 +486,9 @@ const BML_GameplayInterface kGameplayInterface = {
     &GameplayReadCheckpoint,
     &GameplayReadResetpointCount,
     &GameplayReadResetpoint,
+    &GameplayReadCatalogEntries,
+    &GameplayReadCheckpoints,
+    &GameplayReadResetpoints,
 };
 
 const BML_SceneInterface kSceneInterface = {
@@ -454,6 +498,8 @@ const BML_SceneInterface kSceneInterface = {
     &SceneReadEntityTransform,
     &SceneFindObject,
     &SceneFindObjectOfClass,
+    &SceneReadObjects,
+    &SceneReadEntityTransforms,
 };
 
 const BML_UIInterface kUIInterface = {
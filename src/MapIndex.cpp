@@ -0,0 +1,291 @@
+#include "MapIndex.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include "StringUtils.h"
+
+namespace {
+    constexpr char kCacheMagic[] = "BMLMapIndex";
+    constexpr int kCacheVersion = 1;
+
+    int64_t GetWriteTime(const std::filesystem::path &path) {
+        std::error_code ec;
+        const auto time = std::filesystem::last_write_time(path, ec);
+        if (ec)
+            return 0;
+        return static_cast<int64_t>(time.time_since_epoch().count());
+    }
+
+    bool IsSafeName(const std::wstring &name) {
+        // Reject entries whose names contain path traversal sequences
+        return !name.empty() &&
+               name.find(L'\\') == std::wstring::npos &&
+               name.find(L'/') == std::wstring::npos &&
+               name.find(L"..") == std::wstring::npos;
+    }
+
+    void SortListing(MapIndexDirectory &directory) {
+        std::sort(directory.directories.begin(), directory.directories.end(),
+                  [](const MapIndexDirectory &lhs, const MapIndexDirectory &rhs) {
+                      return utils::CompareString(lhs.name, rhs.name) < 0;
+                  });
+        std::sort(directory.files.begin(), directory.files.end(),
+                  [](const std::wstring &lhs, const std::wstring &rhs) {
+                      return utils::CompareString(MapIndex::GetDisplayName(lhs), MapIndex::GetDisplayName(rhs)) < 0;
+                  });
+    }
+
+    bool IsCancelled(const std::atomic<bool> *cancel) {
+        return cancel && cancel->load(std::memory_order_relaxed);
+    }
+
+    void ScanDirectory(const std::filesystem::path &path,
+                       int depth,
+                       const MapIndexDirectory *previous,
+                       MapIndexDirectory &out,
+                       MapIndexScanStats &stats,
+                       const std::atomic<bool> *cancel) {
+        out.writeTime = GetWriteTime(path);
+        if (depth <= 0) {
+            out.truncated = true;
+            return;
+        }
+        if (IsCancelled(cancel))
+            return;
+
+        const bool unchanged = previous && !previous->truncated &&
+                               out.writeTime != 0 && previous->writeTime == out.writeTime;
+        if (unchanged) {
+            // Same listing as last time; only subdirectories may have changed below.
+            ++stats.reusedDirectories;
+            out.files = previous->files;
+            out.directories.reserve(previous->directories.size());
+            for (const MapIndexDirectory &cached : previous->directories) {
+                MapIndexDirectory &child = out.directories.emplace_back();
+                child.name = cached.name;
+                ScanDirectory(path / cached.name, depth - 1, &cached, child, stats, cancel);
+            }
+            stats.files += out.files.size();
+            return;
+        }
+
+        ++stats.listedDirectories;
+        std::error_code ec;
+        std::filesystem::directory_iterator it(path, std::filesystem::directory_options::skip_permission_denied, ec);
+        if (ec) {
+            ++stats.failedDirectories;
+            return;
+        }
+
+        for (const std::filesystem::directory_iterator end; it != end; it.increment(ec)) {
+            if (ec) {
+                ++stats.failedDirectories;
+                break;
+            }
+
+            std::wstring name = it->path().filename().wstring();
+            if (!IsSafeName(name))
+                continue;
+
+            std::error_code typeEc;
+            if (it->is_directory(typeEc)) {
+                MapIndexDirectory child;
+                child.name = std::move(name);
+                out.directories.push_back(std::move(child));
+            } else if (MapIndex::IsSupportedFileType(name)) {
+                out.files.push_back(std::move(name));
+            }
+        }
+
+        SortListing(out);
+        stats.files += out.files.size();
+
+        std::unordered_map<std::wstring, const MapIndexDirectory *> previousChildren;
+        if (previous) {
+            previousChildren.reserve(previous->directories.size());
+            for (const MapIndexDirectory &cached : previous->directories)
+                previousChildren.emplace(cached.name, &cached);
+        }
+
+        for (MapIndexDirectory &child : out.directories) {
+            const auto found = previousChildren.find(child.name);
+            const MapIndexDirectory *cached = found != previousChildren.end() ? found->second : nullptr;
+            ScanDirectory(path / child.name, depth - 1, cached, child, stats, cancel);
+        }
+    }
+
+    void WriteDirectory(std::ostream &out, const MapIndexDirectory &directory, int level) {
+        out << "D " << level << ' ' << directory.writeTime << ' ' << (directory.truncated ? 1 : 0) << ' '
+            << utils::Utf16ToUtf8(directory.name) << '\n';
+        for (const std::wstring &file : directory.files)
+            out << "F " << utils::Utf16ToUtf8(file) << '\n';
+        for (const MapIndexDirectory &child : directory.directories)
+            WriteDirectory(out, child, level + 1);
+    }
+
+    std::string ReadRestOfLine(std::istringstream &line) {
+        std::string rest;
+        if (line.peek() == ' ')
+            line.get();
+        std::getline(line, rest);
+        return rest;
+    }
+}
+
+bool MapIndex::IsSupportedFileType(const std::wstring &path) {
+    if (path.empty()) {
+        return false;
+    }
+
+    size_t dotPos = path.find_last_of(L'.');
+    if (dotPos == std::wstring::npos || dotPos >= path.length() - 1) {
+        return false;
+    }
+
+    std::wstring ext = path.substr(dotPos);
+
+    // Convert to lowercase for comparison
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::towlower);
+
+    return ext == L".nmo" || ext == L".cmo";
+}
+
+std::wstring MapIndex::GetDisplayName(const std::wstring &fileName) {
+    const size_t dotPos = fileName.find_last_of(L'.');
+    if (dotPos == std::wstring::npos)
+        return fileName;
+    return fileName.substr(0, dotPos);
+}
+
+MapIndexDirectory MapIndex::Scan(const std::filesystem::path &root,
+                                 int maxDepth,
+                                 const MapIndexDirectory *previous,
+                                 MapIndexScanStats *stats,
+                                 const std::atomic<bool> *cancel) {
+    MapIndexScanStats localStats;
+    MapIndexDirectory result;
+    result.name = root.filename().wstring();
+    ScanDirectory(root, maxDepth, previous, result, stats ? *stats : localStats, cancel);
+    return result;
+}
+
+size_t MapIndex::CountFiles(const MapIndexDirectory &directory) {
+    size_t count = directory.files.size();
+    for (const MapIndexDirectory &child : directory.directories)
+        count += CountFiles(child);
+    return count;
+}
+
+bool MapIndex::LoadCache(const std::filesystem::path &cacheFile,
+                         const std::wstring &root,
+                         int maxDepth,
+                         MapIndexDirectory &out) {
+    std::ifstream in(cacheFile, std::ios::binary);
+    if (!in)
+        return false;
+
+    std::string line;
+    std::string magic;
+    int version = 0;
+    if (!std::getline(in, line))
+        return false;
+    std::istringstream(line) >> magic >> version;
+    if (magic != kCacheMagic || version != kCacheVersion)
+        return false;
+
+    int depth = -1;
+    std::string cachedRoot;
+    for (int i = 0; i < 2; ++i) {
+        if (!std::getline(in, line))
+            return false;
+        std::istringstream header(line);
+        std::string key;
+        header >> key;
+        if (key == "depth")
+            header >> depth;
+        else if (key == "root")
+            cachedRoot = ReadRestOfLine(header);
+    }
+    if (depth != maxDepth || utils::Utf8ToUtf16(cachedRoot) != root)
+        return false;
+
+    MapIndexDirectory result;
+    bool hasRoot = false;
+    std::vector<MapIndexDirectory *> stack;
+    while (std::getline(in, line)) {
+        if (line.empty())
+            continue;
+
+        std::istringstream record(line);
+        std::string kind;
+        record >> kind;
+        if (kind == "D") {
+            int level = -1;
+            int64_t writeTime = 0;
+            int truncated = 0;
+            record >> level >> writeTime >> truncated;
+            if (!record || level < 0 || level > static_cast<int>(stack.size()) || (level == 0) == hasRoot)
+                return false;
+
+            stack.resize(level);
+            MapIndexDirectory *directory;
+            if (level == 0) {
+                directory = &result;
+                hasRoot = true;
+            } else {
+                directory = &stack.back()->directories.emplace_back();
+            }
+            directory->name = utils::Utf8ToUtf16(ReadRestOfLine(record));
+            directory->writeTime = writeTime;
+            directory->truncated = truncated != 0;
+            stack.push_back(directory);
+        } else if (kind == "F") {
+            if (stack.empty())
+                return false;
+            stack.back()->files.push_back(utils::Utf8ToUtf16(ReadRestOfLine(record)));
+        } else {
+            return false;
+        }
+    }
+
+    if (!hasRoot)
+        return false;
+
+    out = std::move(result);
+    return true;
+}
+
+bool MapIndex::SaveCache(const std::filesystem::path &cacheFile,
+                         const std::wstring &root,
+                         int maxDepth,
+                         const MapIndexDirectory &index) {
+    std::ostringstream content;
+    content << kCacheMagic << ' ' << kCacheVersion << '\n';
+    content << "depth " << maxDepth << '\n';
+    content << "root " << utils::Utf16ToUtf8(root) << '\n';
+    WriteDirectory(content, index, 0);
+
+    std::filesystem::path tempFile = cacheFile;
+    tempFile += L".tmp";
+    {
+        std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+        const std::string data = content.str();
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!out)
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempFile, cacheFile, ec);
+    if (ec) {
+        std::filesystem::remove(tempFile, ec);
+        return false;
+    }
+    return true;
+}
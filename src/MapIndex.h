@@ -0,0 +1,64 @@
+#ifndef BML_MAPINDEX_H
+#define BML_MAPINDEX_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/**
+ * Snapshot of the Maps directory tree.
+ *
+ * Every directory remembers its last write time. A directory's write time
+ * changes when an entry is added, removed or renamed directly inside it, so a
+ * later scan can keep the cached listing of any directory whose time is
+ * unchanged and only re-enumerate the ones that moved.
+ *
+ * Files and subdirectories are stored in display order (natural,
+ * case-insensitive, files by name without extension), so consumers never sort.
+ */
+struct MapIndexDirectory {
+    std::wstring name;
+    int64_t writeTime = 0;
+    bool truncated = false; // Beyond the depth limit; contents not listed
+    std::vector<std::wstring> files;
+    std::vector<MapIndexDirectory> directories;
+};
+
+struct MapIndexScanStats {
+    size_t listedDirectories = 0;
+    size_t reusedDirectories = 0;
+    size_t failedDirectories = 0;
+    size_t files = 0;
+};
+
+class MapIndex {
+public:
+    static bool IsSupportedFileType(const std::wstring &path);
+    static std::wstring GetDisplayName(const std::wstring &fileName);
+
+    // Scans root and at most maxDepth levels below it, matching the old
+    // recursive explorer. previous may be null for a full scan. A set cancel
+    // flag stops the scan early; the partial result must then be discarded.
+    static MapIndexDirectory Scan(const std::filesystem::path &root,
+                                  int maxDepth,
+                                  const MapIndexDirectory *previous,
+                                  MapIndexScanStats *stats = nullptr,
+                                  const std::atomic<bool> *cancel = nullptr);
+
+    static size_t CountFiles(const MapIndexDirectory &directory);
+
+    // The cache only applies to the same root and depth limit it was saved with.
+    static bool LoadCache(const std::filesystem::path &cacheFile,
+                          const std::wstring &root,
+                          int maxDepth,
+                          MapIndexDirectory &out);
+    static bool SaveCache(const std::filesystem::path &cacheFile,
+                          const std::wstring &root,
+                          int maxDepth,
+                          const MapIndexDirectory &index);
+};
+
+#endif // BML_MAPINDEX_H
@@ -1,7 +1,5 @@
 #include "MapMenu.h"
 
-#include <io.h>
-
 #include <oniguruma.h>
 
 #include "BML/InputHook.h"
@@ -15,6 +13,10 @@
 
 using namespace ScriptHelper;
 
+namespace {
+    constexpr wchar_t kMapIndexCacheFile[] = L"MapIndex.cache";
+}
+
 MapEntry::~MapEntry() {
     if (m_BeingDeleted) {
         return; // Prevent recursive deletion
@@ -49,6 +51,7 @@ bool MapEntry::operator<(const MapEntry &rhs) const {
 MapMenu::MapMenu(BMLMod *mod): m_Mod(mod), m_Maps(new MapEntry(nullptr, MAP_ENTRY_DIR)) {}
 
 MapMenu::~MapMenu() {
+    Shutdown();
     delete m_Maps;
 }
 
@@ -58,8 +61,20 @@ void MapMenu::Init() {
     RefreshMaps();
 }
 
+void MapMenu::Shutdown() {
+    m_CancelScan.store(true, std::memory_order_relaxed);
+    JoinScan();
+    m_RefreshQueued = false;
+
+    std::lock_guard<std::mutex> lock(m_ScanMutex);
+    m_PendingScan.reset();
+}
+
 void MapMenu::OnOpen() {
     Bui::BlockKeyboardInput();
+
+    // Pick up maps added since the last scan; unchanged folders are not listed again.
+    RefreshMaps();
 }
 
 void MapMenu::OnClose() {
@@ -101,7 +116,18 @@ void MapMenu::LoadMap(const std::wstring &path) {
 }
 
 void MapMenu::RefreshMaps() {
-    std::wstring path = BML_GetModContext()->GetDirectory(BML_DIR_LOADER);
+    if (IsRefreshing()) {
+        m_RefreshQueued = true;
+        return;
+    }
+    JoinScan();
+    // A finished scan nobody applied yet holds the index to diff against.
+    // This refresh covers any queued one, so don't let applying start another.
+    m_RefreshQueued = false;
+    ApplyPendingMaps();
+
+    const std::wstring loaderDir = BML_GetModContext()->GetDirectory(BML_DIR_LOADER);
+    std::wstring path = loaderDir;
     path.append(L"\\Maps");
 
     if (!utils::DirectoryExistsW(path)) {
@@ -109,182 +135,189 @@ void MapMenu::RefreshMaps() {
         return;
     }
 
-    auto *newMaps = new(std::nothrow) MapEntry(nullptr, MAP_ENTRY_DIR);
-    if (!newMaps) {
-        BML_GetModContext()->GetLogger()->Error("Failed to allocate memory for maps root");
-        return;
-    }
+    // The on-disk cache seeds the first scan (or one after the depth limit changed);
+    // later scans diff against the index kept from the previous one.
+    const bool loadCache = m_IndexDepth != m_MaxDepth;
+    MapIndexDirectory previous = loadCache ? MapIndexDirectory() : std::move(m_Index);
+    m_Index = MapIndexDirectory();
+    m_IndexDepth = -1;
 
-    newMaps->name = "Maps";
-    newMaps->path = path;
+    m_CancelScan.store(false, std::memory_order_relaxed);
+    m_Refreshing.store(true, std::memory_order_release);
+    try {
+        m_ScanThread = std::thread(&MapMenu::RunScan, this, std::move(path),
+                                   utils::CombinePathW(loaderDir, kMapIndexCacheFile),
+                                   m_MaxDepth, std::move(previous), loadCache);
+    } catch (const std::exception &e) {
+        m_Refreshing.store(false, std::memory_order_release);
+        BML_GetModContext()->GetLogger()->Error("Failed to start map scan: %s", e.what());
+    }
+}
 
+void MapMenu::RunScan(std::wstring root, std::wstring cacheFile, int maxDepth, MapIndexDirectory previous, bool loadCache) {
+    // Runs on the scan thread: no logging and no access to the live entry tree.
+    std::unique_ptr<ScanResult> result;
     try {
-        if (ExploreMaps(newMaps, m_MaxDepth)) {
-            // Only replace if successful
-            delete m_Maps;
-            m_Maps = newMaps;
-            ResetCurrentMaps();
-        } else {
-            delete newMaps;
-            BML_GetModContext()->GetLogger()->Warn("No maps found in directory");
+        result = std::make_unique<ScanResult>();
+        result->maxDepth = maxDepth;
+        if (loadCache)
+            result->fromCache = MapIndex::LoadCache(cacheFile, root, maxDepth, previous);
+
+        result->index = MapIndex::Scan(root, maxDepth, &previous, &result->stats, &m_CancelScan);
+        if (!m_CancelScan.load(std::memory_order_relaxed)) {
+            // With nothing listed the index equals the previous one, and so would the tree.
+            result->changed = loadCache || result->stats.listedDirectories > 0;
+            if (result->stats.listedDirectories > 0 || (loadCache && !result->fromCache))
+                MapIndex::SaveCache(cacheFile, root, maxDepth, result->index);
+            if (result->changed)
+                BuildEntries(root, result->index, *result);
+            result->completed = true;
         }
     } catch (...) {
-        delete newMaps;
-        BML_GetModContext()->GetLogger()->Error("Exception during map refresh");
+        if (result) {
+            result->maps.reset();
+            result->searchEntries.clear();
+            result->completed = false;
+        }
     }
-}
 
-bool MapMenu::ExploreMaps(MapEntry *maps, int depth) {
-    if (!maps || maps->type != MAP_ENTRY_DIR || maps->path.empty()) {
-        return false;
+    {
+        std::lock_guard<std::mutex> lock(m_ScanMutex);
+        m_PendingScan = std::move(result);
     }
+    m_Refreshing.store(false, std::memory_order_release);
+}
 
-    if (depth <= 0) {
-        return false;
-    }
+void MapMenu::JoinScan() {
+    if (m_ScanThread.joinable())
+        m_ScanThread.join();
+}
 
-    std::wstring searchPath = maps->path;
-    if (searchPath.length() > MAX_PATH) {
-        BML_GetModContext()->GetLogger()->Error("Path too long: %s", utils::Utf16ToUtf8(maps->path).c_str());
-        return false;
+bool MapMenu::ApplyPendingMaps() {
+    std::unique_ptr<ScanResult> result;
+    {
+        std::lock_guard<std::mutex> lock(m_ScanMutex);
+        result = std::move(m_PendingScan);
     }
+    if (!result)
+        return false;
+    JoinScan();
 
-    searchPath.append(L"\\*");
+    bool replaced = false;
+    if (!result->completed) {
+        BML_GetModContext()->GetLogger()->Error("Exception during map refresh");
+    } else if (!result->changed) {
+        m_Index = std::move(result->index);
+        m_IndexDepth = result->maxDepth;
+    } else {
+        m_Index = std::move(result->index);
+        m_IndexDepth = result->maxDepth;
 
-    _wfinddata_t fileinfo = {};
-    intptr_t handle = _wfindfirst(searchPath.c_str(), &fileinfo);
+        const MapIndexScanStats &stats = result->stats;
+        if (stats.failedDirectories > 0) {
+            BML_GetModContext()->GetLogger()->Warn("Failed to read %zu map directories", stats.failedDirectories);
+        }
 
-    if (handle == -1) {
-        int err = errno;
-        if (err != ENOENT) {
-            std::string errMsg = "Failed to explore maps directory " + utils::Utf16ToUtf8(maps->path) + ": ";
-            errMsg += strerror(err);
-            BML_GetModContext()->GetLogger()->Error(errMsg.c_str());
+        if (result->maps->children.empty()) {
+            BML_GetModContext()->GetLogger()->Warn("No maps found in directory");
+        } else {
+            // Stay in the folder being browsed if it still exists
+            const std::wstring currentPath = m_Current ? m_Current->path : std::wstring();
+            delete m_Maps;
+            m_Maps = result->maps.release();
+            ++m_TreeVersion;
+            m_SearchIndex = std::move(result->search);
+            m_SearchEntries = std::move(result->searchEntries);
+            m_Current = FindEntryByPath(m_Maps, currentPath);
+            if (!m_Current)
+                ResetCurrentMaps();
+            replaced = true;
+
+            BML_GetModContext()->GetLogger()->Info("Indexed %zu maps (%zu folders listed, %zu unchanged%s)",
+                stats.files, stats.listedDirectories, stats.reusedDirectories,
+                result->fromCache ? ", from cache" : "");
         }
-        return false;
     }
 
-    bool foundAny = false;
-
-    struct FileHandleGuard {
-        intptr_t handle;
-        explicit FileHandleGuard(intptr_t h) : handle(h) {}
-        ~FileHandleGuard() {
-            if (handle != -1) {
-                _findclose(handle);
-            }
-        }
-    } guard(handle);
+    if (m_RefreshQueued) {
+        m_RefreshQueued = false;
+        RefreshMaps();
+    }
 
-    try {
-        do {
-            // Skip current and parent directories
-            if (wcscmp(fileinfo.name, L".") == 0 || wcscmp(fileinfo.name, L"..") == 0) {
-                continue;
-            }
+    return replaced;
+}
 
-            std::wstring fullPath = maps->path;
-            if (fullPath.length() + wcslen(fileinfo.name) + 2 > MAX_PATH) {
-                BML_GetModContext()->GetLogger()->Warn("Skipping file with path too long: %s\\%s",
-                    utils::Utf16ToUtf8(maps->path).c_str(), utils::Utf16ToUtf8(fileinfo.name).c_str());
-                continue;
-            }
+void MapMenu::BuildEntries(const std::wstring &root, const MapIndexDirectory &index, ScanResult &result) {
+    result.maps = std::make_unique<MapEntry>(nullptr, MAP_ENTRY_DIR);
+    result.maps->name = "Maps";
+    result.maps->path = root;
 
-            fullPath.append(L"\\").append(fileinfo.name);
+    // Entries are added to the search index in the same preorder as the tree
+    result.search.Clear();
+    result.search.Reserve(result.stats.files + result.stats.listedDirectories + result.stats.reusedDirectories);
+    result.searchEntries.clear();
+    result.maps->searchId = result.search.Add(result.maps->name, true, MapSearchIndex::kInvalidId);
+    result.searchEntries.push_back(result.maps.get());
 
-            // Reject entries whose names contain path traversal sequences
-            if (wcschr(fileinfo.name, L'\\') || wcschr(fileinfo.name, L'/') ||
-                wcsstr(fileinfo.name, L"..")) {
-                continue;
-            }
+    AddEntries(result.maps.get(), index, result);
+    result.search.Build();
+}
 
-            if (fileinfo.attrib & _A_SUBDIR) {
-                std::wstring dirName = fileinfo.name;
-
-                auto *entry = new(std::nothrow) MapEntry(maps, MAP_ENTRY_DIR);
-                if (!entry) {
-                    BML_GetModContext()->GetLogger()->Error("Memory allocation failed for directory entry");
-                    break;
-                }
-
-                entry->name = utils::Utf16ToUtf8(dirName);
-                entry->path = fullPath;
-
-                maps->children.push_back(entry);
-
-                if (ExploreMaps(entry, depth - 1)) {
-                    foundAny = true;
-                }
-            } else if (IsSupportedFileType(fileinfo.name)) {
-                std::wstring filename = fileinfo.name;
-                size_t dotPos = filename.find_last_of(L'.');
-                if (dotPos != std::wstring::npos) {
-                    filename = filename.substr(0, dotPos);
-                }
-
-                auto *entry = new(std::nothrow) MapEntry(maps, MAP_ENTRY_FILE);
-                if (!entry) {
-                    BML_GetModContext()->GetLogger()->Error("Memory allocation failed for file entry");
-                    break;
-                }
-
-                entry->name = utils::Utf16ToUtf8(filename);
-                entry->path = fullPath;
-
-                maps->children.push_back(entry);
-                foundAny = true;
-            }
-        } while (_wfindnext(handle, &fileinfo) == 0);
+void MapMenu::AddEntries(MapEntry *parent, const MapIndexDirectory &directory, ScanResult &result) {
+    // The index is already in display order: directories first, then files, each by name.
+    parent->children.reserve(directory.directories.size() + directory.files.size());
 
-    } catch (const std::exception &e) {
-        BML_GetModContext()->GetLogger()->Error("Exception in ExploreMaps: %s", e.what());
-        return false;
-    } catch (...) {
-        BML_GetModContext()->GetLogger()->Error("Unknown exception in ExploreMaps");
-        return false;
+    for (const MapIndexDirectory &child : directory.directories) {
+        auto *entry = new MapEntry(parent, MAP_ENTRY_DIR);
+        parent->children.push_back(entry);
+        entry->name = utils::Utf16ToUtf8(child.name);
+        entry->path = parent->path + L"\\" + child.name;
+        entry->searchId = result.search.Add(entry->name, true, parent->searchId);
+        result.searchEntries.push_back(entry);
+        AddEntries(entry, child, result);
     }
 
-    // Sort children safely
-    if (!maps->children.empty()) {
-        try {
-            std::sort(maps->children.begin(), maps->children.end(),
-                [](const MapEntry *lhs, const MapEntry *rhs) {
-                    if (!lhs || !rhs) return false;
-                    return *lhs < *rhs;
-                });
-            foundAny = true;
-        } catch (...) {
-            BML_GetModContext()->GetLogger()->Error("Failed to sort map entries");
-        }
+    for (const std::wstring &file : directory.files) {
+        auto *entry = new MapEntry(parent, MAP_ENTRY_FILE);
+        parent->children.push_back(entry);
+        entry->name = utils::Utf16ToUtf8(MapIndex::GetDisplayName(file));
+        entry->path = parent->path + L"\\" + file;
+        entry->searchId = result.search.Add(entry->name, false, parent->searchId);
+        result.searchEntries.push_back(entry);
     }
-
-    return foundAny;
 }
 
-bool MapMenu::IsSupportedFileType(const std::wstring &path) {
-    if (path.empty()) {
-        return false;
-    }
-
-    size_t dotPos = path.find_last_of(L'.');
-    if (dotPos == std::wstring::npos || dotPos >= path.length() - 1) {
-        return false;
+MapEntry *MapMenu::FindEntryByPath(MapEntry *root, const std::wstring &path) {
+    if (!root || path.empty())
+        return nullptr;
+    if (root->path == path)
+        return root;
+
+    for (MapEntry *child : root->children) {
+        if (!child || child->type != MAP_ENTRY_DIR)
+            continue;
+        const std::wstring &childPath = child->path;
+        if (path.size() >= childPath.size() && path.compare(0, childPath.size(), childPath) == 0 &&
+            (path.size() == childPath.size() || path[childPath.size()] == L'\\')) {
+            return FindEntryByPath(child, path);
+        }
     }
-
-    std::wstring ext = path.substr(dotPos);
-
-    // Convert to lowercase for comparison
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::towlower);
-
-    return ext == L".nmo" || ext == L".cmo";
+    return nullptr;
 }
 
 void MapListPage::OnPostBegin() {
     Bui::Title(m_Title.c_str(), 0.07f);
 
-    auto *maps = dynamic_cast<MapMenu *>(m_Menu)->GetCurrentMaps();
+    auto *mapMenu = dynamic_cast<MapMenu *>(m_Menu);
+    // The tree may also have been replaced by a refresh while the menu was closed.
+    mapMenu->ApplyPendingMaps();
+    SyncSearchWithTree();
+
+    auto *maps = mapMenu->GetCurrentMaps();
     if (!maps || maps->children.empty()) {
         m_Count = 0;
+        if (mapMenu->IsRefreshing())
+            Bui::Title("Scanning maps...", 0.4f, 1.0f);
         return;
     }
 
@@ -300,18 +333,6 @@ void MapListPage::OnPostBegin() {
 
     ImGui::PopStyleColor();
 
-    // When not searching, ensure current directory entries are shown as "directories first, then by name"
-    if (!IsSearching() && !maps->children.empty()) {
-        try {
-            std::sort(maps->children.begin(), maps->children.end(), [](const MapEntry *lhs, const MapEntry *rhs) {
-                if (!lhs || !rhs) return false;
-                return *lhs < *rhs; // operator< implements dir-first then name
-            });
-        } catch (...) {
-            BML_GetModContext()->GetLogger()->Error("Failed to sort current directory entries");
-        }
-    }
-
     m_Count = IsSearching() ? static_cast<int>(m_MapSearchResult.size()) : static_cast<int>(maps->children.size());
     // Keep page count in sync with total entries (10 per page)
     SetPageCount(Bui::CalcPageCount(m_Count, 10));
@@ -355,6 +376,7 @@ void MapListPage::OnPreEnd() {
 }
 
 void MapListPage::OnDraw() {
+    SyncSearchWithTree();
     if (m_Count == 0)
         return;
 
@@ -400,86 +422,110 @@ bool MapListPage::IsSearching() const {
 void MapListPage::ClearSearch() {
     memset(m_MapSearchBuf, 0, sizeof(m_MapSearchBuf));
     m_MapSearchResult.clear();
+    m_SearchIds.clear();
+    m_LastQuery.clear();
+    m_LastScope = nullptr;
+}
+
+void MapListPage::SyncSearchWithTree() {
+    auto *mapMenu = dynamic_cast<MapMenu *>(m_Menu);
+    if (!mapMenu || m_SearchTreeVersion == mapMenu->GetTreeVersion())
+        return;
+
+    // Results, ids and scope all point into the replaced tree
+    m_MapSearchResult.clear();
+    m_SearchIds.clear();
+    m_LastQuery.clear();
+    m_LastScope = nullptr;
+    m_SearchTreeVersion = mapMenu->GetTreeVersion();
+    if (IsSearching())
+        OnSearchMaps();
 }
 
 void MapListPage::OnSearchMaps() {
     SetPage(0);
     m_MapSearchResult.clear();
 
-    if (!IsSearching())
+    auto *mapMenu = dynamic_cast<MapMenu *>(m_Menu);
+    m_SearchTreeVersion = mapMenu->GetTreeVersion();
+    // Search across subfolders of the current maps
+    auto *root = mapMenu->GetCurrentMaps();
+    if (!IsSearching() || !root) {
+        m_SearchIds.clear();
+        m_LastQuery.clear();
         return;
+    }
+
+    const MapSearchIndex &index = mapMenu->GetSearchIndex();
+    if (mapMenu->IsRegexSearch()) {
+        m_LastQuery.clear();
+        index.Collect(root->searchId, m_SearchIds);
+        if (!FilterByRegex())
+            return;
+    } else {
+        // A query containing the previous one can only match a subset of its results
+        std::string query = MapSearchIndex::FoldCase(m_MapSearchBuf);
+        if (!m_LastQuery.empty() && root == m_LastScope && query.find(m_LastQuery) != std::string::npos) {
+            index.Refine(query, m_SearchIds);
+        } else {
+            index.Search(query, root->searchId, m_SearchIds);
+        }
+        m_LastQuery = std::move(query);
+        m_LastScope = root;
+    }
 
+    // Ids come back in display order: directories first, then by name
+    m_MapSearchResult.reserve(m_SearchIds.size());
+    for (uint32_t id : m_SearchIds) {
+        if (MapEntry *entry = mapMenu->GetSearchEntry(id))
+            m_MapSearchResult.push_back(entry);
+    }
+}
+
+bool MapListPage::FilterByRegex() {
     auto *pattern = (OnigUChar *) m_MapSearchBuf;
     regex_t *reg = nullptr;
     OnigErrorInfo einfo;
 
-    try {
-        int r = onig_new(&reg, pattern, pattern + strlen((char *) pattern),
-                         ONIG_OPTION_DEFAULT, ONIG_ENCODING_UTF8, ONIG_SYNTAX_ASIS, &einfo);
-        if (r != ONIG_NORMAL) {
-            char s[ONIG_MAX_ERROR_MESSAGE_LEN];
-            onig_error_code_to_str((UChar *) s, r, &einfo);
-            BML_GetModContext()->GetLogger()->Error(s);
-            return;
-        }
-
-        // Depth-first traversal starting at current maps to search across subfolders
-        auto *root = dynamic_cast<MapMenu *>(m_Menu)->GetCurrentMaps();
-        if (!root) {
-            onig_free(reg);
-            return;
-        }
+    int r = onig_new(&reg, pattern, pattern + strlen((char *) pattern),
+                     ONIG_OPTION_DEFAULT, ONIG_ENCODING_UTF8, ONIG_SYNTAX_ASIS, &einfo);
+    if (r != ONIG_NORMAL) {
+        char s[ONIG_MAX_ERROR_MESSAGE_LEN];
+        onig_error_code_to_str((UChar *) s, r, &einfo);
+        BML_GetModContext()->GetLogger()->Error(s);
+        m_SearchIds.clear();
+        return false;
+    }
 
-        std::vector<MapEntry *> stack;
-        stack.reserve(64);
-        stack.push_back(root);
-
-        while (!stack.empty()) {
-            MapEntry *node = stack.back();
-            stack.pop_back();
-
-            for (MapEntry *child : node->children) {
-                if (!child) continue;
-
-                const auto &name = child->name;
-                const auto *end = (const UChar *) (name.c_str() + name.size());
-                const auto *start = (const UChar *) name.c_str();
-                const auto *range = end;
-
-                r = onig_search(reg, start, end, start, range, nullptr, ONIG_OPTION_NONE);
-                if (r >= 0) {
-                    m_MapSearchResult.push_back(child);
-                } else if (r != ONIG_MISMATCH) {
-                    char s[ONIG_MAX_ERROR_MESSAGE_LEN];
-                    onig_error_code_to_str((UChar *) s, r);
-                    BML_GetModContext()->GetLogger()->Error(s);
-                }
-
-                if (child->type == MAP_ENTRY_DIR) {
-                    stack.push_back(child);
-                }
+    auto *mapMenu = dynamic_cast<MapMenu *>(m_Menu);
+    try {
+        m_SearchIds.erase(std::remove_if(m_SearchIds.begin(), m_SearchIds.end(), [&](uint32_t id) {
+            const MapEntry *entry = mapMenu->GetSearchEntry(id);
+            if (!entry)
+                return true;
+
+            const auto &name = entry->name;
+            const auto *end = (const UChar *) (name.c_str() + name.size());
+            const auto *start = (const UChar *) name.c_str();
+            const auto *range = end;
+
+            int res = onig_search(reg, start, end, start, range, nullptr, ONIG_OPTION_NONE);
+            if (res >= 0)
+                return false;
+            if (res != ONIG_MISMATCH) {
+                char s[ONIG_MAX_ERROR_MESSAGE_LEN];
+                onig_error_code_to_str((UChar *) s, res);
+                BML_GetModContext()->GetLogger()->Error(s);
             }
-        }
+            return true;
+        }), m_SearchIds.end());
     } catch (...) {
-        if (reg)
-            onig_free(reg);
+        onig_free(reg);
         throw;
     }
 
-    if (reg)
-        onig_free(reg);
-
-    // Sort search results: directories first, then by name
-    if (!m_MapSearchResult.empty()) {
-        try {
-            std::sort(m_MapSearchResult.begin(), m_MapSearchResult.end(), [](const MapEntry *a, const MapEntry *b) {
-                if (a->type != b->type) return a->type < b->type; // MAP_ENTRY_DIR < MAP_ENTRY_FILE
-                return utils::CompareString(a->name, b->name) < 0;
-            });
-        } catch (...) {
-            BML_GetModContext()->GetLogger()->Error("Failed to sort search results");
-        }
-    }
+    onig_free(reg);
+    return true;
 }
 
 bool MapListPage::OnDrawEntry(MapEntry *entry, bool *v) {
@@ -1,12 +1,19 @@
 #ifndef BML_MAPMENU_H
 #define BML_MAPMENU_H
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <memory>
 
 #include "BML/Bui.h"
 
+#include "MapIndex.h"
+#include "MapSearchIndex.h"
+
 class BMLMod;
 class MapMenu;
 
@@ -21,6 +28,7 @@ struct MapEntry {
     std::string name;
     std::wstring path;
     std::vector<MapEntry *> children;
+    uint32_t searchId = MapSearchIndex::kInvalidId;
     bool m_BeingDeleted = false;
 
     explicit MapEntry(MapEntry *parent, MapEntryType entryType) : parent(parent), type(entryType) {}
@@ -54,7 +62,11 @@ public:
 private:
     bool IsSearching() const;
     void ClearSearch();
+    // Drops or redoes the search when its results point into a replaced tree.
+    void SyncSearchWithTree();
     void OnSearchMaps();
+    // Keeps the entries of m_SearchIds whose names match m_MapSearchBuf as a regex
+    bool FilterByRegex();
     // Draw by direct entry pointer (used for both normal list and recursive search results)
     bool OnDrawEntry(MapEntry *entry, bool *v);
 
@@ -63,6 +75,11 @@ private:
     char m_MapSearchBuf[1024] = {};
     // Store pointers to entries to support recursive results across subfolders
     std::vector<MapEntry *> m_MapSearchResult;
+    // Last plain-text search, kept so that typing more characters only narrows it
+    std::vector<uint32_t> m_SearchIds;
+    std::string m_LastQuery; // Case-folded
+    const MapEntry *m_LastScope = nullptr;
+    uint32_t m_SearchTreeVersion = 0;
 };
 
 class MapMenu : public Bui::Menu {
@@ -76,13 +93,27 @@ public:
     void OnOpen() override;
     void OnClose() override;
     void OnClose(bool backToMenu);
+    void Shutdown();
 
     void LoadMap(const std::wstring &path);
     MapEntry *GetMaps() const { return m_Maps; }
     MapEntry *GetCurrentMaps() const { return m_Current; }
     void SetCurrentMaps(MapEntry *entry) { m_Current = entry; }
     void ResetCurrentMaps() { m_Current = m_Maps; }
+
+    // Starts a background rescan of the Maps directory. Only directories whose
+    // write time changed since the last scan (or the on-disk cache) are listed
+    // again. The result is swapped in by ApplyPendingMaps on the game thread.
     void RefreshMaps();
+    // Installs a finished scan. Returns true if the entry tree was replaced,
+    // which invalidates every MapEntry pointer taken from the old tree.
+    bool ApplyPendingMaps();
+    // Bumped each time the entry tree is replaced, whoever installed the scan.
+    uint32_t GetTreeVersion() const { return m_TreeVersion; }
+    bool IsRefreshing() const { return m_Refreshing.load(std::memory_order_acquire); }
+
+    const MapSearchIndex &GetSearchIndex() const { return m_SearchIndex; }
+    MapEntry *GetSearchEntry(uint32_t id) const { return id < m_SearchEntries.size() ? m_SearchEntries[id] : nullptr; }
 
     bool ShouldShowTooltip() const { return m_ShowTooltip; }
     void SetShowTooltip(bool show) { m_ShowTooltip = show; }
@@ -90,16 +121,49 @@ public:
     int GetMaxDepth() const { return m_MaxDepth; }
     void SetMaxDepth(int depth) { m_MaxDepth = depth; }
 
+    bool IsRegexSearch() const { return m_RegexSearch; }
+    void SetRegexSearch(bool regex) { m_RegexSearch = regex; }
+
 private:
-    bool ExploreMaps(MapEntry *maps, int depth = 8);
-    static bool IsSupportedFileType(const std::wstring &path);
+    struct ScanResult {
+        MapIndexDirectory index;
+        MapIndexScanStats stats;
+        std::unique_ptr<MapEntry> maps;
+        MapSearchIndex search;
+        std::vector<MapEntry *> searchEntries;
+        int maxDepth = 0;
+        bool fromCache = false;
+        bool completed = false;
+        bool changed = false;
+    };
+
+    void RunScan(std::wstring root, std::wstring cacheFile, int maxDepth, MapIndexDirectory previous, bool loadCache);
+    void JoinScan();
+    static void BuildEntries(const std::wstring &root, const MapIndexDirectory &index, ScanResult &result);
+    static void AddEntries(MapEntry *parent, const MapIndexDirectory &directory, ScanResult &result);
+    static MapEntry *FindEntryByPath(MapEntry *root, const std::wstring &path);
 
     BMLMod *m_Mod;
     bool m_MapLoaded = false;
     bool m_ShowTooltip = false;
+    bool m_RegexSearch = false;
     int m_MaxDepth = 8;
     MapEntry *m_Maps = nullptr;
     MapEntry *m_Current = nullptr;
+    uint32_t m_TreeVersion = 0;
+    MapSearchIndex m_SearchIndex;
+    std::vector<MapEntry *> m_SearchEntries; // Indexed by MapEntry::searchId
+
+    // Background scan state. The scan thread owns the previous index while it
+    // runs and hands index and entry tree back through m_PendingScan.
+    std::thread m_ScanThread;
+    std::atomic<bool> m_Refreshing{false};
+    std::atomic<bool> m_CancelScan{false};
+    std::mutex m_ScanMutex;
+    std::unique_ptr<ScanResult> m_PendingScan;
+    MapIndexDirectory m_Index;
+    int m_IndexDepth = -1;
+    bool m_RefreshQueued = false;
 };
 
 #endif // BML_MAPMENU_H
@@ -0,0 +1,176 @@
+#include "MapSearchIndex.h"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <utility>
+
+#include "StringUtils.h"
+
+namespace {
+    uint32_t PackTrigram(const char *p) {
+        return static_cast<uint32_t>(static_cast<unsigned char>(p[0])) << 16 |
+               static_cast<uint32_t>(static_cast<unsigned char>(p[1])) << 8 |
+               static_cast<uint32_t>(static_cast<unsigned char>(p[2]));
+    }
+
+    void CollectTrigrams(std::string_view text, std::vector<uint32_t> &out) {
+        out.clear();
+        if (text.size() < 3)
+            return;
+        for (size_t i = 0; i + 3 <= text.size(); ++i)
+            out.push_back(PackTrigram(text.data() + i));
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+}
+
+void MapSearchIndex::Clear() {
+    m_Entries.clear();
+    m_RankToId.clear();
+    m_Trigrams.clear();
+    m_Offsets.clear();
+    m_Postings.clear();
+}
+
+void MapSearchIndex::Reserve(size_t count) {
+    m_Entries.reserve(count);
+}
+
+uint32_t MapSearchIndex::Add(const std::string &name, bool directory, uint32_t parent) {
+    const auto id = static_cast<uint32_t>(m_Entries.size());
+    Entry &entry = m_Entries.emplace_back();
+    entry.name = name;
+    entry.folded = FoldCase(name);
+    entry.parent = parent;
+    entry.subtreeEnd = id + 1;
+    entry.directory = directory;
+
+    for (uint32_t p = parent; p != kInvalidId; p = m_Entries[p].parent)
+        m_Entries[p].subtreeEnd = id + 1;
+    return id;
+}
+
+void MapSearchIndex::Build() {
+    const auto count = static_cast<uint32_t>(m_Entries.size());
+
+    // Same order the list used to be sorted into after every search
+    m_RankToId.resize(count);
+    std::iota(m_RankToId.begin(), m_RankToId.end(), 0u);
+    std::stable_sort(m_RankToId.begin(), m_RankToId.end(), [this](uint32_t lhs, uint32_t rhs) {
+        const Entry &a = m_Entries[lhs];
+        const Entry &b = m_Entries[rhs];
+        if (a.directory != b.directory)
+            return a.directory;
+        return utils::CompareString(a.name, b.name) < 0;
+    });
+
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    std::vector<uint32_t> trigrams;
+    for (uint32_t rank = 0; rank < count; ++rank) {
+        CollectTrigrams(m_Entries[m_RankToId[rank]].folded, trigrams);
+        for (uint32_t trigram : trigrams)
+            pairs.emplace_back(trigram, rank);
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    m_Trigrams.clear();
+    m_Offsets.clear();
+    m_Postings.clear();
+    m_Postings.reserve(pairs.size());
+    for (const auto &[trigram, rank] : pairs) {
+        if (m_Trigrams.empty() || m_Trigrams.back() != trigram) {
+            m_Trigrams.push_back(trigram);
+            m_Offsets.push_back(static_cast<uint32_t>(m_Postings.size()));
+        }
+        m_Postings.push_back(rank);
+    }
+    m_Offsets.push_back(static_cast<uint32_t>(m_Postings.size()));
+}
+
+void MapSearchIndex::Search(std::string_view query, uint32_t scope, std::vector<uint32_t> &out) const {
+    out.clear();
+    if (scope >= m_Entries.size())
+        return;
+
+    const std::string folded = FoldCase(query);
+    std::vector<uint32_t> trigrams;
+    CollectTrigrams(folded, trigrams);
+    if (trigrams.empty()) {
+        // Too short to use the index; the names are scanned directly.
+        for (uint32_t id : m_RankToId) {
+            if (InScope(id, scope) && Matches(id, folded))
+                out.push_back(id);
+        }
+        return;
+    }
+
+    std::vector<std::pair<const uint32_t *, size_t>> lists;
+    lists.reserve(trigrams.size());
+    for (uint32_t trigram : trigrams) {
+        size_t count = 0;
+        const uint32_t *postings = FindPostings(trigram, count);
+        if (!postings)
+            return;
+        lists.emplace_back(postings, count);
+    }
+
+    // Intersect starting from the rarest trigram to keep the candidate set small
+    std::sort(lists.begin(), lists.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.second < rhs.second;
+    });
+    std::vector<uint32_t> ranks(lists[0].first, lists[0].first + lists[0].second);
+    std::vector<uint32_t> narrowed;
+    for (size_t i = 1; i < lists.size() && !ranks.empty(); ++i) {
+        narrowed.clear();
+        std::set_intersection(ranks.begin(), ranks.end(),
+                              lists[i].first, lists[i].first + lists[i].second,
+                              std::back_inserter(narrowed));
+        ranks.swap(narrowed);
+    }
+
+    // Sharing all trigrams does not guarantee the whole query is a substring
+    for (uint32_t rank : ranks) {
+        const uint32_t id = m_RankToId[rank];
+        if (InScope(id, scope) && Matches(id, folded))
+            out.push_back(id);
+    }
+}
+
+void MapSearchIndex::Refine(std::string_view query, std::vector<uint32_t> &results) const {
+    const std::string folded = FoldCase(query);
+    results.erase(std::remove_if(results.begin(), results.end(), [&](uint32_t id) {
+        return id >= m_Entries.size() || !Matches(id, folded);
+    }), results.end());
+}
+
+void MapSearchIndex::Collect(uint32_t scope, std::vector<uint32_t> &out) const {
+    out.clear();
+    if (scope >= m_Entries.size())
+        return;
+    for (uint32_t id : m_RankToId) {
+        if (InScope(id, scope))
+            out.push_back(id);
+    }
+}
+
+std::string MapSearchIndex::FoldCase(std::string_view text) {
+    // ASCII only, so multi-byte UTF-8 sequences are never altered
+    std::string folded(text);
+    for (char &c : folded) {
+        if (c >= 'A' && c <= 'Z')
+            c = static_cast<char>(c - 'A' + 'a');
+    }
+    return folded;
+}
+
+const uint32_t *MapSearchIndex::FindPostings(uint32_t trigram, size_t &count) const {
+    const auto it = std::lower_bound(m_Trigrams.begin(), m_Trigrams.end(), trigram);
+    if (it == m_Trigrams.end() || *it != trigram) {
+        count = 0;
+        return nullptr;
+    }
+    const size_t index = it - m_Trigrams.begin();
+    count = m_Offsets[index + 1] - m_Offsets[index];
+    return m_Postings.data() + m_Offsets[index];
+}
@@ -0,0 +1,72 @@
+#ifndef BML_MAPSEARCHINDEX_H
+#define BML_MAPSEARCHINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Substring search over the names of the map tree.
+ *
+ * Entries are added in depth-first preorder and identified by their insertion
+ * index, so the subtree of a directory is a contiguous id range. Names are
+ * folded to ASCII lowercase and every distinct byte trigram gets a posting
+ * list. The posting lists hold display ranks (directories first, then natural
+ * name order) instead of ids, so an intersection comes out already sorted for
+ * display.
+ */
+class MapSearchIndex {
+public:
+    static constexpr uint32_t kInvalidId = UINT32_MAX;
+
+    void Clear();
+    void Reserve(size_t count);
+
+    // Must be called in preorder. parent is kInvalidId for the root.
+    uint32_t Add(const std::string &name, bool directory, uint32_t parent);
+    // Computes display ranks and posting lists; call once after the last Add.
+    void Build();
+
+    size_t Size() const { return m_Entries.size(); }
+    bool Empty() const { return m_Entries.empty(); }
+
+    // Ids of every entry below scope whose name contains query, compared
+    // case-insensitively for ASCII, in display order.
+    void Search(std::string_view query, uint32_t scope, std::vector<uint32_t> &out) const;
+    // Narrows an earlier result for a query that contains the earlier one.
+    void Refine(std::string_view query, std::vector<uint32_t> &results) const;
+    // Ids of every entry below scope, in display order.
+    void Collect(uint32_t scope, std::vector<uint32_t> &out) const;
+
+    static std::string FoldCase(std::string_view text);
+
+private:
+    struct Entry {
+        std::string name;
+        std::string folded;
+        uint32_t parent = kInvalidId;
+        uint32_t subtreeEnd = 0; // One past the last descendant id
+        bool directory = false;
+    };
+
+    bool InScope(uint32_t id, uint32_t scope) const {
+        return id > scope && id < m_Entries[scope].subtreeEnd;
+    }
+    bool Matches(uint32_t id, std::string_view folded) const {
+        return m_Entries[id].folded.find(folded) != std::string::npos;
+    }
+    const uint32_t *FindPostings(uint32_t trigram, size_t &count) const;
+
+    std::vector<Entry> m_Entries;
+    std::vector<uint32_t> m_RankToId;
+
+    // Posting lists in CSR form: m_Postings[m_Offsets[i], m_Offsets[i + 1])
+    // are the ranks of the names containing m_Trigrams[i].
+    std::vector<uint32_t> m_Trigrams;
+    std::vector<uint32_t> m_Offsets;
+    std::vector<uint32_t> m_Postings;
+};
+
+#endif // BML_MAPSEARCHINDEX_H
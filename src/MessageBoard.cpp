@@ -24,38 +24,20 @@ void MessageBoard::MessageUnit::SetMessage(const char *msg) {
     if (!msg) return;
 
     ansiText.SetText(msg);
-    cachedHeight = -1.0f;
-    cachedWrapWidth = -1.0f;
-    cachedLineSpacing = -1.0f;
-    cachedFontPixels = -1.0f;
 }
 
-float MessageBoard::MessageUnit::GetTextHeight(float wrapWidth, float lineSpacing, int tabColumns) const {
-    const float fontPixelSize = ImGui::GetFontSize();
-    if (cachedHeight >= 0.0f && std::abs(cachedWrapWidth - wrapWidth) < 0.5f &&
-        std::abs(cachedLineSpacing - lineSpacing) < 0.5f &&
-        std::fabs(cachedFontPixels - fontPixelSize) < 1e-3f)
-        return cachedHeight;
-
+float MessageBoard::MessageUnit::CalcTextHeight(float wrapWidth, float lineSpacing, int tabColumns) const {
     AnsiText::TextOptions measure;
     measure.font = ImGui::GetFont();
     measure.wrapWidth = wrapWidth;
     measure.lineSpacing = lineSpacing;
     measure.tabColumns = tabColumns;
-    cachedHeight = AnsiText::CalcTextHeight(ansiText, measure);
-    cachedWrapWidth = wrapWidth;
-    cachedLineSpacing = lineSpacing;
-    cachedFontPixels = fontPixelSize;
-    return cachedHeight;
+    return AnsiText::CalcTextHeight(ansiText, measure);
 }
 
 void MessageBoard::MessageUnit::Reset() {
     ansiText.Clear();
     timer = 0.0f;
-    cachedHeight = -1.0f;
-    cachedWrapWidth = -1.0f;
-    cachedLineSpacing = -1.0f;
-    cachedFontPixels = -1.0f;
 }
 
 // =============================================================================
@@ -130,6 +112,12 @@ void MessageBoard::ScrollToBottom() {
 // Height Calculation System
 // =============================================================================
 
+int MessageBoard::SlotOf(int logical) const {
+    const int capacity = static_cast<int>(m_Messages.size());
+    const int slot = m_MessageHead + logical;
+    return slot >= capacity ? slot - capacity : slot;
+}
+
 bool MessageBoard::ShouldShowMessage(const MessageUnit &msg) const {
     return m_IsCommandBarVisible || msg.GetTimer() > 0;
 }
@@ -148,16 +136,6 @@ float MessageBoard::GetMessageAlpha(const MessageUnit &msg) const {
     return std::min(maxAlpha255, msg.GetTimer() / 20.0f) / 255.0f;
 }
 
-int MessageBoard::CountVisibleMessages() const {
-    int count = 0;
-    for (int i = 0; i < m_MessageCount; i++) {
-        if (ShouldShowMessage(m_Messages[i])) {
-            count++;
-        }
-    }
-    return count;
-}
-
 bool MessageBoard::HasVisibleContent() const {
     if (m_IsCommandBarVisible) {
         return m_MessageCount > 0;
@@ -165,20 +143,111 @@ bool MessageBoard::HasVisibleContent() const {
     return m_DisplayMessageCount > 0;
 }
 
-float MessageBoard::CalculateContentHeight(float wrapWidth) const {
-    float contentHeight = 0.0f;
-    int visibleCount = 0;
+const MessageBoard::HistoryLayout &MessageBoard::EnsureLayout(float wrapWidth) {
+    const float fontPixelSize = ImGui::GetFontSize();
 
-    for (int i = 0; i < m_MessageCount; i++) {
-        const MessageUnit &msg = m_Messages[i];
-        if (ShouldShowMessage(msg)) {
-            contentHeight += msg.GetTextHeight(wrapWidth, m_MessageGap, m_TabColumns);
-            visibleCount++;
+    // Pick the cached layout for this key, otherwise recycle the least recently used one.
+    // Two entries cover the with/without scrollbar widths used in the same frame.
+    HistoryLayout *layout = nullptr;
+    for (auto &candidate : m_Layouts) {
+        if (candidate.valid && candidate.generation == m_LayoutGeneration &&
+            std::abs(candidate.wrapWidth - wrapWidth) < 0.5f &&
+            std::abs(candidate.lineSpacing - m_MessageGap) < 0.5f &&
+            std::fabs(candidate.fontPixels - fontPixelSize) < 1e-3f &&
+            candidate.tabColumns == m_TabColumns) {
+            layout = &candidate;
+            break;
         }
     }
 
-    if (visibleCount > 1)
-        contentHeight += m_MessageGap * (visibleCount - 1);
+    const int capacity = static_cast<int>(m_Messages.size());
+    if (!layout) {
+        layout = m_Layouts[0].lastUsed <= m_Layouts[1].lastUsed ? &m_Layouts[0] : &m_Layouts[1];
+        layout->wrapWidth = wrapWidth;
+        layout->lineSpacing = m_MessageGap;
+        layout->fontPixels = fontPixelSize;
+        layout->tabColumns = m_TabColumns;
+        layout->generation = m_LayoutGeneration;
+        layout->valid = true;
+        layout->heights.assign(capacity, 0.0f);
+        layout->tops.assign(capacity, 0.0);
+        layout->end = 0.0;
+        layout->appendedCount = m_AppendedCount;
+        for (int i = 0; i < m_MessageCount; ++i)
+            AppendToLayout(*layout, i);
+    } else if (layout->appendedCount != m_AppendedCount) {
+        // Only the newest messages need measuring; older prefix sums stay valid.
+        const uint64_t pending = m_AppendedCount - layout->appendedCount;
+        const int appended = static_cast<int>(std::min<uint64_t>(pending, static_cast<uint64_t>(m_MessageCount)));
+        if (pending > static_cast<uint64_t>(m_MessageCount))
+            layout->end = 0.0;
+        for (int i = m_MessageCount - appended; i < m_MessageCount; ++i)
+            AppendToLayout(*layout, i);
+        layout->appendedCount = m_AppendedCount;
+    }
+
+    layout->lastUsed = ++m_LayoutClock;
+    return *layout;
+}
+
+void MessageBoard::AppendToLayout(HistoryLayout &layout, int logical) const {
+    const int slot = SlotOf(logical);
+    const float height = m_Messages[slot].CalcTextHeight(layout.wrapWidth, layout.lineSpacing, layout.tabColumns);
+    layout.heights[slot] = height;
+    layout.tops[slot] = layout.end;
+    layout.end += height + layout.lineSpacing;
+}
+
+int MessageBoard::FindFirstBottomAtOrAfter(const HistoryLayout &layout, double y) const {
+    int lo = 0;
+    int hi = m_MessageCount;
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        const int slot = SlotOf(mid);
+        if (layout.tops[slot] + layout.heights[slot] < y)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+int MessageBoard::FindFirstTopAfter(const HistoryLayout &layout, double y) const {
+    int lo = 0;
+    int hi = m_MessageCount;
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        if (layout.tops[SlotOf(mid)] <= y)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+float MessageBoard::CalculateContentHeight(float wrapWidth) {
+    float contentHeight = 0.0f;
+    if (m_MessageCount > 0) {
+        const HistoryLayout &layout = EnsureLayout(wrapWidth);
+        if (m_IsCommandBarVisible) {
+            // Every message is shown: the prefix sums give the span directly.
+            const int first = SlotOf(0);
+            const int last = SlotOf(m_MessageCount - 1);
+            contentHeight = static_cast<float>(layout.tops[last] + layout.heights[last] - layout.tops[first]);
+        } else {
+            int visibleCount = 0;
+            for (int i = m_FirstActiveMessage; i < m_MessageCount; i++) {
+                const int slot = SlotOf(i);
+                if (ShouldShowMessage(m_Messages[slot])) {
+                    contentHeight += layout.heights[slot];
+                    visibleCount++;
+                }
+            }
+
+            if (visibleCount > 1)
+                contentHeight += m_MessageGap * (visibleCount - 1);
+        }
+    }
 
     // Return pure content height (no padding)
     return std::max(contentHeight, ImGui::GetTextLineHeightWithSpacing());
@@ -289,52 +358,43 @@ void MessageBoard::OnDraw() {
 }
 
 void MessageBoard::RenderMessages(ImDrawList *drawList, ImVec2 startPos, float wrapWidth) {
-    ImVec4 bgColorBase = m_HasCustomMessageBg ? m_MessageBgColor : Bui::GetMenuColor();
-
-    // Prepare visible indices (display order: newest first) and cached heights
-    std::vector<int> indices;
-    indices.reserve(m_MessageCount);
-    std::vector<float> heights;
-    heights.reserve(m_MessageCount);
-
-    for (int i = m_MessageCount - 1; i >= 0; --i) {
-        const MessageUnit &msg = m_Messages[i];
-        const bool shouldShow = m_IsCommandBarVisible || ShouldShowMessage(msg);
-        if (!shouldShow)
-            continue;
-        indices.push_back(i);
-        heights.push_back(msg.GetTextHeight(wrapWidth, m_MessageGap, m_TabColumns));
-    }
-
-    const int n = (int)indices.size();
-    if (n == 0)
+    if (m_MessageCount == 0)
         return;
 
-    // Precompute offsets (top Y of each message relative to startPos.y) and bottoms
-    std::vector<float> offsets;
-    offsets.resize(n);
-    std::vector<float> bottoms;
-    bottoms.resize(n);
-    float acc = 0.0f;
-    for (int j = 0; j < n; ++j) {
-        offsets[j] = acc;
-        const float h = heights[j];
-        bottoms[j] = acc + h;                 // bottom Y (relative)
-        acc += h + m_MessageGap;              // advance incl. gap (gap after last is harmless)
-    }
+    const ImVec4 bgColorBase = m_HasCustomMessageBg ? m_MessageBgColor : Bui::GetMenuColor();
+    const HistoryLayout &layout = EnsureLayout(wrapWidth);
 
-    // Determine visible index range against current clip rect
+    // Determine visible range against current clip rect
     const ImVec2 clip_min = drawList->GetClipRectMin();
     const ImVec2 clip_max = drawList->GetClipRectMax();
     const float clipMinRel = clip_min.y - startPos.y;
     const float clipMaxRel = clip_max.y - startPos.y;
 
-    auto lb = std::lower_bound(bottoms.begin(), bottoms.end(), clipMinRel);
-    int begin = (int)std::distance(bottoms.begin(), lb);
-    auto ub = std::upper_bound(offsets.begin(), offsets.end(), clipMaxRel);
-    int end = (int)std::distance(offsets.begin(), ub);
-    begin = std::clamp(begin, 0, n);
-    end = std::clamp(end, begin, n);
+    if (!m_IsCommandBarVisible) {
+        // Only the tail of unexpired messages can be shown; lay them out back to back.
+        float offset = 0.0f;
+        for (int i = m_FirstActiveMessage; i < m_MessageCount; ++i) {
+            const int slot = SlotOf(i);
+            const MessageUnit &msg = m_Messages[slot];
+            if (!ShouldShowMessage(msg))
+                continue;
+            const float msgHeight = layout.heights[slot];
+            if (offset + msgHeight >= clipMinRel && offset <= clipMaxRel) {
+                const ImVec2 pos = ImVec2(startPos.x, startPos.y + offset);
+                ImGui::SetCursorScreenPos(pos);
+                DrawMessage(drawList, msg, bgColorBase, pos, msgHeight, wrapWidth);
+                ImGui::ItemSize(ImVec2(0.0f, msgHeight + m_MessageGap));
+            }
+            offset += msgHeight + m_MessageGap;
+        }
+        return;
+    }
+
+    // All messages are shown (display order: oldest first); binary search the prefix sums.
+    const double base = layout.tops[SlotOf(0)];
+    const int n = m_MessageCount;
+    const int begin = std::clamp(FindFirstBottomAtOrAfter(layout, base + clipMinRel), 0, n);
+    const int end = std::clamp(FindFirstTopAfter(layout, base + clipMaxRel), begin, n);
 
     // Use ImGuiListClipper to iterate the visible range (for correctness and consistency with other code)
     ImGuiListClipper clipper;
@@ -347,29 +407,14 @@ void MessageBoard::RenderMessages(ImDrawList *drawList, ImVec2 startPos, float w
         const int ds = ImMax(clipper.DisplayStart, begin);
         const int de = ImMin(clipper.DisplayEnd, end);
         for (int j = ds; j < de; ++j) {
-            const int i = indices[j];
-            const MessageUnit &msg = m_Messages[i];
-            const float msgHeight = heights[j];
-            ImVec2 pos = ImVec2(startPos.x, startPos.y + offsets[j]);
+            const int slot = SlotOf(j);
+            const float msgHeight = layout.heights[slot];
+            const ImVec2 pos = ImVec2(startPos.x, startPos.y + static_cast<float>(layout.tops[slot] - base));
 
             // Keep ImGui cursor in sync with the draw position so nested clippers work while scrolling.
             ImGui::SetCursorScreenPos(pos);
 
-            const float alpha = GetMessageAlpha(msg);
-            if (alpha > 0.0f) {
-                const float finalAlpha = std::clamp(bgColorBase.w * std::clamp(m_MessageBgAlphaScale, 0.0f, 1.0f) * alpha, 0.0f, 1.0f);
-                if (finalAlpha > 0.0f) {
-                    const ImVec4 bg = ImVec4(bgColorBase.x, bgColorBase.y, bgColorBase.z, finalAlpha);
-                    drawList->AddRectFilled(
-                        ImVec2(pos.x - m_PadX * 0.5f, pos.y - m_PadY * 0.25f),
-                        ImVec2(pos.x + wrapWidth + m_PadX * 0.5f, pos.y + msgHeight + m_PadY * 0.25f),
-                        ImGui::GetColorU32(bg)
-                    );
-                }
-
-                // Text
-                DrawMessageText(drawList, msg, pos, wrapWidth, alpha);
-            }
+            DrawMessage(drawList, m_Messages[slot], bgColorBase, pos, msgHeight, wrapWidth);
 
             // Feed clipper a logical item advance (height + gap). We don't rely on its cursor for drawing.
             ImGui::ItemSize(ImVec2(0.0f, msgHeight + m_MessageGap));
@@ -377,6 +422,25 @@ void MessageBoard::RenderMessages(ImDrawList *drawList, ImVec2 startPos, float w
     }
 }
 
+void MessageBoard::DrawMessage(ImDrawList *drawList, const MessageUnit &message, const ImVec4 &bgColorBase, const ImVec2 &pos, float height, float wrapWidth) {
+    const float alpha = GetMessageAlpha(message);
+    if (alpha <= 0.0f)
+        return;
+
+    const float finalAlpha = std::clamp(bgColorBase.w * std::clamp(m_MessageBgAlphaScale, 0.0f, 1.0f) * alpha, 0.0f, 1.0f);
+    if (finalAlpha > 0.0f) {
+        const ImVec4 bg = ImVec4(bgColorBase.x, bgColorBase.y, bgColorBase.z, finalAlpha);
+        drawList->AddRectFilled(
+            ImVec2(pos.x - m_PadX * 0.5f, pos.y - m_PadY * 0.25f),
+            ImVec2(pos.x + wrapWidth + m_PadX * 0.5f, pos.y + height + m_PadY * 0.25f),
+            ImGui::GetColorU32(bg)
+        );
+    }
+
+    // Text
+    DrawMessageText(drawList, message, pos, wrapWidth, alpha);
+}
+
 void MessageBoard::DrawMessageText(ImDrawList *drawList, const MessageUnit &message, const ImVec2 &startPos, float wrapWidth, float alpha) {
     AnsiText::TextOptions drawOptions;
     drawOptions.font = ImGui::GetFont();
@@ -426,11 +490,7 @@ void MessageBoard::UpdateScrollBounds(float contentHeight, float availableHeight
 }
 
 void MessageBoard::InvalidateLayoutCache() {
-    for (auto &m : m_Messages) {
-        m.cachedHeight = -1.0f;
-        m.cachedWrapWidth = -1.0f;
-        m.cachedLineSpacing = -1.0f;
-    }
+    ++m_LayoutGeneration;
 }
 
 void MessageBoard::DrawScrollIndicators(ImDrawList *drawList, const ImVec2 &contentPos, const ImVec2 &contentSize, float contentHeight, float visibleHeight) {
@@ -513,15 +573,19 @@ std::string MessageBoard::FormatScrollPercent(float contentHeight, float visible
 // =============================================================================
 
 void MessageBoard::UpdateTimers(float deltaTime) {
-    for (int i = 0; i < m_MessageCount; i++) {
-        if (m_Messages[i].timer > 0.0f) {
-            m_Messages[i].timer -= deltaTime;
-            if (m_Messages[i].timer <= 0.0f) {
-                m_Messages[i].timer = 0.0f;
+    for (int i = m_FirstActiveMessage; i < m_MessageCount; i++) {
+        MessageUnit &msg = MessageAt(i);
+        if (msg.timer > 0.0f) {
+            msg.timer -= deltaTime;
+            if (msg.timer <= 0.0f) {
+                msg.timer = 0.0f;
                 --m_DisplayMessageCount;
             }
         }
     }
+
+    while (m_FirstActiveMessage < m_MessageCount && MessageAt(m_FirstActiveMessage).timer <= 0.0f)
+        ++m_FirstActiveMessage;
 }
 
 void MessageBoard::AddMessageInternal(const char *msg) {
@@ -530,24 +594,24 @@ void MessageBoard::AddMessageInternal(const char *msg) {
     if (msg[0] == '\0')
         msg = "\n"; // treat empty messages as newlines
 
-    // Update display count
-    if (m_MessageCount == static_cast<int>(m_Messages.size()) && m_Messages[m_MessageCount - 1].GetTimer() > 0) {
-        --m_DisplayMessageCount;
-    }
-
-    // Shift messages
-    const int shiftCount = std::min(m_MessageCount, static_cast<int>(m_Messages.size()) - 1);
-    for (int i = shiftCount - 1; i >= 0; i--) {
-        m_Messages[i + 1] = std::move(m_Messages[i]);
-    }
-
-    // Add new message
-    m_Messages[0] = MessageUnit(msg, m_MaxTimer);
-
-    if (m_MessageCount < static_cast<int>(m_Messages.size())) {
+    const int capacity = static_cast<int>(m_Messages.size());
+    if (m_MessageCount == capacity) {
+        // Full: the new message takes the oldest slot
+        MessageUnit &oldest = m_Messages[m_MessageHead];
+        if (oldest.GetTimer() > 0) {
+            --m_DisplayMessageCount;
+        }
+        oldest = MessageUnit(msg, m_MaxTimer);
+        m_MessageHead = (m_MessageHead + 1) % capacity;
+        if (m_FirstActiveMessage > 0) {
+            --m_FirstActiveMessage;
+        }
+    } else {
+        MessageAt(m_MessageCount) = MessageUnit(msg, m_MaxTimer);
         ++m_MessageCount;
     }
     ++m_DisplayMessageCount;
+    ++m_AppendedCount;
 
     // Auto-scroll to bottom for new messages
     if (m_IsCommandBarVisible && (m_ScrollToBottom || m_MaxScrollY <= 0.0f)) {
@@ -606,18 +670,30 @@ void MessageBoard::PrintfColored(ImU32 color, const char *format, ...) {
 }
 
 void MessageBoard::ClearMessages() {
+    m_MessageHead = 0;
     m_MessageCount = 0;
     m_DisplayMessageCount = 0;
+    m_FirstActiveMessage = 0;
     for (auto &message : m_Messages) {
         message.Reset();
     }
+    InvalidateLayoutCache();
 }
 
 void MessageBoard::ResizeMessages(int size) {
     if (size < 1) return;
 
-    m_Messages.resize(size);
-    m_MessageCount = std::min(m_MessageCount, size);
+    // Unroll the ring, keeping the newest messages when shrinking
+    const int kept = std::min(m_MessageCount, size);
+    const int dropped = m_MessageCount - kept;
+    std::vector<MessageUnit> messages(size);
+    for (int i = 0; i < kept; ++i) {
+        messages[i] = std::move(MessageAt(dropped + i));
+    }
+    m_Messages = std::move(messages);
+    m_MessageHead = 0;
+    m_MessageCount = kept;
+    m_FirstActiveMessage = std::max(0, m_FirstActiveMessage - dropped);
 
     // Recount displayed messages since truncation may have removed active-timer entries
     int displayed = 0;
@@ -626,6 +702,7 @@ void MessageBoard::ResizeMessages(int size) {
             ++displayed;
     }
     m_DisplayMessageCount = displayed;
+    InvalidateLayoutCache();
 }
 
 // =============================================================================
@@ -1,6 +1,7 @@
 #ifndef BML_MESSAGEBOARD_H
 #define BML_MESSAGEBOARD_H
 
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <algorithm>
@@ -26,6 +27,10 @@
  *
  * Scrolling controls (when command bar visible AND content overflows):
  * - Mouse wheel: Scroll up/down
+ *
+ * History is a ring buffer; per-message heights and their prefix sums are
+ * cached per wrap width, so adding a message and picking the visible range
+ * stay cheap even with very large histories.
  */
 class MessageBoard : public Bui::Window {
 public:
@@ -35,10 +40,6 @@ public:
     struct MessageUnit {
         AnsiText::AnsiString ansiText;
         float timer = 0.0f;
-        mutable float cachedHeight = -1.0f;
-        mutable float cachedWrapWidth = -1.0f;
-        mutable float cachedLineSpacing = -1.0f;
-        mutable float cachedFontPixels = -1.0f;
 
         MessageUnit() = default;
         MessageUnit(const char *msg, float timer);
@@ -52,7 +53,7 @@ public:
         void SetMessage(const char *msg);
         float GetTimer() const { return timer; }
         void SetTimer(float t) { timer = t; }
-        float GetTextHeight(float wrapWidth, float lineSpacing, int tabColumns) const;
+        float CalcTextHeight(float wrapWidth, float lineSpacing, int tabColumns) const;
         const std::vector<TextSegment> &GetSegments() const { return ansiText.GetSegments(); }
         void Reset();
     };
@@ -132,18 +133,44 @@ protected:
     void OnPostEnd() override;
 
 private:
+    // Heights and cumulative tops of the history laid out at one wrap width,
+    // indexed by ring slot. Tops are absolute and only grow, so appending a
+    // message extends the prefix sums without touching older entries.
+    struct HistoryLayout {
+        float wrapWidth = -1.0f;
+        float lineSpacing = -1.0f;
+        float fontPixels = -1.0f;
+        int tabColumns = 0;
+        uint32_t generation = 0;
+        uint64_t appendedCount = 0;
+        uint64_t lastUsed = 0;
+        bool valid = false;
+        double end = 0.0;            // Top of the next appended message
+        std::vector<float> heights;
+        std::vector<double> tops;
+    };
+
+    // Ring buffer addressing (logical 0 = oldest)
+    int SlotOf(int logical) const;
+    const MessageUnit &MessageAt(int logical) const { return m_Messages[SlotOf(logical)]; }
+    MessageUnit &MessageAt(int logical) { return m_Messages[SlotOf(logical)]; }
+
     // Visibility and state
     bool ShouldShowMessage(const MessageUnit &msg) const;
     float GetMessageAlpha(const MessageUnit &msg) const;
-    int CountVisibleMessages() const;
     bool HasVisibleContent() const;
 
     // Layout calculation
-    float CalculateContentHeight(float wrapWidth) const;
+    const HistoryLayout &EnsureLayout(float wrapWidth);
+    void AppendToLayout(HistoryLayout &layout, int logical) const;
+    int FindFirstBottomAtOrAfter(const HistoryLayout &layout, double y) const;
+    int FindFirstTopAfter(const HistoryLayout &layout, double y) const;
+    float CalculateContentHeight(float wrapWidth);
     float CalculateDisplayHeight(float contentHeight) const;
 
     // Rendering
     void RenderMessages(ImDrawList *drawList, ImVec2 startPos, float wrapWidth);
+    void DrawMessage(ImDrawList *drawList, const MessageUnit &message, const ImVec4 &bgColorBase, const ImVec2 &pos, float height, float wrapWidth);
     void DrawMessageText(ImDrawList *drawList, const MessageUnit &message, const ImVec2 &pos, float wrapWidth, float alpha);
     void DrawScrollIndicators(ImDrawList *drawList, const ImVec2 &contentPos, const ImVec2 &contentSize, float contentHeight, float visibleHeight);
 
@@ -158,10 +185,18 @@ private:
     void SetScrollYClamped(float y);
     void SyncScrollBottomFlag();
 
-    // Message storage
+    // Message storage (ring buffer)
     std::vector<MessageUnit> m_Messages;
+    int m_MessageHead = 0;          // Slot of the oldest message
     int m_MessageCount = 0;
     int m_DisplayMessageCount = 0;
+    int m_FirstActiveMessage = 0;   // Every older message has an expired timer
+    uint64_t m_AppendedCount = 0;   // Messages added since the last layout reset
+
+    // Layout caches, one per recently used wrap width
+    HistoryLayout m_Layouts[2];
+    uint32_t m_LayoutGeneration = 1;
+    uint64_t m_LayoutClock = 0;
 
     // Configuration
     bool m_IsCommandBarVisible = false;
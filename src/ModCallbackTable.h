@@ -0,0 +1,118 @@
+#ifndef BML_MODCALLBACKTABLE_H
+#define BML_MODCALLBACKTABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "BML/IMod.h"
+
+// Every callback the loader dispatches to Mods, one dispatch slot each.
+#define BML_MOD_CALLBACKS(X)                                               \
+    X(PreStartMenu, &IMessageReceiver::OnPreStartMenu)                     \
+    X(PostStartMenu, &IMessageReceiver::OnPostStartMenu)                   \
+    X(ExitGame, &IMessageReceiver::OnExitGame)                             \
+    X(PreLoadLevel, &IMessageReceiver::OnPreLoadLevel)                     \
+    X(PostLoadLevel, &IMessageReceiver::OnPostLoadLevel)                   \
+    X(StartLevel, &IMessageReceiver::OnStartLevel)                         \
+    X(PreResetLevel, &IMessageReceiver::OnPreResetLevel)                   \
+    X(PostResetLevel, &IMessageReceiver::OnPostResetLevel)                 \
+    X(PauseLevel, &IMessageReceiver::OnPauseLevel)                         \
+    X(UnpauseLevel, &IMessageReceiver::OnUnpauseLevel)                     \
+    X(PreExitLevel, &IMessageReceiver::OnPreExitLevel)                     \
+    X(PostExitLevel, &IMessageReceiver::OnPostExitLevel)                   \
+    X(PreNextLevel, &IMessageReceiver::OnPreNextLevel)                     \
+    X(PostNextLevel, &IMessageReceiver::OnPostNextLevel)                   \
+    X(Dead, &IMessageReceiver::OnDead)                                     \
+    X(PreEndLevel, &IMessageReceiver::OnPreEndLevel)                       \
+    X(PostEndLevel, &IMessageReceiver::OnPostEndLevel)                     \
+    X(CounterActive, &IMessageReceiver::OnCounterActive)                   \
+    X(CounterInactive, &IMessageReceiver::OnCounterInactive)               \
+    X(BallNavActive, &IMessageReceiver::OnBallNavActive)                   \
+    X(BallNavInactive, &IMessageReceiver::OnBallNavInactive)               \
+    X(CamNavActive, &IMessageReceiver::OnCamNavActive)                     \
+    X(CamNavInactive, &IMessageReceiver::OnCamNavInactive)                 \
+    X(BallOff, &IMessageReceiver::OnBallOff)                               \
+    X(PreCheckpointReached, &IMessageReceiver::OnPreCheckpointReached)     \
+    X(PostCheckpointReached, &IMessageReceiver::OnPostCheckpointReached)   \
+    X(LevelFinish, &IMessageReceiver::OnLevelFinish)                       \
+    X(GameOver, &IMessageReceiver::OnGameOver)                             \
+    X(ExtraPoint, &IMessageReceiver::OnExtraPoint)                         \
+    X(PreSubLife, &IMessageReceiver::OnPreSubLife)                         \
+    X(PostSubLife, &IMessageReceiver::OnPostSubLife)                       \
+    X(PreLifeUp, &IMessageReceiver::OnPreLifeUp)                           \
+    X(PostLifeUp, &IMessageReceiver::OnPostLifeUp)                         \
+    X(Load, &IMod::OnLoad)                                                 \
+    X(Unload, &IMod::OnUnload)                                             \
+    X(ModifyConfig, &IMod::OnModifyConfig)                                 \
+    X(LoadObject, &IMod::OnLoadObject)                                     \
+    X(LoadScript, &IMod::OnLoadScript)                                     \
+    X(Process, &IMod::OnProcess)                                           \
+    X(Render, &IMod::OnRender)                                             \
+    X(CheatEnabled, &IMod::OnCheatEnabled)                                 \
+    X(Physicalize, &IMod::OnPhysicalize)                                   \
+    X(Unphysicalize, &IMod::OnUnphysicalize)                               \
+    X(PreCommandExecute, &IMod::OnPreCommandExecute)                       \
+    X(PostCommandExecute, &IMod::OnPostCommandExecute)
+
+enum ModCallbackSlot : uint8_t {
+#define BML_MOD_CALLBACK_SLOT(NAME, FUNC) MOD_CALLBACK_##NAME,
+    BML_MOD_CALLBACKS(BML_MOD_CALLBACK_SLOT)
+#undef BML_MOD_CALLBACK_SLOT
+    MOD_CALLBACK_COUNT
+};
+
+inline const char *GetModCallbackName(ModCallbackSlot slot) {
+    static constexpr const char *names[] = {
+#define BML_MOD_CALLBACK_NAME(NAME, FUNC) "On" #NAME,
+        BML_MOD_CALLBACKS(BML_MOD_CALLBACK_NAME)
+#undef BML_MOD_CALLBACK_NAME
+    };
+    return slot < MOD_CALLBACK_COUNT ? names[slot] : "";
+}
+
+// Maps a callback member pointer to its slot at compile time, so broadcasting
+// never hashes the pointer. A callback missing from BML_MOD_CALLBACKS does not
+// compile.
+template <auto Callback>
+struct ModCallbackSlotOf;
+
+#define BML_MOD_CALLBACK_SLOT_OF(NAME, FUNC) \
+    template <>                              \
+    struct ModCallbackSlotOf<FUNC> : std::integral_constant<ModCallbackSlot, MOD_CALLBACK_##NAME> {};
+BML_MOD_CALLBACKS(BML_MOD_CALLBACK_SLOT_OF)
+#undef BML_MOD_CALLBACK_SLOT_OF
+
+// Immutable snapshot of which Mods receive each callback, in load order. A
+// new table is built whenever a Mod is registered or removed and replaces the
+// old one with a single pointer store; readers never lock.
+class ModCallbackTable {
+public:
+    using Slots = std::array<std::vector<IMod *>, MOD_CALLBACK_COUNT>;
+
+    explicit ModCallbackTable(const Slots &slots) {
+        size_t total = 0;
+        for (const auto &mods : slots)
+            total += mods.size();
+        m_Mods.reserve(total);
+
+        for (size_t i = 0; i < MOD_CALLBACK_COUNT; ++i) {
+            m_Offsets[i] = static_cast<uint32_t>(m_Mods.size());
+            m_Mods.insert(m_Mods.end(), slots[i].begin(), slots[i].end());
+        }
+        m_Offsets[MOD_CALLBACK_COUNT] = static_cast<uint32_t>(m_Mods.size());
+    }
+
+    std::span<IMod *const> Get(ModCallbackSlot slot) const {
+        return {m_Mods.data() + m_Offsets[slot], m_Offsets[slot + 1] - m_Offsets[slot]};
+    }
+
+private:
+    std::array<uint32_t, MOD_CALLBACK_COUNT + 1> m_Offsets = {};
+    std::vector<IMod *> m_Mods;
+};
+
+#endif // BML_MODCALLBACKTABLE_H
@@ -16,6 +16,7 @@
 #include <oniguruma.h>
 
 #include "BML/BML.h"
+#include "BML/ScriptHelper.h"
 #include "BML/Timer.h"
 #include "BuiltinCapabilities.h"
 #include "EventStreams.h"
@@ -25,6 +26,7 @@
 #include "Logger.h"
 #if BML_ENABLE_ANGELSCRIPT
 #include "AngelScriptBindings.h"
+#include "ScriptContextPool.h"
 #include "ScriptDevToolsService.h"
 #include "ScriptMod.h"
 #include "ScriptModEntryScanner.h"
@@ -178,6 +180,20 @@ namespace {
         return utils::CombinePathW(utils::CombinePathW(tempDirectory, kPackagesDirectoryName), archiveName);
     }
 
+    // Timers run from Timer::ProcessAll, long after the Mod that scheduled them
+    // returned. While profiling, the callback keeps that Mod as its owner.
+    template <typename Callback>
+    Callback AttributeTimer(Callback callback) {
+        FrameProfiler &profiler = FrameProfiler::Get();
+        if (!profiler.IsEnabled() || profiler.GetCurrentOwner().empty())
+            return callback;
+
+        return [owner = std::string(profiler.GetCurrentOwner()), callback = std::move(callback)]() {
+            FrameProfiler::Scope scope(FrameProfiler::Get(), owner, "Timer");
+            return callback();
+        };
+    }
+
 }
 
 ModContext *g_ModContext = nullptr;
@@ -215,6 +231,7 @@ ModContext::ModContext(CKContext *context) {
 
 ModContext::~ModContext() {
     Shutdown();
+    delete m_CallbackTable.exchange(nullptr, std::memory_order_acq_rel);
     if (m_DataShare) m_DataShare->Release();
     g_ModContext = nullptr;
 }
@@ -655,13 +672,20 @@ void ModContext::DeactivateActiveMods() {
 
     {
         std::lock_guard<std::mutex> lock(m_Mutex);
-        m_CallbackMap.clear();
+        for (auto &mods : m_CallbackMods)
+            mods.clear();
+        PublishCallbackTable();
         m_Configs.clear();
         m_ConfigMap.clear();
         m_CommandOwnerMap.clear();
     }
     m_CommandContext.ClearCommands();
     m_ActiveMods.clear();
+
+#if BML_ENABLE_ANGELSCRIPT
+    // Pooled contexts keep the script engine referenced.
+    ScriptContextPool::Get().Clear();
+#endif
 }
 
 void ModContext::RollbackModActivation() {
@@ -1036,23 +1060,29 @@ void ModContext::ExecuteCommand(const char *cmd) {
     if (!cmd || cmd[0] == '\0')
         return;
 
-    const auto args = CommandContext::ParseCommandLine(cmd);
-    if (args.empty()) {
+    CommandTokens tokens;
+    CommandContext::TokenizeCommandLine(cmd, tokens);
+    if (tokens.Empty()) {
         m_BMLMod->AddIngameMessage("Error: Empty command");
         return;
     }
 
-    ICommand *command = FindCommand(args[0].c_str());
+    const std::string_view name = tokens[0];
+    ICommand *command = m_CommandContext.GetCommandByName(name);
     if (!command) {
-        m_BMLMod->AddIngameMessage(("Error: Unknown Command " + args[0]).c_str());
+        m_BMLMod->AddIngameMessage(("Error: Unknown Command " + std::string(name)).c_str());
         return;
     }
 
     if (command->IsCheat() && !IsCheatEnabled()) {
-        m_BMLMod->AddIngameMessage(("Error: Can not execute cheat command " + args[0]).c_str());
+        m_BMLMod->AddIngameMessage(("Error: Can not execute cheat command " + std::string(name)).c_str());
         return;
     }
 
+    // ICommand and IMod take the arguments as owned strings, so they are only
+    // built once the command is known to run.
+    const std::vector<std::string> args = tokens.ToStrings();
+
     m_Logger->Info("Execute Command: %s", cmd);
 
     try {
@@ -1061,14 +1091,14 @@ void ModContext::ExecuteCommand(const char *cmd) {
             event.Command = args[0];
             event.CommandArgs.assign(args.begin() + 1, args.end());
         });
-        BroadcastCallback(&IMod::OnPreCommandExecute, command, args);
+        BroadcastCallback<&IMod::OnPreCommandExecute>(command, args);
         command->Execute(this, args);
         BML::CaptureEventNoexcept([&](BML::EventSnapshot &event) {
             event.Kind = BML_EVENT_COMMAND_POST;
             event.Command = args[0];
             event.CommandArgs.assign(args.begin() + 1, args.end());
         });
-        BroadcastCallback(&IMod::OnPostCommandExecute, command, args);
+        BroadcastCallback<&IMod::OnPostCommandExecute>(command, args);
     } catch (const std::exception &e) {
         m_Logger->Error("Exception executing command '%s': %s", cmd, e.what());
         m_BMLMod->AddIngameMessage(("Error: Command failed - " + std::string(e.what())).c_str());
@@ -1301,28 +1331,28 @@ void ModContext::AddTimer(CKDWORD delay, std::function<void()> callback) {
     if (!CanScheduleTimer())
         return;
 
-    Delay(static_cast<size_t>(delay), callback, m_TimeManager->GetMainTickCount());
+    Delay(static_cast<size_t>(delay), AttributeTimer(std::move(callback)), m_TimeManager->GetMainTickCount());
 }
 
 void ModContext::AddTimerLoop(CKDWORD delay, std::function<bool()> callback) {
     if (!CanScheduleTimer())
         return;
 
-    Interval(static_cast<size_t>(delay), callback, m_TimeManager->GetMainTickCount());
+    Interval(static_cast<size_t>(delay), AttributeTimer(std::move(callback)), m_TimeManager->GetMainTickCount());
 }
 
 void ModContext::AddTimer(float delay, std::function<void()> callback) {
     if (!CanScheduleTimer())
         return;
 
-    Delay(delay / 1000.0f, callback, m_TimeManager->GetAbsoluteTime() / 1000.0f);
+    Delay(delay / 1000.0f, AttributeTimer(std::move(callback)), m_TimeManager->GetAbsoluteTime() / 1000.0f);
 }
 
 void ModContext::AddTimerLoop(float delay, std::function<bool()> callback) {
     if (!CanScheduleTimer())
         return;
 
-    Interval(delay / 1000.0f, callback, m_TimeManager->GetAbsoluteTime() / 1000.0f);
+    Interval(delay / 1000.0f, AttributeTimer(std::move(callback)), m_TimeManager->GetAbsoluteTime() / 1000.0f);
 }
 
 void ModContext::ExitGame() {
@@ -1359,7 +1389,7 @@ void ModContext::EnableCheat(bool enable) {
             event.Kind = BML_EVENT_CHEAT_CHANGED;
             event.CheatEnabled = enable;
         });
-        BroadcastCallback(&IMod::OnCheatEnabled, enable);
+        BroadcastCallback<&IMod::OnCheatEnabled>(enable);
     }
 }
 
@@ -1467,6 +1497,8 @@ void ModContext::OnProcess() {
     if (!IsInited() || !m_TimeManager)
         return;
 
+    FrameProfiler::Get().BeginFrame();
+
 #if BML_ENABLE_ANGELSCRIPT
     BML_TryRegisterAngelScriptBindings(this);
     ProcessScriptModFailureCleanup();
@@ -1476,16 +1508,22 @@ void ModContext::OnProcess() {
         m_ScriptHotReload->Process();
     ProcessScriptModQueuedCallbacks();
 #endif
-    m_ImcRuntime.Pump();
-    Timer::ProcessAll(m_TimeManager->GetMainTickCount(), m_TimeManager->GetAbsoluteTime() / 1000.0f);
-    BroadcastCallback(&IMod::OnProcess);
+    {
+        FrameProfiler::Scope scope(FrameProfiler::Get(), "BML", "IMC");
+        m_ImcRuntime.Pump();
+    }
+    {
+        FrameProfiler::Scope scope(FrameProfiler::Get(), "BML", "Timers");
+        Timer::ProcessAll(m_TimeManager->GetMainTickCount(), m_TimeManager->GetAbsoluteTime() / 1000.0f);
+    }
+    BroadcastCallback<&IMod::OnProcess>();
 }
 
 void ModContext::OnRender(CKRenderContext *dev) {
     if (!IsInited() || !dev)
         return;
 
-    BroadcastCallback(&IMod::OnRender, static_cast<CK_RENDER_FLAGS>(dev->GetCurrentRenderOptions()));
+    BroadcastCallback<&IMod::OnRender>(static_cast<CK_RENDER_FLAGS>(dev->GetCurrentRenderOptions()));
 }
 
 void ModContext::OnLoadGame() {
@@ -1497,8 +1535,8 @@ void ModContext::OnLoadGame() {
         event.ReuseMaterials = true;
         event.FilterClass = CKCID_3DOBJECT;
     });
-    BroadcastCallback(&IMod::OnLoadObject, "base.cmo", false, "", CKCID_3DOBJECT,
-                      true, true, true, false, nullptr, nullptr);
+    BroadcastCallback<&IMod::OnLoadObject>("base.cmo", false, "", CKCID_3DOBJECT,
+                                           true, true, true, false, nullptr, nullptr);
 
     int scriptCnt = m_CKContext->GetObjectsCountByClassID(CKCID_BEHAVIOR);
     CK_ID *scripts = m_CKContext->GetObjectsListByClassID(CKCID_BEHAVIOR);
@@ -1510,183 +1548,185 @@ void ModContext::OnLoadGame() {
                 event.Filename = "base.cmo";
                 event.Script = MakeBuiltinObjectRef(*this, behavior);
             });
-            BroadcastCallback(&IMod::OnLoadScript, "base.cmo", behavior);
+            ScriptHelper::IndexScript(behavior);
+            BroadcastCallback<&IMod::OnLoadScript>("base.cmo", behavior);
+            ScriptHelper::ReleaseScriptIndex(behavior);
         }
     }
 }
 
 void ModContext::OnPreStartMenu() {
     PublishEvent(BML_EVENT_PRE_START_MENU);
-    BroadcastMessage("PreStartMenu", &IMod::OnPreStartMenu);
+    BroadcastMessage<&IMod::OnPreStartMenu>("PreStartMenu");
 }
 
 void ModContext::OnPostStartMenu() {
     PublishEvent(BML_EVENT_POST_START_MENU);
-    BroadcastMessage("PostStartMenu", &IMod::OnPostStartMenu);
+    BroadcastMessage<&IMod::OnPostStartMenu>("PostStartMenu");
 }
 
 void ModContext::OnExitGame() {
     PublishEvent(BML_EVENT_EXIT_GAME);
-    BroadcastMessage("ExitGame", &IMod::OnExitGame);
+    BroadcastMessage<&IMod::OnExitGame>("ExitGame");
 }
 
 void ModContext::OnPreLoadLevel() {
     PublishEvent(BML_EVENT_PRE_LOAD_LEVEL);
-    BroadcastMessage("PreLoadLevel", &IMod::OnPreLoadLevel);
+    BroadcastMessage<&IMod::OnPreLoadLevel>("PreLoadLevel");
 }
 
 void ModContext::OnPostLoadLevel() {
     PublishEvent(BML_EVENT_POST_LOAD_LEVEL);
-    BroadcastMessage("PostLoadLevel", &IMod::OnPostLoadLevel);
+    BroadcastMessage<&IMod::OnPostLoadLevel>("PostLoadLevel");
 }
 
 void ModContext::OnStartLevel() {
     PublishEvent(BML_EVENT_START_LEVEL);
-    BroadcastMessage("StartLevel", &IMod::OnStartLevel);
+    BroadcastMessage<&IMod::OnStartLevel>("StartLevel");
     m_RuntimeState.Apply(BML::RuntimeStateTransition::EnterLevel);
 }
 
 void ModContext::OnPreResetLevel() {
     PublishEvent(BML_EVENT_PRE_RESET_LEVEL);
-    BroadcastMessage("PreResetLevel", &IMod::OnPreResetLevel);
+    BroadcastMessage<&IMod::OnPreResetLevel>("PreResetLevel");
     m_RuntimeState.Apply(BML::RuntimeStateTransition::LeaveLevel);
 }
 
 void ModContext::OnPostResetLevel() {
     PublishEvent(BML_EVENT_POST_RESET_LEVEL);
-    BroadcastMessage("PostResetLevel", &IMod::OnPostResetLevel);
+    BroadcastMessage<&IMod::OnPostResetLevel>("PostResetLevel");
 }
 
 void ModContext::OnPauseLevel() {
     PublishEvent(BML_EVENT_PAUSE_LEVEL);
-    BroadcastMessage("PauseLevel", &IMod::OnPauseLevel);
+    BroadcastMessage<&IMod::OnPauseLevel>("PauseLevel");
     m_RuntimeState.Apply(BML::RuntimeStateTransition::Pause);
 }
 
 void ModContext::OnUnpauseLevel() {
     PublishEvent(BML_EVENT_UNPAUSE_LEVEL);
-    BroadcastMessage("UnpauseLevel", &IMod::OnUnpauseLevel);
+    BroadcastMessage<&IMod::OnUnpauseLevel>("UnpauseLevel");
     m_RuntimeState.Apply(BML::RuntimeStateTransition::Resume);
 }
 
 void ModContext::OnPreExitLevel() {
     PublishEvent(BML_EVENT_PRE_EXIT_LEVEL);
-    BroadcastMessage("PreExitLevel", &IMod::OnPreExitLevel);
+    BroadcastMessage<&IMod::OnPreExitLevel>("PreExitLevel");
 }
 
 void ModContext::OnPostExitLevel() {
     PublishEvent(BML_EVENT_POST_EXIT_LEVEL);
-    BroadcastMessage("PostExitLevel", &IMod::OnPostExitLevel);
+    BroadcastMessage<&IMod::OnPostExitLevel>("PostExitLevel");
     m_RuntimeState.Apply(BML::RuntimeStateTransition::LeaveGame);
 }
 
 void ModContext::OnPreNextLevel() {
     PublishEvent(BML_EVENT_PRE_NEXT_LEVEL);
-    BroadcastMessage("PreNextLevel", &IMod::OnPreNextLevel);
+    BroadcastMessage<&IMod::OnPreNextLevel>("PreNextLevel");
 }
 
 void ModContext::OnPostNextLevel() {
     PublishEvent(BML_EVENT_POST_NEXT_LEVEL);
-    BroadcastMessage("PostNextLevel", &IMod::OnPostNextLevel);
+    BroadcastMessage<&IMod::OnPostNextLevel>("PostNextLevel");
     m_RuntimeState.Apply(BML::RuntimeStateTransition::LeaveLevel);
 }
 
 void ModContext::OnDead() {
     PublishEvent(BML_EVENT_DEAD);
-    BroadcastMessage("Dead", &IMod::OnDead);
+    BroadcastMessage<&IMod::OnDead>("Dead");
     m_RuntimeState.Apply(BML::RuntimeStateTransition::LeaveGame);
 }
 
 void ModContext::OnPreEndLevel() {
     PublishEvent(BML_EVENT_PRE_END_LEVEL);
-    BroadcastMessage("PreEndLevel", &IMod::OnPreEndLevel);
+    BroadcastMessage<&IMod::OnPreEndLevel>("PreEndLevel");
 }
 
 void ModContext::OnPostEndLevel() {
     PublishEvent(BML_EVENT_POST_END_LEVEL);
-    BroadcastMessage("PostEndLevel", &IMod::OnPostEndLevel);
+    BroadcastMessage<&IMod::OnPostEndLevel>("PostEndLevel");
     m_RuntimeState.Apply(BML::RuntimeStateTransition::LeaveGame);
 }
 
 void ModContext::OnCounterActive() {
     PublishEvent(BML_EVENT_COUNTER_ACTIVE);
-    BroadcastMessage("CounterActive", &IMod::OnCounterActive);
+    BroadcastMessage<&IMod::OnCounterActive>("CounterActive");
 }
 
 void ModContext::OnCounterInactive() {
     PublishEvent(BML_EVENT_COUNTER_INACTIVE);
-    BroadcastMessage("CounterInactive", &IMod::OnCounterInactive);
+    BroadcastMessage<&IMod::OnCounterInactive>("CounterInactive");
 }
 
 void ModContext::OnBallNavActive() {
     PublishEvent(BML_EVENT_BALL_NAV_ACTIVE);
-    BroadcastMessage("BallNavActive", &IMod::OnBallNavActive);
+    BroadcastMessage<&IMod::OnBallNavActive>("BallNavActive");
 }
 
 void ModContext::OnBallNavInactive() {
     PublishEvent(BML_EVENT_BALL_NAV_INACTIVE);
-    BroadcastMessage("BallNavInactive", &IMod::OnBallNavInactive);
+    BroadcastMessage<&IMod::OnBallNavInactive>("BallNavInactive");
 }
 
 void ModContext::OnCamNavActive() {
     PublishEvent(BML_EVENT_CAM_NAV_ACTIVE);
-    BroadcastMessage("CamNavActive", &IMod::OnCamNavActive);
+    BroadcastMessage<&IMod::OnCamNavActive>("CamNavActive");
 }
 
 void ModContext::OnCamNavInactive() {
     PublishEvent(BML_EVENT_CAM_NAV_INACTIVE);
-    BroadcastMessage("CamNavInactive", &IMod::OnCamNavInactive);
+    BroadcastMessage<&IMod::OnCamNavInactive>("CamNavInactive");
 }
 
 void ModContext::OnBallOff() {
     PublishEvent(BML_EVENT_BALL_OFF);
-    BroadcastMessage("BallOff", &IMod::OnBallOff);
+    BroadcastMessage<&IMod::OnBallOff>("BallOff");
 }
 
 void ModContext::OnPreCheckpointReached() {
     PublishEvent(BML_EVENT_PRE_CHECKPOINT_REACHED);
-    BroadcastMessage("PreCheckpoint", &IMod::OnPreCheckpointReached);
+    BroadcastMessage<&IMod::OnPreCheckpointReached>("PreCheckpoint");
 }
 
 void ModContext::OnPostCheckpointReached() {
     PublishEvent(BML_EVENT_POST_CHECKPOINT_REACHED);
-    BroadcastMessage("PostCheckpoint", &IMod::OnPostCheckpointReached);
+    BroadcastMessage<&IMod::OnPostCheckpointReached>("PostCheckpoint");
 }
 
 void ModContext::OnLevelFinish() {
     PublishEvent(BML_EVENT_LEVEL_FINISH);
-    BroadcastMessage("LevelFinish", &IMod::OnLevelFinish);
+    BroadcastMessage<&IMod::OnLevelFinish>("LevelFinish");
     m_RuntimeState.Apply(BML::RuntimeStateTransition::LeaveLevel);
 }
 
 void ModContext::OnGameOver() {
     PublishEvent(BML_EVENT_GAME_OVER);
-    BroadcastMessage("GameOver", &IMod::OnGameOver);
+    BroadcastMessage<&IMod::OnGameOver>("GameOver");
 }
 
 void ModContext::OnExtraPoint() {
     PublishEvent(BML_EVENT_EXTRA_POINT);
-    BroadcastMessage("ExtraPoint", &IMod::OnExtraPoint);
+    BroadcastMessage<&IMod::OnExtraPoint>("ExtraPoint");
 }
 
 void ModContext::OnPreSubLife() {
     PublishEvent(BML_EVENT_PRE_SUB_LIFE);
-    BroadcastMessage("PreSubLife", &IMod::OnPreSubLife);
+    BroadcastMessage<&IMod::OnPreSubLife>("PreSubLife");
 }
 
 void ModContext::OnPostSubLife() {
     PublishEvent(BML_EVENT_POST_SUB_LIFE);
-    BroadcastMessage("PostSubLife", &IMod::OnPostSubLife);
+    BroadcastMessage<&IMod::OnPostSubLife>("PostSubLife");
 }
 
 void ModContext::OnPreLifeUp() {
     PublishEvent(BML_EVENT_PRE_LIFE_UP);
-    BroadcastMessage("PreLifeUp", &IMod::OnPreLifeUp);
+    BroadcastMessage<&IMod::OnPreLifeUp>("PreLifeUp");
 }
 
 void ModContext::OnPostLifeUp() {
     PublishEvent(BML_EVENT_POST_LIFE_UP);
-    BroadcastMessage("PostLifeUp", &IMod::OnPostLifeUp);
+    BroadcastMessage<&IMod::OnPostLifeUp>("PostLifeUp");
 }
 
 void ModContext::InitDirectories() {
@@ -2630,11 +2670,10 @@ bool ModContext::UnregisterMod(IMod *mod, const std::shared_ptr<void> &dllHandle
             std::lock_guard<std::mutex> lock(m_Mutex);
             std::unique_lock<std::shared_mutex> registryLock(m_ModRegistryMutex);
 
-            // Remove from callback map to prevent dangling pointer in BroadcastCallback
-            for (auto &kv : m_CallbackMap) {
-                auto &vec = kv.second;
-                vec.erase(std::remove(vec.begin(), vec.end(), mod), vec.end());
-            }
+            // Remove from callback table to prevent dangling pointer in BroadcastCallback
+            for (auto &mods : m_CallbackMods)
+                mods.erase(std::remove(mods.begin(), mods.end(), mod), mods.end());
+            PublishCallbackTable();
 
             // Remove from mod map
             auto it = m_ModMap.find(modId);
@@ -2814,11 +2853,11 @@ void ModContext::FillCallbackMap(IMod *mod) {
     };
 
     int index = 0;
-#define CHECK_V_FUNC(IDX, FUNC)                             \
-    do {                                                    \
-        auto idx = IDX;                                     \
-        if (vtable[0][idx] != vtable[1][idx])               \
-            m_CallbackMap[utils::TypeErase(FUNC)].push_back(mod);  \
+#define CHECK_V_FUNC(IDX, FUNC)                                             \
+    do {                                                                    \
+        auto idx = IDX;                                                     \
+        if (vtable[0][idx] != vtable[1][idx])                               \
+            m_CallbackMods[ModCallbackSlotOf<FUNC>::value].push_back(mod);  \
     } while(0)
 
     CHECK_V_FUNC(index++, &IMessageReceiver::OnPreStartMenu);
@@ -2873,6 +2912,39 @@ void ModContext::FillCallbackMap(IMod *mod) {
     CHECK_V_FUNC(index++, &IMod::OnPostCommandExecute);
 
 #undef CHECK_V_FUNC
+
+    PublishCallbackTable();
+}
+
+void ModContext::PublishCallbackTable() {
+    auto table = std::make_unique<const ModCallbackTable>(m_CallbackMods);
+    const ModCallbackTable *previous = m_CallbackTable.exchange(table.release());
+    if (!previous)
+        return;
+
+    // A running broadcast may still be walking the old table
+    {
+        std::lock_guard<std::mutex> lock(m_RetiredCallbackTablesMutex);
+        m_RetiredCallbackTables.emplace_back(previous);
+        m_HasRetiredCallbackTables.store(true);
+    }
+    ReleaseRetiredCallbackTables();
+}
+
+void ModContext::ReleaseRetiredCallbackTables() {
+    std::lock_guard<std::mutex> lock(m_RetiredCallbackTablesMutex);
+    // Broadcasts count themselves before loading the table and the table is
+    // replaced before this check, so once the count reads zero any broadcast
+    // that starts later sees the current table, never a retired one.
+    if (m_ActiveBroadcasts.load() != 0)
+        return;
+    m_RetiredCallbackTables.clear();
+    m_HasRetiredCallbackTables.store(false);
+}
+
+void ModContext::EndBroadcast() {
+    if (m_ActiveBroadcasts.fetch_sub(1) == 1 && m_HasRetiredCallbackTables.load())
+        ReleaseRetiredCallbackTables();
 }
 
 void ModContext::AddDataPath(const char *path) {
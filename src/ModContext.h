@@ -1,8 +1,10 @@
 #ifndef BML_MODCONTEXT_H
 #define BML_MODCONTEXT_H
 
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <shared_mutex>
 #include <string>
 #include <thread>
@@ -16,8 +18,10 @@
 #include "Config.h"
 #include "DataShare.hpp"
 #include "CommandContext.h"
+#include "FrameProfiler.h"
 #include "HookUtils.h"
 #include "ImcRuntime.h"
+#include "ModCallbackTable.h"
 #include "ModInvocationGate.h"
 #include "RuntimeState.h"
 
@@ -290,19 +294,30 @@ public:
     void RegisterTrafo(const char *modulName) override;
     void RegisterModul(const char *modulName) override;
 
-    template<typename T, typename... Args>
-    std::enable_if_t<std::is_member_function_pointer<T>::value, void> BroadcastCallback(T callback, Args&&... args) {
+    template<auto Callback, typename... Args>
+    void BroadcastCallback(Args&&... args) {
+        static_assert(std::is_member_function_pointer_v<decltype(Callback)>);
         auto invocationLock = LockModInvocation();
-        std::vector<IMod *> mods;
-        {
-            std::lock_guard<std::mutex> lock(m_Mutex);
-            auto it = m_CallbackMap.find(utils::TypeErase(callback));
-            if (it != m_CallbackMap.end())
-                mods = it->second;
-        }
-        for (IMod *mod : mods) {
+        // Tables are immutable and a replaced one stays alive until no broadcast
+        // is running, so the loop needs neither a lock nor a copy. The count
+        // goes up before the table is loaded; see ReleaseRetiredCallbackTables.
+        m_ActiveBroadcasts.fetch_add(1);
+        struct BroadcastScope {
+            ModContext &Context;
+            ~BroadcastScope() { Context.EndBroadcast(); }
+        } broadcastScope{*this};
+        const ModCallbackTable *table = m_CallbackTable.load();
+        if (!table)
+            return;
+        constexpr ModCallbackSlot slot = ModCallbackSlotOf<Callback>::value;
+        BML::FrameProfiler &profiler = BML::FrameProfiler::Get();
+        const bool profiling = profiler.IsEnabled();
+        for (IMod *mod : table->Get(slot)) {
             try {
-                (mod->*callback)(std::forward<Args>(args)...);
+                std::optional<BML::FrameProfiler::Scope> scope;
+                if (profiling)
+                    scope.emplace(profiler, mod->GetID(), GetModCallbackName(slot));
+                (mod->*Callback)(args...);
             } catch (const std::exception &e) {
                 if (m_Logger)
                     m_Logger->Error("Exception in mod %s callback: %s", mod->GetID(), e.what());
@@ -313,10 +328,10 @@ public:
         }
     }
 
-    template<typename T>
-    std::enable_if_t<std::is_member_function_pointer<T>::value, void> BroadcastMessage(const char *msg, T func) {
+    template<auto Callback>
+    void BroadcastMessage(const char *msg) {
         m_Logger->Info("On Message %s", msg);
-        BroadcastCallback(func);
+        BroadcastCallback<Callback>();
     }
 
     void OnProcess();
@@ -413,6 +428,10 @@ private:
     bool ResolveDependencies();
 
     void FillCallbackMap(IMod *mod);
+    // Both require m_Mutex.
+    void PublishCallbackTable();
+    void ReleaseRetiredCallbackTables();
+    void EndBroadcast();
     void DeactivateActiveMods();
     void RollbackModActivation();
 
@@ -494,7 +513,16 @@ private:
     typedef std::unordered_map<std::string, Config *> ConfigMap;
     ConfigMap m_ConfigMap;
 
-    std::unordered_map<void *, std::vector<IMod *>> m_CallbackMap;
+    // Which Mods override each callback. Guarded by m_Mutex; broadcasts read
+    // the published m_CallbackTable instead.
+    ModCallbackTable::Slots m_CallbackMods;
+    std::atomic<const ModCallbackTable *> m_CallbackTable{nullptr};
+    // Replaced tables a running broadcast may still be walking. Freed as soon
+    // as m_ActiveBroadcasts drops to zero.
+    std::vector<std::unique_ptr<const ModCallbackTable>> m_RetiredCallbackTables;
+    std::mutex m_RetiredCallbackTablesMutex;
+    std::atomic<bool> m_HasRetiredCallbackTables{false};
+    std::atomic<int> m_ActiveBroadcasts{0};
 
     const std::thread::id m_MainThreadId = std::this_thread::get_id();
     mutable std::shared_mutex m_ModRegistryMutex;
@@ -1,4 +1,5 @@
 #include "BML/Guids/Narratives.h"
+#include "BML/ScriptHelper.h"
 
 #include <cstring>
 #include <string>
@@ -67,6 +68,7 @@ int ObjectLoad(const CKBehaviorContext &behcontext) {
     }
 
     CKContext *ckContext = modContext->GetCKContext();
+    InvalidateBuiltinObjectNames(*modContext);
     BML::CaptureEventNoexcept([&](BML::EventSnapshot &event) {
         event.Kind = BML_EVENT_LOAD_OBJECT;
         event.Filename = callbackName;
@@ -84,10 +86,10 @@ int ObjectLoad(const CKBehaviorContext &behcontext) {
         }
     });
 
-    modContext->BroadcastCallback(&IMod::OnLoadObject,
-                                  callbackName.c_str(), isMap, mastername.c_str(), cid,
-                                  addtoscene, reuseMeshes, reuseMaterials, dynamic, oarray,
-                                  masterobject);
+    modContext->BroadcastCallback<&IMod::OnLoadObject>(
+        callbackName.c_str(), isMap, mastername.c_str(), cid,
+        addtoscene, reuseMeshes, reuseMaterials, dynamic, oarray,
+        masterobject);
 
     for (CK_ID *id = oarray->Begin(); ckContext && id != oarray->End(); id++) {
         CKObject *obj = ckContext->GetObject(*id);
@@ -99,7 +101,9 @@ int ObjectLoad(const CKBehaviorContext &behcontext) {
                     event.Filename = callbackName;
                     event.Script = MakeBuiltinObjectRef(*modContext, behavior);
                 });
-                modContext->BroadcastCallback(&IMod::OnLoadScript, callbackName.c_str(), behavior);
+                ScriptHelper::IndexScript(behavior);
+                modContext->BroadcastCallback<&IMod::OnLoadScript>(callbackName.c_str(), behavior);
+                ScriptHelper::ReleaseScriptIndex(behavior);
             }
         }
     }
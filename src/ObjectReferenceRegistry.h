@@ -4,7 +4,9 @@
 #include <cstdint>
 #include <cstddef>
 #include <limits>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "BML/Types.h"
 
@@ -14,6 +16,12 @@
  * slot.  The ModManager invalidates a slot from Virtools' deletion callback
  * before its storage can be reused, so the next Make() receives a new
  * generation even when the allocator gives the replacement the same address.
+ *
+ * CK_IDs are small dense indices, so entries live in pages indexed directly by
+ * slot rather than in a hash map; a page is allocated the first time one of
+ * its slots is used.  An entry only counts while its epoch is the current one,
+ * which makes InvalidateAll a counter bump.  Slots past kMaxPagedSlot, which
+ * Virtools does not hand out in practice, still work through a map.
  */
 class ObjectReferenceRegistry {
 public:
@@ -21,37 +29,91 @@ public:
         if (domain == 0 || slot == 0 || !identity)
             return {};
 
-        Entry &entry = m_Entries[slot];
-        if (entry.Identity != identity)
-            entry = {identity, NextGeneration()};
+        Entry &entry = Slot(slot);
+        if (entry.Epoch != m_Epoch || !entry.Identity) {
+            entry = {identity, NextGeneration(), m_Epoch};
+            ++m_Size;
+        } else if (entry.Identity != identity) {
+            entry.Identity = identity;
+            entry.Generation = NextGeneration();
+        }
         return {domain, slot, entry.Generation};
     }
 
     void Invalidate(uint32_t slot) {
-        const auto found = m_Entries.find(slot);
-        if (slot == 0 || found == m_Entries.end())
+        Entry *entry = Find(slot);
+        if (!entry)
             return;
-        m_Entries.erase(found);
+        *entry = {};
+        --m_Size;
     }
 
     void InvalidateAll() {
-        m_Entries.clear();
+        if (m_Epoch == (std::numeric_limits<uint32_t>::max)()) {
+            // Entries of the first epoch would count again after a wrap.
+            m_Pages.clear();
+            m_Epoch = 0;
+        }
+        ++m_Epoch;
+        m_Overflow.clear();
+        m_Size = 0;
     }
 
     bool Matches(uint32_t slot, uint32_t generation, const void *identity) const {
-        const auto found = m_Entries.find(slot);
-        return slot != 0 && generation != 0 && identity && found != m_Entries.end() &&
-               found->second.Generation == generation && found->second.Identity == identity;
+        const Entry *entry = Find(slot);
+        return generation != 0 && identity && entry && entry->Generation == generation &&
+               entry->Identity == identity;
     }
 
-    size_t Size() const { return m_Entries.size(); }
+    size_t Size() const { return m_Size; }
 
 private:
+    static constexpr uint32_t kPageBits = 10;
+    static constexpr uint32_t kPageSize = 1u << kPageBits;
+    static constexpr uint32_t kMaxPagedSlot = 1u << 24;
+
     struct Entry {
         const void *Identity = nullptr;
         uint32_t Generation = 0;
+        uint32_t Epoch = 0;
+    };
+
+    struct Page {
+        Entry Entries[kPageSize];
     };
 
+    // The entry for slot, allocating its page; it may be a dead one.
+    Entry &Slot(uint32_t slot) {
+        if (slot >= kMaxPagedSlot)
+            return m_Overflow[slot];
+        const uint32_t page = slot >> kPageBits;
+        if (page >= m_Pages.size())
+            m_Pages.resize(page + 1);
+        if (!m_Pages[page])
+            m_Pages[page] = std::make_unique<Page>();
+        return m_Pages[page]->Entries[slot & (kPageSize - 1)];
+    }
+
+    // The live entry for slot, or null.
+    Entry *Find(uint32_t slot) {
+        return const_cast<Entry *>(static_cast<const ObjectReferenceRegistry *>(this)->Find(slot));
+    }
+
+    const Entry *Find(uint32_t slot) const {
+        const Entry *entry = nullptr;
+        if (slot == 0) {
+            return nullptr;
+        } else if (slot >= kMaxPagedSlot) {
+            const auto found = m_Overflow.find(slot);
+            entry = found != m_Overflow.end() ? &found->second : nullptr;
+        } else {
+            const uint32_t page = slot >> kPageBits;
+            entry = page < m_Pages.size() && m_Pages[page] ? &m_Pages[page]->Entries[slot & (kPageSize - 1)]
+                                                           : nullptr;
+        }
+        return entry && entry->Epoch == m_Epoch && entry->Identity ? entry : nullptr;
+    }
+
     uint32_t NextGeneration() {
         const uint32_t result = m_NextGeneration;
         m_NextGeneration = m_NextGeneration == (std::numeric_limits<uint32_t>::max)()
@@ -60,8 +122,11 @@ private:
         return result;
     }
 
-    std::unordered_map<uint32_t, Entry> m_Entries;
+    std::vector<std::unique_ptr<Page>> m_Pages;
+    std::unordered_map<uint32_t, Entry> m_Overflow;
+    uint32_t m_Epoch = 1;
     uint32_t m_NextGeneration = 1;
+    size_t m_Size = 0;
 };
 
 #endif // BML_OBJECT_REFERENCE_REGISTRY_H
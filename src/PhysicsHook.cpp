@@ -198,14 +198,14 @@ int Physicalize(const CKBehaviorContext &behcontext) {
                 event.ConcaveMeshes.push_back(MakeBuiltinObjectRef(*modContext, concaveMesh[i]));
         });
 
-        modContext->BroadcastCallback(&IMod::OnPhysicalize, target,
-                                               fixed, friction, elasticity, mass,
-                                               collisionGroup, startFrozen, enableCollision,
-                                               autoCalcMassCenter, linearSpeedDampening,
-                                               rotSpeedDampening,
-                                               collisionSurface, shiftMassCenter, convexCount,
-                                               convexMesh, ballCount, ballCenter,
-                                               ballRadius, concaveCount, concaveMesh);
+        modContext->BroadcastCallback<&IMod::OnPhysicalize>(target,
+                                                            fixed, friction, elasticity, mass,
+                                                            collisionGroup, startFrozen, enableCollision,
+                                                            autoCalcMassCenter, linearSpeedDampening,
+                                                            rotSpeedDampening,
+                                                            collisionSurface, shiftMassCenter, convexCount,
+                                                            convexMesh, ballCount, ballCenter,
+                                                            ballRadius, concaveCount, concaveMesh);
         delete[] convexMesh;
         delete[] ballCenter;
         delete[] ballRadius;
@@ -215,7 +215,7 @@ int Physicalize(const CKBehaviorContext &behcontext) {
             event.Kind = BML_EVENT_UNPHYSICALIZE;
             event.Target = MakeBuiltinObjectRef(*modContext, target);
         });
-        modContext->BroadcastCallback(&IMod::OnUnphysicalize, target);
+        modContext->BroadcastCallback<&IMod::OnUnphysicalize>(target);
     }
 
     return g_Physicalize(behcontext);
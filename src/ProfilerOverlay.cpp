@@ -0,0 +1,101 @@
+#include "ProfilerOverlay.h"
+
+#include <algorithm>
+
+namespace {
+    constexpr float kRefreshInterval = 0.5f;
+    constexpr size_t kMaxRows = 20;
+}
+
+ProfilerOverlay::ProfilerOverlay() : Window("ProfilerOverlay") {
+    Hide();
+}
+
+ProfilerOverlay::~ProfilerOverlay() = default;
+
+ImGuiWindowFlags ProfilerOverlay::GetFlags() {
+    return ImGuiWindowFlags_NoDecoration |
+           ImGuiWindowFlags_AlwaysAutoResize |
+           ImGuiWindowFlags_NoInputs |
+           ImGuiWindowFlags_NoFocusOnAppearing |
+           ImGuiWindowFlags_NoNav |
+           ImGuiWindowFlags_NoSavedSettings;
+}
+
+void ProfilerOverlay::OnPreBegin() {
+    const ImVec2 vpSize = ImGui::GetMainViewport()->Size;
+    ImGui::SetNextWindowPos(ImVec2(vpSize.x * 0.99f, vpSize.y * 0.01f), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.6f);
+
+    m_RefreshTimer -= ImGui::GetIO().DeltaTime;
+    if (m_RefreshTimer <= 0.0f)
+        Refresh();
+}
+
+void ProfilerOverlay::OnDraw() {
+    const BML::FrameProfiler &profiler = BML::FrameProfiler::Get();
+    if (!profiler.IsEnabled()) {
+        ImGui::TextUnformatted("Profiler is off. Run \"bml profile on\" to start it.");
+        return;
+    }
+
+    ImGui::Text("Frame time per %s over %zu frames (ms)", m_PerLabel ? "callback" : "Mod", m_RecordedFrames);
+
+    const int columns = m_PerLabel ? 7 : 6;
+    if (!ImGui::BeginTable("##ProfilerStats", columns, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg))
+        return;
+
+    ImGui::TableSetupColumn("Mod");
+    if (m_PerLabel)
+        ImGui::TableSetupColumn("Callback");
+    ImGui::TableSetupColumn("Mean");
+    ImGui::TableSetupColumn("p50");
+    ImGui::TableSetupColumn("p99");
+    ImGui::TableSetupColumn("Max");
+    ImGui::TableSetupColumn("Calls/frame");
+    ImGui::TableHeadersRow();
+
+    const size_t rows = std::min(m_Stats.size(), kMaxRows);
+    for (size_t i = 0; i < rows; ++i) {
+        const auto &stat = m_Stats[i];
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(stat.Owner.c_str());
+        if (m_PerLabel) {
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(stat.Label.c_str());
+        }
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", stat.MeanMs);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", stat.P50Ms);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", stat.P99Ms);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", stat.MaxMs);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", m_RecordedFrames > 0 ? static_cast<double>(stat.Calls) / static_cast<double>(m_RecordedFrames) : 0.0);
+    }
+
+    ImGui::EndTable();
+    if (m_Stats.size() > rows)
+        ImGui::TextDisabled("%zu more not shown", m_Stats.size() - rows);
+}
+
+void ProfilerOverlay::OnShow() {
+    Refresh();
+}
+
+void ProfilerOverlay::SetPerLabel(bool perLabel) {
+    if (m_PerLabel == perLabel)
+        return;
+    m_PerLabel = perLabel;
+    Refresh();
+}
+
+void ProfilerOverlay::Refresh() {
+    const BML::FrameProfiler &profiler = BML::FrameProfiler::Get();
+    m_Stats = profiler.GetStats(m_PerLabel);
+    m_RecordedFrames = profiler.GetRecordedFrames();
+    m_RefreshTimer = kRefreshInterval;
+}
@@ -0,0 +1,36 @@
+#ifndef BML_PROFILEROVERLAY_H
+#define BML_PROFILEROVERLAY_H
+
+#include <vector>
+
+#include "BML/Bui.h"
+
+#include "FrameProfiler.h"
+
+// Read-only table of the slowest Mods or callbacks reported by the frame
+// profiler. The statistics are recomputed a couple of times per second, not
+// every frame.
+class ProfilerOverlay : public Bui::Window {
+public:
+    ProfilerOverlay();
+    ~ProfilerOverlay() override;
+
+    ImGuiWindowFlags GetFlags() override;
+
+    void OnPreBegin() override;
+    void OnDraw() override;
+    void OnShow() override;
+
+    bool IsPerLabel() const { return m_PerLabel; }
+    void SetPerLabel(bool perLabel);
+
+private:
+    void Refresh();
+
+    std::vector<BML::FrameProfiler::Stat> m_Stats;
+    size_t m_RecordedFrames = 0;
+    float m_RefreshTimer = 0.0f;
+    bool m_PerLabel = false;
+};
+
+#endif // BML_PROFILEROVERLAY_H
@@ -1,8 +1,174 @@
 #include "BML/ScriptHelper.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "BehaviorGraphIndex.h"
+
+namespace {
+    struct CKGraph {
+        using Behavior = CKBehavior;
+        using Link = CKBehaviorLink;
+
+        static int SubBehaviorCount(CKBehavior *beh) { return beh->GetSubBehaviorCount(); }
+        static CKBehavior *SubBehavior(CKBehavior *beh, int i) { return beh->GetSubBehavior(i); }
+        static const char *Name(CKBehavior *beh) { return beh->GetName(); }
+        static int LinkCount(CKBehavior *beh) { return beh->GetSubBehaviorLinkCount(); }
+        static CKBehaviorLink *GetLink(CKBehavior *beh, int i) { return beh->GetSubBehaviorLink(i); }
+        static CKBehaviorIO *LinkIn(CKBehaviorLink *link) { return link->GetInBehaviorIO(); }
+        static CKBehaviorIO *LinkOut(CKBehaviorLink *link) { return link->GetOutBehaviorIO(); }
+        static CKBehavior *Owner(CKBehaviorIO *io) { return io->GetOwner(); }
+    };
+
+    using ScriptIndex = BehaviorGraphIndex<CKGraph>;
+
+    // Few scripts are indexed at a time; the loader keeps one per OnLoadScript broadcast.
+    std::vector<std::unique_ptr<ScriptIndex>> g_ScriptIndices;
+
+    ScriptIndex *FindScriptIndex(CKBehavior *script) {
+        for (auto &index : g_ScriptIndices) {
+            if (index->Stale())
+                index->Build(index->Root());
+            if (index->Covers(script))
+                return index.get();
+        }
+        return nullptr;
+    }
+
+    void InvalidateScriptIndex(CKBehavior *script) {
+        if (ScriptIndex *index = FindScriptIndex(script))
+            index->Invalidate();
+    }
+
+    void InvalidateScriptLinks(CKBehavior *script) {
+        if (ScriptIndex *index = FindScriptIndex(script))
+            index->InvalidateLinks(script);
+    }
+
+    bool MatchesBB(CKBehavior *beh, const char *name, int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
+        return (!name || !strcmp(beh->GetName(), name)) && (inputCnt < 0 || beh->GetInputCount() == inputCnt) &&
+               (outputCnt < 0 || beh->GetOutputCount() == outputCnt) &&
+               (inputParamCnt < 0 || beh->GetInputParameterCount() == inputParamCnt) &&
+               (outputParamCnt < 0 || beh->GetOutputParameterCount() == outputParamCnt);
+    }
+
+    // The links of script leaving or entering beh, from the index when there is one.
+    template <typename Visitor>
+    CKBehaviorLink *FindLinkOf(CKBehavior *script, CKBehavior *beh, bool outgoing, Visitor &&matches) {
+        if (ScriptIndex *index = FindScriptIndex(script)) {
+            if (const std::vector<CKBehaviorLink *> *links = index->FindLinks(script, beh, outgoing)) {
+                for (CKBehaviorLink *link : *links) {
+                    if (matches(link))
+                        return link;
+                }
+                return nullptr;
+            }
+        }
+
+        int linkCnt = script->GetSubBehaviorLinkCount();
+        for (int i = 0; i < linkCnt; i++) {
+            CKBehaviorLink *link = script->GetSubBehaviorLink(i);
+            CKBehaviorIO *io = outgoing ? link->GetInBehaviorIO() : link->GetOutBehaviorIO();
+            if (io->GetOwner() == beh && matches(link))
+                return link;
+        }
+        return nullptr;
+    }
+
+    CKBehaviorLink *NextLink(CKBehavior *script, CKBehavior *beh, const char *name, int inPos, int outPos,
+                             int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
+        return FindLinkOf(script, beh, true, [&](CKBehaviorLink *link) {
+            CKBehaviorIO *out = link->GetOutBehaviorIO();
+            CKBehavior *outBeh = out->GetOwner();
+            return (inPos < 0 || beh->GetOutput(inPos) == link->GetInBehaviorIO()) &&
+                   (outPos < 0 || outBeh->GetInput(outPos) == out) &&
+                   MatchesBB(outBeh, name, inputCnt, outputCnt, inputParamCnt, outputParamCnt);
+        });
+    }
+
+    CKBehaviorLink *PreviousLink(CKBehavior *script, CKBehavior *beh, const char *name, int inPos, int outPos,
+                                 int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
+        return FindLinkOf(script, beh, false, [&](CKBehaviorLink *link) {
+            CKBehaviorIO *in = link->GetInBehaviorIO();
+            CKBehavior *inBeh = in->GetOwner();
+            return (outPos < 0 || beh->GetInput(outPos) == link->GetOutBehaviorIO()) &&
+                   (inPos < 0 || inBeh->GetOutput(inPos) == in) &&
+                   MatchesBB(inBeh, name, inputCnt, outputCnt, inputParamCnt, outputParamCnt);
+        });
+    }
+
+    CKBehaviorLink *NextLink(CKBehavior *script, CKBehaviorIO *io, const char *name, int outPos,
+                             int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
+        return FindLinkOf(script, io->GetOwner(), true, [&](CKBehaviorLink *link) {
+            CKBehaviorIO *out = link->GetOutBehaviorIO();
+            CKBehavior *outBeh = out->GetOwner();
+            return link->GetInBehaviorIO() == io && (outPos < 0 || outBeh->GetInput(outPos) == out) &&
+                   MatchesBB(outBeh, name, inputCnt, outputCnt, inputParamCnt, outputParamCnt);
+        });
+    }
+
+    CKBehaviorLink *PreviousLink(CKBehavior *script, CKBehaviorIO *io, const char *name, int inPos,
+                                 int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
+        return FindLinkOf(script, io->GetOwner(), false, [&](CKBehaviorLink *link) {
+            CKBehaviorIO *in = link->GetInBehaviorIO();
+            CKBehavior *inBeh = in->GetOwner();
+            return link->GetOutBehaviorIO() == io && (inPos < 0 || inBeh->GetOutput(inPos) == in) &&
+                   MatchesBB(inBeh, name, inputCnt, outputCnt, inputParamCnt, outputParamCnt);
+        });
+    }
+
+    // A link handed to the caller may be rewired directly, so its graph's
+    // links are grouped again before the next lookup.
+    CKBehaviorLink *HandOut(CKBehavior *script, CKBehaviorLink *link) {
+        if (link)
+            InvalidateScriptLinks(script);
+        return link;
+    }
+}
+
 namespace ScriptHelper {
+    void IndexScript(CKBehavior *script) {
+        if (!script)
+            return;
+        for (auto &index : g_ScriptIndices) {
+            if (index->Root() == script) {
+                index->Build(script);
+                return;
+            }
+        }
+        auto index = std::make_unique<ScriptIndex>();
+        index->Build(script);
+        g_ScriptIndices.push_back(std::move(index));
+    }
+
+    void ReleaseScriptIndex(CKBehavior *script) {
+        g_ScriptIndices.erase(std::remove_if(g_ScriptIndices.begin(), g_ScriptIndices.end(),
+                                             [script](const std::unique_ptr<ScriptIndex> &index) {
+                                                 return index->Root() == script;
+                                             }),
+                              g_ScriptIndices.end());
+    }
+
+    bool IsScriptIndexed(CKBehavior *script) {
+        return FindScriptIndex(script) != nullptr;
+    }
+
     bool FindBB(CKBehavior *script, std::function<bool(CKBehavior *)> callback, const char *name, bool hierarchically,
                 int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
+        if (ScriptIndex *index = name ? FindScriptIndex(script) : nullptr) {
+            std::vector<CKBehavior *> candidates;
+            if (index->FindByName(script, name, hierarchically, candidates)) {
+                for (CKBehavior *beh : candidates) {
+                    if (MatchesBB(beh, name, inputCnt, outputCnt, inputParamCnt, outputParamCnt) && !callback(beh))
+                        return false;
+                }
+                return true;
+            }
+            // A graph below script gained or lost blocks behind the helpers' back.
+            index->Invalidate();
+        }
+
         int cnt = script->GetSubBehaviorCount();
         for (int i = 0; i < cnt; i++) {
             CKBehavior *beh = script->GetSubBehavior(i);
@@ -11,12 +177,8 @@ namespace ScriptHelper {
                     return false;
             }
 
-            if ((!name || !strcmp(beh->GetName(), name)) && (inputCnt < 0 || beh->GetInputCount() == inputCnt) &&
-                (outputCnt < 0 || beh->GetOutputCount() == outputCnt) &&
-                (inputParamCnt < 0 || beh->GetInputParameterCount() == inputParamCnt) &&
-                (outputParamCnt < 0 || beh->GetOutputParameterCount() == outputParamCnt))
-                if (!callback(beh))
-                    return false;
+            if (MatchesBB(beh, name, inputCnt, outputCnt, inputParamCnt, outputParamCnt) && !callback(beh))
+                return false;
         }
 
         return true;
@@ -55,6 +217,7 @@ namespace ScriptHelper {
         link->SetInBehaviorIO(in);
         link->SetOutBehaviorIO(out);
         script->AddSubBehaviorLink(link);
+        InvalidateScriptLinks(script);
         return link;
     }
 
@@ -64,12 +227,14 @@ namespace ScriptHelper {
         if (target)
             beh->UseTarget();
         script->AddSubBehavior(beh);
+        InvalidateScriptIndex(script);
         return beh;
     }
 
     void InsertBB(CKBehavior *script, CKBehaviorLink *link, CKBehavior *beh, int inPos, int outPos) {
         CreateLink(script, beh, link->GetOutBehaviorIO(), outPos);
         link->SetOutBehaviorIO(beh->GetInput(inPos));
+        InvalidateScriptLinks(script);
     }
 
     CKParameterLocal *CreateLocalParameter(CKBehavior *script, const char *name, CKGUID type) {
@@ -105,121 +270,51 @@ namespace ScriptHelper {
 
     CKBehaviorLink *FindNextLink(CKBehavior *script, CKBehavior *beh, const char *name, int inPos, int outPos,
                                  int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
-        int linkCnt = script->GetSubBehaviorLinkCount();
-        for (int i = 0; i < linkCnt; i++) {
-            CKBehaviorLink *link = script->GetSubBehaviorLink(i);
-            CKBehaviorIO *in = link->GetInBehaviorIO();
-
-            if (in->GetOwner() == beh && (inPos < 0 || beh->GetOutput(inPos) == in)) {
-                CKBehaviorIO *out = link->GetOutBehaviorIO();
-                CKBehavior *outBeh = out->GetOwner();
-
-                if ((!name || !strcmp(outBeh->GetName(), name)) && (outPos < 0 || outBeh->GetInput(outPos) == out) &&
-                    (inputCnt < 0 || outBeh->GetInputCount() == inputCnt) &&
-                    (outputCnt < 0 || outBeh->GetOutputCount() == outputCnt) &&
-                    (inputParamCnt < 0 || outBeh->GetInputParameterCount() == inputParamCnt) &&
-                    (outputParamCnt < 0 || outBeh->GetOutputParameterCount() == outputParamCnt))
-                    return link;
-            }
-        }
-
-        return nullptr;
+        return HandOut(script, NextLink(script, beh, name, inPos, outPos, inputCnt, outputCnt, inputParamCnt,
+                                        outputParamCnt));
     }
 
     CKBehaviorLink *FindPreviousLink(CKBehavior *script, CKBehavior *beh, const char *name, int inPos, int outPos,
                                      int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
-        int linkCnt = script->GetSubBehaviorLinkCount();
-        for (int i = 0; i < linkCnt; i++) {
-            CKBehaviorLink *link = script->GetSubBehaviorLink(i);
-            CKBehaviorIO *out = link->GetOutBehaviorIO();
-
-            if (out->GetOwner() == beh && (outPos < 0 || beh->GetInput(outPos) == out)) {
-                CKBehaviorIO *in = link->GetInBehaviorIO();
-                CKBehavior *inBeh = in->GetOwner();
-
-                if ((!name || !strcmp(inBeh->GetName(), name)) && (inPos < 0 || inBeh->GetOutput(inPos) == in) &&
-                    (inputCnt < 0 || inBeh->GetInputCount() == inputCnt) &&
-                    (outputCnt < 0 || inBeh->GetOutputCount() == outputCnt) &&
-                    (inputParamCnt < 0 || inBeh->GetInputParameterCount() == inputParamCnt) &&
-                    (outputParamCnt < 0 || inBeh->GetOutputParameterCount() == outputParamCnt))
-                    return link;
-            }
-        }
-
-        return nullptr;
+        return HandOut(script, PreviousLink(script, beh, name, inPos, outPos, inputCnt, outputCnt, inputParamCnt,
+                                            outputParamCnt));
     }
 
     CKBehavior *FindNextBB(CKBehavior *script, CKBehavior *beh, const char *name, int inPos, int outPos,
                            int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
-        CKBehaviorLink *link = FindNextLink(script, beh, name, inPos, outPos, inputCnt, outputCnt, inputParamCnt,
-                                            outputParamCnt);
+        CKBehaviorLink *link = NextLink(script, beh, name, inPos, outPos, inputCnt, outputCnt, inputParamCnt,
+                                        outputParamCnt);
         return link ? link->GetOutBehaviorIO()->GetOwner() : nullptr;
     }
 
     CKBehavior *FindPreviousBB(CKBehavior *script, CKBehavior *beh, const char *name, int inPos, int outPos,
                                int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
-        CKBehaviorLink *link = FindPreviousLink(script, beh, name, inPos, outPos, inputCnt, outputCnt, inputParamCnt,
-                                                outputParamCnt);
+        CKBehaviorLink *link = PreviousLink(script, beh, name, inPos, outPos, inputCnt, outputCnt, inputParamCnt,
+                                            outputParamCnt);
         return link ? link->GetInBehaviorIO()->GetOwner() : nullptr;
     }
 
     CKBehaviorLink *FindNextLink(CKBehavior *script, CKBehaviorIO *io, const char *name, int outPos,
                                  int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
-        int linkCnt = script->GetSubBehaviorLinkCount();
-        for (int i = 0; i < linkCnt; i++) {
-            CKBehaviorLink *link = script->GetSubBehaviorLink(i);
-            CKBehaviorIO *in = link->GetInBehaviorIO();
-
-            if (in == io) {
-                CKBehaviorIO *out = link->GetOutBehaviorIO();
-                CKBehavior *outBeh = out->GetOwner();
-
-                if ((!name || !strcmp(outBeh->GetName(), name)) && (outPos < 0 || outBeh->GetInput(outPos) == out) &&
-                    (inputCnt < 0 || outBeh->GetInputCount() == inputCnt) &&
-                    (outputCnt < 0 || outBeh->GetOutputCount() == outputCnt) &&
-                    (inputParamCnt < 0 || outBeh->GetInputParameterCount() == inputParamCnt) &&
-                    (outputParamCnt < 0 || outBeh->GetOutputParameterCount() == outputParamCnt))
-                    return link;
-            }
-        }
-
-        return nullptr;
+        return HandOut(script, NextLink(script, io, name, outPos, inputCnt, outputCnt, inputParamCnt, outputParamCnt));
     }
 
     CKBehaviorLink *FindPreviousLink(CKBehavior *script, CKBehaviorIO *io, const char *name, int inPos,
                                      int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
-        int linkCnt = script->GetSubBehaviorLinkCount();
-        for (int i = 0; i < linkCnt; i++) {
-            CKBehaviorLink *link = script->GetSubBehaviorLink(i);
-            CKBehaviorIO *out = link->GetOutBehaviorIO();
-
-            if (out == io) {
-                CKBehaviorIO *in = link->GetInBehaviorIO();
-                CKBehavior *inBeh = in->GetOwner();
-
-                if ((!name || !strcmp(inBeh->GetName(), name)) && (inPos < 0 || inBeh->GetOutput(inPos) == in) &&
-                    (inputCnt < 0 || inBeh->GetInputCount() == inputCnt) &&
-                    (outputCnt < 0 || inBeh->GetOutputCount() == outputCnt) &&
-                    (inputParamCnt < 0 || inBeh->GetInputParameterCount() == inputParamCnt) &&
-                    (outputParamCnt < 0 || inBeh->GetOutputParameterCount() == outputParamCnt))
-                    return link;
-            }
-        }
-
-        return nullptr;
+        return HandOut(script, PreviousLink(script, io, name, inPos, inputCnt, outputCnt, inputParamCnt,
+                                            outputParamCnt));
     }
 
     CKBehavior *FindNextBB(CKBehavior *script, CKBehaviorIO *io, const char *name, int outPos,
                            int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
-        CKBehaviorLink *link = FindNextLink(script, io, name, outPos, inputCnt, outputCnt, inputParamCnt,
-                                            outputParamCnt);
+        CKBehaviorLink *link = NextLink(script, io, name, outPos, inputCnt, outputCnt, inputParamCnt, outputParamCnt);
         return link ? link->GetOutBehaviorIO()->GetOwner() : nullptr;
     }
 
     CKBehavior *FindPreviousBB(CKBehavior *script, CKBehaviorIO *io, const char *name, int inPos,
                                int inputCnt, int outputCnt, int inputParamCnt, int outputParamCnt) {
-        CKBehaviorLink *link = FindPreviousLink(script, io, name, inPos, inputCnt, outputCnt, inputParamCnt,
-                                                outputParamCnt);
+        CKBehaviorLink *link = PreviousLink(script, io, name, inPos, inputCnt, outputCnt, inputParamCnt,
+                                            outputParamCnt);
         return link ? link->GetInBehaviorIO()->GetOwner() : nullptr;
     }
 
@@ -247,6 +342,7 @@ namespace ScriptHelper {
 
         link->SetInBehaviorIO(nopout);
         link->SetOutBehaviorIO(nopin);
+        InvalidateScriptLinks(script);
     }
 
     void DeleteBB(CKBehavior *script, CKBehavior *beh) {
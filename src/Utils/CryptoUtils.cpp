@@ -9,6 +9,7 @@
 #include <Windows.h>
 #include <bcrypt.h>
 
+#include <algorithm>
 #include <array>
 #include <cstring>
 #include <vector>
@@ -165,6 +166,58 @@ namespace utils {
         return status == 0;
     }
 
+    Sha256Hasher::Sha256Hasher() {
+        BCRYPT_ALG_HANDLE algorithm = nullptr;
+        if (!OpenSha256Provider(&algorithm)) {
+            return;
+        }
+        BCRYPT_HASH_HANDLE hash = nullptr;
+        if (BCryptCreateHash(algorithm, &hash, nullptr, 0, nullptr, 0, 0) != 0) {
+            BCryptCloseAlgorithmProvider(algorithm, 0);
+            return;
+        }
+        m_Algorithm = algorithm;
+        m_Hash = hash;
+        m_Ok = true;
+    }
+
+    Sha256Hasher::~Sha256Hasher() {
+        if (m_Hash) {
+            BCryptDestroyHash(static_cast<BCRYPT_HASH_HANDLE>(m_Hash));
+        }
+        if (m_Algorithm) {
+            BCryptCloseAlgorithmProvider(static_cast<BCRYPT_ALG_HANDLE>(m_Algorithm), 0);
+        }
+    }
+
+    bool Sha256Hasher::Update(const void *data, size_t dataLength) {
+        if (!m_Ok || (!data && dataLength > 0)) {
+            m_Ok = false;
+            return false;
+        }
+
+        // BCryptHashData takes a ULONG length
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        while (dataLength > 0) {
+            const ULONG chunk = static_cast<ULONG>(std::min<size_t>(dataLength, 0x40000000));
+            if (BCryptHashData(static_cast<BCRYPT_HASH_HANDLE>(m_Hash), const_cast<PUCHAR>(bytes), chunk, 0) != 0) {
+                m_Ok = false;
+                return false;
+            }
+            bytes += chunk;
+            dataLength -= chunk;
+        }
+        return true;
+    }
+
+    bool Sha256Hasher::Finish(uint8_t outDigest[32]) {
+        if (!m_Ok || !outDigest) {
+            return false;
+        }
+        m_Ok = false;
+        return BCryptFinishHash(static_cast<BCRYPT_HASH_HANDLE>(m_Hash), outDigest, static_cast<ULONG>(kSha256Length), 0) == 0;
+    }
+
     std::vector<uint8_t> Sha256Bytes(const uint8_t *data, size_t dataLength) {
         std::vector<uint8_t> digest(kSha256Length);
         if (!Sha256(data, dataLength, digest.data())) {
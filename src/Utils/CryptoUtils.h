@@ -27,6 +27,26 @@ namespace utils {
                                   const uint8_t *info, size_t infoLength,
                                   uint8_t *outBytes, size_t outLength);
     [[nodiscard]] uint64_t KeyToSeed(const uint8_t *key, size_t keyLength);
+
+    // SHA-256 over data that arrives in pieces, such as a file being written.
+    // Finish can be called once. Any failure sticks: later Update calls and
+    // Finish then return false.
+    class Sha256Hasher {
+    public:
+        Sha256Hasher();
+        ~Sha256Hasher();
+
+        Sha256Hasher(const Sha256Hasher &) = delete;
+        Sha256Hasher &operator=(const Sha256Hasher &) = delete;
+
+        [[nodiscard]] bool Update(const void *data, size_t dataLength);
+        [[nodiscard]] bool Finish(uint8_t outDigest[32]);
+
+    private:
+        void *m_Algorithm{nullptr};
+        void *m_Hash{nullptr};
+        bool m_Ok{false};
+    };
 } // namespace utils
 
 #endif // BML_CRYPTO_UTILS_H
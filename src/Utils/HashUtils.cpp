@@ -1,12 +1,175 @@
 #include "HashUtils.h"
 
+#include <array>
 #include <cstdio>
+#include <cstring>
+
+#include "SplitMix64.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BML_HASH128_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
 
 namespace {
     constexpr uint64_t kFnv1a64OffsetBasis = 14695981039346656037ull;
     constexpr uint64_t kFnv1a64Prime = 1099511628211ull;
     constexpr uint32_t kFnv1a32OffsetBasis = 2166136261u;
     constexpr uint32_t kFnv1a32Prime = 16777619u;
+
+    // -- ContentHash128 --
+
+    constexpr size_t kLanes = 8;
+    constexpr size_t kStripeSize = kLanes * sizeof(uint64_t);
+    // Accumulators are scrambled after each block of stripes; stripe n of a
+    // block is keyed with the secret words starting at n.
+    constexpr size_t kStripesPerBlock = 16;
+    constexpr size_t kScrambleOffset = kStripesPerBlock + kLanes;
+    constexpr size_t kFinalOffset = kScrambleOffset + kLanes;
+    constexpr size_t kSecretWords = kFinalOffset + 2 * kLanes;
+
+    constexpr uint64_t kPrime32 = 0x9E3779B1ull;
+    constexpr uint64_t kPrime64A = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t kPrime64B = 0xC2B2AE3D27D4EB4Full;
+
+    constexpr std::array<uint64_t, kSecretWords> MakeSecret() {
+        std::array<uint64_t, kSecretWords> secret = {};
+        uint64_t state = 0x424D4C48617368ull; // "BMLHash"
+        for (uint64_t &word : secret) {
+            state += 0x9E3779B97F4A7C15ull;
+            word = utils::SplitMix64Once(state);
+        }
+        return secret;
+    }
+
+    constexpr std::array<uint64_t, kSecretWords> kSecret = MakeSecret();
+
+    uint64_t Load64(const uint8_t *p) {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    // Folded 64x64->128 product.
+    uint64_t MulFold64(uint64_t lhs, uint64_t rhs) {
+#if defined(__SIZEOF_INT128__)
+        const unsigned __int128 product = static_cast<unsigned __int128>(lhs) * rhs;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        uint64_t high;
+        const uint64_t low = _umul128(lhs, rhs, &high);
+        return low ^ high;
+#else
+        const uint64_t lo = (lhs & 0xFFFFFFFFull) * (rhs & 0xFFFFFFFFull);
+        const uint64_t hl = (lhs >> 32) * (rhs & 0xFFFFFFFFull);
+        const uint64_t lh = (lhs & 0xFFFFFFFFull) * (rhs >> 32);
+        const uint64_t hh = (lhs >> 32) * (rhs >> 32);
+        const uint64_t cross = (lo >> 32) + (hl & 0xFFFFFFFFull) + lh;
+        const uint64_t low = (cross << 32) | (lo & 0xFFFFFFFFull);
+        const uint64_t high = (hl >> 32) + (cross >> 32) + hh;
+        return low ^ high;
+#endif
+    }
+
+    struct ScalarLanes {
+        static void Accumulate(uint64_t *acc, const uint8_t *stripe, const uint64_t *secret) {
+            for (size_t lane = 0; lane < kLanes; ++lane) {
+                const uint64_t value = Load64(stripe + lane * sizeof(uint64_t));
+                const uint64_t keyed = value ^ secret[lane];
+                acc[lane ^ 1] += value;
+                acc[lane] += (keyed & 0xFFFFFFFFull) * (keyed >> 32);
+            }
+        }
+
+        static void Scramble(uint64_t *acc, const uint64_t *secret) {
+            for (size_t lane = 0; lane < kLanes; ++lane) {
+                uint64_t value = acc[lane];
+                value ^= value >> 47;
+                value ^= secret[lane];
+                acc[lane] = value * kPrime32;
+            }
+        }
+    };
+
+#if BML_HASH128_SSE2
+    // Two lanes per register; the same arithmetic as ScalarLanes.
+    struct Sse2Lanes {
+        static void Accumulate(uint64_t *acc, const uint8_t *stripe, const uint64_t *secret) {
+            for (size_t i = 0; i < kLanes / 2; ++i) {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(stripe) + i);
+                const __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i *>(secret) + i);
+                const __m128i keyed = _mm_xor_si128(value, key);
+                const __m128i keyedHigh = _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+                const __m128i product = _mm_mul_epu32(keyed, keyedHigh);
+                const __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+                __m128i *lanes = reinterpret_cast<__m128i *>(acc) + i;
+                _mm_storeu_si128(lanes, _mm_add_epi64(_mm_loadu_si128(lanes), _mm_add_epi64(product, swapped)));
+            }
+        }
+
+        static void Scramble(uint64_t *acc, const uint64_t *secret) {
+            const __m128i prime = _mm_set1_epi32(static_cast<int>(kPrime32));
+            for (size_t i = 0; i < kLanes / 2; ++i) {
+                __m128i *lanes = reinterpret_cast<__m128i *>(acc) + i;
+                __m128i value = _mm_loadu_si128(lanes);
+                value = _mm_xor_si128(value, _mm_srli_epi64(value, 47));
+                value = _mm_xor_si128(value, _mm_loadu_si128(reinterpret_cast<const __m128i *>(secret) + i));
+                const __m128i low = _mm_mul_epu32(value, prime);
+                const __m128i high = _mm_mul_epu32(_mm_srli_epi64(value, 32), prime);
+                _mm_storeu_si128(lanes, _mm_add_epi64(low, _mm_slli_epi64(high, 32)));
+            }
+        }
+    };
+#endif
+
+    template <typename Lanes>
+    utils::Hash128 ContentHash128Impl(const void *data, size_t size, uint64_t seed) {
+        std::array<uint64_t, kSecretWords> secret = kSecret;
+        if (seed != 0) {
+            for (size_t i = 0; i < kSecretWords; ++i)
+                secret[i] += (i & 1) ? 0 - seed : seed;
+        }
+
+        alignas(16) uint64_t acc[kLanes] = {
+            kPrime32, kPrime64A, kPrime64B, 0x165667B19E3779F9ull,
+            0x85EBCA77C2B2AE63ull, 0x27D4EB2F165667C5ull, 0x61C8864E7A143579ull, 0xC2B2AE3D27D4EB4Full,
+        };
+
+        const auto *p = static_cast<const uint8_t *>(data);
+        size_t remaining = size;
+        size_t stripe = 0;
+        while (remaining >= kStripeSize) {
+            Lanes::Accumulate(acc, p, secret.data() + stripe);
+            p += kStripeSize;
+            remaining -= kStripeSize;
+            if (++stripe == kStripesPerBlock) {
+                Lanes::Scramble(acc, secret.data() + kScrambleOffset);
+                stripe = 0;
+            }
+        }
+        if (remaining != 0) {
+            // Zero padding is told apart by the length mixed in below
+            alignas(16) uint8_t last[kStripeSize] = {};
+            std::memcpy(last, p, remaining);
+            Lanes::Accumulate(acc, last, secret.data() + stripe);
+        }
+
+        const uint64_t *finalKey = secret.data() + kFinalOffset;
+        uint64_t low = static_cast<uint64_t>(size) * kPrime64A ^ seed;
+        uint64_t high = ~(static_cast<uint64_t>(size) * kPrime64B) ^ seed;
+        for (size_t i = 0; i < kLanes; i += 2) {
+            low += MulFold64(acc[i] ^ finalKey[i], acc[i + 1] ^ finalKey[i + 1]);
+            high += MulFold64(acc[i] ^ finalKey[kLanes + i], acc[i + 1] ^ finalKey[kLanes + i + 1]);
+        }
+
+        utils::Hash128 hash;
+        hash.Low = utils::SplitMix64Once(low);
+        hash.High = utils::SplitMix64Once(high ^ hash.Low);
+        return hash;
+    }
 }
 
 namespace utils {
@@ -63,4 +226,22 @@ namespace utils {
         std::snprintf(buf, sizeof(buf), "%08x", static_cast<unsigned>(value));
         return buf;
     }
+
+    Hash128 ContentHash128(const void *data, size_t size, uint64_t seed) {
+#if BML_HASH128_SSE2
+        return ContentHash128Impl<Sse2Lanes>(data, size, seed);
+#else
+        return ContentHash128Impl<ScalarLanes>(data, size, seed);
+#endif
+    }
+
+    std::string ToHex128(const Hash128 &value) {
+        return ToHex64(value.High) + ToHex64(value.Low);
+    }
+
+    namespace detail {
+        Hash128 ContentHash128Scalar(const void *data, size_t size, uint64_t seed) {
+            return ContentHash128Impl<ScalarLanes>(data, size, seed);
+        }
+    } // namespace detail
 } // namespace utils
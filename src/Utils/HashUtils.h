@@ -68,6 +68,39 @@ namespace utils {
     inline std::string Fnv1a32Hex(std::string_view sv) {
         return ToHex32(Fnv1a32(sv));
     }
+
+    // -- 128-bit content hash --
+    //
+    // Fast non-cryptographic hash for change detection (source snapshots,
+    // caches). Eight 64-bit lanes consume 64-byte stripes, with SSE2 where the
+    // target has it; both paths produce the same value. Not collision resistant
+    // against an adversary: use Sha256 wherever content is verified.
+
+    struct Hash128 {
+        uint64_t Low = 0;
+        uint64_t High = 0;
+
+        bool operator==(const Hash128 &other) const { return Low == other.Low && High == other.High; }
+        bool operator!=(const Hash128 &other) const { return !(*this == other); }
+    };
+
+    Hash128 ContentHash128(const void *data, size_t size, uint64_t seed = 0);
+
+    inline Hash128 ContentHash128(std::string_view sv, uint64_t seed = 0) {
+        return ContentHash128(sv.data(), sv.size(), seed);
+    }
+
+    // 32 hex digits, high half first.
+    std::string ToHex128(const Hash128 &value);
+
+    inline std::string ContentHash128Hex(std::string_view sv) {
+        return ToHex128(ContentHash128(sv));
+    }
+
+    namespace detail {
+        // The portable path, exposed so tests can check the SIMD path against it.
+        Hash128 ContentHash128Scalar(const void *data, size_t size, uint64_t seed);
+    } // namespace detail
 } // namespace utils
 
 #endif // BML_HASHUTILS_H
@@ -1,7 +1,8 @@
 #ifndef BML_PATHUTILSDETAIL_H
 #define BML_PATHUTILSDETAIL_H
 
-// Internal detail header - included only by PathUtils.cpp.
+// Internal detail header - included by PathUtils.cpp, and by portable code
+// that needs the pure-string helpers without linking BML_PathUtils.
 // Provides template implementations for pure-string path manipulation
 // that is identical across char/wchar_t, eliminating A/W duplication.
 
@@ -11,6 +12,9 @@
 
 #ifdef _WIN32
 #include <cstring> // _stricmp, _wcsicmp
+#else
+#include <strings.h> // strcasecmp
+#include <cwchar>    // wcscasecmp
 #endif
 
 namespace utils::detail {
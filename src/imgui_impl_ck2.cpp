@@ -12,11 +12,13 @@
 
 // CHANGELOG
 // (minor and older changes stripped away, please see git history for details)
+//  2026-10-18: Virtools: Convert vertices with SSE2 and merge consecutive commands sharing a texture into one DrawPrimitive call.
 //  2025-08-20: Virtools: Added support for ImGuiBackendFlags_RendererHasTextures, for dynamic font atlas.
 //  2025-08-20: Virtools: Changed default texture sampler to Clamp instead of Repeat/Wrap.
 
 #include "imgui.h"
 #include "imgui_impl_ck2.h"
+#include "ImGuiDrawBatch.h"
 
 // Virtools
 #include "CKContext.h"
@@ -31,6 +33,7 @@ struct ImGui_ImplCK2_Data
     CKContext *Context;
     CKRenderContext *RenderContext;
     CKTexture *FontTexture;
+    ImVector<ImDrawCmd> Batches; // Scratch list of merged commands, reused across frames
 
     ImGui_ImplCK2_Data() { memset(this, 0, sizeof(*this)); }
 };
@@ -198,6 +201,28 @@ void ImGui_ImplCK2_UpdateTexture(ImTextureData *tex)
     }
 }
 
+// Fill a draw primitive structure with vtx_count converted vertices
+static VxDrawPrimitiveData *ImGui_ImplCK2_ConvertVertices(CKRenderContext *dev, const ImDrawVert *vtx_src, int vtx_count)
+{
+    VxDrawPrimitiveData *data = dev->GetDrawPrimitiveStructure((CKRST_DPFLAGS)(CKRST_DP_CL_VCT | CKRST_DP_VBUFFER), vtx_count);
+    if (!data)
+    {
+        data = dev->GetDrawPrimitiveStructure(CKRST_DP_CL_VCT, vtx_count);
+        if (!data)
+            return NULL;
+    }
+
+    BML::ImGuiVertexTarget target;
+    target.Positions = data->PositionPtr;
+    target.PositionStride = data->PositionStride;
+    target.Colors = data->ColorPtr;
+    target.ColorStride = data->ColorStride;
+    target.TexCoords = data->TexCoordPtr;
+    target.TexCoordStride = data->TexCoordStride;
+    BML::ConvertImGuiVertices(vtx_src, vtx_count, target);
+    return data;
+}
+
 // Render function.
 void ImGui_ImplCK2_RenderDrawData(ImDrawData *draw_data)
 {
@@ -223,9 +248,12 @@ void ImGui_ImplCK2_RenderDrawData(ImDrawData *draw_data)
     // Setup desired render state
     ImGui_ImplCK2_SetupRenderState(draw_data);
 
-    // Will project scissor/clipping rectangles into framebuffer space
-    ImVec2 clip_off = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
-    ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
+    // Commands are culled against the framebuffer and merged into batches
+    BML::ImGuiDrawViewport viewport;
+    viewport.ClipOffset = draw_data->DisplayPos;       // (0,0) unless using multi-viewports
+    viewport.ClipScale = draw_data->FramebufferScale;  // (1,1) unless using retina display which are often (2,2)
+    viewport.Width = (float)fb_width;
+    viewport.Height = (float)fb_height;
 
     // Render command lists
     for (int n = 0; n < draw_data->CmdListsCount; n++)
@@ -234,45 +262,25 @@ void ImGui_ImplCK2_RenderDrawData(ImDrawData *draw_data)
         const ImDrawVert *vtx_buffer = cmd_list->VtxBuffer.Data;
         const ImDrawIdx *idx_buffer = cmd_list->IdxBuffer.Data;
 
+        BML::BuildImGuiDrawBatches(cmd_list->CmdBuffer, viewport, bd->Batches);
+        if (bd->Batches.empty())
+            continue;
+
         VxDrawPrimitiveData *data = NULL;
         bool use_large_mesh_approach = cmd_list->VtxBuffer.Size >= 0xFFFF;
 
         // For normal sized meshes, prepare all vertices at once
         if (!use_large_mesh_approach)
         {
-            const ImDrawVert *vtx_src = vtx_buffer;
-            int vtx_count = cmd_list->VtxBuffer.Size;
-
-            data = dev->GetDrawPrimitiveStructure((CKRST_DPFLAGS)(CKRST_DP_CL_VCT | CKRST_DP_VBUFFER), vtx_count);
+            data = ImGui_ImplCK2_ConvertVertices(dev, vtx_buffer, cmd_list->VtxBuffer.Size);
             if (!data)
-            {
-                data = dev->GetDrawPrimitiveStructure(CKRST_DP_CL_VCT, vtx_count);
-                if (!data)
-                    continue;
-            }
-
-            XPtrStrided<VxVector4> positions(data->PositionPtr, data->PositionStride);
-            XPtrStrided<CKDWORD> colors(data->ColorPtr, data->ColorStride);
-            XPtrStrided<VxUV> uvs(data->TexCoordPtr, data->TexCoordStride);
-
-            for (int i = 0; i < vtx_count; i++)
-            {
-                positions->Set(vtx_src->pos.x, vtx_src->pos.y, 0.0f, 1.0f);
-                *colors = IMGUI_COL_TO_ARGB(vtx_src->col);
-                uvs->u = vtx_src->uv.x;
-                uvs->v = vtx_src->uv.y;
-
-                ++positions;
-                ++colors;
-                ++uvs;
-                ++vtx_src;
-            }
+                continue;
         }
 
         // Process command buffer
-        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+        for (const ImDrawCmd &batch : bd->Batches)
         {
-            const ImDrawCmd *pcmd = &cmd_list->CmdBuffer[cmd_i];
+            const ImDrawCmd *pcmd = &batch;
 
             // Handle user callbacks
             if (pcmd->UserCallback)
@@ -286,55 +294,25 @@ void ImGui_ImplCK2_RenderDrawData(ImDrawData *draw_data)
                 continue;
             }
 
-            // Project scissor/clipping rectangles into framebuffer space
-            ImVec2 clip_min((pcmd->ClipRect.x - clip_off.x) * clip_scale.x, (pcmd->ClipRect.y - clip_off.y) * clip_scale.y);
-            ImVec2 clip_max((pcmd->ClipRect.z - clip_off.x) * clip_scale.x, (pcmd->ClipRect.w - clip_off.y) * clip_scale.y);
-
-            // Apply scissor/clipping rectangle (Y is inverted in CK2)
-            if (clip_min.x < 0.0f) { clip_min.x = 0.0f; }
-            if (clip_min.y < 0.0f) { clip_min.y = 0.0f; }
-            if (clip_max.x > (float)fb_width) { clip_max.x = (float)fb_width; }
-            if (clip_max.y > (float)fb_height) { clip_max.y = (float)fb_height; }
-            if (clip_max.x <= clip_min.x || clip_max.y <= clip_min.y)
-                continue;
+            // Set texture or material
+            CKObject *obj = (CKObject *)pcmd->GetTexID();
+            if (!obj)
+                continue; // Skip if no texture/material
 
-            // Handle per-chunk vertex data for large meshes
+            // Handle per-batch vertex data for large meshes: the indices are relative to VtxOffset
             if (use_large_mesh_approach)
             {
-                const ImDrawVert *vtx_src = vtx_buffer + pcmd->VtxOffset;
-                int vtx_count = pcmd->ElemCount;
+                const ImDrawIdx *idx = idx_buffer + pcmd->IdxOffset;
+                unsigned int vtx_count = 0;
+                for (unsigned int i = 0; i < pcmd->ElemCount; i++)
+                    if (idx[i] >= vtx_count)
+                        vtx_count = idx[i] + 1u;
 
-                data = dev->GetDrawPrimitiveStructure((CKRST_DPFLAGS)(CKRST_DP_CL_VCT | CKRST_DP_VBUFFER), vtx_count);
+                data = ImGui_ImplCK2_ConvertVertices(dev, vtx_buffer + pcmd->VtxOffset, (int)vtx_count);
                 if (!data)
-                {
-                    data = dev->GetDrawPrimitiveStructure(CKRST_DP_CL_VCT, vtx_count);
-                    if (!data)
-                        continue;
-                }
-
-                // Copy vertex data
-                XPtrStrided<VxVector4> positions(data->PositionPtr, data->PositionStride);
-                XPtrStrided<CKDWORD> colors(data->ColorPtr, data->ColorStride);
-                XPtrStrided<VxUV> uvs(data->TexCoordPtr, data->TexCoordStride);
-
-                for (int i = 0; i < vtx_count; i++)
-                {
-                    positions->Set(vtx_src[i].pos.x, vtx_src[i].pos.y, 0.0f, 1.0f);
-                    *colors = IMGUI_COL_TO_ARGB(vtx_src[i].col);
-                    uvs->u = vtx_src[i].uv.x;
-                    uvs->v = vtx_src[i].uv.y;
-
-                    ++positions;
-                    ++colors;
-                    ++uvs;
-                }
+                    continue;
             }
 
-            // Set texture or material
-            CKObject *obj = (CKObject *)pcmd->GetTexID();
-            if (!obj)
-                continue; // Skip if no texture/material
-
             if (obj->GetClassID() == CKCID_TEXTURE)
             {
                 CKTexture *texture = (CKTexture *)obj;
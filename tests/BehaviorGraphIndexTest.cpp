@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "BehaviorGraphIndex.h"
+
+namespace {
+
+struct MockBehavior;
+
+struct MockIO {
+    MockBehavior *Owner = nullptr;
+};
+
+struct MockLink {
+    MockIO *In = nullptr;
+    MockIO *Out = nullptr;
+};
+
+struct MockBehavior {
+    std::string Name;
+    std::vector<MockBehavior *> Children;
+    std::vector<MockLink *> Links;
+    MockIO Input;
+    MockIO Output;
+};
+
+struct MockGraph {
+    using Behavior = MockBehavior;
+    using Link = MockLink;
+
+    static int SubBehaviorCount(MockBehavior *beh) { return static_cast<int>(beh->Children.size()); }
+    static MockBehavior *SubBehavior(MockBehavior *beh, int i) { return beh->Children[i]; }
+    static const char *Name(MockBehavior *beh) { return beh->Name.c_str(); }
+    static int LinkCount(MockBehavior *beh) { return static_cast<int>(beh->Links.size()); }
+    static MockLink *GetLink(MockBehavior *beh, int i) { return beh->Links[i]; }
+    static MockIO *LinkIn(MockLink *link) { return link->In; }
+    static MockIO *LinkOut(MockLink *link) { return link->Out; }
+    static MockBehavior *Owner(MockIO *io) { return io->Owner; }
+};
+
+using Index = BehaviorGraphIndex<MockGraph>;
+
+class Script {
+public:
+    MockBehavior *Add(MockBehavior *parent, const std::string &name) {
+        MockBehavior &beh = m_Behaviors.emplace_back();
+        beh.Name = name;
+        beh.Input.Owner = &beh;
+        beh.Output.Owner = &beh;
+        if (parent)
+            parent->Children.push_back(&beh);
+        return &beh;
+    }
+
+    MockLink *Link(MockBehavior *graph, MockBehavior *from, MockBehavior *to) {
+        MockLink &link = m_Links.emplace_back();
+        link.In = &from->Output;
+        link.Out = &to->Input;
+        graph->Links.push_back(&link);
+        return &link;
+    }
+
+private:
+    std::deque<MockBehavior> m_Behaviors;
+    std::deque<MockLink> m_Links;
+};
+
+// ScriptHelper::FindBB without the count filters.
+void Walk(MockBehavior *script, const char *name, bool hierarchically, std::vector<MockBehavior *> &out) {
+    for (MockBehavior *beh : script->Children) {
+        if (hierarchically && !beh->Children.empty())
+            Walk(beh, name, hierarchically, out);
+        if (beh->Name == name)
+            out.push_back(beh);
+    }
+}
+
+std::vector<MockLink *> Outgoing(MockBehavior *graph, MockBehavior *beh) {
+    std::vector<MockLink *> links;
+    for (MockLink *link : graph->Links) {
+        if (link->In->Owner == beh)
+            links.push_back(link);
+    }
+    return links;
+}
+
+} // namespace
+
+TEST(BehaviorGraphIndexTest, FindsBehaviorsInTheOrderOfAWalk) {
+    Script script;
+    MockBehavior *root = script.Add(nullptr, "Gameplay_Ingame");
+    MockBehavior *init = script.Add(root, "Init Ingame");
+    script.Add(init, "Set Attribute");
+    MockBehavior *nested = script.Add(init, "Sequencer");
+    script.Add(nested, "Set Attribute");
+    script.Add(nested, "Identity");
+    script.Add(root, "Set Attribute");
+    MockBehavior *ballNav = script.Add(root, "Ball Navigation");
+    script.Add(ballNav, "Identity");
+    script.Add(ballNav, "Set Attribute");
+    script.Add(root, "Identity");
+
+    Index index;
+    index.Build(root);
+    EXPECT_EQ(index.Size(), 11u);
+
+    for (MockBehavior *graph : {root, init, nested, ballNav}) {
+        for (const char *name : {"Set Attribute", "Identity", "Sequencer", "Gameplay_Ingame", "Missing"}) {
+            for (bool hierarchically : {false, true}) {
+                std::vector<MockBehavior *> expected;
+                Walk(graph, name, hierarchically, expected);
+                std::vector<MockBehavior *> found;
+                ASSERT_TRUE(index.FindByName(graph, name, hierarchically, found));
+                EXPECT_EQ(found, expected) << graph->Name << " / " << name << (hierarchically ? " (deep)" : "");
+            }
+        }
+    }
+
+    std::vector<MockBehavior *> found;
+    MockBehavior *outside = script.Add(nullptr, "Outside");
+    EXPECT_FALSE(index.FindByName(outside, "Identity", true, found));
+    EXPECT_FALSE(index.FindByName(root, nullptr, true, found));
+}
+
+TEST(BehaviorGraphIndexTest, StopsAnsweringWhenTheGraphChanges) {
+    Script script;
+    MockBehavior *root = script.Add(nullptr, "Level");
+    script.Add(root, "Identity");
+
+    Index index;
+    index.Build(root);
+    std::vector<MockBehavior *> found;
+    ASSERT_TRUE(index.FindByName(root, "Identity", false, found));
+    EXPECT_EQ(found.size(), 1u);
+
+    script.Add(root, "Identity");
+    EXPECT_FALSE(index.FindByName(root, "Identity", false, found));
+
+    index.Invalidate();
+    EXPECT_TRUE(index.Stale());
+    EXPECT_FALSE(index.FindByName(root, "Identity", false, found));
+    EXPECT_EQ(index.FindLinks(root, root, true), nullptr);
+
+    index.Build(index.Root());
+    ASSERT_TRUE(index.FindByName(root, "Identity", false, found));
+    EXPECT_EQ(found.size(), 2u);
+}
+
+TEST(BehaviorGraphIndexTest, StopsAnsweringWhenANestedGraphChanges) {
+    Script script;
+    MockBehavior *root = script.Add(nullptr, "Level");
+    MockBehavior *init = script.Add(root, "Init");
+    MockBehavior *nested = script.Add(init, "Sequencer");
+    script.Add(root, "Identity");
+
+    Index index;
+    index.Build(root);
+    std::vector<MockBehavior *> found;
+    ASSERT_TRUE(index.FindByName(root, "Identity", true, found));
+    EXPECT_EQ(found.size(), 1u);
+
+    script.Add(init, "Identity");
+    EXPECT_FALSE(index.FindByName(root, "Identity", true, found));
+    EXPECT_FALSE(index.FindByName(init, "Identity", false, found));
+    // The graph's own children are unchanged, so a flat lookup still holds.
+    ASSERT_TRUE(index.FindByName(root, "Identity", false, found));
+    EXPECT_EQ(found.size(), 1u);
+
+    // An empty graph gaining its first block counts too.
+    index.Build(root);
+    script.Add(nested, "Identity");
+    EXPECT_FALSE(index.FindByName(root, "Identity", true, found));
+
+    index.Build(root);
+    std::vector<MockBehavior *> expected;
+    Walk(root, "Identity", true, expected);
+    ASSERT_TRUE(index.FindByName(root, "Identity", true, found));
+    EXPECT_EQ(found, expected);
+    EXPECT_EQ(found.size(), 3u);
+}
+
+TEST(BehaviorGraphIndexTest, GroupsLinksByTheBehaviorsTheyJoin) {
+    Script script;
+    MockBehavior *root = script.Add(nullptr, "Gameplay_Events");
+    MockBehavior *a = script.Add(root, "A");
+    MockBehavior *b = script.Add(root, "B");
+    MockBehavior *c = script.Add(root, "C");
+    MockLink *ab = script.Link(root, a, b);
+    MockLink *bc = script.Link(root, b, c);
+    MockLink *ac = script.Link(root, a, c);
+
+    Index index;
+    index.Build(root);
+    const std::vector<MockLink *> *links = index.FindLinks(root, a, true);
+    ASSERT_NE(links, nullptr);
+    EXPECT_EQ(*links, (std::vector<MockLink *>{ab, ac}));
+    links = index.FindLinks(root, c, false);
+    ASSERT_NE(links, nullptr);
+    EXPECT_EQ(*links, (std::vector<MockLink *>{bc, ac}));
+    links = index.FindLinks(root, c, true);
+    ASSERT_NE(links, nullptr);
+    EXPECT_TRUE(links->empty());
+
+    // A new link changes the count and is picked up without being reported.
+    MockLink *ca = script.Link(root, c, a);
+    EXPECT_EQ(*index.FindLinks(root, c, true), (std::vector<MockLink *>{ca}));
+
+    // Rewiring keeps the count, so it has to be reported.
+    ab->In = &c->Output;
+    EXPECT_EQ(*index.FindLinks(root, a, true), (std::vector<MockLink *>{ab, ac}));
+    index.InvalidateLinks(root);
+    EXPECT_EQ(*index.FindLinks(root, a, true), Outgoing(root, a));
+    EXPECT_EQ(*index.FindLinks(root, c, true), Outgoing(root, c));
+}
+
+// Compares name lookups on a script the size of a large custom map against
+// walking the graph for each one.
+TEST(BehaviorGraphIndexTest, AnswersRepeatedLookupsOnLargeScripts) {
+    Script script;
+    MockBehavior *root = script.Add(nullptr, "Level_Init");
+    for (int group = 0; group < 200; ++group) {
+        MockBehavior *graph = script.Add(root, "Group " + std::to_string(group));
+        for (int block = 0; block < 50; ++block)
+            script.Add(graph, "Block " + std::to_string(block % 25));
+    }
+    script.Add(root, "Needle");
+
+    Index index;
+    index.Build(root);
+    std::vector<MockBehavior *> found;
+    std::vector<MockBehavior *> expected;
+    for (int lookup = 0; lookup < 200; ++lookup) {
+        const std::string name = "Block " + std::to_string(lookup % 30);
+        ASSERT_TRUE(index.FindByName(root, name.c_str(), true, found));
+        expected.clear();
+        Walk(root, name.c_str(), true, expected);
+        ASSERT_EQ(found, expected);
+    }
+    ASSERT_TRUE(index.FindByName(root, "Needle", false, found));
+    ASSERT_EQ(found.size(), 1u);
+    EXPECT_EQ(found[0]->Name, "Needle");
+}
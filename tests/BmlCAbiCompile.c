@@ -105,7 +105,16 @@ int BML_TestCAbiGameplayInterface(void) {
         if (entry.FileLength < (int) strlen(entry.File))
             return 0;
     }
-    return gameplay->ReadCatalogEntry(count, &entry) == BML_ERROR_NOT_FOUND;
+    if (gameplay->ReadCatalogEntry(count, &entry) != BML_ERROR_NOT_FOUND)
+        return 0;
+
+    /* Minor 1: a range past the last row is an empty answer, not an error. */
+    if (BML_IFACE_HAS(gameplay, BML_GameplayInterface, ReadCatalogEntries)) {
+        size_t written = 1;
+        if (gameplay->ReadCatalogEntries(count, 1, &entry, &written) != BML_OK || written != 0)
+            return 0;
+    }
+    return 1;
 }
 
 // The scene interface is the one that writes text back, so this also checks the
@@ -137,6 +146,19 @@ int BML_TestCAbiSceneInterface(const char *name) {
     if (info.NameLength >= (int) BML_SCENE_NAME_CAPACITY)
         return strlen(info.Name) == BML_SCENE_NAME_CAPACITY - 1u;
 
+    if (BML_IFACE_HAS(scene, BML_SceneInterface, ReadObjects)) {
+        BML_ObjectRef references[2];
+        BML_SceneObjectInfo infos[2];
+        int statuses[2] = {0, 0};
+        references[0] = reference;
+        references[1].Domain = 0u;
+        references[1].Slot = 0u;
+        references[1].Generation = 0u;
+        if (scene->ReadObjects(references, 2, infos, statuses) != BML_ERROR_OBJECT_INVALID ||
+            statuses[0] != BML_OK || statuses[1] != BML_ERROR_OBJECT_INVALID || infos[0].Id != info.Id)
+            return 0;
+    }
+
     return scene->ReadEntityTransform(reference, &transform) != BML_ERROR_INVALID_PARAMETER &&
            scene->FindObjectOfClass(info.Name, info.ClassId, &reference) == BML_OK;
 }
@@ -1,8 +1,32 @@
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+#include <clocale>
+#include <cstdlib>
+#include <new>
+
 #include "CommandContext.h"
 #include "Logger.h"
 
+// Counts heap allocations so the tokenizer tests can check it stays off the heap
+static std::atomic<size_t> g_Allocations{0};
+
+void *operator new(size_t size) {
+    ++g_Allocations;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
 // Stub Logger for test builds
 Logger *Logger::m_DefaultLogger = nullptr;
 
@@ -48,6 +72,21 @@ private:
     std::string m_Alias;
 };
 
+// Command that completes its arguments from a fixed list
+class CompletingCommand : public TestCommand {
+public:
+    CompletingCommand(const char *name, std::vector<std::string> completions)
+        : TestCommand(name), m_Completions(std::move(completions)) {}
+
+    const std::vector<std::string> GetTabCompletion(IBML *, const std::vector<std::string> &) override {
+        ++m_CompletionCount;
+        return m_Completions;
+    }
+
+    std::vector<std::string> m_Completions;
+    int m_CompletionCount = 0;
+};
+
 class CommandContextTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -272,6 +311,93 @@ TEST_F(CommandContextTest, ClearCommands) {
     ctx->ClearCommands();
     EXPECT_EQ(0u, ctx->GetCommandCount());
     EXPECT_EQ(nullptr, ctx->GetCommandByName("aaa"));
+    EXPECT_TRUE(ctx->FindCommandNames("").empty());
+}
+
+// Completion
+TEST_F(CommandContextTest, FindCommandNamesMatchesFoldedPrefix) {
+    ctx->RegisterCommand(MakeCommand("Teleport", "tp"));
+    ctx->RegisterCommand(MakeCommand("time"));
+    ctx->RegisterCommand(MakeCommand("help", "?"));
+
+    EXPECT_EQ((std::vector<std::string>{"Teleport", "time", "tp"}), ctx->FindCommandNames("t"));
+    EXPECT_EQ((std::vector<std::string>{"Teleport"}), ctx->FindCommandNames("TEL"));
+    EXPECT_EQ((std::vector<std::string>{"?", "help", "Teleport", "time", "tp"}), ctx->FindCommandNames(""));
+    EXPECT_TRUE(ctx->FindCommandNames("x").empty());
+    EXPECT_TRUE(ctx->FindCommandNames("teleports").empty());
+}
+
+TEST_F(CommandContextTest, FindCommandNamesFoldsUtf8) {
+    ctx->RegisterCommand(MakeCommand("\xC3\x89tat"));
+
+    EXPECT_EQ((std::vector<std::string>{"\xC3\x89tat"}), ctx->FindCommandNames("\xC3\xA9t"));
+}
+
+TEST_F(CommandContextTest, FindCommandNamesFollowsRegistration) {
+    ctx->RegisterCommand(MakeCommand("teleport", "tp"));
+    ctx->RegisterCommand(MakeCommand("timer"));
+    EXPECT_FALSE(ctx->RegisterCommand(MakeCommand("TIMER")));
+    EXPECT_FALSE(ctx->RegisterCommand(MakeCommand("tab", "bad alias")));
+
+    EXPECT_EQ((std::vector<std::string>{"teleport", "timer", "tp"}), ctx->FindCommandNames("t"));
+
+    ASSERT_TRUE(ctx->UnregisterCommand("tp"));
+    EXPECT_EQ((std::vector<std::string>{"timer"}), ctx->FindCommandNames("t"));
+    EXPECT_TRUE(ctx->FindCommandNames("te").empty());
+}
+
+TEST_F(CommandContextTest, FindCommandNamesKeepsConflictingAliases) {
+    ctx->RegisterCommand(MakeCommand("teleport", "go"));
+    ctx->RegisterCommand(MakeCommand("goto", "go"));
+
+    EXPECT_EQ((std::vector<std::string>{"go", "goto"}), ctx->FindCommandNames("go"));
+
+    ASSERT_TRUE(ctx->UnregisterCommand("teleport"));
+    EXPECT_EQ((std::vector<std::string>{"go", "goto"}), ctx->FindCommandNames("go"));
+
+    ASSERT_TRUE(ctx->UnregisterCommand("goto"));
+    EXPECT_TRUE(ctx->FindCommandNames("go").empty());
+}
+
+TEST_F(CommandContextTest, ArgumentCompletionsFilterAndDeduplicate) {
+    CompletingCommand cmd("load", {"Level01", "level02", "Level01", "menu", ""});
+    ASSERT_TRUE(ctx->RegisterCommand(&cmd));
+
+    const std::vector<std::string> args = {"load", "lev"};
+    EXPECT_EQ((std::vector<std::string>{"Level01", "level02"}), ctx->GetArgumentCompletions(nullptr, &cmd, args, "lev"));
+    EXPECT_EQ((std::vector<std::string>{"Level01", "level02", "menu"}),
+              ctx->GetArgumentCompletions(nullptr, &cmd, {"load", ""}, ""));
+    EXPECT_TRUE(ctx->GetArgumentCompletions(nullptr, nullptr, args, "lev").empty());
+    EXPECT_TRUE(ctx->GetArgumentCompletions(nullptr, &cmd, {}, "").empty());
+
+    ctx->UnregisterCommand("load");
+}
+
+TEST_F(CommandContextTest, ArgumentCompletionsAreCachedUntilInvalidated) {
+    CompletingCommand cmd("load", {"Level01", "level02"});
+    ASSERT_TRUE(ctx->RegisterCommand(&cmd));
+
+    const std::vector<std::string> args = {"load", "l"};
+    for (int i = 0; i < 10; ++i)
+        EXPECT_EQ(2u, ctx->GetArgumentCompletions(nullptr, &cmd, args, "l").size());
+    EXPECT_EQ(1, cmd.m_CompletionCount);
+
+    // A different argument position or prefix is a separate entry
+    ctx->GetArgumentCompletions(nullptr, &cmd, {"load", "x", "l"}, "l");
+    ctx->GetArgumentCompletions(nullptr, &cmd, args, "le");
+    EXPECT_EQ(3, cmd.m_CompletionCount);
+
+    cmd.m_Completions = {"Level03"};
+    EXPECT_EQ(2u, ctx->GetArgumentCompletions(nullptr, &cmd, args, "l").size());
+    ctx->InvalidateCompletionCache();
+    EXPECT_EQ((std::vector<std::string>{"Level03"}), ctx->GetArgumentCompletions(nullptr, &cmd, args, "l"));
+
+    // Changing the command table drops the cache as well
+    ctx->RegisterCommand(MakeCommand("other"));
+    cmd.m_Completions = {"Level04"};
+    EXPECT_EQ((std::vector<std::string>{"Level04"}), ctx->GetArgumentCompletions(nullptr, &cmd, args, "l"));
+
+    ctx->UnregisterCommand("load");
 }
 
 // Variables
@@ -377,6 +503,121 @@ TEST_F(CommandContextTest, ParseCommandLineSingleArg) {
     EXPECT_EQ("test", args[0]);
 }
 
+TEST_F(CommandContextTest, ParseCommandLineKeepsUtf8AndStopsAtNul) {
+    auto args = BML::CommandContext::ParseCommandLine("say \xE4\xBD\xA0\xE5\xA5\xBD\tworld\n");
+    ASSERT_EQ(3u, args.size());
+    EXPECT_EQ("\xE4\xBD\xA0\xE5\xA5\xBD", args[1]);
+    EXPECT_EQ("world", args[2]);
+
+    BML::CommandTokens tokens;
+    BML::CommandContext::TokenizeCommandLine(std::string_view("a b\0c", 5), tokens);
+    ASSERT_EQ(2u, tokens.Size());
+    EXPECT_EQ("b", tokens[1]);
+}
+
+// Tokenizer
+TEST_F(CommandContextTest, TokenizeViewsTheOriginalLine) {
+    const std::string line = "  tp  player   12 ";
+    BML::CommandTokens tokens;
+    BML::CommandContext::TokenizeCommandLine(line, tokens);
+
+    ASSERT_EQ(3u, tokens.Size());
+    EXPECT_EQ("tp", tokens[0]);
+    EXPECT_EQ("player", tokens[1]);
+    EXPECT_EQ("12", tokens[2]);
+    EXPECT_EQ(line.data() + 2, tokens[0].data());
+
+    BML::CommandContext::TokenizeCommandLine(" \t ", tokens);
+    EXPECT_TRUE(tokens.Empty());
+}
+
+TEST_F(CommandContextTest, TokenizeKeepsUtf8ContinuationBytesThatLookLikeSpace) {
+    // 0x85 and 0xA0 are whitespace in some single-byte locales, but here they
+    // are the second bytes of U+0145 and U+00E0.
+    const std::string saved = std::setlocale(LC_CTYPE, nullptr);
+    for (const char *name : {".1252", "en_US.ISO-8859-1", "de_DE.ISO-8859-1"}) {
+        if (std::setlocale(LC_CTYPE, name))
+            break;
+    }
+
+    BML::CommandTokens tokens;
+    BML::CommandContext::TokenizeCommandLine("say \xC5\x85x\xC3\xA0 \xC2\xA0", tokens);
+    std::setlocale(LC_CTYPE, saved.c_str());
+
+    ASSERT_EQ(3u, tokens.Size());
+    EXPECT_EQ("\xC5\x85x\xC3\xA0", tokens[1]);
+    EXPECT_EQ("\xC2\xA0", tokens[2]);
+}
+
+TEST_F(CommandContextTest, TokenizeSpillsPastTheInlineTokens) {
+    std::string line;
+    for (size_t i = 0; i < BML::CommandTokens::kInlineTokens + 4; ++i)
+        line += "t" + std::to_string(i) + " ";
+
+    BML::CommandTokens tokens;
+    BML::CommandContext::TokenizeCommandLine(line, tokens);
+    ASSERT_EQ(BML::CommandTokens::kInlineTokens + 4, tokens.Size());
+    EXPECT_EQ("t0", tokens[0]);
+    EXPECT_EQ("t19", tokens[19]);
+
+    const std::vector<std::string> strings = tokens.ToStrings();
+    EXPECT_EQ(strings, BML::CommandContext::ParseCommandLine(line.c_str()));
+}
+
+TEST_F(CommandContextTest, LookupByTokenIgnoresTheRestOfTheLine) {
+    auto *cmd = MakeCommand("Teleport", "tp");
+    ASSERT_TRUE(ctx->RegisterCommand(cmd));
+
+    BML::CommandTokens tokens;
+    BML::CommandContext::TokenizeCommandLine("TP home", tokens);
+    EXPECT_EQ(static_cast<ICommand *>(cmd), ctx->GetCommandByName(tokens[0]));
+    EXPECT_EQ(nullptr, ctx->GetCommandByName(tokens[1]));
+    EXPECT_EQ(nullptr, ctx->GetCommandByName(std::string_view()));
+    EXPECT_EQ(nullptr, ctx->GetCommandByName(std::string_view(std::string(300, 't'))));
+}
+
+TEST_F(CommandContextTest, TokenizeBenchmarkAgainstParseCommandLine) {
+    constexpr int kIterations = 200000;
+    const char *const lines[] = {
+        "tp",
+        "speed 2.5",
+        "spawn P_Ball_Wood 0 10 0",
+        "  echo   hello    world  with   some  more  words  ",
+    };
+    ctx->RegisterCommand(MakeCommand("spawn"));
+
+    size_t legacyTokens = 0;
+    const auto legacyStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        const auto args = BML::CommandContext::ParseCommandLine(lines[i % 4]);
+        legacyTokens += args.size();
+        if (!args.empty())
+            ctx->GetCommandByName(args[0].c_str());
+    }
+    const auto legacyTime = std::chrono::steady_clock::now() - legacyStart;
+
+    BML::CommandTokens tokens;
+    size_t tokenCount = 0;
+    const size_t allocationsBefore = g_Allocations.load();
+    const auto tokenStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        BML::CommandContext::TokenizeCommandLine(lines[i % 4], tokens);
+        tokenCount += tokens.Size();
+        if (!tokens.Empty())
+            ctx->GetCommandByName(tokens[0]);
+    }
+    const auto tokenTime = std::chrono::steady_clock::now() - tokenStart;
+    const size_t allocations = g_Allocations.load() - allocationsBefore;
+
+    EXPECT_EQ(legacyTokens, tokenCount);
+    EXPECT_EQ(0u, allocations);
+
+    using std::chrono::microseconds;
+    RecordProperty("lines", kIterations);
+    RecordProperty("parse_us", std::to_string(std::chrono::duration_cast<microseconds>(legacyTime).count()));
+    RecordProperty("tokenize_us", std::to_string(std::chrono::duration_cast<microseconds>(tokenTime).count()));
+}
+
 TEST(ICommandParse, ParseFloatKeepsNegativeValuesByDefault) {
     EXPECT_FLOAT_EQ(-1.5f, ICommand::ParseFloat("-1.5"));
     EXPECT_FLOAT_EQ(-1000.0f, ICommand::ParseFloat("-1000"));
@@ -0,0 +1,197 @@
+#include "CommandHistory.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+class CommandHistoryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root = std::filesystem::temp_directory_path() / "BMLCommandHistoryTest";
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root);
+        path = (root / "CommandBar.history").wstring();
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(root);
+    }
+
+    void WriteFile(const std::string &content) {
+        std::ofstream(std::filesystem::path(path), std::ios::binary) << content;
+    }
+
+    std::vector<std::string> ReadLines() {
+        std::ifstream input(std::filesystem::path(path), std::ios::binary);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(input, line))
+            lines.push_back(line);
+        return lines;
+    }
+
+    std::filesystem::path root;
+    std::wstring path;
+};
+
+} // namespace
+
+TEST_F(CommandHistoryTest, RecordingMovesRepeatedEntriesToTheEnd) {
+    CommandHistory history;
+    history.Record("a");
+    history.Record("b");
+    history.Record("c");
+    history.Record("a");
+    history.Record("");
+
+    EXPECT_EQ((std::vector<std::string>{"b", "c", "a"}), history.GetEntries());
+
+    std::string entry;
+    ASSERT_TRUE(history.GetRecent(0, entry));
+    EXPECT_EQ("a", entry);
+    ASSERT_TRUE(history.GetRecent(2, entry));
+    EXPECT_EQ("b", entry);
+    EXPECT_FALSE(history.GetRecent(3, entry));
+}
+
+TEST_F(CommandHistoryTest, BrowsesFromTheNewestEntry) {
+    CommandHistory history;
+    EXPECT_FALSE(history.BrowseOlder());
+    EXPECT_FALSE(history.BrowseNewer());
+
+    history.Record("a");
+    history.Record("b");
+
+    ASSERT_TRUE(history.BrowseOlder());
+    EXPECT_EQ("b", *history.GetBrowsed());
+    ASSERT_TRUE(history.BrowseOlder());
+    EXPECT_EQ("a", *history.GetBrowsed());
+    EXPECT_FALSE(history.BrowseOlder());
+    EXPECT_EQ("a", *history.GetBrowsed());
+
+    ASSERT_TRUE(history.BrowseNewer());
+    EXPECT_EQ("b", *history.GetBrowsed());
+    ASSERT_TRUE(history.BrowseNewer());
+    EXPECT_EQ(nullptr, history.GetBrowsed());
+    EXPECT_FALSE(history.BrowseNewer());
+
+    history.BrowseOlder();
+    history.Record("c");
+    EXPECT_EQ(nullptr, history.GetBrowsed());
+}
+
+TEST_F(CommandHistoryTest, ReplaysTheJournalOfThePreviousSession) {
+    {
+        CommandHistory history;
+        history.Open(path);
+        history.Record("a");
+        history.Record("b");
+        history.Record("a");
+        history.Flush();
+    }
+
+    EXPECT_EQ((std::vector<std::string>{"a", "b", "a"}), ReadLines());
+
+    CommandHistory history;
+    history.Open(path);
+    EXPECT_EQ((std::vector<std::string>{"b", "a"}), history.GetEntries());
+    EXPECT_EQ(3u, history.GetJournalRecordCount());
+}
+
+TEST_F(CommandHistoryTest, LoadsLegacyHistoryFiles) {
+    WriteFile("help\n\ncheat on\nhelp\n");
+
+    CommandHistory history;
+    history.Open(path);
+    history.Record("echo");
+    EXPECT_EQ((std::vector<std::string>{"cheat on", "help", "echo"}), history.GetEntries());
+}
+
+TEST_F(CommandHistoryTest, CompactsTheJournalPastTheThreshold) {
+    CommandHistory history(4);
+    history.Open(path);
+    for (int i = 0; i < 4; ++i) {
+        history.Record("a");
+        history.Record("b");
+    }
+    history.Flush();
+
+    // The seventh record left five superseded lines, so the journal was
+    // rewritten with the two live entries before the last one was appended.
+    EXPECT_EQ(3u, history.GetJournalRecordCount());
+    EXPECT_EQ((std::vector<std::string>{"b", "a", "b"}), ReadLines());
+
+    CommandHistory reloaded;
+    reloaded.Open(path);
+    EXPECT_EQ((std::vector<std::string>{"a", "b"}), reloaded.GetEntries());
+}
+
+TEST_F(CommandHistoryTest, CompactsAnOversizedJournalOnLoad) {
+    std::string content;
+    for (int i = 0; i < 100; ++i)
+        content += "same\n";
+    WriteFile(content);
+
+    {
+        CommandHistory history(8);
+        history.Open(path);
+        EXPECT_EQ(1u, history.Size());
+        history.Flush();
+    }
+
+    EXPECT_EQ((std::vector<std::string>{"same"}), ReadLines());
+}
+
+TEST_F(CommandHistoryTest, ClearRemovesTheJournal) {
+    CommandHistory history;
+    history.Open(path);
+    history.Record("a");
+    history.Clear();
+    history.Flush();
+
+    EXPECT_EQ(0u, history.Size());
+    EXPECT_FALSE(std::filesystem::exists(path));
+
+    history.Record("b");
+    history.Flush();
+    EXPECT_EQ((std::vector<std::string>{"b"}), ReadLines());
+}
+
+TEST_F(CommandHistoryTest, ReopeningDiscardsTheCurrentEntries) {
+    CommandHistory history;
+    history.Record("unsaved");
+    history.Open(path);
+    EXPECT_EQ(0u, history.Size());
+}
+
+TEST_F(CommandHistoryTest, RecordingStaysConstantTimeForLongHistories) {
+    constexpr int kEntries = 20000;
+
+    CommandHistory history;
+    history.Open(path);
+    for (int i = 0; i < kEntries; ++i)
+        history.Record("command " + std::to_string(i));
+
+    // Repeating the oldest entries moves each across the whole history
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kEntries; ++i)
+        history.Record("command " + std::to_string(i));
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    history.Flush();
+
+    EXPECT_EQ(static_cast<size_t>(kEntries), history.Size());
+    std::string entry;
+    ASSERT_TRUE(history.GetRecent(0, entry));
+    EXPECT_EQ("command " + std::to_string(kEntries - 1), entry);
+    EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), 2000);
+
+    CommandHistory reloaded;
+    reloaded.Open(path);
+    EXPECT_EQ(history.GetEntries(), reloaded.GetEntries());
+}
@@ -13,6 +13,21 @@ TEST(CryptoUtilsTest, Sha256HexFormatsKnownDigests) {
               utils::Sha256Hex("abc"));
 }
 
+TEST(CryptoUtilsTest, Sha256HasherMatchesOneShotDigest) {
+    const std::string text = "The quick brown fox jumps over the lazy dog";
+
+    utils::Sha256Hasher hasher;
+    ASSERT_TRUE(hasher.Update(text.data(), 4));
+    ASSERT_TRUE(hasher.Update(nullptr, 0));
+    ASSERT_TRUE(hasher.Update(text.data() + 4, text.size() - 4));
+
+    uint8_t digest[32] = {};
+    ASSERT_TRUE(hasher.Finish(digest));
+    EXPECT_EQ(utils::Sha256Bytes(reinterpret_cast<const uint8_t *>(text.data()), text.size()),
+              std::vector<uint8_t>(digest, digest + 32));
+    EXPECT_FALSE(hasher.Finish(digest));
+}
+
 TEST(CryptoUtilsTest, Sha256FileHexFormatsKnownDigest) {
     const std::wstring root = utils::CombinePathW(utils::GetTempPathW(), L"BMLCryptoUtilsTest");
     utils::DeleteDirectoryW(root);
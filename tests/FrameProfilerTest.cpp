@@ -0,0 +1,159 @@
+#include "FrameProfiler.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+using BML::FrameProfiler;
+
+namespace {
+
+class FrameProfilerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        profiler.SetClock([this] { return now; });
+        profiler.SetEnabled(true);
+    }
+
+    // Spends ms milliseconds of fake time inside one scope.
+    void Spend(const char *owner, const char *label, uint64_t ms) {
+        FrameProfiler::Scope scope(profiler, owner, label);
+        now += ms * 1000000;
+    }
+
+    const FrameProfiler::Stat *Find(const std::vector<FrameProfiler::Stat> &stats,
+                                    const std::string &owner, const std::string &label = {}) {
+        for (const auto &stat : stats) {
+            if (stat.Owner == owner && stat.Label == label)
+                return &stat;
+        }
+        return nullptr;
+    }
+
+    FrameProfiler profiler{8, 16};
+    uint64_t now = 0;
+};
+
+} // namespace
+
+TEST_F(FrameProfilerTest, DisabledProfilerRecordsNothing) {
+    profiler.SetEnabled(false);
+    profiler.BeginFrame();
+    Spend("ModA", "OnProcess", 1);
+    profiler.BeginFrame();
+
+    EXPECT_EQ(0u, profiler.GetRecordedFrames());
+    EXPECT_EQ(0u, profiler.GetEventCount());
+    EXPECT_TRUE(profiler.GetStats(true).empty());
+}
+
+TEST_F(FrameProfilerTest, NestedScopesRecordSelfTime) {
+    profiler.BeginFrame();
+    {
+        FrameProfiler::Scope outer(profiler, "ModA", "OnProcess");
+        now += 2000000;
+        EXPECT_EQ("ModA", profiler.GetCurrentOwner());
+        Spend("ModB", "Handler", 3);
+    }
+    EXPECT_TRUE(profiler.GetCurrentOwner().empty());
+    profiler.BeginFrame();
+
+    const auto stats = profiler.GetStats(true);
+    const auto *outer = Find(stats, "ModA", "OnProcess");
+    const auto *inner = Find(stats, "ModB", "Handler");
+    ASSERT_NE(nullptr, outer);
+    ASSERT_NE(nullptr, inner);
+    EXPECT_DOUBLE_EQ(2.0, outer->MaxMs);
+    EXPECT_DOUBLE_EQ(3.0, inner->MaxMs);
+    EXPECT_EQ(1u, outer->Calls);
+}
+
+TEST_F(FrameProfilerTest, ScopesOnOtherThreadsAreIgnored) {
+    profiler.BeginFrame();
+    std::thread worker([this] {
+        for (int i = 0; i < 1000; ++i)
+            FrameProfiler::Scope scope(profiler, "Worker", "OnProcess");
+    });
+    for (int i = 0; i < 100; ++i)
+        profiler.SetEnabled(true);
+    worker.join();
+    profiler.BeginFrame();
+
+    EXPECT_EQ(nullptr, Find(profiler.GetStats(true), "Worker", "OnProcess"));
+    EXPECT_EQ(0u, profiler.GetEventCount());
+}
+
+TEST_F(FrameProfilerTest, PercentilesCoverFrameWindow) {
+    // Ten frames against a window of eight: the first two fall out
+    for (uint64_t ms = 1; ms <= 10; ++ms) {
+        profiler.BeginFrame();
+        Spend("ModA", "OnProcess", ms);
+        Spend("ModA", "OnRender", 1);
+    }
+    profiler.BeginFrame();
+
+    EXPECT_EQ(8u, profiler.GetRecordedFrames());
+
+    const auto perLabel = profiler.GetStats(true);
+    const auto *process = Find(perLabel, "ModA", "OnProcess");
+    ASSERT_NE(nullptr, process);
+    EXPECT_DOUBLE_EQ(6.5, process->MeanMs);
+    EXPECT_DOUBLE_EQ(6.0, process->P50Ms);
+    EXPECT_DOUBLE_EQ(10.0, process->P99Ms);
+    EXPECT_DOUBLE_EQ(10.0, process->MaxMs);
+    EXPECT_EQ(8u, process->Calls);
+    EXPECT_EQ("OnProcess", perLabel.front().Label);
+
+    const auto perOwner = profiler.GetStats(false);
+    const auto *total = Find(perOwner, "ModA");
+    ASSERT_NE(nullptr, total);
+    EXPECT_DOUBLE_EQ(7.5, total->MeanMs);
+    EXPECT_EQ(16u, total->Calls);
+}
+
+TEST_F(FrameProfilerTest, QuietFramesCountAsZero) {
+    profiler.BeginFrame();
+    Spend("ModA", "OnLoadObject", 40);
+    for (int i = 0; i < 7; ++i)
+        profiler.BeginFrame();
+    profiler.BeginFrame();
+
+    const auto stats = profiler.GetStats(true);
+    const auto *stat = Find(stats, "ModA", "OnLoadObject");
+    ASSERT_NE(nullptr, stat);
+    EXPECT_DOUBLE_EQ(0.0, stat->P50Ms);
+    EXPECT_DOUBLE_EQ(40.0, stat->P99Ms);
+    EXPECT_DOUBLE_EQ(5.0, stat->MeanMs);
+}
+
+TEST_F(FrameProfilerTest, ResetDropsHistory) {
+    profiler.BeginFrame();
+    Spend("ModA", "OnProcess", 1);
+    profiler.BeginFrame();
+    profiler.Reset();
+
+    EXPECT_EQ(0u, profiler.GetRecordedFrames());
+    EXPECT_EQ(0u, profiler.GetEventCount());
+    const auto stats = profiler.GetStats(true);
+    const auto *stat = Find(stats, "ModA", "OnProcess");
+    ASSERT_NE(nullptr, stat);
+    EXPECT_EQ(0u, stat->Calls);
+}
+
+TEST_F(FrameProfilerTest, ChromeTraceKeepsNewestEvents) {
+    profiler.BeginFrame();
+    for (int i = 0; i < 20; ++i)
+        Spend("Mod \"Quoted\"", i < 4 ? "Old" : "New", 1);
+    EXPECT_EQ(16u, profiler.GetEventCount());
+
+    std::ostringstream out;
+    profiler.WriteChromeTrace(out);
+    const std::string json = out.str();
+
+    EXPECT_EQ(0u, json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    EXPECT_EQ(std::string::npos, json.find("\"Old\""));
+    EXPECT_NE(std::string::npos, json.find("\"cat\":\"Mod \\\"Quoted\\\"\""));
+    EXPECT_NE(std::string::npos, json.find("\"ph\":\"X\",\"ts\":4000.000,\"dur\":1000.000"));
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <set>
+#include <string>
+
+#include "Utils/HashUtils.h"
+
+namespace {
+    std::string MakeBytes(size_t size, uint32_t seed) {
+        std::string bytes(size, '\0');
+        for (size_t i = 0; i < size; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            bytes[i] = static_cast<char>(seed >> 24);
+        }
+        return bytes;
+    }
+}
+
+TEST(HashUtilsTest, Fnv1aKnownValues) {
+    EXPECT_EQ(utils::Fnv1a64Hex(std::string_view("")), "cbf29ce484222325");
+    EXPECT_EQ(utils::Fnv1a32Hex(std::string_view("a")), "e40c292c");
+}
+
+TEST(HashUtilsTest, ContentHash128IsDeterministic) {
+    const std::string bytes = MakeBytes(1000, 1);
+    EXPECT_EQ(utils::ContentHash128(bytes), utils::ContentHash128(bytes));
+    EXPECT_EQ(utils::ContentHash128Hex(bytes).size(), 32u);
+    EXPECT_NE(utils::ContentHash128(bytes), utils::ContentHash128(bytes, 7));
+}
+
+TEST(HashUtilsTest, ContentHash128MatchesScalarPathAtEveryLength) {
+    // Covers empty input, partial stripes and several scramble blocks
+    const std::string bytes = MakeBytes(64 * 16 * 3 + 17, 2);
+    for (size_t size = 0; size <= bytes.size(); size += (size < 200 ? 1 : 61)) {
+        EXPECT_EQ(utils::ContentHash128(bytes.data(), size),
+                  utils::detail::ContentHash128Scalar(bytes.data(), size, 0))
+            << "size " << size;
+    }
+    EXPECT_EQ(utils::ContentHash128(bytes, 42), utils::detail::ContentHash128Scalar(bytes.data(), bytes.size(), 42));
+}
+
+TEST(HashUtilsTest, ContentHash128SeparatesSmallChanges) {
+    std::set<std::string> hashes;
+    const std::string bytes = MakeBytes(300, 3);
+
+    // Trailing zero bytes differ from the shorter input only by length
+    for (size_t size = 0; size <= 130; ++size)
+        hashes.insert(utils::ContentHash128Hex(std::string(size, '\0')));
+    // Every single-bit flip
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        for (int bit = 0; bit < 8; ++bit) {
+            std::string flipped = bytes;
+            flipped[i] = static_cast<char>(flipped[i] ^ (1 << bit));
+            hashes.insert(utils::ContentHash128Hex(flipped));
+        }
+    }
+    EXPECT_EQ(hashes.size(), 131u + bytes.size() * 8);
+}
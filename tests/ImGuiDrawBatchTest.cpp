@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "ImGuiDrawBatch.h"
+#include "imgui.h"
+
+namespace {
+
+class ScopedImGuiContext {
+public:
+    ScopedImGuiContext() : m_Previous(ImGui::GetCurrentContext()) {
+        m_Context = ImGui::CreateContext();
+        ImGui::SetCurrentContext(m_Context);
+        ImGuiIO &io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+        io.IniFilename = nullptr;
+        io.LogFilename = nullptr;
+        io.Fonts->AddFontDefault();
+
+        unsigned char *pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    }
+
+    ~ScopedImGuiContext() {
+        ImGui::SetCurrentContext(m_Context);
+        ImGui::DestroyContext(m_Context);
+        ImGui::SetCurrentContext(m_Previous);
+    }
+
+private:
+    ImGuiContext *m_Previous = nullptr;
+    ImGuiContext *m_Context = nullptr;
+};
+
+// A frame shaped like the mod menu, HUD and console open at once.
+ImDrawData *RecordBusyFrame() {
+    ImGui::NewFrame();
+    for (int w = 0; w < 3; ++w) {
+        char title[32];
+        std::snprintf(title, sizeof(title), "Window %d", w);
+        ImGui::SetNextWindowPos(ImVec2(20.0f + 620.0f * w, 20.0f));
+        ImGui::SetNextWindowSize(ImVec2(600.0f, 1000.0f));
+        ImGui::Begin(title, nullptr, ImGuiWindowFlags_NoSavedSettings);
+        for (int line = 0; line < 60; ++line) {
+            ImGui::Text("[%02d:%02d] Mod %d loaded %d objects from BuildingBlocks", line / 60, line % 60, line, line * 7);
+            bool checked = (line % 3) == 0;
+            ImGui::Checkbox("##check", &checked);
+            ImGui::SameLine();
+            ImGui::Button("Configure");
+        }
+        ImGui::End();
+    }
+    ImGui::Render();
+    return ImGui::GetDrawData();
+}
+
+std::vector<ImDrawVert> Noise(int count) {
+    std::vector<ImDrawVert> vertices(count);
+    unsigned int seed = 12345;
+    for (ImDrawVert &vtx : vertices) {
+        seed = seed * 1664525u + 1013904223u;
+        vtx.pos = ImVec2((float)(seed % 1920), (float)((seed >> 11) % 1080));
+        vtx.uv = ImVec2((float)(seed & 0xFF) / 255.0f, (float)((seed >> 8) & 0xFF) / 255.0f);
+        vtx.col = seed;
+    }
+    return vertices;
+}
+
+struct Layout {
+    unsigned int PositionOffset;
+    unsigned int PositionStride;
+    unsigned int ColorOffset;
+    unsigned int ColorStride;
+    unsigned int TexCoordOffset;
+    unsigned int TexCoordStride;
+};
+
+// Separate arrays as used without a vertex buffer, the interleaved
+// D3D-style layout with a specular slot, and an unusual stride.
+const Layout kLayouts[] = {
+    {0, 16, 0, 4, 0, 8},
+    {0, 32, 16, 32, 24, 32},
+    {4, 36, 24, 36, 28, 36},
+};
+
+struct VertexBuffers {
+    std::vector<unsigned char> Positions;
+    std::vector<unsigned char> Colors;
+    std::vector<unsigned char> TexCoords;
+    BML::ImGuiVertexTarget Target;
+
+    VertexBuffers(const Layout &layout, int count) {
+        const bool interleaved = layout.ColorStride == layout.PositionStride;
+        Positions.assign(layout.PositionStride * (count + 1), 0xCD);
+        if (!interleaved) {
+            Colors.assign(layout.ColorStride * (count + 1), 0xCD);
+            TexCoords.assign(layout.TexCoordStride * (count + 1), 0xCD);
+        }
+        unsigned char *colors = interleaved ? Positions.data() : Colors.data();
+        unsigned char *uvs = interleaved ? Positions.data() : TexCoords.data();
+        Target = {Positions.data() + layout.PositionOffset, layout.PositionStride,
+                  colors + layout.ColorOffset, layout.ColorStride,
+                  uvs + layout.TexCoordOffset, layout.TexCoordStride};
+    }
+
+    bool operator==(const VertexBuffers &other) const {
+        return Positions == other.Positions && Colors == other.Colors && TexCoords == other.TexCoords;
+    }
+};
+
+ImDrawCmd MakeCmd(ImTextureID texture, unsigned int idxOffset, unsigned int elemCount, ImVec4 clip = ImVec4(0, 0, 100, 100)) {
+    ImDrawCmd cmd;
+    cmd.TexRef = ImTextureRef(texture);
+    cmd.ClipRect = clip;
+    cmd.IdxOffset = idxOffset;
+    cmd.ElemCount = elemCount;
+    return cmd;
+}
+
+void Callback(const ImDrawList *, const ImDrawCmd *) {}
+
+} // namespace
+
+TEST(ImGuiDrawBatchTest, ConvertMatchesScalarForCommonLayouts) {
+    const std::vector<ImDrawVert> vertices = Noise(1003);
+    for (const Layout &layout : kLayouts) {
+        for (int count : {0, 1, 3, 4, 5, 8, 1003}) {
+            VertexBuffers scalar(layout, count);
+            VertexBuffers vectorised(layout, count);
+            BML::ConvertImGuiVerticesScalar(vertices.data(), count, scalar.Target);
+            BML::ConvertImGuiVertices(vertices.data(), count, vectorised.Target);
+            EXPECT_TRUE(scalar == vectorised) << "stride " << layout.PositionStride << ", " << count << " vertices";
+        }
+    }
+
+    VertexBuffers single(kLayouts[0], 1);
+    BML::ConvertImGuiVertices(vertices.data(), 1, single.Target);
+    float position[4];
+    std::memcpy(position, single.Positions.data(), sizeof(position));
+    EXPECT_EQ(position[0], vertices[0].pos.x);
+    EXPECT_EQ(position[1], vertices[0].pos.y);
+    EXPECT_EQ(position[2], 0.0f);
+    EXPECT_EQ(position[3], 1.0f);
+}
+
+TEST(ImGuiDrawBatchTest, MergesConsecutiveCommandsWithTheSameTexture) {
+    const ImTextureID font = (ImTextureID)1;
+    const ImTextureID image = (ImTextureID)2;
+    ImVector<ImDrawCmd> cmds;
+    cmds.push_back(MakeCmd(font, 0, 6));
+    cmds.push_back(MakeCmd(font, 6, 12, ImVec4(10, 10, 50, 50)));
+    cmds.push_back(MakeCmd(image, 18, 6));
+    cmds.push_back(MakeCmd(font, 24, 6));
+    cmds.push_back(MakeCmd(font, 30, 6, ImVec4(200, 200, 300, 300))); // Off screen
+    cmds.push_back(MakeCmd(font, 36, 6));
+    ImDrawCmd callback = MakeCmd(font, 42, 0);
+    callback.UserCallback = Callback;
+    cmds.push_back(callback);
+    cmds.push_back(MakeCmd(font, 42, 6));
+    ImDrawCmd offset = MakeCmd(font, 48, 6);
+    offset.VtxOffset = 100;
+    cmds.push_back(offset);
+
+    BML::ImGuiDrawViewport viewport;
+    viewport.Width = 100.0f;
+    viewport.Height = 100.0f;
+    ImVector<ImDrawCmd> batches;
+    BML::BuildImGuiDrawBatches(cmds, viewport, batches);
+
+    ASSERT_EQ(batches.Size, 7);
+    EXPECT_EQ(batches[0].IdxOffset, 0u);
+    EXPECT_EQ(batches[0].ElemCount, 18u);
+    EXPECT_EQ(batches[1].GetTexID(), image);
+    EXPECT_EQ(batches[2].IdxOffset, 24u);
+    EXPECT_EQ(batches[2].ElemCount, 6u);
+    EXPECT_EQ(batches[3].IdxOffset, 36u);
+    EXPECT_TRUE(batches[4].UserCallback == Callback);
+    EXPECT_EQ(batches[5].IdxOffset, 42u);
+    EXPECT_EQ(batches[6].VtxOffset, 100u);
+}
+
+// Reports the cost of converting a recorded busy frame and how many draw
+// calls batching leaves.
+TEST(ImGuiDrawBatchTest, ConvertsRecordedDrawData) {
+    ScopedImGuiContext context;
+    const ImDrawData *drawData = RecordBusyFrame();
+    ASSERT_NE(drawData, nullptr);
+    ASSERT_GT(drawData->TotalVtxCount, 0);
+
+    BML::ImGuiDrawViewport viewport;
+    viewport.ClipOffset = drawData->DisplayPos;
+    viewport.ClipScale = drawData->FramebufferScale;
+    viewport.Width = drawData->DisplaySize.x;
+    viewport.Height = drawData->DisplaySize.y;
+
+    int commands = 0;
+    int batches = 0;
+    int batchedElements = 0;
+    ImVector<ImDrawCmd> scratch;
+    for (const ImDrawList *list : drawData->CmdLists) {
+        BML::BuildImGuiDrawBatches(list->CmdBuffer, viewport, scratch);
+        commands += list->CmdBuffer.Size;
+        batches += scratch.Size;
+        for (const ImDrawCmd &batch : scratch)
+            batchedElements += batch.ElemCount;
+    }
+    EXPECT_LE(batches, commands);
+    EXPECT_GT(batchedElements, 0);
+
+    constexpr int kFrames = 200;
+    const Layout &layout = kLayouts[1];
+    VertexBuffers scalar(layout, drawData->TotalVtxCount);
+    VertexBuffers vectorised(layout, drawData->TotalVtxCount);
+    const auto convertFrames = [&](VertexBuffers &buffers, void (*convert)(const ImDrawVert *, int, const BML::ImGuiVertexTarget &)) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < kFrames; ++frame) {
+            BML::ImGuiVertexTarget target = buffers.Target;
+            for (const ImDrawList *list : drawData->CmdLists) {
+                convert(list->VtxBuffer.Data, list->VtxBuffer.Size, target);
+                target.Positions = static_cast<unsigned char *>(target.Positions) + list->VtxBuffer.Size * target.PositionStride;
+                target.Colors = static_cast<unsigned char *>(target.Colors) + list->VtxBuffer.Size * target.ColorStride;
+                target.TexCoords = static_cast<unsigned char *>(target.TexCoords) + list->VtxBuffer.Size * target.TexCoordStride;
+            }
+        }
+        return std::chrono::steady_clock::now() - start;
+    };
+    const auto scalarTime = convertFrames(scalar, BML::ConvertImGuiVerticesScalar);
+    const auto vectorisedTime = convertFrames(vectorised, BML::ConvertImGuiVertices);
+    EXPECT_TRUE(scalar == vectorised);
+
+    using std::chrono::microseconds;
+    RecordProperty("vertices", drawData->TotalVtxCount);
+    RecordProperty("commands", commands);
+    RecordProperty("draw_calls", batches);
+    RecordProperty("frames", kFrames);
+    RecordProperty("scalar_us", std::to_string(std::chrono::duration_cast<microseconds>(scalarTime).count()));
+    RecordProperty("sse2_us", std::to_string(std::chrono::duration_cast<microseconds>(vectorisedTime).count()));
+}
@@ -0,0 +1,140 @@
+#include "MapIndex.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+std::filesystem::path MakeTempMapsRoot() {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    std::filesystem::path root = std::filesystem::temp_directory_path() /
+                                 ("bml-map-index-" + std::to_string(now)) / "Maps";
+    std::filesystem::create_directories(root);
+    return root;
+}
+
+class TempMapsRoot {
+public:
+    TempMapsRoot() : m_Path(MakeTempMapsRoot()) {}
+    ~TempMapsRoot() {
+        std::error_code ec;
+        std::filesystem::remove_all(m_Path.parent_path(), ec);
+    }
+
+    const std::filesystem::path &Path() const { return m_Path; }
+    std::filesystem::path CacheFile() const { return m_Path.parent_path() / "MapIndex.cache"; }
+
+private:
+    std::filesystem::path m_Path;
+};
+
+void TouchFile(const std::filesystem::path &path) {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream << "x";
+}
+
+// Directory write times can share a tick with the previous scan; force a change.
+void BumpWriteTime(const std::filesystem::path &path) {
+    std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(2));
+}
+
+} // namespace
+
+TEST(MapIndexTest, ScansSupportedFilesInDisplayOrder) {
+    const TempMapsRoot maps;
+    std::filesystem::create_directories(maps.Path() / "Pack B");
+    std::filesystem::create_directories(maps.Path() / "pack a");
+    TouchFile(maps.Path() / "Level10.nmo");
+    TouchFile(maps.Path() / "Level2.NMO");
+    TouchFile(maps.Path() / "readme.txt");
+    TouchFile(maps.Path() / "pack a" / "Inner.cmo");
+
+    MapIndexScanStats stats;
+    const MapIndexDirectory index = MapIndex::Scan(maps.Path(), 8, nullptr, &stats);
+
+    ASSERT_EQ(2u, index.directories.size());
+    EXPECT_EQ(L"pack a", index.directories[0].name);
+    EXPECT_EQ(L"Pack B", index.directories[1].name);
+    ASSERT_EQ(2u, index.files.size());
+    EXPECT_EQ(L"Level2.NMO", index.files[0]);
+    EXPECT_EQ(L"Level10.nmo", index.files[1]);
+    ASSERT_EQ(1u, index.directories[0].files.size());
+    EXPECT_EQ(L"Inner.cmo", index.directories[0].files[0]);
+
+    EXPECT_EQ(3u, stats.listedDirectories);
+    EXPECT_EQ(0u, stats.reusedDirectories);
+    EXPECT_EQ(3u, stats.files);
+    EXPECT_EQ(3u, MapIndex::CountFiles(index));
+}
+
+TEST(MapIndexTest, StopsListingAtDepthLimit) {
+    const TempMapsRoot maps;
+    std::filesystem::create_directories(maps.Path() / "A" / "B");
+    TouchFile(maps.Path() / "A" / "B" / "Deep.nmo");
+
+    const MapIndexDirectory index = MapIndex::Scan(maps.Path(), 2, nullptr);
+
+    ASSERT_EQ(1u, index.directories.size());
+    const MapIndexDirectory &a = index.directories[0];
+    ASSERT_EQ(1u, a.directories.size());
+    EXPECT_TRUE(a.directories[0].truncated);
+    EXPECT_TRUE(a.directories[0].files.empty());
+}
+
+TEST(MapIndexTest, RescanListsOnlyChangedDirectories) {
+    const TempMapsRoot maps;
+    std::filesystem::create_directories(maps.Path() / "A" / "Nested");
+    std::filesystem::create_directories(maps.Path() / "B");
+    TouchFile(maps.Path() / "A" / "Nested" / "One.nmo");
+    TouchFile(maps.Path() / "B" / "Two.nmo");
+
+    const MapIndexDirectory first = MapIndex::Scan(maps.Path(), 8, nullptr);
+
+    MapIndexScanStats unchanged;
+    const MapIndexDirectory second = MapIndex::Scan(maps.Path(), 8, &first, &unchanged);
+    EXPECT_EQ(0u, unchanged.listedDirectories);
+    EXPECT_EQ(4u, unchanged.reusedDirectories);
+    EXPECT_EQ(2u, MapIndex::CountFiles(second));
+
+    TouchFile(maps.Path() / "A" / "Nested" / "Three.nmo");
+    BumpWriteTime(maps.Path() / "A" / "Nested");
+
+    MapIndexScanStats changed;
+    const MapIndexDirectory third = MapIndex::Scan(maps.Path(), 8, &second, &changed);
+    EXPECT_EQ(1u, changed.listedDirectories);
+    EXPECT_EQ(3u, changed.reusedDirectories);
+    ASSERT_EQ(2u, third.directories[0].directories[0].files.size());
+    EXPECT_EQ(L"One.nmo", third.directories[0].directories[0].files[0]);
+    EXPECT_EQ(L"Three.nmo", third.directories[0].directories[0].files[1]);
+}
+
+TEST(MapIndexTest, CacheRoundTripsForSameRootAndDepth) {
+    const TempMapsRoot maps;
+    std::filesystem::create_directories(maps.Path() / "Pack");
+    TouchFile(maps.Path() / "Pack" / "Level.nmo");
+    TouchFile(maps.Path() / "Root.cmo");
+
+    const MapIndexDirectory index = MapIndex::Scan(maps.Path(), 8, nullptr);
+    ASSERT_TRUE(MapIndex::SaveCache(maps.CacheFile(), maps.Path().wstring(), 8, index));
+
+    MapIndexDirectory loaded;
+    ASSERT_TRUE(MapIndex::LoadCache(maps.CacheFile(), maps.Path().wstring(), 8, loaded));
+    EXPECT_EQ(index.name, loaded.name);
+    EXPECT_EQ(index.writeTime, loaded.writeTime);
+    EXPECT_EQ(index.files, loaded.files);
+    ASSERT_EQ(1u, loaded.directories.size());
+    EXPECT_EQ(index.directories[0].writeTime, loaded.directories[0].writeTime);
+    EXPECT_EQ(index.directories[0].files, loaded.directories[0].files);
+
+    MapIndexScanStats stats;
+    MapIndex::Scan(maps.Path(), 8, &loaded, &stats);
+    EXPECT_EQ(0u, stats.listedDirectories);
+
+    MapIndexDirectory rejected;
+    EXPECT_FALSE(MapIndex::LoadCache(maps.CacheFile(), maps.Path().wstring(), 4, rejected));
+    EXPECT_FALSE(MapIndex::LoadCache(maps.CacheFile(), (maps.Path() / "Pack").wstring(), 8, rejected));
+}
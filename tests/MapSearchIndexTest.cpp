@@ -0,0 +1,119 @@
+#include "MapSearchIndex.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+// Root
+// +- Pack (dir)
+// |  +- Sky Tower
+// |  +- tower run
+// +- Towers (dir)
+// |  +- Tower 2
+// +- Lava Tower
+// +- Plain
+class MapSearchIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root = index.Add("Maps", true, MapSearchIndex::kInvalidId);
+        pack = index.Add("Pack", true, root);
+        skyTower = index.Add("Sky Tower", false, pack);
+        towerRun = index.Add("tower run", false, pack);
+        towers = index.Add("Towers", true, root);
+        tower2 = index.Add("Tower 2", false, towers);
+        lavaTower = index.Add("Lava Tower", false, root);
+        plain = index.Add("Plain", false, root);
+        index.Build();
+    }
+
+    MapSearchIndex index;
+    uint32_t root = 0, pack = 0, skyTower = 0, towerRun = 0, towers = 0, tower2 = 0, lavaTower = 0, plain = 0;
+};
+
+} // namespace
+
+TEST_F(MapSearchIndexTest, MatchesCaseInsensitivelyInDisplayOrder) {
+    std::vector<uint32_t> ids;
+    index.Search("TOWER", root, ids);
+
+    // Directories first, then files by name
+    const std::vector<uint32_t> expected = {towers, lavaTower, skyTower, tower2, towerRun};
+    EXPECT_EQ(expected, ids);
+}
+
+TEST_F(MapSearchIndexTest, RestrictsResultsToScope) {
+    std::vector<uint32_t> ids;
+    index.Search("tower", pack, ids);
+
+    const std::vector<uint32_t> expected = {skyTower, towerRun};
+    EXPECT_EQ(expected, ids);
+}
+
+TEST(MapSearchIndexStandaloneTest, VerifiesCandidatesSharingAllTrigrams) {
+    MapSearchIndex index;
+    const uint32_t root = index.Add("Maps", true, MapSearchIndex::kInvalidId);
+    const uint32_t abcab = index.Add("abcab", false, root);
+    index.Build();
+
+    // "bcabc" only has trigrams found in "abcab" but is not a substring of it
+    std::vector<uint32_t> ids;
+    index.Search("bcabc", root, ids);
+    EXPECT_TRUE(ids.empty());
+
+    index.Search("bcab", root, ids);
+    EXPECT_EQ(std::vector<uint32_t>{abcab}, ids);
+}
+
+TEST_F(MapSearchIndexTest, ShortQueriesScanNames) {
+    std::vector<uint32_t> ids;
+    index.Search("2", root, ids);
+    EXPECT_EQ(std::vector<uint32_t>{tower2}, ids);
+
+    index.Search("pl", root, ids);
+    EXPECT_EQ(std::vector<uint32_t>{plain}, ids);
+}
+
+TEST_F(MapSearchIndexTest, RefineNarrowsPreviousResults) {
+    std::vector<uint32_t> ids;
+    index.Search("to", root, ids);
+    ASSERT_EQ(5u, ids.size());
+
+    index.Refine("tower r", ids);
+    EXPECT_EQ(std::vector<uint32_t>{towerRun}, ids);
+}
+
+TEST_F(MapSearchIndexTest, CollectReturnsWholeSubtree) {
+    std::vector<uint32_t> ids;
+    index.Collect(root, ids);
+    EXPECT_EQ(7u, ids.size());
+    EXPECT_EQ(pack, ids[0]);
+    EXPECT_EQ(towers, ids[1]);
+
+    index.Collect(towers, ids);
+    EXPECT_EQ(std::vector<uint32_t>{tower2}, ids);
+}
+
+TEST(MapSearchIndexStandaloneTest, ManyEntriesMatchLinearScan) {
+    MapSearchIndex index;
+    const uint32_t root = index.Add("Maps", true, MapSearchIndex::kInvalidId);
+    std::vector<std::string> names;
+    for (int i = 0; i < 5000; ++i) {
+        names.push_back("Level_" + std::to_string(i * 7919 % 10007));
+        index.Add(names.back(), false, root);
+    }
+    index.Build();
+
+    std::vector<uint32_t> ids;
+    index.Search("l_12", root, ids);
+
+    size_t expected = 0;
+    for (const std::string &name : names) {
+        if (MapSearchIndex::FoldCase(name).find("l_12") != std::string::npos)
+            ++expected;
+    }
+    EXPECT_EQ(expected, ids.size());
+    EXPECT_GT(expected, 0u);
+}
@@ -2,6 +2,10 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
 namespace {
 
 TEST(ObjectReferenceRegistryTest, DeletionInvalidatesAReusedSlotEvenAtTheSameAddress) {
@@ -48,4 +52,89 @@ TEST(ObjectReferenceRegistryTest, DeletionReleasesBookkeepingWithoutRevalidating
     EXPECT_FALSE(references.Matches(first.Slot, first.Generation, &storage));
 }
 
+TEST(ObjectReferenceRegistryTest, ResetDoesNotReviveRefsWhenSlotsAreReused) {
+    ObjectReferenceRegistry references;
+    int storage = 0;
+    const BML_ObjectRef before = references.Make(1, 7, &storage);
+
+    references.InvalidateAll();
+    const BML_ObjectRef after = references.Make(1, 7, &storage);
+    EXPECT_EQ(1u, references.Size());
+    EXPECT_NE(before.Generation, after.Generation);
+    EXPECT_FALSE(references.Matches(before.Slot, before.Generation, &storage));
+    EXPECT_TRUE(references.Matches(after.Slot, after.Generation, &storage));
+
+    // Making the same object again keeps its generation.
+    EXPECT_EQ(after.Generation, references.Make(1, 7, &storage).Generation);
+    EXPECT_EQ(1u, references.Size());
+}
+
+TEST(ObjectReferenceRegistryTest, TracksSlotsOutsideTheDenseRange) {
+    ObjectReferenceRegistry references;
+    int first = 0;
+    int second = 0;
+    const BML_ObjectRef low = references.Make(1, 3, &first);
+    const BML_ObjectRef high = references.Make(1, 0xFFFFFFF0u, &second);
+    ASSERT_NE(0u, high.Generation);
+    EXPECT_EQ(2u, references.Size());
+    EXPECT_TRUE(references.Matches(high.Slot, high.Generation, &second));
+    EXPECT_FALSE(references.Matches(high.Slot, high.Generation, &first));
+    EXPECT_FALSE(references.Matches(0x7FFFFFFFu, high.Generation, &second));
+
+    references.Invalidate(high.Slot);
+    EXPECT_FALSE(references.Matches(high.Slot, high.Generation, &second));
+    EXPECT_TRUE(references.Matches(low.Slot, low.Generation, &first));
+    EXPECT_EQ(1u, references.Size());
+}
+
+// Reports the cost of the Make and Matches calls the scene reads make for
+// 100k objects, next to the hash map the registry used before.
+TEST(ObjectReferenceRegistryTest, MakesAndMatchesManyReferences) {
+    constexpr uint32_t kObjects = 100000;
+    std::vector<int> storage(kObjects);
+    std::vector<BML_ObjectRef> made(kObjects);
+
+    ObjectReferenceRegistry references;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t slot = 1; slot <= kObjects; ++slot)
+        made[slot - 1] = references.Make(1, slot, &storage[slot - 1]);
+    size_t matched = 0;
+    for (uint32_t slot = 1; slot <= kObjects; ++slot)
+        matched += references.Matches(slot, made[slot - 1].Generation, &storage[slot - 1]) ? 1 : 0;
+    const auto registryTime = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(kObjects, matched);
+    EXPECT_EQ(kObjects, references.Size());
+
+    struct Entry {
+        const void *Identity = nullptr;
+        uint32_t Generation = 0;
+    };
+    std::unordered_map<uint32_t, Entry> map;
+    const auto mapStart = std::chrono::steady_clock::now();
+    for (uint32_t slot = 1; slot <= kObjects; ++slot) {
+        Entry &entry = map[slot];
+        if (entry.Identity != &storage[slot - 1])
+            entry = {&storage[slot - 1], slot};
+    }
+    size_t mapMatched = 0;
+    for (uint32_t slot = 1; slot <= kObjects; ++slot) {
+        const auto found = map.find(slot);
+        mapMatched += found != map.end() && found->second.Generation == slot ? 1 : 0;
+    }
+    const auto mapTime = std::chrono::steady_clock::now() - mapStart;
+    EXPECT_EQ(kObjects, mapMatched);
+
+    const auto resetStart = std::chrono::steady_clock::now();
+    references.InvalidateAll();
+    const auto resetTime = std::chrono::steady_clock::now() - resetStart;
+    EXPECT_EQ(0u, references.Size());
+    EXPECT_FALSE(references.Matches(1, made[0].Generation, &storage[0]));
+
+    using std::chrono::microseconds;
+    RecordProperty("objects", static_cast<int>(kObjects));
+    RecordProperty("paged_us", std::to_string(std::chrono::duration_cast<microseconds>(registryTime).count()));
+    RecordProperty("hash_map_us", std::to_string(std::chrono::duration_cast<microseconds>(mapTime).count()));
+    RecordProperty("invalidate_all_us", std::to_string(std::chrono::duration_cast<microseconds>(resetTime).count()));
+}
+
 } // namespace
@@ -0,0 +1,154 @@
+#include "AngelScript/ScriptContextPool.h"
+
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <vector>
+
+namespace {
+
+struct FakeEngine;
+
+struct FakeContext {
+    FakeEngine *Engine = nullptr;
+    asEContextState State = asEXECUTION_UNINITIALIZED;
+    int Unprepares = 0;
+    bool FailUnprepare = false;
+    bool Released = false;
+};
+
+struct FakeEngine {
+    std::deque<FakeContext> Contexts;
+};
+
+struct FakeTraits {
+    using Engine = FakeEngine;
+    using Context = FakeContext;
+
+    static FakeContext *Create(FakeEngine *engine) {
+        FakeContext &context = engine->Contexts.emplace_back();
+        context.Engine = engine;
+        return &context;
+    }
+    static FakeEngine *EngineOf(FakeContext *context) { return context->Engine; }
+    static asEContextState State(FakeContext *context) { return context->State; }
+    static int Unprepare(FakeContext *context) {
+        ++context->Unprepares;
+        if (context->FailUnprepare)
+            return asCONTEXT_ACTIVE;
+        context->State = asEXECUTION_UNINITIALIZED;
+        return asSUCCESS;
+    }
+    static void Release(FakeContext *context) { context->Released = true; }
+};
+
+using Pool = BML::BasicScriptContextPool<FakeTraits>;
+
+} // namespace
+
+TEST(ScriptContextPoolTest, ReusesAReturnedContext) {
+    FakeEngine engine;
+    Pool pool;
+
+    FakeContext *first = pool.Acquire(&engine);
+    ASSERT_NE(first, nullptr);
+    first->State = asEXECUTION_FINISHED;
+    pool.Return(first);
+    EXPECT_EQ(first->Unprepares, 1);
+    EXPECT_FALSE(first->Released);
+
+    EXPECT_EQ(pool.Acquire(&engine), first);
+    EXPECT_EQ(engine.Contexts.size(), 1u);
+
+    const BML::ScriptContextPoolStats stats = pool.GetStats();
+    EXPECT_EQ(stats.Requests, 2u);
+    EXPECT_EQ(stats.Hits, 1u);
+    EXPECT_EQ(stats.Active, 1u);
+    EXPECT_EQ(stats.Idle, 0u);
+    EXPECT_EQ(pool.Acquire(nullptr), nullptr);
+}
+
+TEST(ScriptContextPoolTest, GivesANestedCallItsOwnContext) {
+    FakeEngine engine;
+    Pool pool;
+
+    // A callback running on the outer context re-enters the pool twice.
+    FakeContext *outer = pool.Acquire(&engine);
+    outer->State = asEXECUTION_ACTIVE;
+    FakeContext *nested = pool.Acquire(&engine);
+    ASSERT_NE(nested, outer);
+    nested->State = asEXECUTION_FINISHED;
+    pool.Return(nested);
+    EXPECT_EQ(outer->State, asEXECUTION_ACTIVE);
+    EXPECT_EQ(outer->Unprepares, 0);
+
+    EXPECT_EQ(pool.Acquire(&engine), nested);
+    nested->State = asEXECUTION_FINISHED;
+    pool.Return(nested);
+
+    outer->State = asEXECUTION_FINISHED;
+    pool.Return(outer);
+    EXPECT_EQ(engine.Contexts.size(), 2u);
+    EXPECT_EQ(pool.GetStats().Idle, 2u);
+    EXPECT_EQ(pool.GetStats().Active, 0u);
+
+    // Handing back a context that is still running must not pool it.
+    FakeContext *running = pool.Acquire(&engine);
+    const int unprepares = running->Unprepares;
+    running->State = asEXECUTION_ACTIVE;
+    pool.Return(running);
+    EXPECT_TRUE(running->Released);
+    EXPECT_EQ(running->Unprepares, unprepares);
+    EXPECT_EQ(pool.GetStats().Idle, 1u);
+}
+
+TEST(ScriptContextPoolTest, ReusesAContextAfterAnExceptionOrAbort) {
+    FakeEngine engine;
+    Pool pool;
+
+    for (asEContextState end : {asEXECUTION_EXCEPTION, asEXECUTION_ABORTED, asEXECUTION_SUSPENDED}) {
+        FakeContext *context = pool.Acquire(&engine);
+        ASSERT_EQ(context, &engine.Contexts.front());
+        context->State = end;
+        pool.Return(context);
+        EXPECT_FALSE(context->Released);
+        EXPECT_EQ(context->State, asEXECUTION_UNINITIALIZED);
+    }
+    EXPECT_EQ(engine.Contexts.size(), 1u);
+    EXPECT_EQ(engine.Contexts.front().Unprepares, 3);
+
+    // One that cannot be unprepared still holds the last call, so it goes.
+    FakeContext *context = pool.Acquire(&engine);
+    context->State = asEXECUTION_EXCEPTION;
+    context->FailUnprepare = true;
+    pool.Return(context);
+    EXPECT_TRUE(context->Released);
+    EXPECT_NE(pool.Acquire(&engine), context);
+}
+
+TEST(ScriptContextPoolTest, KeepsEnginesApartAndBoundsTheIdleContexts) {
+    FakeEngine a;
+    FakeEngine b;
+    Pool pool;
+
+    std::vector<FakeContext *> contexts;
+    for (size_t i = 0; i < Pool::kMaxIdlePerEngine + 2; ++i)
+        contexts.push_back(pool.Acquire(&a));
+    FakeContext *other = pool.Acquire(&b);
+    for (FakeContext *context : contexts)
+        pool.Return(context);
+    pool.Return(other);
+
+    EXPECT_TRUE(contexts[Pool::kMaxIdlePerEngine]->Released);
+    EXPECT_TRUE(contexts[Pool::kMaxIdlePerEngine + 1]->Released);
+    EXPECT_EQ(pool.GetStats().Idle, Pool::kMaxIdlePerEngine + 1);
+    EXPECT_EQ(pool.Acquire(&b), other);
+    pool.Return(other);
+
+    pool.Clear();
+    EXPECT_EQ(pool.GetStats().Idle, 0u);
+    for (FakeContext *context : contexts)
+        EXPECT_TRUE(context->Released);
+    EXPECT_TRUE(other->Released);
+    EXPECT_EQ(pool.GetStats().Requests, Pool::kMaxIdlePerEngine + 4);
+}
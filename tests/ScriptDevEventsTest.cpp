@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <string>
+#include <vector>
+
 #include "AngelScript/ScriptDevEvents.h"
 
 namespace BML {
@@ -15,6 +19,38 @@ ScriptDevEvent MakeEvent(std::string code, std::string modId, std::string messag
     return event;
 }
 
+// Deterministic mix of mods, codes, phases and attempts for the view tests.
+ScriptDevEvent MakeMixedEvent(int i) {
+    static const char *const kCodes[] = {"LogLine", "ScriptReloadDiagnostic", "ScriptReloadCommitted", "ScriptWatchOverflow"};
+    static const char *const kMods[] = {"alpha.script", "beta.script", "gamma.script"};
+    ScriptDevEvent event = MakeEvent(kCodes[i % 4], kMods[i % 3], "message " + std::to_string(i));
+    event.Severity = static_cast<ScriptDevEventSeverity>(i % 3);
+    event.Phase = i % 5 == 0 ? "reload" : "compile";
+    event.SourcePath = "Mods/" + std::string(kMods[i % 3]) + "/main.mod.as";
+    event.ReloadAttemptId = static_cast<unsigned int>(i % 7);
+    event.Fields.push_back({"line", std::to_string(i % 11)});
+    return event;
+}
+
+std::vector<uint64_t> Sequences(const std::vector<ScriptDevEvent> &events) {
+    std::vector<uint64_t> sequences;
+    for (const ScriptDevEvent &event : events)
+        sequences.push_back(event.Sequence);
+    return sequences;
+}
+
+std::vector<uint64_t> Sequences(const std::vector<ScriptDevEventRef> &events) {
+    std::vector<uint64_t> sequences;
+    for (const ScriptDevEventRef &record : events)
+        sequences.push_back(record->Event.Sequence);
+    return sequences;
+}
+
+void Refresh(ScriptDevLogView &view, const ScriptDevEventRingBuffer &buffer, const ScriptDevLogFilters &filters) {
+    view.SetFilters(filters);
+    view.Apply(buffer.SnapshotSince(view.GetGeneration(), view.GetLastSequence()));
+}
+
 } // namespace
 
 TEST(ScriptDevEventRingBufferTest, DropsOldestEventsAndKeepsMonotonicSequence) {
@@ -73,6 +109,27 @@ TEST(ScriptDevEventFilterTest, MatchesReloadAttemptSelectedModSourceAndText) {
     EXPECT_EQ(7u, filtered[0].ReloadAttemptId);
 }
 
+TEST(ScriptDevEventFilterTest, TextMatchesAcrossEventFieldsIgnoringCase) {
+    ScriptDevEvent event = MakeEvent("LogLine", "Hello.Script", "aaab");
+    event.Phase = "Reload";
+    event.ReloadAttemptId = 42;
+    event.Fields.push_back({"Stack", "Line 12"});
+    const std::vector<ScriptDevEvent> events{event};
+
+    for (const char *text : {"hello.script reload 42", "AAB", "aaab stack=line", "LINE 12"}) {
+        ScriptDevLogFilters filters;
+        filters.Text = text;
+        EXPECT_EQ(1u, FilterScriptDevEvents(events, filters).size()) << text;
+        EXPECT_TRUE(ScriptDevLogMatcher(filters).Matches(*MakeScriptDevEventRecord(event))) << text;
+    }
+    for (const char *text : {"aaaab", "reload  42", "line 13"}) {
+        ScriptDevLogFilters filters;
+        filters.Text = text;
+        EXPECT_TRUE(FilterScriptDevEvents(events, filters).empty()) << text;
+        EXPECT_FALSE(ScriptDevLogMatcher(filters).Matches(*MakeScriptDevEventRecord(event))) << text;
+    }
+}
+
 TEST(ScriptDevEventFilterTest, ReloadOnlyIncludesReloadPhaseAndScriptReloadCodes) {
     std::vector<ScriptDevEvent> events;
     events.push_back(MakeEvent("LogLine", "hello.script", "regular log"));
@@ -112,5 +169,102 @@ TEST(ScriptDevEventFilterTest, LimitKeepsNewestMatchingEvents) {
     EXPECT_EQ(5u, filtered[1].Sequence);
 }
 
+TEST(ScriptDevEventRingBufferTest, SnapshotSinceReturnsOnlyNewEvents) {
+    ScriptDevEventRingBuffer buffer(4);
+    buffer.Append(MakeEvent("A", "mod", "one"));
+    buffer.Append(MakeEvent("B", "mod", "two"));
+    buffer.Append(MakeEvent("C", "mod", "three"));
+
+    ScriptDevEventDelta delta = buffer.SnapshotSince(0, 0);
+    EXPECT_EQ((std::vector<uint64_t>{1, 2, 3}), Sequences(delta.Events));
+    EXPECT_EQ(1u, delta.FirstSequence);
+    const uint64_t generation = delta.Generation;
+
+    EXPECT_TRUE(buffer.SnapshotSince(generation, 3).Events.empty());
+
+    buffer.Append(MakeEvent("D", "mod", "four"));
+    buffer.Append(MakeEvent("E", "mod", "five"));
+    buffer.Append(MakeEvent("F", "mod", "six"));
+    delta = buffer.SnapshotSince(generation, 3);
+    EXPECT_FALSE(delta.Reset);
+    EXPECT_EQ(3u, delta.FirstSequence);
+    EXPECT_EQ((std::vector<uint64_t>{4, 5, 6}), Sequences(delta.Events));
+
+    // Snapshots hand out the stored records instead of copies.
+    EXPECT_EQ(buffer.SnapshotSince(0, 0).Events.back().get(), delta.Events.back().get());
+
+    buffer.Clear();
+    buffer.Append(MakeEvent("G", "mod", "seven"));
+    delta = buffer.SnapshotSince(generation, 6);
+    EXPECT_TRUE(delta.Reset);
+    EXPECT_EQ((std::vector<uint64_t>{7}), Sequences(delta.Events));
+}
+
+TEST(ScriptDevEventFilterTest, LogViewFollowsTheBufferIncrementally) {
+    ScriptDevEventRingBuffer buffer(300);
+    ScriptDevLogView view(50);
+
+    std::vector<ScriptDevLogFilters> filterSets(5);
+    filterSets[1].Severity = "warn";
+    filterSets[2].SelectedModId = "beta.script";
+    filterSets[2].SelectedModOnly = true;
+    filterSets[2].Text = "LINE=3";
+    filterSets[3].ReloadOnly = true;
+    filterSets[3].Source = "GAMMA";
+    filterSets[4].Attempt = "5";
+    filterSets[4].Code = "reload";
+
+    int next = 0;
+    for (int step = 0; step < 40; ++step) {
+        const ScriptDevLogFilters &filters = filterSets[(step / 4) % filterSets.size()];
+        for (int i = 0; i < 1 + step % 9 * 7; ++i)
+            buffer.Append(MakeMixedEvent(next++));
+        if (step == 23)
+            buffer.Clear();
+
+        Refresh(view, buffer, filters);
+        EXPECT_EQ(Sequences(FilterScriptDevEvents(buffer.Snapshot(), filters, 50)), Sequences(view.GetEvents()))
+            << "step " << step;
+    }
+}
+
+TEST(ScriptDevEventFilterTest, LogViewAvoidsRescanningAFullBuffer) {
+    constexpr size_t kCapacity = 10000;
+    constexpr int kFrames = 20;
+    constexpr int kEventsPerFrame = 10;
+    ScriptDevEventRingBuffer buffer(kCapacity);
+    int next = 0;
+    for (size_t i = 0; i < kCapacity; ++i)
+        buffer.Append(MakeMixedEvent(next++));
+
+    ScriptDevLogFilters filters;
+    filters.Text = "message 9";
+    ScriptDevLogView view(1000);
+    Refresh(view, buffer, filters);
+
+    using Clock = std::chrono::steady_clock;
+    Clock::duration fullTime{};
+    Clock::duration viewTime{};
+    std::vector<ScriptDevEvent> full;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        for (int i = 0; i < kEventsPerFrame; ++i)
+            buffer.Append(MakeMixedEvent(next++));
+
+        auto start = Clock::now();
+        full = FilterScriptDevEvents(buffer.Snapshot(), filters, 1000);
+        fullTime += Clock::now() - start;
+
+        start = Clock::now();
+        Refresh(view, buffer, filters);
+        viewTime += Clock::now() - start;
+    }
+    EXPECT_EQ(Sequences(full), Sequences(view.GetEvents()));
+
+    const double fullMs = std::chrono::duration<double, std::milli>(fullTime).count() / kFrames;
+    const double viewMs = std::chrono::duration<double, std::milli>(viewTime).count() / kFrames;
+    RecordProperty("FullRescanMsPerFrame", std::to_string(fullMs));
+    RecordProperty("IncrementalMsPerFrame", std::to_string(viewMs));
+}
+
 } // namespace Test
 } // namespace BML
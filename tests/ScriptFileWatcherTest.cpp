@@ -0,0 +1,329 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "AngelScript/ScriptFileWatcher.h"
+#include "AngelScript/ScriptFileWatcherPolling.h"
+
+namespace BML {
+namespace Test {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using WatcherFactory = std::function<std::unique_ptr<ScriptFileWatcher>(size_t)>;
+
+std::unique_ptr<ScriptFileWatcher> MakeNativeWatcher(size_t maxQueuedEvents) {
+    return ScriptFileWatcher::Create(maxQueuedEvents);
+}
+
+std::unique_ptr<ScriptFileWatcher> MakePollingWatcher(size_t maxQueuedEvents) {
+    return std::make_unique<ScriptFileWatcherPolling>(maxQueuedEvents, std::chrono::milliseconds(20));
+}
+
+class TempWatchRoot {
+public:
+    TempWatchRoot() {
+        const auto now = Clock::now().time_since_epoch().count();
+        m_Path = std::filesystem::temp_directory_path() / ("bml-script-watch-stress-" + std::to_string(now));
+        std::filesystem::create_directories(m_Path);
+    }
+    ~TempWatchRoot() {
+        std::error_code ec;
+        std::filesystem::remove_all(m_Path, ec);
+    }
+
+    const std::filesystem::path &Path() const { return m_Path; }
+
+private:
+    std::filesystem::path m_Path;
+};
+
+std::wstring FileName(const std::wstring &path) {
+    const size_t slash = path.find_last_of(L"\\/");
+    return slash == std::wstring::npos ? path : path.substr(slash + 1);
+}
+
+void WriteText(const std::filesystem::path &path, const std::string &text, bool append = false) {
+    std::ofstream stream(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    stream << text;
+}
+
+// Waits until the backend has reported at least minimumEvents and then stayed
+// quiet for a moment, so the queue holds everything the writes produced.
+ScriptFileWatcherStats WaitForQuiet(const ScriptFileWatcher &watcher, uint64_t minimumEvents) {
+    const auto deadline = Clock::now() + std::chrono::seconds(15);
+    ScriptFileWatcherStats last = watcher.GetStats();
+    auto lastChange = Clock::now();
+    while (Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(25));
+        const ScriptFileWatcherStats stats = watcher.GetStats();
+        if (stats.Events != last.Events || stats.Overflows != last.Overflows) {
+            last = stats;
+            lastChange = Clock::now();
+            continue;
+        }
+        if (stats.Events >= minimumEvents && Clock::now() - lastChange >= std::chrono::milliseconds(250))
+            break;
+    }
+    return watcher.GetStats();
+}
+
+size_t CountChanges(const std::vector<ScriptFileWatcher::Event> &events) {
+    return static_cast<size_t>(std::count_if(events.begin(), events.end(), [](const auto &event) {
+        return !event.Overflow;
+    }));
+}
+
+double Percentile(std::vector<double> values, double fraction) {
+    if (values.empty())
+        return 0.0;
+    std::sort(values.begin(), values.end());
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * static_cast<double>(values.size())));
+    return values[index];
+}
+
+void ExpectRepeatedModificationsCoalesce(const WatcherFactory &factory) {
+    const TempWatchRoot root;
+    const std::unique_ptr<ScriptFileWatcher> watcher = factory(ScriptFileWatcher::kDefaultMaxQueuedEvents);
+    ASSERT_TRUE(watcher->Watch(root.Path().wstring()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const std::filesystem::path entry = root.Path() / "Busy.mod.as";
+    WriteText(entry, "class Busy {}\n");
+    WaitForQuiet(*watcher, 1);
+    size_t delivered = CountChanges(watcher->DrainEvents());
+
+    constexpr int kWrites = 2000;
+    for (int i = 0; i < kWrites; ++i)
+        WriteText(entry, "// edit " + std::to_string(i) + "\n", true);
+    const ScriptFileWatcherStats stats = WaitForQuiet(*watcher, 1);
+
+    const std::vector<ScriptFileWatcher::Event> events = watcher->DrainEvents();
+    delivered += CountChanges(events);
+    size_t modifications = 0;
+    for (const auto &event : events) {
+        EXPECT_FALSE(event.Overflow);
+        EXPECT_EQ(FileName(event.Path), L"Busy.mod.as");
+        if (event.Action == ScriptFileAction::Modified)
+            ++modifications;
+    }
+    EXPECT_EQ(modifications, 1u);
+    EXPECT_EQ(stats.Dropped, 0u);
+    EXPECT_EQ(delivered + stats.Coalesced, stats.Events);
+
+    ::testing::Test::RecordProperty("Reported", std::to_string(stats.Events));
+    ::testing::Test::RecordProperty("Coalesced", std::to_string(stats.Coalesced));
+    ::testing::Test::RecordProperty("Delivered", std::to_string(delivered));
+    watcher->StopAll();
+}
+
+void ExpectDroppedEventsAreAccounted(const WatcherFactory &factory) {
+    constexpr size_t kQueueLimit = 64;
+    constexpr int kFiles = 1000;
+    const TempWatchRoot root;
+    const std::unique_ptr<ScriptFileWatcher> watcher = factory(kQueueLimit);
+    ASSERT_TRUE(watcher->Watch(root.Path().wstring()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    for (int i = 0; i < kFiles; ++i)
+        WriteText(root.Path() / ("Flood" + std::to_string(i) + ".as"), "void F() {}\n");
+    const ScriptFileWatcherStats stats = WaitForQuiet(*watcher, kFiles);
+
+    const std::vector<ScriptFileWatcher::Event> events = watcher->DrainEvents();
+    ASSERT_LE(events.size(), kQueueLimit);
+    const size_t overflows = events.size() - CountChanges(events);
+    EXPECT_EQ(overflows, 1u);
+    EXPECT_GT(stats.Dropped, 0u);
+    EXPECT_EQ(watcher->GetDroppedEventCount(), stats.Dropped);
+    EXPECT_EQ(CountChanges(events) + stats.Coalesced + stats.Dropped, stats.Events);
+
+    // Draining makes room again; the next change arrives as itself.
+    WriteText(root.Path() / "After.as", "void After() {}\n");
+    WaitForQuiet(*watcher, stats.Events + 1);
+    const std::vector<ScriptFileWatcher::Event> after = watcher->DrainEvents();
+    ASSERT_FALSE(after.empty());
+    for (const auto &event : after) {
+        EXPECT_FALSE(event.Overflow);
+        EXPECT_EQ(FileName(event.Path), L"After.as");
+    }
+    EXPECT_EQ(watcher->GetDroppedEventCount(), stats.Dropped);
+
+    ::testing::Test::RecordProperty("Reported", std::to_string(stats.Events));
+    ::testing::Test::RecordProperty("Dropped", std::to_string(stats.Dropped));
+    ::testing::Test::RecordProperty("Queued", std::to_string(events.size()));
+    watcher->StopAll();
+}
+
+void ExpectEveryEventUnderLoad(const WatcherFactory &factory) {
+    constexpr size_t kFiles = 3000;
+    const TempWatchRoot root;
+    const std::unique_ptr<ScriptFileWatcher> watcher = factory(ScriptFileWatcher::kDefaultMaxQueuedEvents);
+    ASSERT_TRUE(watcher->Watch(root.Path().wstring()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::unordered_map<std::wstring, size_t> indexes;
+    for (size_t i = 0; i < kFiles; ++i)
+        indexes.emplace(L"Load" + std::to_wstring(i) + L".as", i);
+
+    std::vector<Clock::time_point> written(kFiles);
+    Clock::duration writeDuration{};
+    std::thread writer([&] {
+        const auto start = Clock::now();
+        for (size_t i = 0; i < kFiles; ++i) {
+            written[i] = Clock::now();
+            WriteText(root.Path() / ("Load" + std::to_string(i) + ".as"), "void L() {}\n");
+        }
+        writeDuration = Clock::now() - start;
+    });
+
+    std::vector<Clock::time_point> seen(kFiles);
+    std::vector<bool> hasSeen(kFiles, false);
+    size_t seenCount = 0;
+    size_t overflows = 0;
+    const auto deadline = Clock::now() + std::chrono::seconds(30);
+    while (seenCount < kFiles && Clock::now() < deadline) {
+        const std::vector<ScriptFileWatcher::Event> events = watcher->DrainEvents();
+        const auto now = Clock::now();
+        for (const auto &event : events) {
+            if (event.Overflow) {
+                ++overflows;
+                continue;
+            }
+            const auto it = indexes.find(FileName(event.Path));
+            if (it == indexes.end() || hasSeen[it->second])
+                continue;
+            hasSeen[it->second] = true;
+            seen[it->second] = now;
+            ++seenCount;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    writer.join();
+
+    EXPECT_EQ(seenCount, kFiles);
+    EXPECT_EQ(overflows, 0u);
+    EXPECT_EQ(watcher->GetDroppedEventCount(), 0u);
+
+    std::vector<double> latencies;
+    latencies.reserve(kFiles);
+    for (size_t i = 0; i < kFiles; ++i) {
+        if (hasSeen[i])
+            latencies.push_back(std::max(0.0, std::chrono::duration<double, std::milli>(seen[i] - written[i]).count()));
+    }
+    const double p50 = Percentile(latencies, 0.50);
+    const double p99 = Percentile(latencies, 0.99);
+    const double max = Percentile(latencies, 1.0);
+    const double writeSeconds = std::max(1e-6, std::chrono::duration<double>(writeDuration).count());
+    const double rate = static_cast<double>(watcher->GetStats().Events) / writeSeconds;
+
+    ::testing::Test::RecordProperty("EventsPerSecond", std::to_string(static_cast<uint64_t>(rate)));
+    ::testing::Test::RecordProperty("LatencyP50Ms", std::to_string(p50));
+    ::testing::Test::RecordProperty("LatencyP99Ms", std::to_string(p99));
+    ::testing::Test::RecordProperty("LatencyMaxMs", std::to_string(max));
+    watcher->StopAll();
+}
+
+} // namespace
+
+TEST(ScriptFileWatcherTest, CoalescesQueuedModificationsOfAPath) {
+    ExpectRepeatedModificationsCoalesce(MakeNativeWatcher);
+}
+
+TEST(ScriptFileWatcherTest, CountsEventsDroppedByAFullQueue) {
+    ExpectDroppedEventsAreAccounted(MakeNativeWatcher);
+}
+
+TEST(ScriptFileWatcherTest, DeliversEveryEventOfAWriteBurst) {
+    ExpectEveryEventUnderLoad(MakeNativeWatcher);
+}
+
+TEST(ScriptFileWatcherTest, PollingCoalescesQueuedModificationsOfAPath) {
+    ExpectRepeatedModificationsCoalesce(MakePollingWatcher);
+}
+
+TEST(ScriptFileWatcherTest, PollingCountsEventsDroppedByAFullQueue) {
+    ExpectDroppedEventsAreAccounted(MakePollingWatcher);
+}
+
+TEST(ScriptFileWatcherTest, PollingDeliversEveryEventOfAWriteBurst) {
+    ExpectEveryEventUnderLoad(MakePollingWatcher);
+}
+
+TEST(ScriptFileWatcherTest, ModificationAfterAnotherChangeIsNotCoalesced) {
+    const TempWatchRoot root;
+    const std::unique_ptr<ScriptFileWatcher> watcher = MakeNativeWatcher(ScriptFileWatcher::kDefaultMaxQueuedEvents);
+    ASSERT_TRUE(watcher->Watch(root.Path().wstring()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const std::filesystem::path entry = root.Path() / "Cycle.as";
+    WriteText(entry, "a");
+    WaitForQuiet(*watcher, 1);
+    std::filesystem::remove(entry);
+    WriteText(entry, "b");
+    WriteText(entry, "c", true);
+    WaitForQuiet(*watcher, 3);
+
+    // The removal stays between the modifications around it.
+    const std::vector<ScriptFileWatcher::Event> events = watcher->DrainEvents();
+    size_t removal = events.size();
+    size_t lastModification = 0;
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (events[i].Action == ScriptFileAction::Removed && removal == events.size())
+            removal = i;
+        if (events[i].Action == ScriptFileAction::Modified)
+            lastModification = i;
+    }
+    ASSERT_LT(removal, events.size());
+    EXPECT_GT(lastModification, removal);
+    watcher->StopAll();
+}
+
+TEST(ScriptFileWatcherTest, RecursiveWatchFollowsNewDirectories) {
+    const TempWatchRoot root;
+    const std::unique_ptr<ScriptFileWatcher> watcher = MakeNativeWatcher(ScriptFileWatcher::kDefaultMaxQueuedEvents);
+    ASSERT_TRUE(watcher->Watch(root.Path().wstring()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const std::filesystem::path nested = root.Path() / "scripts" / "deep";
+    std::filesystem::create_directories(nested);
+    WriteText(nested / "First.as", "void First() {}\n");
+    WaitForQuiet(*watcher, 1);
+    WriteText(nested / "Second.as", "void Second() {}\n");
+    WaitForQuiet(*watcher, 1);
+
+    bool first = false;
+    bool second = false;
+    for (const auto &event : watcher->DrainEvents()) {
+        first = first || FileName(event.Path) == L"First.as";
+        second = second || FileName(event.Path) == L"Second.as";
+    }
+    EXPECT_TRUE(first);
+    EXPECT_TRUE(second);
+    watcher->StopAll();
+}
+
+TEST(ScriptFileWatcherTest, OverflowEventsAreDeduplicatedPerRoot) {
+    const std::unique_ptr<ScriptFileWatcher> watcher = MakePollingWatcher(ScriptFileWatcher::kDefaultMaxQueuedEvents);
+    watcher->PushOverflowEventForTest(L"/mods/one", true);
+    watcher->PushOverflowEventForTest(L"/mods/two", true);
+    watcher->PushOverflowEventForTest(L"/mods/one", true);
+
+    const std::vector<ScriptFileWatcher::Event> events = watcher->DrainEvents();
+    ASSERT_EQ(2u, events.size());
+    EXPECT_TRUE(events[0].Overflow);
+    EXPECT_TRUE(events[1].Overflow);
+    EXPECT_EQ(watcher->GetStats().Overflows, 2u);
+}
+
+} // namespace Test
+} // namespace BML
@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <string>
+#include <vector>
+
 #include "AngelScript/ScriptModHotReloadPathFilter.h"
 
 namespace BML {
@@ -7,11 +11,11 @@ namespace Test {
 
 namespace {
 
-ScriptFileWatcherWin32::Event MakeEvent(const wchar_t *root,
-                                        const wchar_t *path,
-                                        DWORD action,
-                                        bool recursive = true) {
-    ScriptFileWatcherWin32::Event event;
+ScriptFileWatcher::Event MakeEvent(const wchar_t *root,
+                                   const wchar_t *path,
+                                   ScriptFileAction action,
+                                   bool recursive = true) {
+    ScriptFileWatcher::Event event;
     event.Root = root ? root : L"";
     event.Path = path ? path : L"";
     event.Action = action;
@@ -19,8 +23,8 @@ ScriptFileWatcherWin32::Event MakeEvent(const wchar_t *root,
     return event;
 }
 
-ScriptFileWatcherWin32::Event MakeOverflow(const wchar_t *root, bool recursive = true) {
-    ScriptFileWatcherWin32::Event event;
+ScriptFileWatcher::Event MakeOverflow(const wchar_t *root, bool recursive = true) {
+    ScriptFileWatcher::Event event;
     event.Root = root ? root : L"";
     event.Path = event.Root;
     event.Overflow = true;
@@ -63,22 +67,53 @@ ScriptLibraryUse MakeLibraryUse() {
     return library;
 }
 
+std::vector<size_t> RoutedMods(const ScriptHotReloadEventRouter &router, const ScriptFileWatcher::Event &event) {
+    std::vector<ScriptHotReloadEventRouter::Target> targets;
+    router.Route(event, targets);
+    std::vector<size_t> mods;
+    for (const ScriptHotReloadEventRouter::Target &target : targets) {
+        if (mods.empty() || mods.back() != target.Mod)
+            mods.push_back(target.Mod);
+    }
+    return mods;
+}
+
+// What the hot reload service does with an event for one mod: reload the
+// libraries it touches, otherwise reload the mod if its source changed.
+std::string Decide(const ScriptFileWatcher::Event &event,
+                   size_t mod,
+                   const ScriptModEntry &entry,
+                   const std::vector<ScriptLibraryUse> &libraries,
+                   const std::vector<size_t> &libraryIndices,
+                   bool source) {
+    std::string libraryDecision;
+    for (size_t index : libraryIndices) {
+        if (ScriptHotReloadEventLooksRelevantToLibraryUse(event, libraries[index]))
+            libraryDecision += " " + libraries[index].Id;
+    }
+    if (!libraryDecision.empty())
+        return std::to_string(mod) + " libraries" + libraryDecision;
+    if (source && ScriptHotReloadEventLooksRelevant(event, entry))
+        return std::to_string(mod) + " reload";
+    return {};
+}
+
 } // namespace
 
 TEST(ScriptModHotReloadPathFilterTest, DirectoryRootLifecycleEventsAreRelevant) {
     const ScriptModEntry entry = MakeDirectoryEntry();
 
     EXPECT_TRUE(ScriptHotReloadEventLooksRelevant(
-        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello", FILE_ACTION_REMOVED, false),
+        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello", ScriptFileAction::Removed, false),
         entry));
     EXPECT_TRUE(ScriptHotReloadEventLooksRelevant(
-        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello", FILE_ACTION_RENAMED_OLD_NAME, false),
+        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello", ScriptFileAction::RenamedOldName, false),
         entry));
     EXPECT_TRUE(ScriptHotReloadEventLooksRelevant(
-        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello", FILE_ACTION_RENAMED_NEW_NAME, false),
+        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello", ScriptFileAction::RenamedNewName, false),
         entry));
     EXPECT_FALSE(ScriptHotReloadEventLooksRelevant(
-        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello", FILE_ACTION_MODIFIED, false),
+        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello", ScriptFileAction::Modified, false),
         entry));
 }
 
@@ -86,13 +121,13 @@ TEST(ScriptModHotReloadPathFilterTest, DirectoryEntriesAndHelpersAreRelevant) {
     const ScriptModEntry entry = MakeDirectoryEntry();
 
     EXPECT_TRUE(ScriptHotReloadEventLooksRelevant(
-        MakeEvent(L"C:\\Mods\\Hello", L"C:\\Mods\\Hello\\Hello.mod.as", FILE_ACTION_MODIFIED),
+        MakeEvent(L"C:\\Mods\\Hello", L"C:\\Mods\\Hello\\Hello.mod.as", ScriptFileAction::Modified),
         entry));
     EXPECT_TRUE(ScriptHotReloadEventLooksRelevant(
-        MakeEvent(L"C:\\Mods\\Hello", L"C:\\Mods\\Hello\\scripts\\helper.as", FILE_ACTION_MODIFIED),
+        MakeEvent(L"C:\\Mods\\Hello", L"C:\\Mods\\Hello\\scripts\\helper.as", ScriptFileAction::Modified),
         entry));
     EXPECT_FALSE(ScriptHotReloadEventLooksRelevant(
-        MakeEvent(L"C:\\Mods\\Hello", L"C:\\Mods\\Hello\\readme.txt", FILE_ACTION_MODIFIED),
+        MakeEvent(L"C:\\Mods\\Hello", L"C:\\Mods\\Hello\\readme.txt", ScriptFileAction::Modified),
         entry));
 }
 
@@ -100,16 +135,16 @@ TEST(ScriptModHotReloadPathFilterTest, SingleFileResourceRootLifecycleEventsAreR
     const ScriptModEntry entry = MakeSingleFileEntry();
 
     EXPECT_TRUE(ScriptHotReloadEventLooksRelevant(
-        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello", FILE_ACTION_REMOVED, false),
+        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello", ScriptFileAction::Removed, false),
         entry));
     EXPECT_TRUE(ScriptHotReloadEventLooksRelevant(
-        MakeEvent(L"C:\\Mods\\Hello", L"C:\\Mods\\Hello\\helper.as", FILE_ACTION_MODIFIED),
+        MakeEvent(L"C:\\Mods\\Hello", L"C:\\Mods\\Hello\\helper.as", ScriptFileAction::Modified),
         entry));
     EXPECT_TRUE(ScriptHotReloadEventLooksRelevant(
-        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello.mod.as", FILE_ACTION_REMOVED, false),
+        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello.mod.as", ScriptFileAction::Removed, false),
         entry));
     EXPECT_FALSE(ScriptHotReloadEventLooksRelevant(
-        MakeEvent(L"C:\\Mods\\Hello", L"C:\\Mods\\Hello\\asset.png", FILE_ACTION_MODIFIED),
+        MakeEvent(L"C:\\Mods\\Hello", L"C:\\Mods\\Hello\\asset.png", ScriptFileAction::Modified),
         entry));
 }
 
@@ -117,10 +152,10 @@ TEST(ScriptModHotReloadPathFilterTest, ZipPackagesOnlyReactToTheirArchive) {
     const ScriptModEntry entry = MakeZipEntry();
 
     EXPECT_TRUE(ScriptHotReloadEventLooksRelevant(
-        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello.zip", FILE_ACTION_MODIFIED, false),
+        MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello.zip", ScriptFileAction::Modified, false),
         entry));
     EXPECT_FALSE(ScriptHotReloadEventLooksRelevant(
-        MakeEvent(L"C:\\Mods\\Hello.reload.1", L"C:\\Mods\\Hello.reload.1\\helper.as", FILE_ACTION_MODIFIED),
+        MakeEvent(L"C:\\Mods\\Hello.reload.1", L"C:\\Mods\\Hello.reload.1\\helper.as", ScriptFileAction::Modified),
         entry));
 }
 
@@ -136,16 +171,16 @@ TEST(ScriptModHotReloadPathFilterTest, LibraryUseSourceFilesAreRelevant) {
     const ScriptLibraryUse library = MakeLibraryUse();
 
     EXPECT_TRUE(ScriptHotReloadEventLooksRelevantToLibraryUse(
-        MakeEvent(L"C:\\ModLoader\\ScriptLibs", L"C:\\ModLoader\\ScriptLibs\\com.example.score\\1.2.0\\api.as", FILE_ACTION_MODIFIED),
+        MakeEvent(L"C:\\ModLoader\\ScriptLibs", L"C:\\ModLoader\\ScriptLibs\\com.example.score\\1.2.0\\api.as", ScriptFileAction::Modified),
         library));
     EXPECT_TRUE(ScriptHotReloadEventLooksRelevantToLibraryUse(
-        MakeEvent(L"C:\\ModLoader\\ScriptLibs", L"C:\\ModLoader\\ScriptLibs\\com.example.score\\1.2.0", FILE_ACTION_REMOVED),
+        MakeEvent(L"C:\\ModLoader\\ScriptLibs", L"C:\\ModLoader\\ScriptLibs\\com.example.score\\1.2.0", ScriptFileAction::Removed),
         library));
     EXPECT_FALSE(ScriptHotReloadEventLooksRelevantToLibraryUse(
-        MakeEvent(L"C:\\ModLoader\\ScriptLibs", L"C:\\ModLoader\\ScriptLibs\\com.example.score\\1.2.0\\readme.md", FILE_ACTION_MODIFIED),
+        MakeEvent(L"C:\\ModLoader\\ScriptLibs", L"C:\\ModLoader\\ScriptLibs\\com.example.score\\1.2.0\\readme.md", ScriptFileAction::Modified),
         library));
     EXPECT_FALSE(ScriptHotReloadEventLooksRelevantToLibraryUse(
-        MakeEvent(L"C:\\ModLoader\\ScriptLibs", L"C:\\ModLoader\\ScriptLibs\\com.example.other\\1.2.0\\api.as", FILE_ACTION_MODIFIED),
+        MakeEvent(L"C:\\ModLoader\\ScriptLibs", L"C:\\ModLoader\\ScriptLibs\\com.example.other\\1.2.0\\api.as", ScriptFileAction::Modified),
         library));
 }
 
@@ -157,5 +192,167 @@ TEST(ScriptModHotReloadPathFilterTest, LibraryUseOverflowMatchesPackageScope) {
     EXPECT_FALSE(ScriptHotReloadEventLooksRelevantToLibraryUse(MakeOverflow(L"C:\\Other", true), library));
 }
 
+TEST(ScriptModHotReloadPathFilterTest, RouterFindsModsByTheirWatchedPaths) {
+    ScriptHotReloadEventRouter router;
+    router.AddMod(0, MakeDirectoryEntry(), {MakeLibraryUse()});
+    router.AddMod(1, MakeZipEntry(), {});
+    ScriptModEntry single = MakeSingleFileEntry();
+    single.EntryPath = single.SourcePath = L"C:\\Mods\\Other.mod.as";
+    single.ResourceRootDirectory = L"C:\\Mods\\Other";
+    router.AddMod(2, single, {});
+
+    EXPECT_EQ(std::vector<size_t>{0},
+              RoutedMods(router, MakeEvent(L"C:\\Mods\\Hello", L"C:\\mods\\HELLO\\scripts\\helper.as", ScriptFileAction::Modified)));
+    EXPECT_EQ(std::vector<size_t>{0},
+              RoutedMods(router, MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello", ScriptFileAction::Removed, false)));
+    EXPECT_EQ(std::vector<size_t>{0},
+              RoutedMods(router, MakeEvent(L"C:\\ModLoader\\ScriptLibs",
+                                           L"C:\\ModLoader\\ScriptLibs\\com.example.score\\1.2.0\\api.as",
+                                           ScriptFileAction::Modified)));
+    EXPECT_EQ(std::vector<size_t>{1}, RoutedMods(router, MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello.zip", ScriptFileAction::Modified, false)));
+    EXPECT_EQ(std::vector<size_t>{2},
+              RoutedMods(router, MakeEvent(L"C:\\Mods", L"C:\\Mods\\Other.mod.as", ScriptFileAction::Modified, false)));
+    EXPECT_EQ(std::vector<size_t>{2},
+              RoutedMods(router, MakeEvent(L"C:\\Mods\\Other", L"C:\\Mods\\Other\\data.as", ScriptFileAction::Modified)));
+
+    EXPECT_TRUE(RoutedMods(router, MakeEvent(L"C:\\Mods", L"C:\\Mods\\Hello2\\a.as", ScriptFileAction::Modified)).empty());
+    EXPECT_TRUE(RoutedMods(router, MakeEvent(L"C:\\Mods", L"C:\\Mods", ScriptFileAction::Modified, false)).empty());
+    EXPECT_EQ((std::vector<size_t>{0, 1, 2}), RoutedMods(router, MakeOverflow(L"C:\\Other")));
+
+    std::vector<ScriptHotReloadEventRouter::Target> targets;
+    router.Route(MakeEvent(L"C:\\ModLoader\\ScriptLibs",
+                           L"C:\\ModLoader\\ScriptLibs\\com.example.score\\1.2.0\\api.as",
+                           ScriptFileAction::Modified),
+                 targets);
+    ASSERT_EQ(1u, targets.size());
+    EXPECT_EQ(0u, targets.front().Library);
+}
+
+TEST(ScriptModHotReloadPathFilterTest, RoutedEventsMatchCheckingEveryMod) {
+    constexpr size_t kModCount = 50;
+    constexpr size_t kEventCount = 1000;
+    constexpr size_t kPackageCount = 5;
+
+    std::vector<ScriptModEntry> entries;
+    std::vector<std::vector<ScriptLibraryUse>> libraries(kModCount);
+    ScriptHotReloadEventRouter router;
+    for (size_t mod = 0; mod < kModCount; ++mod) {
+        const std::wstring name = L"Mod" + std::to_wstring(mod);
+        ScriptModEntry entry;
+        if (mod % 5 == 3) {
+            entry.SourceKind = ScriptModEntrySourceKind::ZipPackage;
+            entry.SourcePath = L"C:\\Game\\ModLoader\\Mods\\" + name + L".zip";
+            entry.RootDirectory = L"C:\\Game\\ModLoader\\Mods\\" + name + L".reload.1";
+        } else if (mod % 5 == 4) {
+            entry.SourceKind = ScriptModEntrySourceKind::SingleFile;
+            entry.SourcePath = entry.EntryPath = L"C:\\Game\\ModLoader\\Mods\\" + name + L".mod.as";
+            entry.ResourceRootDirectory = L"C:\\Game\\ModLoader\\Mods\\" + name;
+        } else {
+            entry.SourceKind = ScriptModEntrySourceKind::Directory;
+            entry.RootDirectory = L"C:\\Game\\ModLoader\\Mods\\" + name;
+            entry.EntryPath = entry.RootDirectory + L"\\" + name + L".mod.as";
+        }
+        for (size_t package = mod % kPackageCount; package < kPackageCount; package += 3) {
+            ScriptLibraryUse library;
+            library.Id = "com.example.lib" + std::to_string(package);
+            library.Version = "1.0.0";
+            library.RootDirectory = L"C:\\Game\\ModLoader\\ScriptLibs\\com.example.lib" + std::to_wstring(package) + L"\\1.0.0";
+            libraries[mod].push_back(library);
+        }
+        router.AddMod(mod, entry, libraries[mod]);
+        entries.push_back(std::move(entry));
+    }
+
+    // A checkout touching mod sources, library sources, unrelated files and
+    // whole directories
+    std::vector<ScriptFileWatcher::Event> events;
+    for (size_t i = 0; i < kEventCount; ++i) {
+        const std::wstring mod = L"Mod" + std::to_wstring((i * 7) % kModCount);
+        switch (i % 6) {
+        case 0:
+            events.push_back(MakeEvent((L"C:\\Game\\ModLoader\\Mods\\" + mod).c_str(),
+                                       (L"C:\\Game\\ModLoader\\Mods\\" + mod + L"\\scripts\\file" + std::to_wstring(i) + L".as").c_str(),
+                                       ScriptFileAction::Modified));
+            break;
+        case 1:
+            events.push_back(MakeEvent(L"C:\\Game\\ModLoader\\ScriptLibs",
+                                       (L"C:\\Game\\ModLoader\\ScriptLibs\\com.example.lib" + std::to_wstring(i % kPackageCount) +
+                                        L"\\1.0.0\\api" + std::to_wstring(i) + L".as").c_str(),
+                                       ScriptFileAction::Modified));
+            break;
+        case 2:
+            events.push_back(MakeEvent(L"C:\\Game\\ModLoader\\Mods",
+                                       (L"C:\\Game\\ModLoader\\Mods\\" + mod + L".zip").c_str(),
+                                       ScriptFileAction::Modified,
+                                       false));
+            break;
+        case 3:
+            events.push_back(MakeEvent(L"C:\\Game\\ModLoader\\Mods",
+                                       (L"C:\\Game\\ModLoader\\Mods\\" + mod + L"\\readme" + std::to_wstring(i) + L".md").c_str(),
+                                       ScriptFileAction::Added));
+            break;
+        case 4:
+            events.push_back(MakeEvent(L"C:\\Game\\ModLoader\\Mods",
+                                       (L"C:\\Game\\ModLoader\\Mods\\" + mod).c_str(),
+                                       ScriptFileAction::RenamedNewName,
+                                       false));
+            break;
+        default:
+            events.push_back(MakeEvent(L"C:\\Game\\Textures",
+                                       (L"C:\\Game\\Textures\\tex" + std::to_wstring(i) + L".bmp").c_str(),
+                                       ScriptFileAction::Modified));
+            break;
+        }
+    }
+    events.push_back(MakeOverflow(L"C:\\Game\\ModLoader\\ScriptLibs"));
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> everyMod;
+    for (const ScriptFileWatcher::Event &event : events) {
+        for (size_t mod = 0; mod < kModCount; ++mod) {
+            std::vector<size_t> all(libraries[mod].size());
+            for (size_t i = 0; i < all.size(); ++i)
+                all[i] = i;
+            std::string decision = Decide(event, mod, entries[mod], libraries[mod], all, true);
+            if (!decision.empty())
+                everyMod.push_back(std::move(decision));
+        }
+    }
+    const double everyModMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::vector<std::string> routed;
+    std::vector<ScriptHotReloadEventRouter::Target> targets;
+    for (const ScriptFileWatcher::Event &event : events) {
+        router.Route(event, targets);
+        for (size_t begin = 0; begin < targets.size();) {
+            size_t end = begin;
+            std::vector<size_t> libraryIndices;
+            bool source = false;
+            for (; end < targets.size() && targets[end].Mod == targets[begin].Mod; ++end) {
+                if (targets[end].Library == ScriptHotReloadEventRouter::kModSource)
+                    source = true;
+                else
+                    libraryIndices.push_back(targets[end].Library);
+            }
+            const size_t mod = targets[begin].Mod;
+            std::string decision = Decide(event, mod, entries[mod], libraries[mod], libraryIndices, source);
+            if (!decision.empty())
+                routed.push_back(std::move(decision));
+            begin = end;
+        }
+    }
+    const double routedMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_FALSE(everyMod.empty());
+    EXPECT_EQ(everyMod, routed);
+
+    RecordProperty("every_mod_ms", std::to_string(everyModMs));
+    RecordProperty("routed_ms", std::to_string(routedMs));
+    RecordProperty("trie_nodes", std::to_string(router.GetNodeCount()));
+}
+
 } // namespace Test
 } // namespace BML
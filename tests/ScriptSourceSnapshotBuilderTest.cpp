@@ -1,8 +1,11 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "AngelScript/ScriptLibraryRegistry.h"
 #include "AngelScript/ScriptSourceSnapshotBuilder.h"
@@ -93,6 +96,31 @@ const ScriptSourceIncludeEdge *FindIncludeEdge(const ScriptSourceSnapshot &snaps
     return it == snapshot.IncludeEdges.end() ? nullptr : &*it;
 }
 
+void ExpectSameSnapshot(const ScriptSourceSnapshot &expected, const ScriptSourceSnapshot &actual) {
+    EXPECT_EQ(expected.EntrySectionName, actual.EntrySectionName);
+    ASSERT_EQ(expected.Sections.size(), actual.Sections.size());
+    for (size_t i = 0; i < expected.Sections.size(); ++i) {
+        EXPECT_EQ(expected.Sections[i].Name, actual.Sections[i].Name);
+        EXPECT_EQ(expected.Sections[i].Code, actual.Sections[i].Code);
+    }
+    ASSERT_EQ(expected.Dependencies.size(), actual.Dependencies.size());
+    for (size_t i = 0; i < expected.Dependencies.size(); ++i) {
+        EXPECT_EQ(expected.Dependencies[i].PhysicalPath, actual.Dependencies[i].PhysicalPath);
+        EXPECT_EQ(expected.Dependencies[i].VirtualSection, actual.Dependencies[i].VirtualSection);
+        EXPECT_EQ(expected.Dependencies[i].ContentHash, actual.Dependencies[i].ContentHash);
+    }
+    ASSERT_EQ(expected.IncludeEdges.size(), actual.IncludeEdges.size());
+    for (size_t i = 0; i < expected.IncludeEdges.size(); ++i) {
+        EXPECT_EQ(expected.IncludeEdges[i].FromSection, actual.IncludeEdges[i].FromSection);
+        EXPECT_EQ(expected.IncludeEdges[i].ToSection, actual.IncludeEdges[i].ToSection);
+        EXPECT_EQ(expected.IncludeEdges[i].Line, actual.IncludeEdges[i].Line);
+    }
+    ASSERT_EQ(expected.Libraries.size(), actual.Libraries.size());
+    for (size_t i = 0; i < expected.Libraries.size(); ++i)
+        EXPECT_EQ(expected.Libraries[i].Id + "@" + expected.Libraries[i].Version,
+                  actual.Libraries[i].Id + "@" + actual.Libraries[i].Version);
+}
+
 std::string DumpIncludeEdges(const ScriptSourceSnapshot &snapshot) {
     std::string dump;
     for (const ScriptSourceIncludeEdge &edge : snapshot.IncludeEdges) {
@@ -123,7 +151,7 @@ TEST_F(ScriptSourceSnapshotBuilderTest, DirectoryModKeepsEntryFirstAndOrdersLoca
     EXPECT_TRUE(HasSection(snapshot, "runtime.as"));
     const ScriptSourceDependency *entryDependency = FindDependency(snapshot, "Hello.mod.as");
     ASSERT_NE(nullptr, entryDependency);
-    EXPECT_EQ(64u, entryDependency->ContentHash.size());
+    EXPECT_EQ(32u, entryDependency->ContentHash.size());
 }
 
 TEST_F(ScriptSourceSnapshotBuilderTest, RejectsEntrySymlinkEscapingModRoot) {
@@ -204,7 +232,7 @@ TEST_F(ScriptSourceSnapshotBuilderTest, LibraryIncludeInjectsOnlyDiscoveredClosu
         FindDependency(snapshot, "/bml/libs/com.example.score@1.2.0/api.as");
     ASSERT_NE(nullptr, apiDependency);
     EXPECT_TRUE(apiDependency->LibraryOwned);
-    EXPECT_EQ(64u, apiDependency->ContentHash.size());
+    EXPECT_EQ(32u, apiDependency->ContentHash.size());
 
     const ScriptSourceIncludeEdge *clientEdge =
         FindIncludeEdge(snapshot, "User.mod.as", "/bml/libs/com.example.score@1.2.0/client.as");
@@ -279,7 +307,7 @@ TEST_F(ScriptSourceSnapshotBuilderTest, SharedLibrarySourceCacheKeepsStableBytes
     ASSERT_EQ(1u, sourceCache.GetFileCount());
     std::string capturedHash;
     ASSERT_TRUE(sourceCache.GetFileContentHash(apiPath, capturedHash));
-    EXPECT_EQ(64u, capturedHash.size());
+    EXPECT_EQ(32u, capturedHash.size());
 
     Write(apiPath, "namespace ScoreApi { const int Version = 2; }\n");
     std::string hashAfterDiskRewrite;
@@ -312,11 +340,129 @@ TEST_F(ScriptSourceSnapshotBuilderTest, SharedLibrarySourceCacheKeepsStableBytes
         FindDependency(secondSnapshot, "/bml/libs/com.example.score@1.2.0/api.as");
     ASSERT_NE(nullptr, firstDependency);
     ASSERT_NE(nullptr, secondDependency);
-    EXPECT_EQ(64u, firstDependency->ContentHash.size());
+    EXPECT_EQ(32u, firstDependency->ContentHash.size());
     EXPECT_EQ(firstDependency->ContentHash, secondDependency->ContentHash);
     EXPECT_EQ(capturedHash, firstDependency->ContentHash);
 }
 
+TEST_F(ScriptSourceSnapshotBuilderTest, ContentHashMemoRehashesOnlyWhenTheStampChanges) {
+    const std::wstring path = utils::CombinePathW(Root, L"memo.as");
+    Write(path, "int Value = 1;\n");
+
+    ScriptContentHashMemo memo;
+    const ScriptFileStamp stamp = ScriptContentHashMemo::StampFile(path);
+    ASSERT_TRUE(stamp.Valid);
+    const std::string hash = memo.GetHash(path, stamp, "int Value = 1;\n");
+    EXPECT_EQ(ComputeScriptContentHash("int Value = 1;\n"), hash);
+    EXPECT_EQ(1u, memo.GetSize());
+
+    // Same path, size and write time: the memoised hash is returned unhashed
+    EXPECT_EQ(hash, memo.GetHash(path, stamp, "int Value = 2;\n"));
+
+    Write(path, "int Value = 2;\n");
+    std::filesystem::last_write_time(std::filesystem::path(path),
+                                     std::filesystem::last_write_time(std::filesystem::path(path)) +
+                                         std::chrono::hours(1));
+    const ScriptFileStamp changed = ScriptContentHashMemo::StampFile(path);
+    EXPECT_EQ(ComputeScriptContentHash("int Value = 2;\n"), memo.GetHash(path, changed, "int Value = 2;\n"));
+    EXPECT_EQ(1u, memo.GetSize());
+
+    // A stamp that does not match the content size is never memoised
+    EXPECT_EQ(ComputeScriptContentHash("int Value = 22;\n"), memo.GetHash(path, changed, "int Value = 22;\n"));
+}
+
+TEST_F(ScriptSourceSnapshotBuilderTest, ParallelReloadAllMatchesSequentialBuilds) {
+    constexpr size_t kModCount = 30;
+    constexpr size_t kHelperCount = 12;
+    constexpr size_t kBrokenMod = 7;
+
+    const std::wstring packageRoot =
+        utils::CombinePathW(utils::CombinePathW(LibRoot, L"com.example.score"), L"1.2.0");
+    Write(utils::CombinePathW(packageRoot, L"api.as"),
+          "#include \"detail.as\"\nnamespace ScoreApi { int Get() { return ScoreDetail::Value(); } }\n");
+    Write(utils::CombinePathW(packageRoot, L"detail.as"), "namespace ScoreDetail { int Value() { return 12; } }\n");
+
+    const std::string body(16 * 1024, ' ');
+    std::vector<ScriptModEntry> entries;
+    for (size_t mod = 0; mod < kModCount; ++mod) {
+        const std::wstring modName = L"Mod" + std::to_wstring(mod);
+        const std::wstring modRoot = utils::CombinePathW(ModsRoot, modName);
+        const std::wstring scriptsRoot = utils::CombinePathW(modRoot, L"scripts");
+        std::string entryCode;
+        for (size_t helper = 0; helper < kHelperCount; ++helper) {
+            const std::string helperName = "helper" + std::to_string(helper) + ".as";
+            entryCode += "#include \"scripts/" + helperName + "\"\n";
+            std::string helperCode = helper == 0 ? "#include \"/bml/libs/com.example.score@1.2.0/api.as\"\n" : "";
+            helperCode += "void Helper" + std::to_string(helper) + "() {}\n" + body;
+            Write(utils::CombinePathW(scriptsRoot, utils::Utf8ToUtf16(helperName)), helperCode);
+        }
+        if (mod == kBrokenMod)
+            entryCode += "#include \"scripts/missing.as\"\n";
+        Write(utils::CombinePathW(modRoot, modName + L".mod.as"), entryCode + "class Mod {}\n");
+
+        ScriptModLoadCandidate candidate =
+            MakeDirectoryScriptModCandidate(modRoot, ScriptModEntrySourceKind::Directory, modRoot);
+        ASSERT_EQ(1u, candidate.EntryPaths.size());
+        entries.push_back(MakeScriptModEntry(candidate, candidate.EntryPaths.front()));
+    }
+
+    ScriptLibraryRegistry registry(LibRoot);
+    std::string registryDiagnostic;
+    ASSERT_TRUE(registry.Scan(registryDiagnostic)) << registryDiagnostic;
+    ScriptSourceSnapshotBuilder builder(std::move(registry));
+    const size_t workers = std::max<size_t>(4, ScriptSourceSnapshotBuilder::GetDefaultParallelism());
+
+    auto elapsedMs = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // One build after another on the calling thread
+    ScriptLibrarySourceCache sequentialCache;
+    builder.SetLibrarySourceCache(&sequentialCache);
+    builder.SetParallelism(0);
+    std::vector<ScriptSourceSnapshotBuildResult> sequential(entries.size());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < entries.size(); ++i)
+        sequential[i].Succeeded = builder.Build(entries[i], sequential[i].Snapshot, sequential[i].Diagnostic);
+    const double sequentialMs = elapsedMs(start);
+
+    // One build after another, each fanning its files out
+    ScriptLibrarySourceCache perFileCache;
+    builder.SetLibrarySourceCache(&perFileCache);
+    builder.SetParallelism(workers);
+    std::vector<ScriptSourceSnapshotBuildResult> perFile(entries.size());
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < entries.size(); ++i)
+        perFile[i].Succeeded = builder.Build(entries[i], perFile[i].Snapshot, perFile[i].Diagnostic);
+    const double perFileMs = elapsedMs(start);
+
+    // Every build at once against one shared library cache
+    ScriptLibrarySourceCache sharedCache;
+    builder.SetLibrarySourceCache(&sharedCache);
+    start = std::chrono::steady_clock::now();
+    std::vector<ScriptSourceSnapshotBuildResult> all = builder.BuildAll(entries);
+    const double allMs = elapsedMs(start);
+
+    ASSERT_EQ(entries.size(), all.size());
+    EXPECT_EQ(2u, sharedCache.GetFileCount());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        SCOPED_TRACE(i);
+        EXPECT_EQ(i != kBrokenMod, sequential[i].Succeeded) << sequential[i].Diagnostic.Message;
+        for (const ScriptSourceSnapshotBuildResult *result : {&perFile[i], &all[i]}) {
+            EXPECT_EQ(sequential[i].Succeeded, result->Succeeded);
+            EXPECT_EQ(sequential[i].Diagnostic.Message, result->Diagnostic.Message);
+            EXPECT_EQ(sequential[i].Diagnostic.EntryPath, result->Diagnostic.EntryPath);
+            if (sequential[i].Succeeded)
+                ExpectSameSnapshot(sequential[i].Snapshot, result->Snapshot);
+        }
+    }
+
+    RecordProperty("workers", static_cast<int>(workers));
+    RecordProperty("sequential_ms", std::to_string(sequentialMs));
+    RecordProperty("per_file_ms", std::to_string(perFileMs));
+    RecordProperty("build_all_ms", std::to_string(allMs));
+}
+
 TEST_F(ScriptSourceSnapshotBuilderTest, SharedLibrarySourceCacheRejectsFilesAddedAfterPackageCapture) {
     const std::wstring packageRoot = utils::CombinePathW(LibRoot, L"com.example.score\\1.2.0");
     const std::wstring apiPath = utils::CombinePathW(packageRoot, L"api.as");
@@ -450,7 +596,7 @@ TEST_F(ScriptSourceSnapshotBuilderTest, ScriptLibraryScenarioCanBeConsumedThroug
     EXPECT_TRUE(dependency->LibraryOwned);
     EXPECT_EQ("example.score.helpers", dependency->LibraryId);
     EXPECT_EQ("1.2.0", dependency->LibraryVersion);
-    EXPECT_EQ(64u, dependency->ContentHash.size());
+    EXPECT_EQ(32u, dependency->ContentHash.size());
 }
 
 TEST_F(ScriptSourceSnapshotBuilderTest, IgnoresLibraryIncludesInUnreachableLocalSections) {
@@ -156,11 +156,20 @@ private:
             BML::Scene::ObjectRef reference{};
             BML::Scene::ObjectInfo info{};
             BML::Scene::ObjectRef typedReference{};
-            return BML::Scene::FindObject(name, reference) == BML_OK && !IsNull(reference) &&
-                   BML::Scene::ReadObject(reference, info) == BML_OK && info.Id == expected->GetID() &&
-                   BML::Scene::FindObject(name, expected->GetClassID(), typedReference) == BML_OK &&
-                   typedReference.Domain == reference.Domain && typedReference.Slot == reference.Slot &&
-                   typedReference.Generation == reference.Generation;
+            if (BML::Scene::FindObject(name, reference) != BML_OK || IsNull(reference) ||
+                BML::Scene::ReadObject(reference, info) != BML_OK || info.Id != expected->GetID() ||
+                BML::Scene::FindObject(name, expected->GetClassID(), typedReference) != BML_OK ||
+                typedReference.Domain != reference.Domain || typedReference.Slot != reference.Slot ||
+                typedReference.Generation != reference.Generation) {
+                return false;
+            }
+
+            std::vector<BML::Scene::ObjectInfo> infos;
+            std::vector<int> statuses;
+            return BML::Scene::ReadObjects({reference, {}, reference}, infos, statuses) ==
+                       BML_ERROR_OBJECT_INVALID &&
+                   statuses == std::vector<int>{BML_OK, BML_ERROR_OBJECT_INVALID, BML_OK} &&
+                   infos[0].Id == info.Id && infos[2].Name == info.Name;
         }
 
         return true;
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <Windows.h>
+
+#include <string>
+#include <vector>
+
+#include "CryptoUtils.h"
+#include "UpdaterDelta.h"
+#include "UpdaterPaths.h"
+
+namespace {
+    std::string Noise(size_t size, uint64_t seed) {
+        std::string bytes(size, '\0');
+        for (char &byte : bytes) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            byte = static_cast<char>(seed);
+        }
+        return bytes;
+    }
+
+    std::string Patch(const std::string &base, const std::string &target) {
+        const std::vector<char> patch = bmlupdater::CreateBinaryPatch(base, target);
+        return {patch.begin(), patch.end()};
+    }
+
+    bmlupdater::Result Apply(const std::string &base, const std::string &patch, std::string &output) {
+        output.clear();
+        return bmlupdater::ApplyBinaryPatch(base, patch, [&output](const char *data, size_t size) {
+            output.append(data, size);
+            return true;
+        });
+    }
+
+    std::wstring MakeTempRoot() {
+        wchar_t temp[MAX_PATH]{};
+        EXPECT_NE(GetTempPathW(MAX_PATH, temp), 0u);
+        const std::wstring root = bmlupdater::JoinPath(
+            temp,
+            L"bml-updater-delta-test-" + std::to_wstring(GetCurrentProcessId()) + L"-" + std::to_wstring(GetTickCount64()));
+        EXPECT_TRUE(bmlupdater::CreateDirectories(root));
+        return root;
+    }
+
+    void WriteFile(const std::wstring &root, const std::wstring &relative, const std::string &content) {
+        const std::wstring path = bmlupdater::JoinPath(root, relative);
+        ASSERT_TRUE(bmlupdater::CreateDirectories(bmlupdater::ParentPath(path)));
+        std::string error;
+        ASSERT_TRUE(bmlupdater::WriteBinaryFile(path, content.data(), content.size(), error)) << error;
+    }
+}
+
+TEST(UpdaterDeltaTest, PatchesReproduceTheTarget) {
+    const std::string base = Noise(256 * 1024, 1);
+
+    std::string edited = base;
+    edited[1000] ^= 0x5A;
+    edited.insert(50000, "inserted bytes");
+    edited.erase(120000, 777);
+    edited += Noise(3000, 2);
+
+    const std::vector<std::pair<std::string, std::string>> cases = {
+        {base, edited},
+        {base, base},
+        {base, {}},
+        {{}, edited},
+        {"short", "shorter"},
+        {base, Noise(4096, 3)},
+    };
+    for (const auto &[from, to] : cases) {
+        const std::string patch = Patch(from, to);
+        std::string output;
+        const bmlupdater::Result result = Apply(from, patch, output);
+        ASSERT_TRUE(result.ok) << result.message;
+        EXPECT_EQ(output, to);
+    }
+
+    // A few local edits cost a few hundred bytes, not a copy of the file.
+    EXPECT_LT(Patch(base, edited).size(), 4096u + 1024u);
+}
+
+TEST(UpdaterDeltaTest, RejectsMalformedPatches) {
+    const std::string base = Noise(8192, 4);
+    std::string target = base;
+    target[10] ^= 1;
+    const std::string patch = Patch(base, target);
+
+    std::string output;
+    EXPECT_FALSE(Apply(base, "not a patch", output).ok);
+    EXPECT_FALSE(Apply(base.substr(1), patch, output).ok);
+    EXPECT_FALSE(Apply(base, patch.substr(0, patch.size() - 1), output).ok);
+
+    std::string unknownOp = patch;
+    unknownOp.push_back('X');
+    EXPECT_FALSE(Apply(base, unknownOp, output).ok);
+}
+
+TEST(UpdaterDeltaTest, BuildsPatchesForChangedFiles) {
+    const std::wstring root = MakeTempRoot();
+    const std::wstring previous = bmlupdater::JoinPath(root, L"previous");
+    const std::wstring stage = bmlupdater::JoinPath(root, L"stage");
+
+    const std::string dll = Noise(64 * 1024, 5);
+    std::string newDll = dll;
+    newDll.replace(2048, 16, "0123456789abcdef");
+    WriteFile(previous, L"BuildingBlocks\\BMLPlus.dll", dll);
+    WriteFile(previous, L"ModLoader\\Fonts\\font.otf", "font");
+    WriteFile(stage, L"BuildingBlocks\\BMLPlus.dll", newDll);
+    WriteFile(stage, L"ModLoader\\Fonts\\font.otf", "font");
+    WriteFile(stage, L"ModLoader\\New.txt", "new file");
+
+    std::vector<bmlupdater::ManagedFile> managed;
+    std::vector<bmlupdater::DeltaFile> deltas;
+    bmlupdater::Result result = bmlupdater::BuildDeltaPackage(stage, previous, {}, managed, deltas);
+    ASSERT_TRUE(result.ok) << result.message;
+
+    ASSERT_EQ(managed.size(), 3u);
+    EXPECT_EQ(managed[0].path, "BuildingBlocks/BMLPlus.dll");
+    EXPECT_EQ(managed[0].size, newDll.size());
+    ASSERT_EQ(deltas.size(), 1u);
+    EXPECT_EQ(deltas[0].path, "BuildingBlocks/BMLPlus.dll");
+    EXPECT_EQ(deltas[0].patchPath, "_bmldelta/BuildingBlocks/BMLPlus.dll.bmlpatch");
+    EXPECT_EQ(deltas[0].baseSha256, utils::Sha256FileHex(bmlupdater::JoinPath(previous, L"BuildingBlocks\\BMLPlus.dll")));
+
+    const std::wstring patchPath = bmlupdater::JoinPath(stage, L"_bmldelta\\BuildingBlocks\\BMLPlus.dll.bmlpatch");
+    EXPECT_EQ(utils::Sha256FileHex(patchPath), deltas[0].patchSha256);
+    EXPECT_TRUE(bmlupdater::PathExists(bmlupdater::JoinPath(stage, L"BuildingBlocks\\BMLPlus.dll")));
+
+    // Without full copies only the patch is left in the stage.
+    result = bmlupdater::BuildDeltaPackage(stage, previous, {false}, managed, deltas);
+    ASSERT_TRUE(result.ok) << result.message;
+    ASSERT_EQ(deltas.size(), 1u);
+    EXPECT_FALSE(bmlupdater::PathExists(bmlupdater::JoinPath(stage, L"BuildingBlocks\\BMLPlus.dll")));
+    EXPECT_TRUE(bmlupdater::PathExists(patchPath));
+
+    std::string error;
+    EXPECT_TRUE(bmlupdater::RemoveDirectoryTree(root, error)) << error;
+}
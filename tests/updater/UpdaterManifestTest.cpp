@@ -78,3 +78,87 @@ TEST(UpdaterManifestTest, RejectsForbiddenManagedPaths) {
     bmlupdater::Result result = bmlupdater::ParseManifestJson(json, manifest);
     EXPECT_FALSE(result.ok);
 }
+
+TEST(UpdaterManifestTest, ParsesDeltaFilesForManagedPaths) {
+    constexpr const char *json = R"json({
+      "schemaVersion": 1,
+      "version": "v1.2.4",
+      "package": {
+        "fileName": "BMLPlus-Update-v1.2.4.zip",
+        "sha256": "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"
+      },
+      "managedFiles": [
+        {
+          "path": "BuildingBlocks/BMLPlus.dll",
+          "sha256": "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+          "size": 42
+        }
+      ],
+      "deltaFiles": [
+        {
+          "path": "BuildingBlocks/BMLPlus.dll",
+          "baseSha256": "BBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBBB",
+          "patch": "_bmldelta/BuildingBlocks/BMLPlus.dll.bmlpatch",
+          "patchSha256": "cccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccc"
+        }
+      ]
+    })json";
+
+    bmlupdater::UpdaterManifest manifest;
+    bmlupdater::Result result = bmlupdater::ParseManifestJson(json, manifest);
+    ASSERT_TRUE(result.ok) << result.message;
+    ASSERT_EQ(manifest.deltaFiles.size(), 1u);
+    EXPECT_EQ(manifest.deltaFiles[0].baseSha256, std::string(64, 'b'));
+    EXPECT_EQ(manifest.deltaFiles[0].patchPath, "_bmldelta/BuildingBlocks/BMLPlus.dll.bmlpatch");
+
+    std::string error;
+    const std::string written = bmlupdater::WriteManifestJson(manifest, error);
+    bmlupdater::UpdaterManifest reparsed;
+    result = bmlupdater::ParseManifestJson(written, reparsed);
+    ASSERT_TRUE(result.ok) << result.message;
+    ASSERT_EQ(reparsed.deltaFiles.size(), 1u);
+    EXPECT_EQ(reparsed.deltaFiles[0].patchSha256, manifest.deltaFiles[0].patchSha256);
+
+    // A delta must produce a managed file and must not replace one.
+    std::string unmanaged = json;
+    unmanaged.replace(unmanaged.find("\"path\": \"BuildingBlocks/BMLPlus.dll\",\n          \"baseSha256\""),
+                      std::string("\"path\": \"BuildingBlocks/BMLPlus.dll\"").size(),
+                      "\"path\": \"BuildingBlocks/Other.dll\"");
+    EXPECT_FALSE(bmlupdater::ParseManifestJson(unmanaged, manifest).ok);
+
+    std::string patchIsManaged = json;
+    patchIsManaged.replace(patchIsManaged.find("_bmldelta/BuildingBlocks/BMLPlus.dll.bmlpatch"),
+                           std::string("_bmldelta/BuildingBlocks/BMLPlus.dll.bmlpatch").size(),
+                           "BuildingBlocks/BMLPlus.dll");
+    EXPECT_FALSE(bmlupdater::ParseManifestJson(patchIsManaged, manifest).ok);
+}
+
+TEST(UpdaterManifestTest, IndexLooksUpPathsIgnoringCase) {
+    bmlupdater::UpdaterManifest manifest;
+    manifest.managedFiles = {
+        {"BuildingBlocks/BMLPlus.dll", std::string(64, 'a'), 1},
+        {"ModLoader/Fonts/font.otf", std::string(64, 'b'), 2},
+    };
+    manifest.deltaFiles = {
+        {"BuildingBlocks/BMLPlus.dll", std::string(64, 'c'), "_bmldelta/BuildingBlocks/BMLPlus.dll.bmlpatch", std::string(64, 'd')},
+    };
+    manifest.preserve = {"ModLoader/Config", "ModLoader/Mods/Keep.bmodp"};
+
+    const bmlupdater::ManifestIndex index(manifest);
+    ASSERT_NE(index.FindManaged("buildingblocks/bmlplus.DLL"), nullptr);
+    EXPECT_EQ(index.FindManaged("buildingblocks/bmlplus.DLL")->sha256, std::string(64, 'a'));
+    EXPECT_EQ(index.FindManaged("ModLoader/Fonts"), nullptr);
+    EXPECT_NE(index.FindDelta("BUILDINGBLOCKS/BMLPlus.dll"), nullptr);
+    EXPECT_EQ(index.FindDelta("ModLoader/Fonts/font.otf"), nullptr);
+    EXPECT_NE(index.FindDeltaByPatch("_BMLDELTA/buildingblocks/bmlplus.dll.bmlpatch"), nullptr);
+    EXPECT_EQ(index.FindDeltaByPatch("BuildingBlocks/BMLPlus.dll"), nullptr);
+
+    // A preserve entry covers itself and everything below it, but not
+    // siblings that merely share its name as a prefix.
+    EXPECT_TRUE(index.IsPreserved("ModLoader/Config"));
+    EXPECT_TRUE(index.IsPreserved("modloader/config/BML.cfg"));
+    EXPECT_TRUE(index.IsPreserved("ModLoader/Mods/keep.bmodp"));
+    EXPECT_FALSE(index.IsPreserved("ModLoader/ConfigBackup/BML.cfg"));
+    EXPECT_FALSE(index.IsPreserved("ModLoader"));
+    EXPECT_FALSE(index.IsPreserved("ModLoader/Mods/Other.bmodp"));
+}
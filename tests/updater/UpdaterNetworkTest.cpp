@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <Windows.h>
+
+#include <string>
+
+#include "CryptoUtils.h"
+#include "UpdaterNetwork.h"
+#include "UpdaterPaths.h"
+
+namespace {
+    constexpr const wchar_t *kPackageUrl = L"https://updates.example.invalid/stable/package.zip";
+
+    std::wstring MakeTempRoot() {
+        wchar_t temp[MAX_PATH]{};
+        EXPECT_NE(GetTempPathW(MAX_PATH, temp), 0u);
+        const std::wstring root = bmlupdater::JoinPath(
+            temp,
+            L"bml-updater-network-test-" + std::to_wstring(GetCurrentProcessId()) + L"-" + std::to_wstring(GetTickCount64()));
+        EXPECT_TRUE(bmlupdater::CreateDirectories(root));
+        return root;
+    }
+
+    std::string Noise(size_t size, uint32_t seed) {
+        std::string bytes(size, '\0');
+        for (char &byte : bytes) {
+            seed = seed * 1664525u + 1013904223u;
+            byte = static_cast<char>(seed >> 24);
+        }
+        return bytes;
+    }
+
+    void WriteFile(const std::wstring &path, const std::string &content) {
+        ASSERT_TRUE(bmlupdater::CreateDirectories(bmlupdater::ParentPath(path)));
+        std::string error;
+        ASSERT_TRUE(bmlupdater::WriteBinaryFile(path, content.data(), content.size(), error)) << error;
+    }
+
+    std::string ReadFile(const std::wstring &path) {
+        const std::vector<char> bytes = bmlupdater::ReadBinaryFile(path);
+        return {bytes.begin(), bytes.end()};
+    }
+
+    struct Fixture {
+        std::wstring root = MakeTempRoot();
+        std::wstring served = bmlupdater::JoinPath(root, L"served");
+        std::wstring destination = bmlupdater::JoinPath(root, L"downloads\\package.zip");
+        std::string content = Noise(1024 * 1024 + 123, 7);
+        std::string sha256;
+
+        Fixture() {
+            const std::wstring source = bmlupdater::JoinPath(served, L"stable\\package.zip");
+            WriteFile(source, content);
+            sha256 = utils::Sha256FileHex(source);
+        }
+
+        ~Fixture() {
+            std::string error;
+            EXPECT_TRUE(bmlupdater::RemoveDirectoryTree(root, error)) << error;
+        }
+    };
+}
+
+TEST(UpdaterNetworkTest, FetchesTextThroughTheTransport) {
+    Fixture fixture;
+    WriteFile(bmlupdater::JoinPath(fixture.served, L"stable.json"), "{\"version\":\"v1\"}");
+
+    bmlupdater::LocalFileTransport transport(fixture.served);
+    std::string body;
+    bmlupdater::Result result = bmlupdater::FetchText(transport, L"https://updates.example.invalid/stable.json?x=1", body);
+    ASSERT_TRUE(result.ok) << result.message;
+    EXPECT_EQ(body, "{\"version\":\"v1\"}");
+
+    EXPECT_FALSE(bmlupdater::FetchText(transport, L"https://updates.example.invalid/missing.json", body).ok);
+    EXPECT_FALSE(bmlupdater::FetchText(transport, L"https://updates.example.invalid/../escape.json", body).ok);
+}
+
+TEST(UpdaterNetworkTest, ResumesInterruptedDownloads) {
+    Fixture fixture;
+    bmlupdater::LocalFileTransport transport(fixture.served);
+    transport.SetMaxBytesPerFetch(300 * 1024);
+
+    bmlupdater::DownloadResult download;
+    bmlupdater::Result result;
+    for (int attempt = 0; attempt < 10; ++attempt) {
+        result = bmlupdater::DownloadFile(transport, kPackageUrl, fixture.destination, fixture.sha256, download);
+        if (result.ok) {
+            break;
+        }
+        EXPECT_TRUE(bmlupdater::PathExists(bmlupdater::PartialDownloadPath(fixture.destination)));
+    }
+    ASSERT_TRUE(result.ok) << result.message;
+
+    // Each attempt continues where the last one stopped.
+    EXPECT_EQ(transport.FetchCount(), 4u);
+    EXPECT_EQ(download.resumedFrom, 3u * 300 * 1024);
+    EXPECT_EQ(download.size, fixture.content.size());
+    EXPECT_EQ(download.sha256, fixture.sha256);
+    EXPECT_EQ(ReadFile(fixture.destination), fixture.content);
+    EXPECT_FALSE(bmlupdater::PathExists(bmlupdater::PartialDownloadPath(fixture.destination)));
+}
+
+TEST(UpdaterNetworkTest, StartsOverWhenThePartialFileCannotBeResumed) {
+    Fixture fixture;
+    const std::wstring partial = bmlupdater::PartialDownloadPath(fixture.destination);
+    bmlupdater::LocalFileTransport transport(fixture.served);
+    bmlupdater::DownloadResult download;
+
+    // A server without Range support sends the whole file again.
+    WriteFile(partial, "stale bytes");
+    transport.SetIgnoreRanges(true);
+    bmlupdater::Result result = bmlupdater::DownloadFile(transport, kPackageUrl, fixture.destination, fixture.sha256, download);
+    ASSERT_TRUE(result.ok) << result.message;
+    EXPECT_EQ(download.resumedFrom, 0u);
+    EXPECT_EQ(ReadFile(fixture.destination), fixture.content);
+
+    // A partial file longer than the resource is discarded.
+    WriteFile(partial, fixture.content + "trailing");
+    transport.SetIgnoreRanges(false);
+    result = bmlupdater::DownloadFile(transport, kPackageUrl, fixture.destination, fixture.sha256, download);
+    ASSERT_TRUE(result.ok) << result.message;
+    EXPECT_EQ(download.sha256, fixture.sha256);
+    EXPECT_EQ(ReadFile(fixture.destination), fixture.content);
+
+    // A complete partial file only needs to be verified.
+    WriteFile(partial, fixture.content);
+    result = bmlupdater::DownloadFile(transport, kPackageUrl, fixture.destination, fixture.sha256, download);
+    ASSERT_TRUE(result.ok) << result.message;
+    EXPECT_EQ(download.resumedFrom, fixture.content.size());
+    EXPECT_EQ(ReadFile(fixture.destination), fixture.content);
+}
+
+TEST(UpdaterNetworkTest, DiscardsDownloadsWithTheWrongHash) {
+    Fixture fixture;
+    bmlupdater::LocalFileTransport transport(fixture.served);
+    bmlupdater::DownloadResult download;
+
+    const bmlupdater::Result result = bmlupdater::DownloadFile(
+        transport, kPackageUrl, fixture.destination, std::string(64, 'a'), download);
+    EXPECT_FALSE(result.ok);
+    EXPECT_NE(result.message.find("hash does not match"), std::string::npos) << result.message;
+    EXPECT_FALSE(bmlupdater::PathExists(fixture.destination));
+    EXPECT_FALSE(bmlupdater::PathExists(bmlupdater::PartialDownloadPath(fixture.destination)));
+}
+
+TEST(UpdaterNetworkTest, RestartsAResumedDownloadWithTheWrongHash) {
+    Fixture fixture;
+    const std::wstring partial = bmlupdater::PartialDownloadPath(fixture.destination);
+    bmlupdater::LocalFileTransport transport(fixture.served);
+    bmlupdater::DownloadResult download;
+
+    // The kept bytes are the right length but not the right content.
+    WriteFile(partial, Noise(4096, 99));
+    bmlupdater::Result result = bmlupdater::DownloadFile(transport, kPackageUrl, fixture.destination, fixture.sha256, download);
+    ASSERT_TRUE(result.ok) << result.message;
+    EXPECT_EQ(transport.FetchCount(), 2u);
+    EXPECT_EQ(download.resumedFrom, 0u);
+    EXPECT_EQ(download.sha256, fixture.sha256);
+    EXPECT_EQ(ReadFile(fixture.destination), fixture.content);
+
+    // A fresh download that mismatches is not retried.
+    std::string error;
+    ASSERT_TRUE(bmlupdater::RemoveFileIfPresent(fixture.destination, error)) << error;
+    result = bmlupdater::DownloadFile(transport, kPackageUrl, fixture.destination, std::string(64, 'a'), download);
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(transport.FetchCount(), 3u);
+    EXPECT_FALSE(bmlupdater::PathExists(partial));
+}
@@ -2,8 +2,12 @@
 
 #include <Windows.h>
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "CryptoUtils.h"
 #include "UpdaterPaths.h"
@@ -30,6 +34,37 @@ namespace {
         EXPECT_FALSE(digest.empty());
         return digest;
     }
+
+    std::wstring WidePath(const std::wstring &root, std::string relative) {
+        std::replace(relative.begin(), relative.end(), '/', '\\');
+        return bmlupdater::JoinPath(root, std::wstring(relative.begin(), relative.end()));
+    }
+
+    // Writes files under the staging root for version and returns the
+    // verification that VerifyLocalPackage would have produced for them.
+    bmlupdater::LocalPackageVerification StagePackage(const std::wstring &stateRoot,
+                                                      const std::string &version,
+                                                      const std::vector<std::pair<std::string, std::string>> &files) {
+        bmlupdater::LocalPackageVerification verification;
+        verification.manifest.version = version;
+        verification.manifest.packageFileName = "BMLPlus-Update-" + version + ".zip";
+        verification.manifest.packageSha256 = std::string(64, '0');
+        verification.stagingRoot = WidePath(bmlupdater::JoinPath(stateRoot, L"staging"), version);
+        for (const auto &[path, content] : files) {
+            const std::wstring stagedPath = WidePath(verification.stagingRoot, path);
+            WriteText(stagedPath, content);
+            const std::string sha256 = Sha256Hex(stagedPath);
+            verification.manifest.managedFiles.push_back({path, sha256, content.size()});
+            verification.stagedFiles.push_back({path, stagedPath, sha256, content.size()});
+        }
+        return verification;
+    }
+
+    size_t CountInstalls(const bmlupdater::ApplyPlan &plan) {
+        return static_cast<size_t>(std::count_if(plan.operations.begin(), plan.operations.end(), [](const auto &op) {
+            return op.kind == bmlupdater::OperationKind::InstallOrReplace;
+        }));
+    }
 }
 
 TEST(UpdaterServiceTest, RollbackRestoresUpdaterStateWrittenByApply) {
@@ -147,3 +182,81 @@ TEST(UpdaterServiceTest, RemoteSourceConfigurationRoundTripsThroughSourcesJson)
     ASSERT_TRUE(result.ok) << result.message;
     EXPECT_TRUE(baseUrl.empty());
 }
+
+TEST(UpdaterServiceTest, ApplyPlanSkipsFilesThatAlreadyMatchTheManifest) {
+    const std::wstring tempRoot = MakeTempRoot();
+    const auto cleanup = std::unique_ptr<void, void (*)(void *)>(
+        const_cast<std::wstring *>(&tempRoot),
+        [](void *path) {
+            std::string error;
+            (void)bmlupdater::RemoveDirectoryTree(*static_cast<std::wstring *>(path), error);
+        });
+
+    const std::wstring gameRoot = bmlupdater::JoinPath(tempRoot, L"game");
+    const std::wstring stateRoot = bmlupdater::JoinPath(bmlupdater::JoinPath(gameRoot, L"ModLoader"), L"Updater");
+    bmlupdater::UpdaterService service({gameRoot, stateRoot});
+
+    constexpr size_t kFiles = 300;
+    std::vector<std::pair<std::string, std::string>> files;
+    for (size_t i = 0; i < kFiles; ++i) {
+        files.emplace_back("ModLoader/Data/file" + std::to_string(i) + ".txt",
+                           std::string(4096, static_cast<char>('a' + i % 26)) + std::to_string(i));
+    }
+
+    bmlupdater::LocalPackageVerification first = StagePackage(stateRoot, "v1", files);
+    bmlupdater::ApplyPlan plan;
+    bmlupdater::Result result = service.BuildApplyPlan(first, plan);
+    ASSERT_TRUE(result.ok) << result.message;
+    EXPECT_EQ(CountInstalls(plan), kFiles);
+    result = service.Apply(first, plan, nullptr);
+    ASSERT_TRUE(result.ok) << result.message;
+    EXPECT_TRUE(bmlupdater::PathExists(bmlupdater::JoinPath(stateRoot, L"file-index.json")));
+
+    // A point release that changes three files only installs those three.
+    for (size_t i : {7u, 150u, 299u}) {
+        files[i].second += " v2";
+    }
+    bmlupdater::LocalPackageVerification second = StagePackage(stateRoot, "v2", files);
+    const auto start = std::chrono::steady_clock::now();
+    result = service.BuildApplyPlan(second, plan);
+    ASSERT_TRUE(result.ok) << result.message;
+    const auto planned = std::chrono::steady_clock::now();
+    EXPECT_EQ(CountInstalls(plan), 3u);
+    result = service.Apply(second, plan, nullptr);
+    ASSERT_TRUE(result.ok) << result.message;
+    const auto applied = std::chrono::steady_clock::now();
+    RecordProperty("files", static_cast<int>(kFiles));
+    RecordProperty("plan_ms", std::to_string(std::chrono::duration<double, std::milli>(planned - start).count()));
+    RecordProperty("apply_ms", std::to_string(std::chrono::duration<double, std::milli>(applied - planned).count()));
+
+    EXPECT_EQ(bmlupdater::ReadTextFile(WidePath(gameRoot, files[150].first)), files[150].second);
+    EXPECT_EQ(service.GetStatus().installedVersion, "v2");
+
+    // A file edited after it was installed no longer matches its cached hash.
+    WriteText(WidePath(gameRoot, files[20].first), "edited");
+    result = service.BuildApplyPlan(second, plan);
+    ASSERT_TRUE(result.ok) << result.message;
+    ASSERT_EQ(CountInstalls(plan), 1u);
+    EXPECT_EQ(plan.operations[0].relativePath, files[20].first);
+
+    // Doctor only reads: the hash of the edited file is not written back.
+    const std::wstring indexFile = bmlupdater::JoinPath(stateRoot, L"file-index.json");
+    const std::string indexBefore = bmlupdater::ReadTextFile(indexFile);
+    std::vector<std::string> diagnostics;
+    result = service.RunDoctor(diagnostics);
+    ASSERT_TRUE(result.ok) << result.message;
+    EXPECT_NE(std::find(diagnostics.begin(), diagnostics.end(), "installed file modified: " + files[20].first),
+              diagnostics.end());
+    EXPECT_EQ(bmlupdater::ReadTextFile(indexFile), indexBefore);
+
+    // Rolling back restores the three files and the index that described
+    // them; the edited file was not part of the last apply and stays edited.
+    result = service.Rollback(nullptr);
+    ASSERT_TRUE(result.ok) << result.message;
+    const std::string original = files[150].second.substr(0, files[150].second.size() - 3);
+    EXPECT_EQ(bmlupdater::ReadTextFile(WidePath(gameRoot, files[150].first)), original);
+    bmlupdater::LocalPackageVerification again = StagePackage(stateRoot, "v2", files);
+    result = service.BuildApplyPlan(again, plan);
+    ASSERT_TRUE(result.ok) << result.message;
+    EXPECT_EQ(CountInstalls(plan), 4u);
+}
@@ -0,0 +1,378 @@
+#include <gtest/gtest.h>
+
+#include <Windows.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <zip.h>
+
+#include "CryptoUtils.h"
+#include "UpdaterDelta.h"
+#include "UpdaterPaths.h"
+#include "UpdaterZip.h"
+
+namespace {
+    std::wstring MakeTempRoot() {
+        wchar_t temp[MAX_PATH]{};
+        EXPECT_NE(GetTempPathW(MAX_PATH, temp), 0u);
+        const std::wstring root = bmlupdater::JoinPath(
+            temp,
+            L"bml-updater-zip-test-" + std::to_wstring(GetCurrentProcessId()) + L"-" + std::to_wstring(GetTickCount64()));
+        EXPECT_TRUE(bmlupdater::CreateDirectories(root));
+        return root;
+    }
+
+    void RemoveTempRoot(const std::wstring &root) {
+        std::string error;
+        EXPECT_TRUE(bmlupdater::RemoveDirectoryTree(root, error)) << error;
+    }
+
+    // Fills a buffer with bytes that do not compress, so a package holds about
+    // as many bytes as it extracts to.
+    void FillNoise(std::vector<char> &buffer, uint64_t &state) {
+        for (char &byte : buffer) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            byte = static_cast<char>(state);
+        }
+    }
+
+    struct PackageFile {
+        std::string path;
+        uint64_t size{0};
+        std::string content;
+    };
+
+    // Writes the package with zip level 0 and returns the manifest entries for
+    // it. Files without content are filled with size bytes of noise, written
+    // and hashed one chunk at a time.
+    std::vector<bmlupdater::ManagedFile> WritePackage(const std::wstring &zipPath, const std::vector<PackageFile> &files) {
+        std::vector<bmlupdater::ManagedFile> managed;
+        FILE *file = nullptr;
+        EXPECT_EQ(_wfopen_s(&file, zipPath.c_str(), L"wb"), 0);
+        if (!file) {
+            return managed;
+        }
+        zip_t *zip = zip_cstream_open(file, 0, 'w');
+        EXPECT_NE(zip, nullptr);
+
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+        std::vector<char> chunk(1024 * 1024);
+        for (const PackageFile &entry : files) {
+            EXPECT_EQ(zip_entry_open(zip, entry.path.c_str()), 0);
+            utils::Sha256Hasher hasher;
+            uint64_t size = entry.content.size();
+            if (!entry.content.empty()) {
+                EXPECT_EQ(zip_entry_write(zip, entry.content.data(), entry.content.size()), 0);
+                EXPECT_TRUE(hasher.Update(entry.content.data(), entry.content.size()));
+            } else {
+                size = entry.size;
+                for (uint64_t remaining = entry.size; remaining > 0;) {
+                    const size_t length = static_cast<size_t>(std::min<uint64_t>(remaining, chunk.size()));
+                    chunk.resize(length);
+                    FillNoise(chunk, state);
+                    EXPECT_EQ(zip_entry_write(zip, chunk.data(), chunk.size()), 0);
+                    EXPECT_TRUE(hasher.Update(chunk.data(), chunk.size()));
+                    remaining -= length;
+                }
+                chunk.resize(1024 * 1024);
+            }
+            EXPECT_EQ(zip_entry_close(zip), 0);
+
+            uint8_t digest[32]{};
+            EXPECT_TRUE(hasher.Finish(digest));
+            managed.push_back({entry.path, bmlupdater::BytesToHex(digest, sizeof(digest)), size});
+        }
+
+        zip_cstream_close(zip);
+        std::fclose(file);
+        return managed;
+    }
+
+    bmlupdater::UpdaterManifest MakeManifest(std::vector<bmlupdater::ManagedFile> files) {
+        bmlupdater::UpdaterManifest manifest;
+        manifest.version = "v1.0.0";
+        manifest.packageFileName = "BMLPlus-Update-v1.0.0.zip";
+        manifest.managedFiles = std::move(files);
+        return manifest;
+    }
+
+    std::string HashHex(const std::string &content) {
+        uint8_t digest[32]{};
+        EXPECT_TRUE(utils::Sha256(reinterpret_cast<const uint8_t *>(content.data()), content.size(), digest));
+        return bmlupdater::BytesToHex(digest, sizeof(digest));
+    }
+
+    void WriteInstalledFile(const std::wstring &path, const std::string &content) {
+        ASSERT_TRUE(bmlupdater::CreateDirectories(bmlupdater::ParentPath(path)));
+        std::string error;
+        ASSERT_TRUE(bmlupdater::WriteBinaryFile(path, content.data(), content.size(), error)) << error;
+    }
+}
+
+TEST(UpdaterZipTest, StagesEntriesAndRecordsTheirHashes) {
+    const std::wstring root = MakeTempRoot();
+    const std::wstring zipPath = bmlupdater::JoinPath(root, L"package.zip");
+    const std::wstring staging = bmlupdater::JoinPath(root, L"staging");
+    const auto managed = WritePackage(zipPath, {
+        {"BuildingBlocks/BMLPlus.dll", 0, "dll bytes"},
+        {"ModLoader/Config/BML.cfg", 3 * 1024 * 1024 + 17, {}},
+    });
+    const bmlupdater::UpdaterManifest manifest = MakeManifest(managed);
+
+    std::vector<bmlupdater::StagedFile> staged;
+    std::vector<std::string> progress;
+    const bmlupdater::Result result = bmlupdater::ExtractUpdaterZipToStaging(
+        zipPath, manifest, staging, staged, [&](const std::string &line) { progress.push_back(line); });
+    ASSERT_TRUE(result.ok) << result.message;
+
+    ASSERT_EQ(staged.size(), 2u);
+    for (size_t i = 0; i < staged.size(); ++i) {
+        EXPECT_EQ(staged[i].relativePath, managed[i].path);
+        EXPECT_EQ(staged[i].sha256, managed[i].sha256);
+        EXPECT_EQ(staged[i].size, managed[i].size);
+        EXPECT_EQ(utils::Sha256FileHex(staged[i].stagedPath), managed[i].sha256);
+    }
+    EXPECT_EQ(bmlupdater::ReadTextFile(staged[0].stagedPath), "dll bytes");
+    EXPECT_EQ(progress.size(), 2u);
+
+    RemoveTempRoot(root);
+}
+
+TEST(UpdaterZipTest, RejectsEntriesThatDoNotMatchTheManifest) {
+    const std::wstring root = MakeTempRoot();
+    const std::wstring zipPath = bmlupdater::JoinPath(root, L"package.zip");
+    const std::wstring staging = bmlupdater::JoinPath(root, L"staging");
+    const auto managed = WritePackage(zipPath, {{"BuildingBlocks/BMLPlus.dll", 0, "dll bytes"}});
+
+    std::vector<bmlupdater::StagedFile> staged;
+    auto wrongHash = managed;
+    wrongHash[0].sha256 = std::string(64, 'a');
+    bmlupdater::Result result = bmlupdater::ExtractUpdaterZipToStaging(zipPath, MakeManifest(wrongHash), staging, staged);
+    EXPECT_FALSE(result.ok);
+    EXPECT_NE(result.message.find("hash does not match"), std::string::npos) << result.message;
+
+    // An entry larger than the manifest says stops extracting once it passes
+    // the recorded size.
+    auto tooSmall = managed;
+    tooSmall[0].size = 3;
+    result = bmlupdater::ExtractUpdaterZipToStaging(zipPath, MakeManifest(tooSmall), staging, staged);
+    EXPECT_FALSE(result.ok);
+    EXPECT_NE(result.message.find("size does not match"), std::string::npos) << result.message;
+
+    auto missing = managed;
+    missing.push_back({"BuildingBlocks/Other.dll", std::string(64, 'b'), 1});
+    result = bmlupdater::ExtractUpdaterZipToStaging(zipPath, MakeManifest(missing), staging, staged);
+    EXPECT_FALSE(result.ok);
+
+    RemoveTempRoot(root);
+}
+
+TEST(UpdaterZipTest, ParallelStagingMatchesSequentialStaging) {
+    const std::wstring root = MakeTempRoot();
+    const std::wstring zipPath = bmlupdater::JoinPath(root, L"package.zip");
+    std::vector<PackageFile> files;
+    for (int i = 0; i < 24; ++i) {
+        files.push_back({"BuildingBlocks/Plugin" + std::to_string(i) + ".dll", 64 * 1024 + static_cast<uint64_t>(i) * 4099, {}});
+    }
+    const auto managed = WritePackage(zipPath, files);
+    const bmlupdater::UpdaterManifest manifest = MakeManifest(managed);
+
+    std::vector<bmlupdater::StagedFile> sequential;
+    std::vector<std::string> sequentialProgress;
+    bmlupdater::Result result = bmlupdater::ExtractUpdaterZipToStaging(
+        zipPath, manifest, bmlupdater::JoinPath(root, L"sequential"), sequential,
+        [&](const std::string &line) { sequentialProgress.push_back(line); }, {1});
+    ASSERT_TRUE(result.ok) << result.message;
+
+    std::vector<bmlupdater::StagedFile> parallel;
+    std::vector<std::string> parallelProgress;
+    result = bmlupdater::ExtractUpdaterZipToStaging(
+        zipPath, manifest, bmlupdater::JoinPath(root, L"parallel"), parallel,
+        [&](const std::string &line) { parallelProgress.push_back(line); }, {4});
+    ASSERT_TRUE(result.ok) << result.message;
+
+    ASSERT_EQ(parallel.size(), sequential.size());
+    for (size_t i = 0; i < parallel.size(); ++i) {
+        EXPECT_EQ(parallel[i].relativePath, sequential[i].relativePath);
+        EXPECT_EQ(parallel[i].sha256, sequential[i].sha256);
+        EXPECT_EQ(parallel[i].size, sequential[i].size);
+        EXPECT_EQ(utils::Sha256FileHex(parallel[i].stagedPath), managed[i].sha256);
+    }
+    // Progress follows package order however the workers finish.
+    EXPECT_EQ(parallelProgress, sequentialProgress);
+
+    RemoveTempRoot(root);
+}
+
+TEST(UpdaterZipTest, ParallelStagingRemovesTheStagingRootOnMismatch) {
+    const std::wstring root = MakeTempRoot();
+    const std::wstring zipPath = bmlupdater::JoinPath(root, L"package.zip");
+    const std::wstring staging = bmlupdater::JoinPath(root, L"staging");
+    std::vector<PackageFile> files;
+    for (int i = 0; i < 16; ++i) {
+        files.push_back({"ModLoader/Data" + std::to_string(i) + ".bin", 256 * 1024, {}});
+    }
+    auto managed = WritePackage(zipPath, files);
+    managed[5].sha256 = std::string(64, 'c');
+
+    std::vector<bmlupdater::StagedFile> staged;
+    const bmlupdater::Result result =
+        bmlupdater::ExtractUpdaterZipToStaging(zipPath, MakeManifest(managed), staging, staged, {}, {4});
+    EXPECT_FALSE(result.ok);
+    EXPECT_NE(result.message.find("hash does not match"), std::string::npos) << result.message;
+    EXPECT_TRUE(staged.empty());
+    EXPECT_EQ(GetFileAttributesW(staging.c_str()), INVALID_FILE_ATTRIBUTES);
+
+    RemoveTempRoot(root);
+}
+
+TEST(UpdaterZipTest, StagesDeltaEntriesFromTheInstalledBase) {
+    const std::wstring root = MakeTempRoot();
+    const std::wstring gameRoot = bmlupdater::JoinPath(root, L"game");
+    const std::wstring staging = bmlupdater::JoinPath(root, L"staging");
+    const std::wstring installed = bmlupdater::JoinPath(gameRoot, L"BuildingBlocks\\BMLPlus.dll");
+
+    uint64_t state = 42;
+    std::vector<char> noise(128 * 1024);
+    FillNoise(noise, state);
+    const std::string base(noise.begin(), noise.end());
+    std::string target = base;
+    target.replace(4096, 7, "patched");
+    const std::vector<char> patchBytes = bmlupdater::CreateBinaryPatch(base, target);
+    const std::string patch(patchBytes.begin(), patchBytes.end());
+    const std::string patchPath = bmlupdater::DeltaPatchPath("BuildingBlocks/BMLPlus.dll");
+
+    const auto stage = [&](bool withFullCopy, std::string patchSha256, std::vector<bmlupdater::StagedFile> &staged,
+                           std::vector<std::string> &progress) {
+        const std::wstring zipPath = bmlupdater::JoinPath(root, withFullCopy ? L"full.zip" : L"delta.zip");
+        std::vector<PackageFile> files = {{"ModLoader/Fonts/font.otf", 0, "font"}, {patchPath, 0, patch}};
+        if (withFullCopy) {
+            files.push_back({"BuildingBlocks/BMLPlus.dll", 0, target});
+        }
+        std::vector<bmlupdater::ManagedFile> written = WritePackage(zipPath, files);
+        if (patchSha256.empty()) {
+            patchSha256 = written[1].sha256;
+        }
+
+        bmlupdater::UpdaterManifest manifest = MakeManifest({written[0], {"BuildingBlocks/BMLPlus.dll", HashHex(target), target.size()}});
+        manifest.deltaFiles.push_back({"BuildingBlocks/BMLPlus.dll", HashHex(base), patchPath, patchSha256});
+        progress.clear();
+        return bmlupdater::ExtractUpdaterZipToStaging(
+            zipPath, manifest, staging, staged, [&](const std::string &line) { progress.push_back(line); }, {1, gameRoot});
+    };
+
+    WriteInstalledFile(installed, base);
+    std::vector<bmlupdater::StagedFile> staged;
+    std::vector<std::string> progress;
+    bmlupdater::Result result = stage(false, {}, staged, progress);
+    ASSERT_TRUE(result.ok) << result.message;
+    ASSERT_EQ(staged.size(), 2u);
+    EXPECT_TRUE(staged[1].fromDelta);
+    EXPECT_EQ(staged[1].relativePath, "BuildingBlocks/BMLPlus.dll");
+    EXPECT_EQ(utils::Sha256FileHex(staged[1].stagedPath), HashHex(target));
+    EXPECT_EQ(progress, (std::vector<std::string>{"staged ModLoader/Fonts/font.otf", "patched BuildingBlocks/BMLPlus.dll"}));
+
+    result = stage(false, std::string(64, 'd'), staged, progress);
+    EXPECT_FALSE(result.ok);
+    EXPECT_NE(result.message.find("Delta patch hash does not match"), std::string::npos) << result.message;
+
+    // A bad patch falls back to the full copy when there is one.
+    result = stage(true, std::string(64, 'd'), staged, progress);
+    ASSERT_TRUE(result.ok) << result.message;
+    ASSERT_EQ(staged.size(), 2u);
+    EXPECT_FALSE(staged[1].fromDelta);
+    EXPECT_EQ(utils::Sha256FileHex(staged[1].stagedPath), HashHex(target));
+    EXPECT_EQ(progress, (std::vector<std::string>{"staged ModLoader/Fonts/font.otf", "staged BuildingBlocks/BMLPlus.dll"}));
+
+    // A locally modified file is not the patch base; the full copy is used
+    // when the package has one.
+    WriteInstalledFile(installed, "modified");
+    result = stage(false, {}, staged, progress);
+    EXPECT_FALSE(result.ok);
+    EXPECT_NE(result.message.find("no full copy"), std::string::npos) << result.message;
+    EXPECT_EQ(GetFileAttributesW(staging.c_str()), INVALID_FILE_ATTRIBUTES);
+
+    result = stage(true, {}, staged, progress);
+    ASSERT_TRUE(result.ok) << result.message;
+    ASSERT_EQ(staged.size(), 2u);
+    EXPECT_FALSE(staged[1].fromDelta);
+    EXPECT_EQ(utils::Sha256FileHex(staged[1].stagedPath), HashHex(target));
+
+    RemoveTempRoot(root);
+}
+
+TEST(UpdaterZipTest, ValidatesLargeManifestsWithoutRescanningThem) {
+    constexpr size_t kFileCount = 20000;
+    std::vector<bmlupdater::ManagedFile> managed;
+    std::vector<bmlupdater::ZipEntryInfo> entries;
+    managed.reserve(kFileCount);
+    entries.reserve(kFileCount);
+    for (size_t i = 0; i < kFileCount; ++i) {
+        const std::string path = "ModLoader/Data/" + std::to_string(i % 100) + "/File" + std::to_string(i) + ".bin";
+        managed.push_back({path, std::string(64, 'a'), i});
+        // Archive entries may differ from the manifest in case only.
+        std::string entryPath = path;
+        std::transform(entryPath.begin(), entryPath.end(), entryPath.begin(), [](unsigned char c) {
+            return static_cast<char>(std::toupper(c));
+        });
+        entries.push_back({std::move(entryPath), i, false});
+    }
+    const bmlupdater::UpdaterManifest manifest = MakeManifest(std::move(managed));
+
+    const auto start = std::chrono::steady_clock::now();
+    bmlupdater::Result result = bmlupdater::ValidateUpdaterZipEntries(entries, manifest);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_TRUE(result.ok) << result.message;
+    // A scan of the manifest per entry takes 400 million comparisons here.
+    EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), 1000);
+
+    entries.back().path = "ModLoader/Data/Unlisted.bin";
+    result = bmlupdater::ValidateUpdaterZipEntries(entries, manifest);
+    EXPECT_FALSE(result.ok);
+    EXPECT_NE(result.message.find("not listed in managedFiles"), std::string::npos) << result.message;
+}
+
+// Reports throughput for extracting a large package. It only runs when
+// BML_UPDATER_ZIP_BENCH_MB names the package size in MB.
+TEST(UpdaterZipTest, StreamsLargePackages) {
+    const char *value = std::getenv("BML_UPDATER_ZIP_BENCH_MB");
+    const uint64_t packageMegabytes = value ? std::strtoull(value, nullptr, 10) : 0;
+    if (packageMegabytes == 0) {
+        GTEST_SKIP() << "Set BML_UPDATER_ZIP_BENCH_MB to run";
+    }
+
+    const std::wstring root = MakeTempRoot();
+    const std::wstring zipPath = bmlupdater::JoinPath(root, L"package.zip");
+    const std::wstring staging = bmlupdater::JoinPath(root, L"staging");
+    const uint64_t fileSize = packageMegabytes * 1024 * 1024 / 4;
+    const auto managed = WritePackage(zipPath, {
+        {"BuildingBlocks/A.dll", fileSize, {}},
+        {"BuildingBlocks/B.dll", fileSize, {}},
+        {"ModLoader/C.bin", fileSize, {}},
+        {"ModLoader/D.bin", fileSize, {}},
+    });
+    const uint64_t packageBytes = bmlupdater::FileSize(zipPath);
+
+    std::vector<bmlupdater::StagedFile> staged;
+    const auto start = std::chrono::steady_clock::now();
+    const bmlupdater::Result result = bmlupdater::ExtractUpdaterZipToStaging(zipPath, MakeManifest(managed), staging, staged);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_TRUE(result.ok) << result.message;
+    ASSERT_EQ(staged.size(), 4u);
+
+    const double megabytes = static_cast<double>(fileSize * 4) / (1024.0 * 1024.0);
+    RecordProperty("extracted_mb", std::to_string(megabytes));
+    RecordProperty("package_mb", std::to_string(static_cast<double>(packageBytes) / (1024.0 * 1024.0)));
+    RecordProperty("seconds", std::to_string(seconds));
+    RecordProperty("mb_per_second", std::to_string(seconds > 0.0 ? megabytes / seconds : 0.0));
+
+    RemoveTempRoot(root);
+}
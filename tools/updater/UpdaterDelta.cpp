@@ -0,0 +1,251 @@
+#include "UpdaterDelta.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include "CryptoUtils.h"
+#include "UpdaterPaths.h"
+
+namespace bmlupdater {
+    namespace {
+        constexpr char kPatchMagic[8] = {'B', 'M', 'L', 'P', 'A', 'T', 'C', 'H'};
+        constexpr char kCopyOp = 'C';
+        constexpr char kDataOp = 'D';
+        // Matches shorter than a block are sent as literal data.
+        constexpr size_t kBlockSize = 32;
+        constexpr uint32_t kHashBase = 257;
+
+        void PutVarint(std::vector<char> &out, uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        bool GetVarint(std::string_view data, size_t &pos, uint64_t &value) {
+            value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (pos >= data.size()) {
+                    return false;
+                }
+                const auto byte = static_cast<uint8_t>(data[pos++]);
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void PutData(std::vector<char> &out, std::string_view data) {
+            if (data.empty()) {
+                return;
+            }
+            out.push_back(kDataOp);
+            PutVarint(out, data.size());
+            out.insert(out.end(), data.begin(), data.end());
+        }
+
+        void PutCopy(std::vector<char> &out, uint64_t offset, uint64_t length) {
+            out.push_back(kCopyOp);
+            PutVarint(out, offset);
+            PutVarint(out, length);
+        }
+
+        uint32_t HashBlock(const char *data) {
+            uint32_t hash = 0;
+            for (size_t i = 0; i < kBlockSize; ++i) {
+                hash = hash * kHashBase + static_cast<uint8_t>(data[i]);
+            }
+            return hash;
+        }
+
+        uint32_t BlockOutFactor() {
+            uint32_t factor = 1;
+            for (size_t i = 1; i < kBlockSize; ++i) {
+                factor *= kHashBase;
+            }
+            return factor;
+        }
+    } // namespace
+
+    std::string DeltaPatchPath(std::string_view managedPath) {
+        return std::string(kDeltaPatchDirectory) + "/" + std::string(managedPath) + std::string(kDeltaPatchSuffix);
+    }
+
+    std::vector<char> CreateBinaryPatch(std::string_view base, std::string_view target) {
+        std::vector<char> patch(std::begin(kPatchMagic), std::end(kPatchMagic));
+        PutVarint(patch, base.size());
+        PutVarint(patch, target.size());
+        if (base.size() < kBlockSize || target.size() < kBlockSize) {
+            PutData(patch, target);
+            return patch;
+        }
+
+        // Index the base at block boundaries, then slide a rolling hash over
+        // the target so matches are found at any offset.
+        std::unordered_map<uint32_t, size_t> blocks;
+        blocks.reserve(base.size() / kBlockSize);
+        for (size_t offset = 0; offset + kBlockSize <= base.size(); offset += kBlockSize) {
+            blocks.emplace(HashBlock(base.data() + offset), offset);
+        }
+
+        const uint32_t outFactor = BlockOutFactor();
+        size_t literalStart = 0;
+        size_t pos = 0;
+        uint32_t hash = HashBlock(target.data());
+        while (pos + kBlockSize <= target.size()) {
+            const auto it = blocks.find(hash);
+            if (it != blocks.end() && std::memcmp(base.data() + it->second, target.data() + pos, kBlockSize) == 0) {
+                size_t baseStart = it->second;
+                size_t targetStart = pos;
+                while (baseStart > 0 && targetStart > literalStart && base[baseStart - 1] == target[targetStart - 1]) {
+                    --baseStart;
+                    --targetStart;
+                }
+                size_t length = pos - targetStart + kBlockSize;
+                while (baseStart + length < base.size() && targetStart + length < target.size() &&
+                       base[baseStart + length] == target[targetStart + length]) {
+                    ++length;
+                }
+
+                PutData(patch, target.substr(literalStart, targetStart - literalStart));
+                PutCopy(patch, baseStart, length);
+                pos = targetStart + length;
+                literalStart = pos;
+                if (pos + kBlockSize <= target.size()) {
+                    hash = HashBlock(target.data() + pos);
+                }
+                continue;
+            }
+
+            if (pos + kBlockSize < target.size()) {
+                hash = (hash - static_cast<uint8_t>(target[pos]) * outFactor) * kHashBase +
+                       static_cast<uint8_t>(target[pos + kBlockSize]);
+            }
+            ++pos;
+        }
+
+        PutData(patch, target.substr(literalStart));
+        return patch;
+    }
+
+    Result ApplyBinaryPatch(std::string_view base, std::string_view patch, const PatchOutput &output) {
+        if (patch.size() < sizeof(kPatchMagic) || std::memcmp(patch.data(), kPatchMagic, sizeof(kPatchMagic)) != 0) {
+            return Result::Failure("Not a delta patch");
+        }
+        size_t pos = sizeof(kPatchMagic);
+        uint64_t baseSize = 0;
+        uint64_t targetSize = 0;
+        if (!GetVarint(patch, pos, baseSize) || !GetVarint(patch, pos, targetSize)) {
+            return Result::Failure("Truncated delta patch header");
+        }
+        if (baseSize != base.size()) {
+            return Result::Failure("Delta patch base size does not match");
+        }
+
+        uint64_t written = 0;
+        while (pos < patch.size()) {
+            const char op = patch[pos++];
+            uint64_t offset = 0;
+            uint64_t length = 0;
+            const char *data = nullptr;
+            if (op == kCopyOp) {
+                if (!GetVarint(patch, pos, offset) || !GetVarint(patch, pos, length) ||
+                    offset > base.size() || length > base.size() - offset) {
+                    return Result::Failure("Invalid delta patch copy");
+                }
+                data = base.data() + offset;
+            } else if (op == kDataOp) {
+                if (!GetVarint(patch, pos, length) || length > patch.size() - pos) {
+                    return Result::Failure("Invalid delta patch data");
+                }
+                data = patch.data() + pos;
+                pos += static_cast<size_t>(length);
+            } else {
+                return Result::Failure("Unknown delta patch operation");
+            }
+
+            if (length > targetSize - written) {
+                return Result::Failure("Delta patch output exceeds its declared size");
+            }
+            if (length != 0 && !output(data, static_cast<size_t>(length))) {
+                return Result::Failure("Unable to write delta patch output");
+            }
+            written += length;
+        }
+
+        if (written != targetSize) {
+            return Result::Failure("Delta patch output is shorter than its declared size");
+        }
+        return Result::Success();
+    }
+
+    Result BuildDeltaPackage(const std::wstring &packageStage,
+                             const std::wstring &previousStage,
+                             const DeltaPackageOptions &options,
+                             std::vector<ManagedFile> &managedFiles,
+                             std::vector<DeltaFile> &deltaFiles,
+                             ProgressCallback progress) {
+        managedFiles.clear();
+        deltaFiles.clear();
+
+        std::string error;
+        const std::wstring patchRoot = JoinPath(packageStage, std::wstring(kDeltaPatchDirectory.begin(), kDeltaPatchDirectory.end()));
+        if (!RemoveDirectoryTree(patchRoot, error)) {
+            return Result::Failure(error);
+        }
+
+        std::vector<std::string> files;
+        if (!ListFilesRecursive(packageStage, files)) {
+            return Result::Failure("Unable to list package stage: " + PathUtf8(packageStage));
+        }
+
+        for (const std::string &path : files) {
+            if (IsDisallowedUpdaterPackagePath(path)) {
+                return Result::Failure("Updater package contains forbidden managed path: " + path);
+            }
+            auto normalized = NormalizeArchivePath(path, error);
+            if (!normalized) {
+                return Result::Failure("Invalid package path '" + path + "': " + error);
+            }
+            const std::wstring targetPath = JoinPath(packageStage, normalized->wideRelative);
+            ManagedFile managed{normalized->normalized, utils::Sha256FileHex(targetPath), FileSize(targetPath)};
+            if (managed.sha256.empty()) {
+                return Result::Failure("Unable to hash " + PathUtf8(targetPath));
+            }
+
+            const std::wstring basePath = JoinPath(previousStage, normalized->wideRelative);
+            const std::string baseSha256 = RegularFileExists(basePath) ? utils::Sha256FileHex(basePath) : std::string();
+            if (!baseSha256.empty() && baseSha256 != managed.sha256) {
+                const std::vector<char> base = ReadBinaryFile(basePath);
+                const std::vector<char> target = ReadBinaryFile(targetPath);
+                const std::vector<char> patch = CreateBinaryPatch({base.data(), base.size()}, {target.data(), target.size()});
+                if (static_cast<double>(patch.size()) <= static_cast<double>(target.size()) * options.maxPatchRatio) {
+                    DeltaFile delta{managed.path, baseSha256, DeltaPatchPath(managed.path), {}};
+                    auto patchRelative = NormalizeArchivePath(delta.patchPath, error);
+                    if (!patchRelative) {
+                        return Result::Failure("Invalid patch path '" + delta.patchPath + "': " + error);
+                    }
+                    const std::wstring patchPath = JoinPath(packageStage, patchRelative->wideRelative);
+                    if (!CreateDirectories(ParentPath(patchPath)) ||
+                        !WriteBinaryFile(patchPath, patch.data(), patch.size(), error)) {
+                        return Result::Failure(error.empty() ? "Unable to write " + PathUtf8(patchPath) : error);
+                    }
+                    delta.patchSha256 = utils::Sha256FileHex(patchPath);
+                    if (!options.keepFullFiles && !RemoveFileIfPresent(targetPath, error)) {
+                        return Result::Failure(error);
+                    }
+                    if (progress) {
+                        progress("delta " + managed.path + " " + std::to_string(patch.size()) + "/" + std::to_string(target.size()) + " bytes");
+                    }
+                    deltaFiles.push_back(std::move(delta));
+                }
+            }
+            managedFiles.push_back(std::move(managed));
+        }
+        return Result::Success();
+    }
+} // namespace bmlupdater
@@ -0,0 +1,47 @@
+#ifndef BML_UPDATER_DELTA_H
+#define BML_UPDATER_DELTA_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "UpdaterTypes.h"
+
+namespace bmlupdater {
+    // Delta patches are stored in the package under this directory, named
+    // after the managed file they produce.
+    inline constexpr std::string_view kDeltaPatchDirectory = "_bmldelta";
+    inline constexpr std::string_view kDeltaPatchSuffix = ".bmlpatch";
+
+    using PatchOutput = std::function<bool(const char *data, size_t size)>;
+
+    struct DeltaPackageOptions {
+        // Leave the full copy of a patched file in the package so staging can
+        // fall back to it when the installed file is not the patch base.
+        bool keepFullFiles{true};
+        // A patch is only used when it is at most this share of the file.
+        double maxPatchRatio{0.5};
+    };
+
+    [[nodiscard]] std::string DeltaPatchPath(std::string_view managedPath);
+
+    // A patch is a header with the base and target sizes followed by
+    // operations that either copy a range of the base or insert literal bytes.
+    [[nodiscard]] std::vector<char> CreateBinaryPatch(std::string_view base, std::string_view target);
+    // Streams the patched content to output in order. Fails on a malformed
+    // patch or a base of the wrong size.
+    [[nodiscard]] Result ApplyBinaryPatch(std::string_view base, std::string_view patch, const PatchOutput &output);
+
+    // Lists the files of packageStage as managed files and, for each one that
+    // changed since previousStage, writes a patch next to it and records it in
+    // deltaFiles.
+    [[nodiscard]] Result BuildDeltaPackage(const std::wstring &packageStage,
+                                           const std::wstring &previousStage,
+                                           const DeltaPackageOptions &options,
+                                           std::vector<ManagedFile> &managedFiles,
+                                           std::vector<DeltaFile> &deltaFiles,
+                                           ProgressCallback progress = {});
+} // namespace bmlupdater
+
+#endif // BML_UPDATER_DELTA_H
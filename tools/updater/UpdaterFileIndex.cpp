@@ -0,0 +1,150 @@
+#include "UpdaterFileIndex.h"
+
+#include <Windows.h>
+
+#include "CryptoUtils.h"
+#include "JsonUtils.h"
+#include "UpdaterPaths.h"
+
+namespace bmlupdater {
+    namespace {
+        std::string IndexKey(std::string_view relativePath) {
+            return ToLowerAscii(std::string(relativePath));
+        }
+    } // namespace
+
+    bool QueryFileStamp(const std::wstring &path, FileStamp &stamp) {
+        WIN32_FILE_ATTRIBUTE_DATA data{};
+        if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data) ||
+            (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+            return false;
+        }
+        stamp.size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        stamp.lastWriteTime = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                              data.ftLastWriteTime.dwLowDateTime;
+        return true;
+    }
+
+    void InstalledFileIndex::Load(const std::wstring &path) {
+        m_Entries.clear();
+        m_Dirty = false;
+        m_HashedFiles = 0;
+        if (!PathExists(path)) {
+            return;
+        }
+
+        std::string error;
+        utils::JsonDocument doc = utils::JsonDocument::ParseFile(path, error);
+        if (!doc.IsValid() || !yyjson_is_obj(doc.Root()) ||
+            utils::JsonGetInt(doc.Root(), "schemaVersion", 0) != 1) {
+            return;
+        }
+        yyjson_val *files = yyjson_obj_get(doc.Root(), "files");
+        if (!files || !yyjson_is_arr(files)) {
+            return;
+        }
+
+        size_t idx = 0;
+        size_t max = 0;
+        yyjson_val *item = nullptr;
+        yyjson_arr_foreach(files, idx, max, item) {
+            if (!yyjson_is_obj(item)) {
+                continue;
+            }
+            const std::string relativePath = utils::JsonGetString(item, "path", "");
+            std::string sha256 = ToLowerAscii(utils::JsonGetString(item, "sha256", ""));
+            if (relativePath.empty() || sha256.size() != 64) {
+                continue;
+            }
+            Entry entry;
+            entry.stamp.size = static_cast<uint64_t>(utils::JsonGetInt(item, "size", 0));
+            entry.stamp.lastWriteTime = static_cast<uint64_t>(utils::JsonGetInt(item, "lastWriteTime", 0));
+            entry.sha256 = std::move(sha256);
+            m_Entries[IndexKey(relativePath)] = std::move(entry);
+        }
+    }
+
+    bool InstalledFileIndex::Save(const std::wstring &path, std::string &error) {
+        utils::MutableJsonDocument doc;
+        yyjson_mut_val *root = doc.CreateObject();
+        doc.SetRoot(root);
+        (void)doc.AddInt(root, "schemaVersion", 1);
+        yyjson_mut_val *files = doc.CreateArray();
+        for (const auto &[key, entry] : m_Entries) {
+            yyjson_mut_val *item = doc.CreateObject();
+            (void)doc.AddString(item, "path", key);
+            (void)doc.AddInt(item, "size", static_cast<int64_t>(entry.stamp.size));
+            (void)doc.AddInt(item, "lastWriteTime", static_cast<int64_t>(entry.stamp.lastWriteTime));
+            (void)doc.AddString(item, "sha256", entry.sha256);
+            (void)doc.AddValue(files, item);
+        }
+        (void)doc.AddValue(root, "files", files);
+
+        const std::string json = doc.Write(false, error);
+        if (json.empty() || !WriteTextFile(path, json, error)) {
+            if (error.empty()) {
+                error = "Unable to write installed file index";
+            }
+            return false;
+        }
+        m_Dirty = false;
+        return true;
+    }
+
+    std::string InstalledFileIndex::Hash(std::string_view relativePath, const std::wstring &absolutePath) {
+        const std::string key = IndexKey(relativePath);
+        FileStamp stamp;
+        if (!QueryFileStamp(absolutePath, stamp)) {
+            if (m_Entries.erase(key) != 0) {
+                m_Dirty = true;
+            }
+            return {};
+        }
+
+        auto it = m_Entries.find(key);
+        if (it != m_Entries.end() && it->second.stamp == stamp) {
+            return it->second.sha256;
+        }
+
+        ++m_HashedFiles;
+        std::string sha256 = utils::Sha256FileHex(absolutePath);
+        if (sha256.empty()) {
+            return {};
+        }
+        // The stamp is taken again so a write during hashing is not cached.
+        FileStamp after;
+        if (QueryFileStamp(absolutePath, after) && after == stamp) {
+            m_Entries[key] = {stamp, sha256};
+            m_Dirty = true;
+        }
+        return sha256;
+    }
+
+    void InstalledFileIndex::Record(std::string_view relativePath, const std::wstring &absolutePath, std::string sha256) {
+        FileStamp stamp;
+        if (!QueryFileStamp(absolutePath, stamp)) {
+            Forget(relativePath);
+            return;
+        }
+        m_Entries[IndexKey(relativePath)] = {stamp, ToLowerAscii(std::move(sha256))};
+        m_Dirty = true;
+    }
+
+    void InstalledFileIndex::Forget(std::string_view relativePath) {
+        if (m_Entries.erase(IndexKey(relativePath)) != 0) {
+            m_Dirty = true;
+        }
+    }
+
+    size_t InstalledFileIndex::Size() const noexcept {
+        return m_Entries.size();
+    }
+
+    bool InstalledFileIndex::Dirty() const noexcept {
+        return m_Dirty;
+    }
+
+    size_t InstalledFileIndex::HashedFileCount() const noexcept {
+        return m_HashedFiles;
+    }
+} // namespace bmlupdater
@@ -0,0 +1,53 @@
+#ifndef BML_UPDATER_FILE_INDEX_H
+#define BML_UPDATER_FILE_INDEX_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "UpdaterTypes.h"
+
+namespace bmlupdater {
+    struct FileStamp {
+        uint64_t size{0};
+        uint64_t lastWriteTime{0};
+
+        bool operator==(const FileStamp &other) const noexcept = default;
+    };
+
+    [[nodiscard]] bool QueryFileStamp(const std::wstring &path, FileStamp &stamp);
+
+    // SHA-256 of installed files keyed by their lowercase relative path. A
+    // cached hash is only trusted while the file keeps the size and last write
+    // time it had when the hash was taken; otherwise the file is hashed again.
+    class InstalledFileIndex {
+    public:
+        // A missing or unreadable index loads empty.
+        void Load(const std::wstring &path);
+        [[nodiscard]] bool Save(const std::wstring &path, std::string &error);
+
+        // Hash of the file at absolutePath, or an empty string when it cannot
+        // be read.
+        [[nodiscard]] std::string Hash(std::string_view relativePath, const std::wstring &absolutePath);
+        // Records that absolutePath now holds content with the given hash.
+        void Record(std::string_view relativePath, const std::wstring &absolutePath, std::string sha256);
+        void Forget(std::string_view relativePath);
+
+        [[nodiscard]] size_t Size() const noexcept;
+        [[nodiscard]] bool Dirty() const noexcept;
+        // Files read since the index was loaded because no cached hash applied.
+        [[nodiscard]] size_t HashedFileCount() const noexcept;
+
+    private:
+        struct Entry {
+            FileStamp stamp;
+            std::string sha256;
+        };
+
+        std::unordered_map<std::string, Entry> m_Entries;
+        bool m_Dirty{false};
+        size_t m_HashedFiles{0};
+    };
+} // namespace bmlupdater
+
+#endif // BML_UPDATER_FILE_INDEX_H
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <array>
+#include <unordered_set>
 
 #include "CryptoUtils.h"
 #include "JsonUtils.h"
@@ -156,11 +157,130 @@ namespace bmlupdater {
             return true;
         }
 
+        bool ParseDeltaFiles(yyjson_val *root, UpdaterManifest &manifest, std::string &error) {
+            yyjson_val *array = yyjson_obj_get(root, "deltaFiles");
+            if (!array) {
+                return true;
+            }
+            if (!yyjson_is_arr(array)) {
+                error = "Invalid deltaFiles array";
+                return false;
+            }
+
+            const ManifestIndex managed(manifest);
+            std::unordered_set<std::string> targets;
+            std::unordered_set<std::string> patches;
+
+            size_t idx = 0;
+            size_t max = 0;
+            yyjson_val *item = nullptr;
+            yyjson_arr_foreach(array, idx, max, item) {
+                if (!yyjson_is_obj(item)) {
+                    error = "deltaFiles entries must be objects";
+                    return false;
+                }
+                DeltaFile delta;
+                if (!ReadStringMember(item, "path", delta.path, error) ||
+                    !ValidateManagedPath(delta.path, error) ||
+                    !ReadHashMember(item, "baseSha256", delta.baseSha256, error) ||
+                    !ReadStringMember(item, "patch", delta.patchPath, error) ||
+                    !ValidateManagedPath(delta.patchPath, error) ||
+                    !ReadHashMember(item, "patchSha256", delta.patchSha256, error)) {
+                    return false;
+                }
+                const std::string path = ToLowerAscii(delta.path);
+                const std::string patch = ToLowerAscii(delta.patchPath);
+                if (!managed.FindManaged(path)) {
+                    error = "deltaFiles entry is not listed in managedFiles: " + delta.path;
+                    return false;
+                }
+                if (managed.FindManaged(patch)) {
+                    error = "deltaFiles patch must not be a managed file: " + delta.patchPath;
+                    return false;
+                }
+                if (!targets.insert(path).second || !patches.insert(patch).second) {
+                    error = "Duplicate deltaFiles entry: " + delta.path;
+                    return false;
+                }
+                manifest.deltaFiles.push_back(std::move(delta));
+            }
+            return true;
+        }
+
         void IgnoreJsonResult(bool value) {
             (void)value;
         }
     } // namespace
 
+    ManifestIndex::ManifestIndex(const UpdaterManifest &manifest) : m_Preserve(1) {
+        // The first entry for a path wins, as it did for a front-to-back scan.
+        m_Managed.reserve(manifest.managedFiles.size());
+        for (const ManagedFile &file : manifest.managedFiles) {
+            m_Managed.emplace(ToLowerAscii(file.path), &file);
+        }
+        for (const DeltaFile &delta : manifest.deltaFiles) {
+            m_DeltasByPath.emplace(ToLowerAscii(delta.path), &delta);
+            m_DeltasByPatch.emplace(ToLowerAscii(delta.patchPath), &delta);
+        }
+
+        for (const std::string &preserve : manifest.preserve) {
+            const std::string lower = ToLowerAscii(preserve);
+            size_t node = 0;
+            size_t start = 0;
+            while (start <= lower.size()) {
+                const size_t slash = std::min(lower.find('/', start), lower.size());
+                std::string segment = lower.substr(start, slash - start);
+                const auto child = m_Preserve[node].children.find(segment);
+                if (child != m_Preserve[node].children.end()) {
+                    node = child->second;
+                } else {
+                    m_Preserve[node].children.emplace(std::move(segment), m_Preserve.size());
+                    node = m_Preserve.size();
+                    m_Preserve.emplace_back();
+                }
+                start = slash + 1;
+            }
+            m_Preserve[node].preserved = true;
+        }
+    }
+
+    const ManagedFile *ManifestIndex::FindManaged(std::string_view path) const {
+        const auto it = m_Managed.find(ToLowerAscii(std::string(path)));
+        return it != m_Managed.end() ? it->second : nullptr;
+    }
+
+    const DeltaFile *ManifestIndex::FindDelta(std::string_view path) const {
+        const auto it = m_DeltasByPath.find(ToLowerAscii(std::string(path)));
+        return it != m_DeltasByPath.end() ? it->second : nullptr;
+    }
+
+    const DeltaFile *ManifestIndex::FindDeltaByPatch(std::string_view patchPath) const {
+        const auto it = m_DeltasByPatch.find(ToLowerAscii(std::string(patchPath)));
+        return it != m_DeltasByPatch.end() ? it->second : nullptr;
+    }
+
+    bool ManifestIndex::IsPreserved(std::string_view path) const {
+        if (m_Preserve.size() == 1) {
+            return false;
+        }
+        const std::string lower = ToLowerAscii(std::string(path));
+        size_t node = 0;
+        size_t start = 0;
+        while (start <= lower.size()) {
+            const size_t slash = std::min(lower.find('/', start), lower.size());
+            const auto child = m_Preserve[node].children.find(lower.substr(start, slash - start));
+            if (child == m_Preserve[node].children.end()) {
+                return false;
+            }
+            node = child->second;
+            if (m_Preserve[node].preserved) {
+                return true;
+            }
+            start = slash + 1;
+        }
+        return false;
+    }
+
     Result ParseManifestJson(std::string_view json, UpdaterManifest &manifest) {
         manifest = {};
         std::string error;
@@ -198,7 +318,8 @@ namespace bmlupdater {
 
         if (!ParseManagedFiles(root, manifest, error) ||
             !ParseStringArray(root, "preserve", manifest.preserve, error) ||
-            !ParseRemoveFiles(root, manifest, error)) {
+            !ParseRemoveFiles(root, manifest, error) ||
+            !ParseDeltaFiles(root, manifest, error)) {
             return Result::Failure(error);
         }
         return Result::Success();
@@ -285,6 +406,19 @@ namespace bmlupdater {
             IgnoreJsonResult(doc.AddValue(remove, item));
         }
         IgnoreJsonResult(doc.AddValue(root, "removeFiles", remove));
+
+        if (!manifest.deltaFiles.empty()) {
+            yyjson_mut_val *deltas = doc.CreateArray();
+            for (const DeltaFile &file : manifest.deltaFiles) {
+                yyjson_mut_val *item = doc.CreateObject();
+                IgnoreJsonResult(doc.AddString(item, "path", file.path));
+                IgnoreJsonResult(doc.AddString(item, "baseSha256", file.baseSha256));
+                IgnoreJsonResult(doc.AddString(item, "patch", file.patchPath));
+                IgnoreJsonResult(doc.AddString(item, "patchSha256", file.patchSha256));
+                IgnoreJsonResult(doc.AddValue(deltas, item));
+            }
+            IgnoreJsonResult(doc.AddValue(root, "deltaFiles", deltas));
+        }
         return doc.Write(true, error);
     }
 
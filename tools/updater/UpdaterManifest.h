@@ -2,10 +2,40 @@
 #define BML_UPDATER_MANIFEST_H
 
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include "UpdaterTypes.h"
 
 namespace bmlupdater {
+    // Case-insensitive lookups into a manifest, built once so validation and
+    // planning do not rescan its lists per path. Preserve entries are kept in
+    // a trie of path segments. The manifest must outlive the index.
+    class ManifestIndex {
+    public:
+        explicit ManifestIndex(const UpdaterManifest &manifest);
+
+        [[nodiscard]] const ManagedFile *FindManaged(std::string_view path) const;
+        // The delta that produces the managed file at path.
+        [[nodiscard]] const DeltaFile *FindDelta(std::string_view path) const;
+        // The delta whose patch is stored at patchPath in the package.
+        [[nodiscard]] const DeltaFile *FindDeltaByPatch(std::string_view patchPath) const;
+        // Whether path is a preserve entry or lies below one.
+        [[nodiscard]] bool IsPreserved(std::string_view path) const;
+
+    private:
+        struct PreserveNode {
+            std::unordered_map<std::string, size_t> children;
+            bool preserved{false};
+        };
+
+        std::unordered_map<std::string, const ManagedFile *> m_Managed;
+        std::unordered_map<std::string, const DeltaFile *> m_DeltasByPath;
+        std::unordered_map<std::string, const DeltaFile *> m_DeltasByPatch;
+        std::vector<PreserveNode> m_Preserve;
+    };
+
     [[nodiscard]] Result ParseManifestJson(std::string_view json, UpdaterManifest &manifest);
     [[nodiscard]] Result LoadManifestFile(const std::wstring &path, UpdaterManifest &manifest);
     [[nodiscard]] Result VerifyManifestSignature(const std::wstring &manifestPath,
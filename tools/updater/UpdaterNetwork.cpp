@@ -3,13 +3,19 @@
 #include <Windows.h>
 #include <winhttp.h>
 
+#include <algorithm>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include "CryptoUtils.h"
+#include "StringUtils.h"
 #include "UpdaterPaths.h"
 
 namespace bmlupdater {
     namespace {
+        constexpr size_t kTransferChunkSize = 64 * 1024;
+
         struct Handle {
             HINTERNET value{};
             ~Handle() {
@@ -20,14 +26,56 @@ namespace bmlupdater {
             operator HINTERNET() const { return value; }
         };
 
+        struct FileHandle {
+            HANDLE value{INVALID_HANDLE_VALUE};
+            ~FileHandle() { Close(); }
+            void Close() {
+                if (value != INVALID_HANDLE_VALUE) {
+                    CloseHandle(value);
+                    value = INVALID_HANDLE_VALUE;
+                }
+            }
+            operator HANDLE() const { return value; }
+        };
+
         Result LastErrorResult(const char *prefix) {
             return Result::Failure(std::string(prefix) + " (WinHTTP error " + std::to_string(GetLastError()) + ")");
         }
 
+        Result FileErrorResult(const char *prefix) {
+            return Result::Failure(std::string(prefix) + " (error " + std::to_string(GetLastError()) + ")");
+        }
+
+        bool QueryHeader(HINTERNET request, DWORD info, std::wstring &value) {
+            DWORD size = 0;
+            WinHttpQueryHeaders(request, info, WINHTTP_HEADER_NAME_BY_INDEX, WINHTTP_NO_OUTPUT_BUFFER, &size, WINHTTP_NO_HEADER_INDEX);
+            if (GetLastError() != ERROR_INSUFFICIENT_BUFFER || size == 0) {
+                return false;
+            }
+            value.assign(size / sizeof(wchar_t), L'\0');
+            if (!WinHttpQueryHeaders(request, info, WINHTTP_HEADER_NAME_BY_INDEX, value.data(), &size, WINHTTP_NO_HEADER_INDEX)) {
+                return false;
+            }
+            value.resize(size / sizeof(wchar_t));
+            return true;
+        }
+
+        // The total from a Content-Range value such as "bytes 100-199/200" or
+        // "bytes */200".
+        uint64_t ContentRangeTotal(const std::wstring &value) {
+            const size_t slash = value.rfind(L'/');
+            if (slash == std::wstring::npos || slash + 1 >= value.size() || value[slash + 1] == L'*') {
+                return 0;
+            }
+            return _wcstoui64(value.c_str() + slash + 1, nullptr, 10);
+        }
+
         Result OpenHttpsGetRequest(const std::wstring &url,
+                                   uint64_t offset,
                                    Handle &session,
                                    Handle &connect,
-                                   Handle &request) {
+                                   Handle &request,
+                                   TransferResponse &response) {
             URL_COMPONENTSW parts{};
             parts.dwStructSize = sizeof(parts);
             parts.dwSchemeLength = static_cast<DWORD>(-1);
@@ -61,7 +109,11 @@ namespace bmlupdater {
                 return LastErrorResult("Unable to open HTTP request");
             }
 
-            if (!WinHttpSendRequest(request, WINHTTP_NO_ADDITIONAL_HEADERS, 0, WINHTTP_NO_REQUEST_DATA, 0, 0, 0) ||
+            const std::wstring range = offset != 0 ? L"Range: bytes=" + std::to_wstring(offset) + L"-" : std::wstring();
+            if (!WinHttpSendRequest(request,
+                                    range.empty() ? WINHTTP_NO_ADDITIONAL_HEADERS : range.c_str(),
+                                    range.empty() ? 0 : static_cast<DWORD>(-1L),
+                                    WINHTTP_NO_REQUEST_DATA, 0, 0, 0) ||
                 !WinHttpReceiveResponse(request, nullptr)) {
                 return LastErrorResult("HTTP request failed");
             }
@@ -76,23 +128,77 @@ namespace bmlupdater {
                                      WINHTTP_NO_HEADER_INDEX)) {
                 return LastErrorResult("Unable to read HTTP status");
             }
-            if (status != 200) {
-                return Result::Failure("HTTP GET failed with status " + std::to_string(status));
+
+            std::wstring header;
+            if (status == 200) {
+                response.offset = 0;
+                if (QueryHeader(request, WINHTTP_QUERY_CONTENT_LENGTH, header)) {
+                    response.totalSize = _wcstoui64(header.c_str(), nullptr, 10);
+                }
+                return Result::Success();
+            }
+            if (status == 206 && offset != 0) {
+                response.offset = offset;
+                if (QueryHeader(request, WINHTTP_QUERY_CONTENT_RANGE, header)) {
+                    response.totalSize = ContentRangeTotal(header);
+                }
+                return Result::Success();
+            }
+            if (status == 416 && offset != 0) {
+                response.rangeRejected = true;
+                if (QueryHeader(request, WINHTTP_QUERY_CONTENT_RANGE, header)) {
+                    response.totalSize = ContentRangeTotal(header);
+                }
+                return Result::Success();
+            }
+            return Result::Failure("HTTP GET failed with status " + std::to_string(status));
+        }
+
+        // Restarts a partial download from its first byte.
+        bool TruncatePartial(HANDLE file, std::optional<utils::Sha256Hasher> &hasher) {
+            LARGE_INTEGER zero{};
+            if (!SetFilePointerEx(file, zero, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+                return false;
+            }
+            hasher.emplace();
+            return true;
+        }
+
+        // Feeds the bytes an earlier attempt left in the partial file to the
+        // hasher and leaves the file pointer at their end.
+        bool HashPartial(HANDLE file, utils::Sha256Hasher &hasher, uint64_t &size) {
+            size = 0;
+            std::vector<char> buffer(kTransferChunkSize);
+            for (;;) {
+                DWORD read = 0;
+                if (!ReadFile(file, buffer.data(), static_cast<DWORD>(buffer.size()), &read, nullptr)) {
+                    return false;
+                }
+                if (read == 0) {
+                    return true;
+                }
+                if (!hasher.Update(buffer.data(), read)) {
+                    return false;
+                }
+                size += read;
             }
-            return Result::Success();
         }
     } // namespace
 
-    Result HttpGetUtf8(const std::wstring &url, std::string &body) {
-        body.clear();
+    Result WinHttpTransport::Fetch(const std::wstring &url,
+                                   uint64_t offset,
+                                   TransferResponse &response,
+                                   const TransferSink &sink) {
+        response = {};
         Handle session;
         Handle connect;
         Handle request;
-        Result opened = OpenHttpsGetRequest(url, session, connect, request);
-        if (!opened.ok) {
+        Result opened = OpenHttpsGetRequest(url, offset, session, connect, request, response);
+        if (!opened.ok || response.rangeRejected) {
             return opened;
         }
 
+        std::vector<char> buffer(kTransferChunkSize);
         for (;;) {
             DWORD available = 0;
             if (!WinHttpQueryDataAvailable(request, &available)) {
@@ -101,76 +207,228 @@ namespace bmlupdater {
             if (available == 0) {
                 break;
             }
-            std::vector<char> buffer(available);
             DWORD read = 0;
-            if (!WinHttpReadData(request, buffer.data(), available, &read)) {
+            const DWORD toRead = std::min<DWORD>(available, static_cast<DWORD>(buffer.size()));
+            if (!WinHttpReadData(request, buffer.data(), toRead, &read)) {
                 return LastErrorResult("Unable to read response data");
             }
-            body.append(buffer.data(), read);
+            if (read != 0 && !sink(buffer.data(), read)) {
+                return Result::Failure("Transfer aborted");
+            }
         }
         return Result::Success();
     }
 
-    Result HttpDownloadFile(const std::wstring &url,
-                            const std::wstring &destination,
-                            ProgressCallback progress) {
+    LocalFileTransport::LocalFileTransport(std::wstring root) : m_Root(std::move(root)) {}
+
+    void LocalFileTransport::SetMaxBytesPerFetch(uint64_t bytes) noexcept {
+        m_MaxBytesPerFetch = bytes;
+    }
+
+    void LocalFileTransport::SetIgnoreRanges(bool ignore) noexcept {
+        m_IgnoreRanges = ignore;
+    }
+
+    size_t LocalFileTransport::FetchCount() const noexcept {
+        return m_FetchCount;
+    }
+
+    Result LocalFileTransport::Fetch(const std::wstring &url,
+                                     uint64_t offset,
+                                     TransferResponse &response,
+                                     const TransferSink &sink) {
+        response = {};
+        ++m_FetchCount;
+
+        std::wstring urlPath = url;
+        const size_t scheme = urlPath.find(L"://");
+        if (scheme != std::wstring::npos) {
+            const size_t slash = urlPath.find(L'/', scheme + 3);
+            urlPath = slash == std::wstring::npos ? std::wstring() : urlPath.substr(slash + 1);
+        }
+        urlPath = urlPath.substr(0, urlPath.find_first_of(L"?#"));
+        std::string error;
+        const auto relative = NormalizeArchivePath(utils::Utf16ToUtf8(urlPath), error);
+        if (!relative) {
+            return Result::Failure("Invalid local transport URL '" + utils::Utf16ToUtf8(url) + "': " + error);
+        }
+        const std::wstring path = JoinPath(m_Root, relative->wideRelative);
+
+        FileHandle file;
+        file.value = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return Result::Failure("Local transport file not found: " + PathUtf8(path));
+        }
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size)) {
+            return FileErrorResult("Unable to read local transport file size");
+        }
+        response.totalSize = static_cast<uint64_t>(size.QuadPart);
+        response.offset = m_IgnoreRanges ? 0 : offset;
+        if (response.offset > response.totalSize) {
+            response.offset = 0;
+            response.rangeRejected = true;
+            return Result::Success();
+        }
+
+        LARGE_INTEGER start{};
+        start.QuadPart = static_cast<LONGLONG>(response.offset);
+        if (!SetFilePointerEx(file, start, nullptr, FILE_BEGIN)) {
+            return FileErrorResult("Unable to seek local transport file");
+        }
+
+        uint64_t sent = 0;
+        std::vector<char> buffer(kTransferChunkSize);
+        for (;;) {
+            DWORD toRead = static_cast<DWORD>(buffer.size());
+            if (m_MaxBytesPerFetch != 0) {
+                if (sent >= m_MaxBytesPerFetch) {
+                    return response.offset + sent == response.totalSize
+                               ? Result::Success()
+                               : Result::Failure("Local transport connection dropped");
+                }
+                toRead = static_cast<DWORD>(std::min<uint64_t>(toRead, m_MaxBytesPerFetch - sent));
+            }
+            DWORD read = 0;
+            if (!ReadFile(file, buffer.data(), toRead, &read, nullptr)) {
+                return FileErrorResult("Unable to read local transport file");
+            }
+            if (read == 0) {
+                return Result::Success();
+            }
+            if (!sink(buffer.data(), read)) {
+                return Result::Failure("Transfer aborted");
+            }
+            sent += read;
+        }
+    }
+
+    Result FetchText(DownloadTransport &transport, const std::wstring &url, std::string &body) {
+        body.clear();
+        TransferResponse response;
+        return transport.Fetch(url, 0, response, [&body](const char *data, size_t size) {
+            body.append(data, size);
+            return true;
+        });
+    }
+
+    std::wstring PartialDownloadPath(const std::wstring &destination) {
+        return destination + L".partial";
+    }
+
+    Result DownloadFile(DownloadTransport &transport,
+                        const std::wstring &url,
+                        const std::wstring &destination,
+                        const std::string &expectedSha256,
+                        DownloadResult &result,
+                        ProgressCallback progress) {
+        result = {};
         if (!CreateDirectories(ParentPath(destination))) {
             return Result::Failure("Unable to create download directory: " + PathUtf8(ParentPath(destination)));
         }
 
-        Handle session;
-        Handle connect;
-        Handle request;
-        Result opened = OpenHttpsGetRequest(url, session, connect, request);
-        if (!opened.ok) {
-            return opened;
+        const std::wstring partialPath = PartialDownloadPath(destination);
+        FileHandle file;
+        file.value = CreateFileW(partialPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return FileErrorResult("Unable to open partial download file");
         }
 
-        const std::wstring tempPath = destination + L".tmp";
-        HANDLE file = CreateFileW(tempPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
-        if (file == INVALID_HANDLE_VALUE) {
-            return LastErrorResult("Unable to create download file");
+        // The digest has to cover the whole file, so bytes kept from an
+        // earlier attempt are hashed once before the transfer resumes.
+        std::optional<utils::Sha256Hasher> hasher;
+        hasher.emplace();
+        uint64_t written = 0;
+        if (!HashPartial(file, *hasher, written)) {
+            if (!TruncatePartial(file, hasher)) {
+                return FileErrorResult("Unable to reset partial download file");
+            }
+            written = 0;
+        }
+        result.resumedFrom = written;
+        if (written != 0 && progress) {
+            progress("resuming download at " + std::to_string(written) + " bytes");
         }
 
-        uint64_t total = 0;
-        for (;;) {
-            DWORD available = 0;
-            if (!WinHttpQueryDataAvailable(request, &available)) {
-                CloseHandle(file);
-                std::string ignored;
-                (void)RemoveFileIfPresent(tempPath, ignored);
-                return LastErrorResult("Unable to query response data");
+        TransferResponse response;
+        bool started = false;
+        // A source that ignores the range sends the file from its first byte.
+        const auto begin = [&]() {
+            started = true;
+            if (response.offset == written) {
+                return true;
             }
-            if (available == 0) {
-                break;
+            if (response.offset != 0 || !TruncatePartial(file, hasher)) {
+                return false;
             }
-            std::vector<char> buffer(available);
-            DWORD read = 0;
-            if (!WinHttpReadData(request, buffer.data(), available, &read)) {
-                CloseHandle(file);
-                std::string ignored;
-                (void)RemoveFileIfPresent(tempPath, ignored);
-                return LastErrorResult("Unable to read response data");
+            written = 0;
+            result.resumedFrom = 0;
+            return true;
+        };
+        const TransferSink sink = [&](const char *data, size_t size) {
+            if (!started && !begin()) {
+                return false;
             }
-            DWORD written = 0;
-            if (!WriteFile(file, buffer.data(), read, &written, nullptr) || written != read) {
-                CloseHandle(file);
-                std::string ignored;
-                (void)RemoveFileIfPresent(tempPath, ignored);
-                return LastErrorResult("Unable to write download file");
+            DWORD bytes = 0;
+            if (!WriteFile(file, data, static_cast<DWORD>(size), &bytes, nullptr) || bytes != size ||
+                !hasher->Update(data, size)) {
+                return false;
             }
-            total += read;
+            written += size;
             if (progress) {
-                progress("downloaded " + std::to_string(total) + " bytes");
+                progress("downloaded " + std::to_string(written) +
+                         (response.totalSize != 0 ? "/" + std::to_string(response.totalSize) : std::string()) + " bytes");
             }
+            return true;
+        };
+
+        Result fetched = transport.Fetch(url, written, response, sink);
+        if (fetched.ok && response.rangeRejected && response.totalSize != written) {
+            // The partial file is longer than the resource; start over.
+            if (!TruncatePartial(file, hasher)) {
+                return FileErrorResult("Unable to reset partial download file");
+            }
+            written = 0;
+            result.resumedFrom = 0;
+            started = false;
+            fetched = transport.Fetch(url, 0, response, sink);
+        }
+        if (!fetched.ok) {
+            return fetched;
+        }
+        if (!response.rangeRejected && !started && !begin()) {
+            return FileErrorResult("Unable to reset partial download file");
+        }
+        if (response.totalSize != 0 && written != response.totalSize) {
+            return Result::Failure("Download ended after " + std::to_string(written) + " of " +
+                                   std::to_string(response.totalSize) + " bytes");
         }
-        CloseHandle(file);
+
+        uint8_t digest[32]{};
+        if (!hasher->Finish(digest)) {
+            return Result::Failure("Unable to hash download");
+        }
+        file.Close();
+        result.sha256 = BytesToHex(digest, sizeof(digest));
+        result.size = written;
 
         std::string error;
+        if (!expectedSha256.empty() && result.sha256 != ToLowerAscii(expectedSha256)) {
+            const bool resumed = result.resumedFrom != 0;
+            if (!RemoveFileIfPresent(partialPath, error) || !resumed) {
+                return Result::Failure("Downloaded file hash does not match");
+            }
+            // The bytes kept from the earlier attempt may be the bad ones, so
+            // the whole file is fetched once more; with no partial file left
+            // this attempt cannot resume again.
+            if (progress) {
+                progress("hash mismatch after resuming; downloading again from the start");
+            }
+            return DownloadFile(transport, url, destination, expectedSha256, result, progress);
+        }
         (void)RemoveFileIfPresent(destination, error);
-        if (MoveFileW(tempPath.c_str(), destination.c_str()) == FALSE) {
-            (void)RemoveFileIfPresent(tempPath, error);
-            return LastErrorResult("Unable to finalize download file");
+        if (MoveFileW(partialPath.c_str(), destination.c_str()) == FALSE) {
+            return FileErrorResult("Unable to finalize download file");
         }
         return Result::Success("download complete");
     }
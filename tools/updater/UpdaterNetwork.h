@@ -1,15 +1,90 @@
 #ifndef BML_UPDATER_NETWORK_H
 #define BML_UPDATER_NETWORK_H
 
+#include <cstdint>
+#include <functional>
 #include <string>
 
 #include "UpdaterTypes.h"
 
 namespace bmlupdater {
-    [[nodiscard]] Result HttpGetUtf8(const std::wstring &url, std::string &body);
-    [[nodiscard]] Result HttpDownloadFile(const std::wstring &url,
-                                          const std::wstring &destination,
-                                          ProgressCallback progress = {});
+    using TransferSink = std::function<bool(const char *data, size_t size)>;
+
+    struct TransferResponse {
+        // Offset of the first byte passed to the sink. A source that ignores
+        // the requested range starts over at 0.
+        uint64_t offset{0};
+        // Size of the whole resource, or 0 when the source does not say.
+        uint64_t totalSize{0};
+        // The requested offset lies past the end of the resource.
+        bool rangeRejected{false};
+    };
+
+    // Where updater downloads come from. Remote sources go through WinHTTP;
+    // LocalFileTransport serves the same requests from a directory.
+    class DownloadTransport {
+    public:
+        virtual ~DownloadTransport() = default;
+
+        // Streams url to sink starting at offset. Returning false from the
+        // sink aborts the transfer.
+        [[nodiscard]] virtual Result Fetch(const std::wstring &url,
+                                           uint64_t offset,
+                                           TransferResponse &response,
+                                           const TransferSink &sink) = 0;
+    };
+
+    class WinHttpTransport final : public DownloadTransport {
+    public:
+        [[nodiscard]] Result Fetch(const std::wstring &url,
+                                   uint64_t offset,
+                                   TransferResponse &response,
+                                   const TransferSink &sink) override;
+    };
+
+    // Maps the path of a URL onto a file under root, ignoring its scheme and
+    // host. maxBytesPerFetch cuts each transfer short to stand in for a
+    // dropped connection, and ignoreRanges for a server without Range support.
+    class LocalFileTransport final : public DownloadTransport {
+    public:
+        explicit LocalFileTransport(std::wstring root);
+
+        void SetMaxBytesPerFetch(uint64_t bytes) noexcept;
+        void SetIgnoreRanges(bool ignore) noexcept;
+        [[nodiscard]] size_t FetchCount() const noexcept;
+
+        [[nodiscard]] Result Fetch(const std::wstring &url,
+                                   uint64_t offset,
+                                   TransferResponse &response,
+                                   const TransferSink &sink) override;
+
+    private:
+        std::wstring m_Root;
+        uint64_t m_MaxBytesPerFetch{0};
+        bool m_IgnoreRanges{false};
+        size_t m_FetchCount{0};
+    };
+
+    struct DownloadResult {
+        std::string sha256;
+        uint64_t size{0};
+        // Bytes kept from an earlier interrupted attempt.
+        uint64_t resumedFrom{0};
+    };
+
+    [[nodiscard]] Result FetchText(DownloadTransport &transport, const std::wstring &url, std::string &body);
+    // Downloads url into destination + ".partial", resuming from whatever an
+    // earlier attempt left there, and renames it to destination once
+    // complete. The SHA-256 is computed as the bytes arrive; when
+    // expectedSha256 is set a mismatch discards the partial file, and a
+    // resumed download that mismatches is retried once from the first byte.
+    [[nodiscard]] Result DownloadFile(DownloadTransport &transport,
+                                      const std::wstring &url,
+                                      const std::wstring &destination,
+                                      const std::string &expectedSha256,
+                                      DownloadResult &result,
+                                      ProgressCallback progress = {});
+    [[nodiscard]] std::wstring PartialDownloadPath(const std::wstring &destination);
 }
 
 #endif // BML_UPDATER_NETWORK_H
@@ -59,6 +59,29 @@ namespace bmlupdater {
             return TrimTrailingSlashes(NormalizeSlashes(out));
         }
 
+
+        bool ListFilesUnder(const std::wstring &directory, const std::string &prefix, std::vector<std::string> &files) {
+            WIN32_FIND_DATAW data{};
+            const std::wstring pattern = JoinPath(directory, L"*");
+            HANDLE find = FindFirstFileW(pattern.c_str(), &data);
+            if (find == INVALID_HANDLE_VALUE) {
+                return GetLastError() == ERROR_FILE_NOT_FOUND;
+            }
+            bool ok = true;
+            do {
+                if (wcscmp(data.cFileName, L".") == 0 || wcscmp(data.cFileName, L"..") == 0) {
+                    continue;
+                }
+                const std::string name = prefix + utils::Utf16ToUtf8(data.cFileName);
+                if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+                    ok = ListFilesUnder(JoinPath(directory, data.cFileName), name + "/", files);
+                } else {
+                    files.push_back(name);
+                }
+            } while (ok && FindNextFileW(find, &data));
+            FindClose(find);
+            return ok;
+        }
     } // namespace
 
     std::string ToLowerAscii(std::string value) {
@@ -264,6 +287,15 @@ namespace bmlupdater {
         return false;
     }
 
+    bool ListFilesRecursive(const std::wstring &root, std::vector<std::string> &files) {
+        files.clear();
+        if (!DirectoryExists(root) || !ListFilesUnder(root, {}, files)) {
+            return false;
+        }
+        std::sort(files.begin(), files.end());
+        return true;
+    }
+
     uint64_t FileSize(const std::wstring &path) {
         HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
         if (handle == INVALID_HANDLE_VALUE) {
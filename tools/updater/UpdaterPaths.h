@@ -27,6 +27,8 @@ namespace bmlupdater {
     [[nodiscard]] bool CreateDirectories(const std::wstring &path);
     [[nodiscard]] bool RemoveFileIfPresent(const std::wstring &path, std::string &error);
     [[nodiscard]] bool RemoveDirectoryTree(const std::wstring &path, std::string &error);
+    // Relative paths of all files below root, '/' separated and sorted.
+    [[nodiscard]] bool ListFilesRecursive(const std::wstring &root, std::vector<std::string> &files);
     [[nodiscard]] uint64_t FileSize(const std::wstring &path);
     [[nodiscard]] std::string ReadTextFile(const std::wstring &path);
     [[nodiscard]] std::vector<char> ReadBinaryFile(const std::wstring &path);
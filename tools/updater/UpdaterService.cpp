@@ -12,6 +12,7 @@
 #include "CryptoUtils.h"
 #include "JsonUtils.h"
 #include "StringUtils.h"
+#include "UpdaterFileIndex.h"
 #include "UpdaterManifest.h"
 #include "UpdaterNetwork.h"
 #include "UpdaterPaths.h"
@@ -28,27 +29,6 @@ namespace bmlupdater {
             return BytesToHex(digest.data(), digest.size());
         }
 
-        bool IsPreserved(const UpdaterManifest &manifest, std::string_view path) {
-            const std::string lower = ToLowerAscii(std::string(path));
-            for (const std::string &preserve : manifest.preserve) {
-                const std::string preserveLower = ToLowerAscii(preserve);
-                if (lower == preserveLower || PathMatchesPrefix(lower, preserveLower + "/")) {
-                    return true;
-                }
-            }
-            return false;
-        }
-
-        const ManagedFile *FindManaged(const UpdaterManifest &manifest, std::string_view path) {
-            const std::string lower = ToLowerAscii(std::string(path));
-            for (const ManagedFile &file : manifest.managedFiles) {
-                if (ToLowerAscii(file.path) == lower) {
-                    return &file;
-                }
-            }
-            return nullptr;
-        }
-
         std::wstring LatestTransactionWithRollback(const std::wstring &stateRoot) {
             const std::wstring txRoot = JoinPath(stateRoot, L"transactions");
             if (!DirectoryExists(txRoot)) {
@@ -79,6 +59,33 @@ namespace bmlupdater {
             return latest;
         }
 
+        // Removes every version directory in a channel's download root except
+        // keep; only the version being downloaded can still be resumed.
+        void RemoveOtherDownloads(const std::wstring &channelRoot, const std::wstring &keep) {
+            std::vector<std::wstring> others;
+            WIN32_FIND_DATAW data{};
+            const std::wstring pattern = JoinPath(channelRoot, L"*");
+            HANDLE find = FindFirstFileW(pattern.c_str(), &data);
+            if (find == INVALID_HANDLE_VALUE) {
+                return;
+            }
+            do {
+                if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0 ||
+                    wcscmp(data.cFileName, L".") == 0 ||
+                    wcscmp(data.cFileName, L"..") == 0 ||
+                    _wcsicmp(data.cFileName, keep.c_str()) == 0) {
+                    continue;
+                }
+                others.push_back(JoinPath(channelRoot, data.cFileName));
+            } while (FindNextFileW(find, &data));
+            FindClose(find);
+
+            for (const std::wstring &other : others) {
+                std::string error;
+                (void)RemoveDirectoryTree(other, error);
+            }
+        }
+
         bool CopyFileWithParents(const std::wstring &from,
                                  const std::wstring &to,
                                  std::string &error) {
@@ -325,7 +332,11 @@ namespace bmlupdater {
         }
     } // namespace
 
-    UpdaterService::UpdaterService(UpdaterContext context) : m_Context(std::move(context)) {
+    UpdaterService::UpdaterService(UpdaterContext context, std::shared_ptr<DownloadTransport> transport)
+        : m_Context(std::move(context)), m_Transport(std::move(transport)) {
+        if (!m_Transport) {
+            m_Transport = std::make_shared<WinHttpTransport>();
+        }
         if (m_Context.updaterStateRoot.empty()) {
             m_Context.updaterStateRoot = DefaultStateRoot(m_Context.gameRoot);
         }
@@ -371,7 +382,32 @@ namespace bmlupdater {
         if (!CreateDirectories(m_Context.updaterStateRoot)) {
             return Result::Failure("Unable to create updater state root");
         }
-        diagnostics.push_back(PathExists(InstalledManifestFile()) ? "installed manifest found" : "installed manifest missing");
+        const std::optional<UpdaterManifest> installed = LoadInstalledManifest();
+        diagnostics.push_back(installed ? "installed manifest found" : "installed manifest missing");
+        if (installed) {
+            // Cached hashes spare unchanged files a read; the index is not
+            // saved, so doctor leaves the state root as it found it.
+            InstalledFileIndex index;
+            index.Load(FileIndexFile());
+            size_t verified = 0;
+            for (const ManagedFile &file : installed->managedFiles) {
+                std::string error;
+                auto normalized = NormalizeArchivePath(file.path, error);
+                std::wstring target;
+                if (!normalized || !ResolveUnderRoot(m_Context.gameRoot, normalized->wideRelative, target, error)) {
+                    continue;
+                }
+                if (!RegularFileExists(target)) {
+                    diagnostics.push_back("installed file missing: " + file.path);
+                } else if (index.Hash(file.path, target) != ToLowerAscii(file.sha256)) {
+                    diagnostics.push_back("installed file modified: " + file.path);
+                } else {
+                    ++verified;
+                }
+            }
+            diagnostics.push_back("installed files verified=" + std::to_string(verified) + "/" +
+                                  std::to_string(installed->managedFiles.size()));
+        }
         diagnostics.push_back(PathExists(PendingFile()) ? "pending transaction hint found" : "no pending transaction hint");
         diagnostics.push_back(PathExists(SourcesFile()) ? "remote source configured" : "remote source not configured");
         return Result::Success("doctor passed");
@@ -477,12 +513,12 @@ namespace bmlupdater {
         diagnostics.push_back("fetching " + channelUrl);
 
         std::string channelJson;
-        Result fetched = HttpGetUtf8(utils::Utf8ToUtf16(channelUrl), channelJson);
+        Result fetched = FetchText(*m_Transport, utils::Utf8ToUtf16(channelUrl), channelJson);
         if (!fetched.ok) {
             return fetched;
         }
         std::string signatureText;
-        fetched = HttpGetUtf8(utils::Utf8ToUtf16(signatureUrl), signatureText);
+        fetched = FetchText(*m_Transport, utils::Utf8ToUtf16(signatureUrl), signatureText);
         if (!fetched.ok) {
             return fetched;
         }
@@ -538,12 +574,15 @@ namespace bmlupdater {
             return Result::Success("remote update skipped");
         }
 
-        const std::wstring downloadRoot = JoinPath(
-            JoinPath(JoinPath(m_Context.updaterStateRoot, L"downloads"), utils::Utf8ToUtf16(info.channel)),
-            utils::Utf8ToUtf16(info.latestVersion));
+        const std::wstring channelRoot =
+            JoinPath(JoinPath(m_Context.updaterStateRoot, L"downloads"), utils::Utf8ToUtf16(info.channel));
+        const std::wstring versionName = utils::Utf8ToUtf16(info.latestVersion);
+        const std::wstring downloadRoot = JoinPath(channelRoot, versionName);
+        // The root is kept between attempts so an interrupted package
+        // download resumes from its partial file.
         std::string error;
-        if (!RemoveDirectoryTree(downloadRoot, error) || !CreateDirectories(downloadRoot)) {
-            return Result::Failure(error.empty() ? "Unable to create remote download root: " + PathUtf8(downloadRoot) : error);
+        if (!CreateDirectories(downloadRoot)) {
+            return Result::Failure("Unable to create remote download root: " + PathUtf8(downloadRoot));
         }
 
         if (!WriteTextFile(JoinPath(downloadRoot, L"channel.json"), info.channelJson, error) ||
@@ -553,13 +592,13 @@ namespace bmlupdater {
 
         if (progress) progress("downloading manifest");
         std::string manifestJson;
-        Result fetched = HttpGetUtf8(utils::Utf8ToUtf16(info.manifestUrl), manifestJson);
+        Result fetched = FetchText(*m_Transport, utils::Utf8ToUtf16(info.manifestUrl), manifestJson);
         if (!fetched.ok) {
             return fetched;
         }
         if (progress) progress("downloading manifest signature");
         std::string manifestSignature;
-        fetched = HttpGetUtf8(utils::Utf8ToUtf16(info.manifestSignatureUrl), manifestSignature);
+        fetched = FetchText(*m_Transport, utils::Utf8ToUtf16(info.manifestSignatureUrl), manifestSignature);
         if (!fetched.ok) {
             return fetched;
         }
@@ -598,30 +637,34 @@ namespace bmlupdater {
         }
 
         if (progress) progress("downloading package");
-        Result downloaded = HttpDownloadFile(utils::Utf8ToUtf16(info.packageUrl), packagePath, progress);
+        DownloadResult download;
+        Result downloaded = DownloadFile(*m_Transport, utils::Utf8ToUtf16(info.packageUrl), packagePath,
+                                         manifest.packageSha256, download, progress);
         if (!downloaded.ok) {
             return downloaded;
         }
-        if (progress) progress("verifying package");
-        const std::string packageHash = HashFileHex(packagePath);
-        if (packageHash.empty()) {
-            return Result::Failure("Unable to hash remote package");
-        }
-        if (packageHash != ToLowerAscii(manifest.packageSha256)) {
-            return Result::Failure("Remote package hash does not match manifest");
-        }
+        // Partial packages of versions the channel has moved past are never resumed.
+        RemoveOtherDownloads(channelRoot, versionName);
+        const std::string &packageHash = download.sha256;
 
         const std::string sessionJson = RemoteSessionJson(info, manifestHash, packageHash);
         if (!sessionJson.empty()) {
             (void)WriteTextFile(JoinPath(downloadRoot, L"remote-session.json"), sessionJson, error);
         }
 
-        return VerifyLocalPackage(packagePath, verification, progress);
+        return VerifyPackage(packagePath, packageHash, verification, progress);
     }
 
     Result UpdaterService::VerifyLocalPackage(const std::wstring &packagePath,
                                               LocalPackageVerification &verification,
                                               ProgressCallback progress) const {
+        return VerifyPackage(packagePath, {}, verification, progress);
+    }
+
+    Result UpdaterService::VerifyPackage(const std::wstring &packagePath,
+                                         const std::string &knownPackageSha256,
+                                         LocalPackageVerification &verification,
+                                         ProgressCallback progress) const {
         verification = {};
         if (!PathExists(packagePath)) {
             return Result::Failure("Package does not exist: " + PathUtf8(packagePath));
@@ -649,8 +692,12 @@ namespace bmlupdater {
             return Result::Failure("Manifest package fileName does not match package path");
         }
 
-        if (progress) progress("hashing package");
-        const std::string packageHash = HashFileHex(packagePath);
+        // A package that was hashed while it downloaded is not read again.
+        std::string packageHash = knownPackageSha256;
+        if (packageHash.empty()) {
+            if (progress) progress("hashing package");
+            packageHash = HashFileHex(packagePath);
+        }
         if (packageHash.empty()) {
             return Result::Failure("Unable to hash package");
         }
@@ -660,7 +707,8 @@ namespace bmlupdater {
 
         verification.stagingRoot = JoinPath(JoinPath(m_Context.updaterStateRoot, L"staging"), utils::Utf8ToUtf16(verification.manifest.version));
         if (progress) progress("extracting package to staging");
-        Result extracted = ExtractUpdaterZipToStaging(packagePath, verification.manifest, verification.stagingRoot, verification.stagedFiles, progress);
+        Result extracted = ExtractUpdaterZipToStaging(packagePath, verification.manifest, verification.stagingRoot,
+                                                      verification.stagedFiles, progress, {0, m_Context.gameRoot});
         if (!extracted.ok) {
             return extracted;
         }
@@ -676,6 +724,10 @@ namespace bmlupdater {
             staged[ToLowerAscii(file.relativePath)] = file;
         }
 
+        InstalledFileIndex index;
+        index.Load(FileIndexFile());
+        size_t unchanged = 0;
+
         for (const ManagedFile &file : verification.manifest.managedFiles) {
             std::string error;
             auto normalized = NormalizeArchivePath(file.path, error);
@@ -690,6 +742,10 @@ namespace bmlupdater {
             if (stagedIt == staged.end()) {
                 return Result::Failure("Staged file missing for managed path: " + file.path);
             }
+            if (RegularFileExists(target) && index.Hash(file.path, target) == ToLowerAscii(file.sha256)) {
+                ++unchanged;
+                continue;
+            }
             plan.operations.push_back({
                 OperationKind::InstallOrReplace,
                 file.path,
@@ -700,17 +756,26 @@ namespace bmlupdater {
                 file.sha256});
         }
 
+        if (unchanged != 0) {
+            plan.diagnostics.push_back("Skipping " + std::to_string(unchanged) + " managed files already up to date");
+        }
+
         const std::optional<UpdaterManifest> previous = LoadInstalledManifest();
+        std::optional<ManifestIndex> previousIndex;
+        if (previous) {
+            previousIndex.emplace(*previous);
+        }
+        const ManifestIndex manifestIndex(verification.manifest);
         for (const RemoveFile &remove : verification.manifest.removeFiles) {
             if (!previous) {
                 plan.diagnostics.push_back("Skipping removeFiles without a previous trusted manifest: " + remove.path);
                 continue;
             }
-            if (IsPreserved(verification.manifest, remove.path)) {
+            if (manifestIndex.IsPreserved(remove.path)) {
                 plan.diagnostics.push_back("Skipping preserved removeFiles entry: " + remove.path);
                 continue;
             }
-            const ManagedFile *previousFile = FindManaged(*previous, remove.path);
+            const ManagedFile *previousFile = previousIndex->FindManaged(remove.path);
             if (!previousFile) {
                 plan.diagnostics.push_back("Skipping removeFiles entry not in previous trusted manifest: " + remove.path);
                 continue;
@@ -737,7 +802,7 @@ namespace bmlupdater {
                 plan.diagnostics.push_back("Skipping removeFiles non-regular file: " + remove.path);
                 continue;
             }
-            const std::string actualHash = HashFileHex(target);
+            const std::string actualHash = index.Hash(remove.path, target);
             if (actualHash != ToLowerAscii(expectedHash)) {
                 plan.diagnostics.push_back("Skipping removeFiles entry because hash changed: " + remove.path);
                 continue;
@@ -752,6 +817,10 @@ namespace bmlupdater {
                 {}});
         }
 
+        if (index.Dirty()) {
+            std::string error;
+            (void)index.Save(FileIndexFile(), error);
+        }
         return Result::Success("apply plan built");
     }
 
@@ -822,7 +891,8 @@ namespace bmlupdater {
         }
         if (progress) progress("backing up updater state");
         if (!AppendRollbackForPath(rollback, StateFile(), StateFile(), backupRoot, "state.json", error) ||
-            !AppendRollbackForPath(rollback, InstalledManifestFile(), InstalledManifestFile(), backupRoot, "installed.manifest.json", error)) {
+            !AppendRollbackForPath(rollback, InstalledManifestFile(), InstalledManifestFile(), backupRoot, "installed.manifest.json", error) ||
+            !AppendRollbackForPath(rollback, FileIndexFile(), FileIndexFile(), backupRoot, "file-index.json", error)) {
             rollbackNow();
             return Result::Failure(error);
         }
@@ -831,6 +901,10 @@ namespace bmlupdater {
             return Result::Failure(error);
         }
 
+        // Installed files come from verified staging, so their hashes are
+        // recorded without reading them back.
+        InstalledFileIndex index;
+        index.Load(FileIndexFile());
         for (const ApplyOperation &op : plan.operations) {
             if (op.kind == OperationKind::InstallOrReplace) {
                 if (progress) progress("installing " + op.relativePath);
@@ -838,12 +912,14 @@ namespace bmlupdater {
                     rollbackNow();
                     return Result::Failure(error);
                 }
+                index.Record(op.relativePath, op.targetPath, op.newSha256);
             } else {
                 if (progress) progress("removing " + op.relativePath);
                 if (!RemoveFileIfPresent(op.targetPath, error)) {
                     rollbackNow();
                     return Result::Failure(error);
                 }
+                index.Forget(op.relativePath);
             }
         }
 
@@ -857,6 +933,9 @@ namespace bmlupdater {
             rollbackNow();
             return Result::Failure(error);
         }
+        // The index is only a cache; an unsaved one is rebuilt by hashing.
+        std::string indexError;
+        (void)index.Save(FileIndexFile(), indexError);
         (void)RemoveFileIfPresent(PendingFile(), error);
         if (progress) progress("apply complete");
         return Result::Success("apply complete");
@@ -988,6 +1067,10 @@ namespace bmlupdater {
         return JoinPath(m_Context.updaterStateRoot, L"installed.manifest.json");
     }
 
+    std::wstring UpdaterService::FileIndexFile() const {
+        return JoinPath(m_Context.updaterStateRoot, L"file-index.json");
+    }
+
     std::wstring UpdaterService::PendingFile() const {
         return JoinPath(m_Context.updaterStateRoot, L"pending.json");
     }
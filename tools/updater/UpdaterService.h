@@ -1,12 +1,15 @@
 #ifndef BML_UPDATER_SERVICE_H
 #define BML_UPDATER_SERVICE_H
 
+#include <memory>
 #include <optional>
 #include <string>
 
 #include "UpdaterTypes.h"
 
 namespace bmlupdater {
+    class DownloadTransport;
+
     struct UpdaterSourceConfig {
         std::string baseUrl;
         std::string defaultChannel{"stable"};
@@ -14,7 +17,8 @@ namespace bmlupdater {
 
     class UpdaterService {
     public:
-        explicit UpdaterService(UpdaterContext context);
+        // Remote requests go through transport, or WinHTTP when it is null.
+        explicit UpdaterService(UpdaterContext context, std::shared_ptr<DownloadTransport> transport = {});
 
         [[nodiscard]] const UpdaterContext &Context() const noexcept;
         [[nodiscard]] StatusInfo GetStatus() const;
@@ -52,11 +56,17 @@ namespace bmlupdater {
     private:
         [[nodiscard]] std::wstring StateFile() const;
         [[nodiscard]] std::wstring InstalledManifestFile() const;
+        [[nodiscard]] std::wstring FileIndexFile() const;
         [[nodiscard]] std::wstring PendingFile() const;
         [[nodiscard]] std::wstring SourcesFile() const;
         [[nodiscard]] std::optional<UpdaterManifest> LoadInstalledManifest() const;
+        [[nodiscard]] Result VerifyPackage(const std::wstring &packagePath,
+                                           const std::string &knownPackageSha256,
+                                           LocalPackageVerification &verification,
+                                           ProgressCallback progress) const;
 
         UpdaterContext m_Context;
+        std::shared_ptr<DownloadTransport> m_Transport;
     };
 
     [[nodiscard]] UpdaterContext CreateDefaultContext();
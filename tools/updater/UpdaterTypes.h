@@ -36,6 +36,15 @@ namespace bmlupdater {
         std::string sha256;
     };
 
+    // A binary patch in the package that turns the installed file with
+    // baseSha256 into the managed file at path.
+    struct DeltaFile {
+        std::string path;
+        std::string baseSha256;
+        std::string patchPath;
+        std::string patchSha256;
+    };
+
     struct UpdaterManifest {
         int schemaVersion{1};
         std::string version;
@@ -44,6 +53,7 @@ namespace bmlupdater {
         std::vector<ManagedFile> managedFiles;
         std::vector<std::string> preserve;
         std::vector<RemoveFile> removeFiles;
+        std::vector<DeltaFile> deltaFiles;
     };
 
     struct StagedFile {
@@ -51,6 +61,7 @@ namespace bmlupdater {
         std::wstring stagedPath;
         std::string sha256;
         uint64_t size{0};
+        bool fromDelta{false};
     };
 
     enum class OperationKind {
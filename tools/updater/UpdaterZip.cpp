@@ -1,137 +1,491 @@
 #include "UpdaterZip.h"
 
+#include <Windows.h>
+
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
 #include <cstdlib>
-#include <memory>
+#include <mutex>
+#include <optional>
 #include <set>
+#include <system_error>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
 #include <zip.h>
 
 #include "CryptoUtils.h"
+#include "UpdaterDelta.h"
+#include "UpdaterManifest.h"
 #include "UpdaterPaths.h"
 
 namespace bmlupdater {
     namespace {
+        // The archive is read from the file as entries are extracted; only the
+        // central directory is held in memory.
         struct ZipHandle {
+            FILE *file{nullptr};
             zip_t *zip{nullptr};
             ~ZipHandle() {
                 if (zip) {
-                    zip_stream_close(zip);
+                    zip_cstream_close(zip);
+                }
+                if (file) {
+                    std::fclose(file);
                 }
             }
         };
 
-        Result OpenZipStream(const std::wstring &zipPath, std::vector<char> &bytes, ZipHandle &handle) {
-            bytes = ReadBinaryFile(zipPath);
-            if (bytes.empty()) {
+        Result OpenZipFile(const std::wstring &zipPath, ZipHandle &handle) {
+            if (_wfopen_s(&handle.file, zipPath.c_str(), L"rb") != 0 || !handle.file) {
+                handle.file = nullptr;
                 return Result::Failure("Unable to read zip package: " + PathUtf8(zipPath));
             }
             int err = 0;
-            handle.zip = zip_stream_openwitherror(bytes.data(), bytes.size(), 0, 'r', &err);
+            handle.zip = zip_cstream_openwitherror(handle.file, 0, 'r', &err);
             if (!handle.zip) {
                 return Result::Failure(std::string("Unable to open zip package: ") + zip_strerror(err));
             }
             return Result::Success();
         }
 
-        std::unordered_set<std::string> ManagedFileSet(const UpdaterManifest &manifest) {
-            std::unordered_set<std::string> set;
-            for (const ManagedFile &file : manifest.managedFiles) {
-                set.insert(ToLowerAscii(file.path));
+        Result ListZipEntries(zip_t *zip, std::vector<ZipEntryInfo> &entries) {
+            entries.clear();
+            const ssize_t total = zip_entries_total(zip);
+            if (total <= 0) {
+                return Result::Failure("Zip package contains no entries");
+            }
+
+            entries.reserve(static_cast<size_t>(total));
+            std::unordered_set<std::string> seen;
+            for (ssize_t i = 0; i < total; ++i) {
+                if (zip_entry_openbyindex(zip, static_cast<size_t>(i)) < 0) {
+                    return Result::Failure("Unable to read zip entry");
+                }
+                const char *name = zip_entry_name(zip);
+                const bool isDirectory = zip_entry_isdir(zip) == 1;
+                const uint64_t size = zip_entry_uncomp_size(zip);
+                std::string error;
+                auto normalized = NormalizeArchivePath(name ? name : "", error);
+                zip_entry_close(zip);
+                if (!normalized) {
+                    return Result::Failure("Invalid zip entry path: " + error);
+                }
+                const std::string lower = ToLowerAscii(normalized->normalized);
+                if (!seen.insert(lower).second) {
+                    return Result::Failure("Duplicate zip entry after normalization: " + normalized->normalized);
+                }
+                entries.push_back({normalized->normalized, size, isDirectory});
             }
-            return set;
+            return Result::Success();
         }
 
-        const ManagedFile *FindManagedFile(const UpdaterManifest &manifest, std::string_view path) {
-            const std::string lower = ToLowerAscii(std::string(path));
-            for (const ManagedFile &file : manifest.managedFiles) {
-                if (ToLowerAscii(file.path) == lower) {
-                    return &file;
+        // Receives an entry's inflated bytes in bounded chunks, writing them to
+        // the staged file and hashing them on the way.
+        struct StagedFileSink {
+            HANDLE file{INVALID_HANDLE_VALUE};
+            utils::Sha256Hasher hasher;
+            uint64_t written{0};
+            uint64_t limit{0};
+            const std::atomic<bool> *cancel{nullptr};
+            bool writeFailed{false};
+            bool tooLarge{false};
+            bool cancelled{false};
+
+            ~StagedFileSink() {
+                if (file != INVALID_HANDLE_VALUE) {
+                    CloseHandle(file);
+                }
+            }
+
+            static size_t OnExtract(void *arg, uint64_t, const void *data, size_t size) {
+                auto *sink = static_cast<StagedFileSink *>(arg);
+                if (sink->cancel && sink->cancel->load(std::memory_order_relaxed)) {
+                    sink->cancelled = true;
+                    return 0;
+                }
+                if (sink->limit != 0 && sink->written + size > sink->limit) {
+                    sink->tooLarge = true;
+                    return 0;
                 }
+                DWORD chunkWritten = 0;
+                if (!WriteFile(sink->file, data, static_cast<DWORD>(size), &chunkWritten, nullptr) ||
+                    chunkWritten != size || !sink->hasher.Update(data, size)) {
+                    sink->writeFailed = true;
+                    return 0;
+                }
+                sink->written += size;
+                return size;
             }
-            return nullptr;
+        };
+
+        constexpr size_t kNoEntry = static_cast<size_t>(-1);
+
+        // One managed file to stage, either inflated from its full copy or,
+        // when the installed file is the delta base, patched from it.
+        struct StagingTask {
+            const ManagedFile *manifestFile{nullptr};
+            size_t entryIndex{kNoEntry};
+            const DeltaFile *delta{nullptr};
+            size_t patchIndex{kNoEntry};
+            std::wstring basePath;
+            std::wstring outPath;
+        };
+
+        Result OpenStagedFile(const StagingTask &task, const std::atomic<bool> *cancel, StagedFileSink &sink) {
+            sink.limit = task.manifestFile->size;
+            sink.cancel = cancel;
+            sink.file = CreateFileW(task.outPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (sink.file == INVALID_HANDLE_VALUE) {
+                return Result::Failure("Unable to open file for writing: " + PathUtf8(task.outPath));
+            }
+            return Result::Success();
         }
-    } // namespace
 
-    Result EnumerateZipEntries(const std::wstring &zipPath, std::vector<ZipEntryInfo> &entries) {
-        entries.clear();
-        std::vector<char> bytes;
-        ZipHandle handle;
-        Result opened = OpenZipStream(zipPath, bytes, handle);
-        if (!opened.ok) {
-            return opened;
+        // Checks the bytes written through sink against the manifest.
+        Result FinishStagedFile(StagedFileSink &sink, const StagingTask &task, StagedFile &staged) {
+            const std::string &path = task.manifestFile->path;
+            if (sink.cancelled) {
+                return Result::Failure("Staging cancelled: " + path);
+            }
+            if (sink.tooLarge) {
+                return Result::Failure("Staged file size does not match manifest: " + path);
+            }
+            if (sink.writeFailed) {
+                return Result::Failure("Unable to write file: " + PathUtf8(task.outPath));
+            }
+
+            std::array<uint8_t, 32> digest{};
+            if (!sink.hasher.Finish(digest.data())) {
+                return Result::Failure("Unable to hash staged file: " + path);
+            }
+            const std::string hash = BytesToHex(digest.data(), digest.size());
+            if (hash != ToLowerAscii(task.manifestFile->sha256)) {
+                return Result::Failure("Staged file hash does not match manifest: " + path);
+            }
+            if (task.manifestFile->size != 0 && sink.written != task.manifestFile->size) {
+                return Result::Failure("Staged file size does not match manifest: " + path);
+            }
+
+            staged = {path, task.outPath, hash, sink.written};
+            return Result::Success();
         }
 
-        const ssize_t total = zip_entries_total(handle.zip);
-        if (total <= 0) {
-            return Result::Failure("Zip package contains no entries");
+        // Inflates the full copy of a file into its staged file.
+        Result StageEntry(zip_t *zip, const StagingTask &task, const std::atomic<bool> *cancel, StagedFile &staged) {
+            StagedFileSink sink;
+            Result opened = OpenStagedFile(task, cancel, sink);
+            if (!opened.ok) {
+                return opened;
+            }
+
+            if (zip_entry_openbyindex(zip, task.entryIndex) < 0) {
+                return Result::Failure("Unable to read zip entry");
+            }
+            const int extracted = zip_entry_extract(zip, &StagedFileSink::OnExtract, &sink);
+            zip_entry_close(zip);
+            if (extracted < 0 && !sink.cancelled && !sink.tooLarge && !sink.writeFailed) {
+                return Result::Failure("Unable to extract zip entry: " + task.manifestFile->path);
+            }
+            return FinishStagedFile(sink, task, staged);
         }
 
-        std::unordered_set<std::string> seen;
-        for (ssize_t i = 0; i < total; ++i) {
-            if (zip_entry_openbyindex(handle.zip, static_cast<size_t>(i)) < 0) {
+        // Applies the file's patch to the installed base and writes the result
+        // into its staged file. rejected is set when the patch itself is at
+        // fault: it fails its hash, does not apply, or yields the wrong file.
+        Result StageDelta(zip_t *zip,
+                          const StagingTask &task,
+                          const std::vector<char> &base,
+                          const std::atomic<bool> *cancel,
+                          StagedFile &staged,
+                          bool &rejected) {
+            const DeltaFile &delta = *task.delta;
+            rejected = false;
+            if (zip_entry_openbyindex(zip, task.patchIndex) < 0) {
                 return Result::Failure("Unable to read zip entry");
             }
-            const char *name = zip_entry_name(handle.zip);
-            const bool isDirectory = zip_entry_isdir(handle.zip) == 1;
-            const uint64_t size = zip_entry_uncomp_size(handle.zip);
-            std::string error;
-            auto normalized = NormalizeArchivePath(name ? name : "", error);
-            zip_entry_close(handle.zip);
-            if (!normalized) {
-                return Result::Failure("Invalid zip entry path: " + error);
+            void *buffer = nullptr;
+            size_t bufferSize = 0;
+            const ssize_t read = zip_entry_read(zip, &buffer, &bufferSize);
+            zip_entry_close(zip);
+            const std::string patch(static_cast<const char *>(buffer), read < 0 ? 0 : bufferSize);
+            std::free(buffer);
+            if (read < 0) {
+                return Result::Failure("Unable to extract delta patch: " + delta.patchPath);
             }
-            const std::string lower = ToLowerAscii(normalized->normalized);
-            if (!seen.insert(lower).second) {
-                return Result::Failure("Duplicate zip entry after normalization: " + normalized->normalized);
+
+            std::array<uint8_t, 32> digest{};
+            if (!utils::Sha256(reinterpret_cast<const uint8_t *>(patch.data()), patch.size(), digest.data()) ||
+                BytesToHex(digest.data(), digest.size()) != ToLowerAscii(delta.patchSha256)) {
+                rejected = true;
+                return Result::Failure("Delta patch hash does not match manifest: " + delta.patchPath);
+            }
+
+            StagedFileSink sink;
+            Result opened = OpenStagedFile(task, cancel, sink);
+            if (!opened.ok) {
+                return opened;
+            }
+            Result patched = ApplyBinaryPatch({base.data(), base.size()}, patch, [&sink](const char *data, size_t size) {
+                return StagedFileSink::OnExtract(&sink, 0, data, size) == size;
+            });
+            if (!patched.ok && !sink.cancelled && !sink.tooLarge && !sink.writeFailed) {
+                rejected = true;
+                return Result::Failure(patched.message + ": " + delta.patchPath);
             }
-            entries.push_back({normalized->normalized, size, isDirectory});
+
+            Result finished = FinishStagedFile(sink, task, staged);
+            rejected = !finished.ok && !sink.cancelled && !sink.writeFailed;
+            staged.fromDelta = true;
+            return finished;
         }
-        return Result::Success();
-    }
 
-    Result ValidateUpdaterZipEntries(const std::vector<ZipEntryInfo> &entries,
-                                     const UpdaterManifest &manifest) {
-        const std::unordered_set<std::string> managed = ManagedFileSet(manifest);
-        std::unordered_set<std::string> packageFiles;
+        // Reads the installed file the delta was made against into base, and
+        // hashes it from there so the file is read only once.
+        bool ReadDeltaBase(const StagingTask &task, std::vector<char> &base) {
+            if (task.basePath.empty() || !RegularFileExists(task.basePath)) {
+                return false;
+            }
+            base = ReadBinaryFile(task.basePath);
+            std::array<uint8_t, 32> digest{};
+            return utils::Sha256(reinterpret_cast<const uint8_t *>(base.data()), base.size(), digest.data()) &&
+                   BytesToHex(digest.data(), digest.size()) == ToLowerAscii(task.delta->baseSha256);
+        }
 
-        for (const ZipEntryInfo &entry : entries) {
-            if (entry.directory) {
-                continue;
+        // Stages one file, patching it when its delta applies to the installed
+        // file and falling back to the full copy otherwise, including when the
+        // patch turns out to be bad.
+        Result StageTask(zip_t *zip, const StagingTask &task, const std::atomic<bool> *cancel, StagedFile &staged) {
+            if (task.delta) {
+                std::vector<char> base;
+                if (ReadDeltaBase(task, base)) {
+                    bool rejected = false;
+                    Result patched = StageDelta(zip, task, base, cancel, staged, rejected);
+                    if (patched.ok || !rejected || task.entryIndex == kNoEntry) {
+                        return patched;
+                    }
+                    staged = {};
+                }
+            }
+            if (task.entryIndex == kNoEntry) {
+                return Result::Failure("Installed file does not match the delta base and the package has no full copy: " +
+                                       task.manifestFile->path);
+            }
+            return StageEntry(zip, task, cancel, staged);
+        }
+
+        std::string StagedProgressLine(const StagedFile &file) {
+            return (file.fromDelta ? "patched " : "staged ") + file.relativePath;
+        }
+
+        // Removes the staging root unless the stage is handed back complete, so
+        // nothing half-staged is left behind for a later apply to pick up.
+        struct StagingRootCleanup {
+            const std::wstring &root;
+            bool keep{false};
+
+            ~StagingRootCleanup() {
+                if (!keep) {
+                    std::string error;
+                    (void) RemoveDirectoryTree(root, error);
+                }
+            }
+        };
+
+        // Cancels and joins the workers started so far on any way out, so an
+        // early return or exception never destroys a joinable thread.
+        struct StagingWorkers {
+            std::atomic<bool> &cancel;
+            std::vector<std::thread> threads;
+
+            ~StagingWorkers() {
+                if (!threads.empty()) {
+                    cancel.store(true);
+                    Join();
+                }
             }
-            if (IsDisallowedUpdaterPackagePath(entry.path)) {
-                return Result::Failure("Updater package contains forbidden path: " + entry.path);
+
+            void Join() {
+                for (std::thread &thread : threads) {
+                    if (thread.joinable()) {
+                        thread.join();
+                    }
+                }
+                threads.clear();
             }
-            const std::string lower = ToLowerAscii(entry.path);
-            if (!managed.contains(lower)) {
-                return Result::Failure("Zip entry is not listed in managedFiles: " + entry.path);
+        };
+
+        size_t ResolveWorkerCount(size_t requested, size_t taskCount) {
+            size_t workers = requested;
+            if (workers == 0) {
+                workers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), kMaxZipStagingWorkers);
             }
-            packageFiles.insert(lower);
+            return std::max<size_t>(1, std::min(workers, taskCount));
         }
 
-        for (const ManagedFile &file : manifest.managedFiles) {
-            if (!packageFiles.contains(ToLowerAscii(file.path))) {
-                return Result::Failure("managedFiles entry is missing from package: " + file.path);
+        // Runs the tasks on worker threads, each with its own reader for the
+        // package. Progress is reported on the calling thread in task order.
+        Result StageEntriesInParallel(const std::wstring &zipPath,
+                                      const std::vector<StagingTask> &tasks,
+                                      size_t workerCount,
+                                      std::vector<StagedFile> &stagedFiles,
+                                      const ProgressCallback &progress) {
+            std::vector<StagedFile> results(tasks.size());
+            std::vector<char> done(tasks.size(), 0);
+            std::atomic<size_t> nextTask{0};
+            std::atomic<bool> cancel{false};
+            std::mutex mutex;
+            std::condition_variable changed;
+            std::optional<Result> failure;
+            size_t finishedWorkers = 0;
+
+            auto fail = [&](Result result) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!failure) {
+                    failure = std::move(result);
+                }
+                cancel.store(true);
+            };
+
+            auto work = [&] {
+                ZipHandle handle;
+                Result opened = OpenZipFile(zipPath, handle);
+                if (!opened.ok) {
+                    fail(std::move(opened));
+                } else {
+                    for (size_t i = nextTask++; i < tasks.size() && !cancel.load(); i = nextTask++) {
+                        Result staged = StageTask(handle.zip, tasks[i], &cancel, results[i]);
+                        if (!staged.ok) {
+                            fail(std::move(staged));
+                            break;
+                        }
+                        std::lock_guard<std::mutex> lock(mutex);
+                        done[i] = 1;
+                        changed.notify_all();
+                    }
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                ++finishedWorkers;
+                changed.notify_all();
+            };
+
+            StagingWorkers workers{cancel};
+            workers.threads.reserve(workerCount);
+            for (size_t i = 0; i < workerCount; ++i) {
+                try {
+                    workers.threads.emplace_back(work);
+                } catch (const std::system_error &e) {
+                    fail(Result::Failure(std::string("Unable to start staging worker: ") + e.what()));
+                    break;
+                }
+            }
+            const size_t started = workers.threads.size();
+
+            size_t reported = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (true) {
+                    changed.wait(lock, [&] {
+                        return failure || finishedWorkers == started || (reported < done.size() && done[reported]);
+                    });
+                    if (failure) {
+                        break;
+                    }
+                    while (reported < done.size() && done[reported]) {
+                        const std::string line = StagedProgressLine(results[reported]);
+                        ++reported;
+                        if (progress) {
+                            lock.unlock();
+                            progress(line);
+                            lock.lock();
+                        }
+                    }
+                    if (reported == done.size() || finishedWorkers == started) {
+                        break;
+                    }
+                }
+            }
+
+            workers.Join();
+            if (failure) {
+                return *failure;
             }
+
+            stagedFiles = std::move(results);
+            return Result::Success();
         }
-        return Result::Success();
+
+        Result ValidateEntries(const std::vector<ZipEntryInfo> &entries,
+                               const UpdaterManifest &manifest,
+                               const ManifestIndex &index) {
+            std::unordered_set<std::string> packageFiles;
+            packageFiles.reserve(entries.size());
+            for (const ZipEntryInfo &entry : entries) {
+                if (entry.directory) {
+                    continue;
+                }
+                if (IsDisallowedUpdaterPackagePath(entry.path)) {
+                    return Result::Failure("Updater package contains forbidden path: " + entry.path);
+                }
+                if (!index.FindManaged(entry.path) && !index.FindDeltaByPatch(entry.path)) {
+                    return Result::Failure("Zip entry is not listed in managedFiles: " + entry.path);
+                }
+                packageFiles.insert(ToLowerAscii(entry.path));
+            }
+
+            for (const DeltaFile &delta : manifest.deltaFiles) {
+                if (!packageFiles.contains(ToLowerAscii(delta.patchPath))) {
+                    return Result::Failure("deltaFiles patch is missing from package: " + delta.patchPath);
+                }
+            }
+            for (const ManagedFile &file : manifest.managedFiles) {
+                if (!packageFiles.contains(ToLowerAscii(file.path)) && !index.FindDelta(file.path)) {
+                    return Result::Failure("managedFiles entry is missing from package: " + file.path);
+                }
+            }
+            return Result::Success();
+        }
+    } // namespace
+
+    Result EnumerateZipEntries(const std::wstring &zipPath, std::vector<ZipEntryInfo> &entries) {
+        entries.clear();
+        ZipHandle handle;
+        Result opened = OpenZipFile(zipPath, handle);
+        if (!opened.ok) {
+            return opened;
+        }
+        return ListZipEntries(handle.zip, entries);
+    }
+
+    Result ValidateUpdaterZipEntries(const std::vector<ZipEntryInfo> &entries,
+                                     const UpdaterManifest &manifest) {
+        return ValidateEntries(entries, manifest, ManifestIndex(manifest));
     }
 
     Result ExtractUpdaterZipToStaging(const std::wstring &zipPath,
                                       const UpdaterManifest &manifest,
                                       const std::wstring &stagingRoot,
                                       std::vector<StagedFile> &stagedFiles,
-                                      ProgressCallback progress) {
+                                      ProgressCallback progress,
+                                      const ZipStagingOptions &options) {
         stagedFiles.clear();
+        ZipHandle handle;
+        Result opened = OpenZipFile(zipPath, handle);
+        if (!opened.ok) {
+            return opened;
+        }
+
         std::vector<ZipEntryInfo> entries;
-        Result enumerated = EnumerateZipEntries(zipPath, entries);
+        Result enumerated = ListZipEntries(handle.zip, entries);
         if (!enumerated.ok) {
             return enumerated;
         }
-        Result validated = ValidateUpdaterZipEntries(entries, manifest);
+        const ManifestIndex index(manifest);
+        Result validated = ValidateEntries(entries, manifest, index);
         if (!validated.ok) {
             return validated;
         }
@@ -140,76 +494,86 @@ namespace bmlupdater {
         if (!RemoveDirectoryTree(stagingRoot, error) || !CreateDirectories(stagingRoot)) {
             return Result::Failure(error.empty() ? "Unable to create staging root: " + PathUtf8(stagingRoot) : error);
         }
+        StagingRootCleanup cleanup{stagingRoot};
 
-        std::vector<char> bytes;
-        ZipHandle handle;
-        Result opened = OpenZipStream(zipPath, bytes, handle);
-        if (!opened.ok) {
-            return opened;
+        std::unordered_map<std::string, size_t> entryIndices;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (!entries[i].directory) {
+                entryIndices.emplace(ToLowerAscii(entries[i].path), i);
+            }
         }
 
-        const ssize_t total = zip_entries_total(handle.zip);
-        for (ssize_t i = 0; i < total; ++i) {
-            if (zip_entry_openbyindex(handle.zip, static_cast<size_t>(i)) < 0) {
-                return Result::Failure("Unable to read zip entry");
-            }
-            const char *name = zip_entry_name(handle.zip);
-            const bool isDirectory = zip_entry_isdir(handle.zip) == 1;
-            std::string error;
-            auto normalized = NormalizeArchivePath(name ? name : "", error);
-            if (!normalized) {
-                zip_entry_close(handle.zip);
-                return Result::Failure("Invalid zip entry path: " + error);
-            }
-            if (isDirectory) {
-                zip_entry_close(handle.zip);
+        // Tasks follow package order; a patched file is staged at the position
+        // of its patch, which also covers its full copy if there is one.
+        std::vector<StagingTask> tasks;
+        tasks.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const ZipEntryInfo &entry = entries[i];
+            if (entry.directory) {
                 continue;
             }
 
-            const ManagedFile *manifestFile = FindManagedFile(manifest, normalized->normalized);
-            if (!manifestFile) {
-                zip_entry_close(handle.zip);
-                return Result::Failure("Unexpected zip entry: " + normalized->normalized);
+            StagingTask task;
+            if (const DeltaFile *delta = index.FindDeltaByPatch(entry.path)) {
+                task.delta = delta;
+                task.patchIndex = i;
+                task.manifestFile = index.FindManaged(delta->path);
+                const auto full = entryIndices.find(ToLowerAscii(delta->path));
+                if (full != entryIndices.end()) {
+                    task.entryIndex = full->second;
+                }
+            } else if (index.FindDelta(entry.path)) {
+                continue;
+            } else {
+                task.entryIndex = i;
+                task.manifestFile = index.FindManaged(entry.path);
             }
-
-            std::wstring outPath;
-            if (!ResolveUnderRoot(stagingRoot, normalized->wideRelative, outPath, error)) {
-                zip_entry_close(handle.zip);
-                return Result::Failure(error);
+            if (!task.manifestFile) {
+                return Result::Failure("Unexpected zip entry: " + entry.path);
             }
 
-            void *buffer = nullptr;
-            size_t bufferSize = 0;
-            const ssize_t read = zip_entry_read(handle.zip, &buffer, &bufferSize);
-            zip_entry_close(handle.zip);
-            if (read < 0 || !buffer) {
-                return Result::Failure("Unable to extract zip entry: " + normalized->normalized);
+            std::string pathError;
+            auto normalized = NormalizeArchivePath(task.manifestFile->path, pathError);
+            if (!normalized) {
+                return Result::Failure("Invalid zip entry path: " + pathError);
             }
-
-            const auto freeBuffer = std::unique_ptr<void, decltype(&std::free)>(buffer, &std::free);
-            if (!WriteBinaryFile(outPath, buffer, bufferSize, error)) {
+            if (!ResolveUnderRoot(stagingRoot, normalized->wideRelative, task.outPath, error)) {
                 return Result::Failure(error);
             }
-
-            std::array<uint8_t, 32> digest{};
-            if (!utils::Sha256File(outPath, digest.data())) {
-                return Result::Failure("Unable to hash staged file: " + normalized->normalized);
+            if (task.delta && !options.deltaBaseRoot.empty() &&
+                !ResolveUnderRoot(options.deltaBaseRoot, normalized->wideRelative, task.basePath, pathError)) {
+                task.basePath.clear();
             }
-            const std::string hash = BytesToHex(digest.data(), digest.size());
-            if (hash != ToLowerAscii(manifestFile->sha256)) {
-                return Result::Failure("Staged file hash does not match manifest: " + normalized->normalized);
-            }
-            const uint64_t fileSize = FileSize(outPath);
-            if (manifestFile->size != 0 && fileSize != manifestFile->size) {
-                return Result::Failure("Staged file size does not match manifest: " + normalized->normalized);
+            if (!CreateDirectories(ParentPath(task.outPath))) {
+                return Result::Failure("Unable to create directory: " + PathUtf8(ParentPath(task.outPath)));
             }
+            tasks.push_back(std::move(task));
+        }
 
-            stagedFiles.push_back({normalized->normalized, outPath, hash, fileSize});
-            if (progress) {
-                progress("staged " + normalized->normalized);
+        Result staged = Result::Success();
+        const size_t workers = ResolveWorkerCount(options.workerCount, tasks.size());
+        if (workers > 1) {
+            staged = StageEntriesInParallel(zipPath, tasks, workers, stagedFiles, progress);
+        } else {
+            for (const StagingTask &task : tasks) {
+                StagedFile file;
+                staged = StageTask(handle.zip, task, nullptr, file);
+                if (!staged.ok) {
+                    break;
+                }
+                if (progress) {
+                    progress(StagedProgressLine(file));
+                }
+                stagedFiles.push_back(std::move(file));
             }
         }
 
+        if (!staged.ok) {
+            stagedFiles.clear();
+            return staged;
+        }
+
+        cleanup.keep = true;
         return Result::Success();
     }
 } // namespace bmlupdater
@@ -13,14 +13,35 @@ namespace bmlupdater {
         bool directory{false};
     };
 
+    // Upper bound for the number of entries staged at once when the caller
+    // leaves the choice to ExtractUpdaterZipToStaging.
+    inline constexpr size_t kMaxZipStagingWorkers = 8;
+
+    struct ZipStagingOptions {
+        // 0 picks one worker per core up to kMaxZipStagingWorkers.
+        size_t workerCount{0};
+        // Root of the installed files that deltaFiles patch. Without it every
+        // file is staged from its full copy.
+        std::wstring deltaBaseRoot;
+    };
+
     [[nodiscard]] Result EnumerateZipEntries(const std::wstring &zipPath, std::vector<ZipEntryInfo> &entries);
     [[nodiscard]] Result ValidateUpdaterZipEntries(const std::vector<ZipEntryInfo> &entries,
                                                    const UpdaterManifest &manifest);
+    // Stages every managed file of the package under stagingRoot, checking
+    // each against the manifest. A file with a delta entry is patched from the
+    // installed file when that is the patch base, and staged from its full
+    // copy otherwise. With more than one worker, entries are inflated and
+    // hashed in parallel, each worker reading the package through its own
+    // handle. Progress is reported on the calling thread in package order. On
+    // the first failure the remaining work is cancelled and stagingRoot is
+    // removed.
     [[nodiscard]] Result ExtractUpdaterZipToStaging(const std::wstring &zipPath,
                                                     const UpdaterManifest &manifest,
                                                     const std::wstring &stagingRoot,
                                                     std::vector<StagedFile> &stagedFiles,
-                                                    ProgressCallback progress = {});
+                                                    ProgressCallback progress = {},
+                                                    const ZipStagingOptions &options = {});
 } // namespace bmlupdater
 
 #endif // BML_UPDATER_ZIP_H
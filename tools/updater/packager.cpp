@@ -0,0 +1,99 @@
+#include <Windows.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "JsonUtils.h"
+#include "UpdaterDelta.h"
+#include "UpdaterPaths.h"
+
+namespace {
+    void PrintUsage() {
+        std::cout <<
+            "BML+ Updater Packager\n"
+            "\n"
+            "Commands:\n"
+            "  delta <package-stage> <previous-stage> <out.json> [--drop-full]\n"
+            "      Writes patches for files that changed since the previous release\n"
+            "      into the package stage and the managedFiles/deltaFiles manifest\n"
+            "      sections to out.json. --drop-full removes the full copies of\n"
+            "      patched files from the stage.\n";
+    }
+
+    std::string DeltaJson(const std::vector<bmlupdater::ManagedFile> &managedFiles,
+                          const std::vector<bmlupdater::DeltaFile> &deltaFiles,
+                          std::string &error) {
+        utils::MutableJsonDocument doc;
+        yyjson_mut_val *root = doc.CreateObject();
+        doc.SetRoot(root);
+
+        yyjson_mut_val *managed = doc.CreateArray();
+        for (const bmlupdater::ManagedFile &file : managedFiles) {
+            yyjson_mut_val *item = doc.CreateObject();
+            (void)doc.AddString(item, "path", file.path);
+            (void)doc.AddString(item, "sha256", file.sha256);
+            (void)doc.AddInt(item, "size", static_cast<int64_t>(file.size));
+            (void)doc.AddValue(managed, item);
+        }
+        (void)doc.AddValue(root, "managedFiles", managed);
+
+        yyjson_mut_val *deltas = doc.CreateArray();
+        for (const bmlupdater::DeltaFile &file : deltaFiles) {
+            yyjson_mut_val *item = doc.CreateObject();
+            (void)doc.AddString(item, "path", file.path);
+            (void)doc.AddString(item, "baseSha256", file.baseSha256);
+            (void)doc.AddString(item, "patch", file.patchPath);
+            (void)doc.AddString(item, "patchSha256", file.patchSha256);
+            (void)doc.AddValue(deltas, item);
+        }
+        (void)doc.AddValue(root, "deltaFiles", deltas);
+        return doc.Write(true, error);
+    }
+
+    int RunDelta(int argc, wchar_t **argv) {
+        if (argc < 5) {
+            PrintUsage();
+            return 2;
+        }
+        bmlupdater::DeltaPackageOptions options;
+        for (int i = 5; i < argc; ++i) {
+            if (std::wstring(argv[i]) == L"--drop-full") {
+                options.keepFullFiles = false;
+            } else {
+                PrintUsage();
+                return 2;
+            }
+        }
+
+        std::vector<bmlupdater::ManagedFile> managedFiles;
+        std::vector<bmlupdater::DeltaFile> deltaFiles;
+        bmlupdater::Result result = bmlupdater::BuildDeltaPackage(
+            argv[2], argv[3], options, managedFiles, deltaFiles, [](const std::string &line) {
+                std::cout << line << "\n";
+            });
+        if (!result.ok) {
+            std::cout << "ERROR: " << result.message << "\n";
+            return 1;
+        }
+
+        std::string error;
+        const std::string json = DeltaJson(managedFiles, deltaFiles, error);
+        if (json.empty() || !bmlupdater::WriteTextFile(argv[4], json, error)) {
+            std::cout << "ERROR: " << (error.empty() ? "Unable to write delta manifest" : error) << "\n";
+            return 1;
+        }
+        std::cout << "OK: " << deltaFiles.size() << " of " << managedFiles.size() << " files patched\n";
+        return 0;
+    }
+}
+
+int wmain(int argc, wchar_t **argv) {
+    SetConsoleOutputCP(CP_UTF8);
+    const std::wstring command = argc > 1 ? argv[1] : L"--help";
+    if (command == L"delta") {
+        return RunDelta(argc, argv);
+    }
+    PrintUsage();
+    return command == L"--help" || command == L"-h" ? 0 : 2;
+}